@@ -1,6 +1,12 @@
+// 此文件由 scripts/keygen.py 生成，加入工程编译后以 extern 声明引用：
+//   extern const uint8_t smota_ecdsa_pub_key[64];
+//   extern const unsigned int smota_ecdsa_pub_table[16 * 16];
+
+#include <stdint.h>
+
 // ECDSA-P256 公钥 (未压缩格式)
 // X 坐标 (32 bytes)
-static const uint8_t smota_ecdsa_pub_key_x[32] = {
+const uint8_t smota_ecdsa_pub_key_x[32] = {
     0x73, 0x6D, 0xE7, 0xC2, 0x01, 0x1F, 0xEA, 0xF0,
     0xB6, 0xCA, 0x34, 0x97, 0x99, 0x35, 0x77, 0xC9,
     0x57, 0xF4, 0x8D, 0x8F, 0xAE, 0x19, 0xDA, 0x67,
@@ -8,7 +14,7 @@ static const uint8_t smota_ecdsa_pub_key_x[32] = {
 };
 
 // Y 坐标 (32 bytes)
-static const uint8_t smota_ecdsa_pub_key_y[32] = {
+const uint8_t smota_ecdsa_pub_key_y[32] = {
     0xD6, 0x61, 0xDC, 0xCA, 0x4E, 0x50, 0x92, 0xEF,
     0x22, 0x09, 0xE7, 0x3D, 0x8D, 0x48, 0x17, 0xC6,
     0x21, 0x51, 0xD1, 0x78, 0x15, 0xCC, 0x20, 0x53,
@@ -16,7 +22,7 @@ static const uint8_t smota_ecdsa_pub_key_y[32] = {
 };
 
 // 完整公钥 (64 bytes)
-static const uint8_t smota_ecdsa_pub_key[64] = {
+const uint8_t smota_ecdsa_pub_key[64] = {
     0x73, 0x6D, 0xE7, 0xC2, 0x01, 0x1F, 0xEA, 0xF0,
     0xB6, 0xCA, 0x34, 0x97, 0x99, 0x35, 0x77, 0xC9,
     0x57, 0xF4, 0x8D, 0x8F, 0xAE, 0x19, 0xDA, 0x67,
@@ -26,3 +32,88 @@ static const uint8_t smota_ecdsa_pub_key[64] = {
     0x21, 0x51, 0xD1, 0x78, 0x15, 0xCC, 0x20, 0x53,
     0xAE, 0xE1, 0x63, 0xE7, 0x60, 0x5C, 0x5A, 0xE5
 };
+
+// ECDSA-P256 验签预计算表 (uECC_verify_with_table 使用)
+// 奇数倍点 Q, 3Q, ..., 31Q，每点 x、y 各 8 个 32 位字，低位字在前
+const unsigned int smota_ecdsa_pub_table[16 * 16] = {
+    /* 1Q */
+    0x8C576998, 0xA80FD1A9, 0xAE19DA67, 0x57F48D8F,
+    0x993577C9, 0xB6CA3497, 0x011FEAF0, 0x736DE7C2,
+    0x605C5AE5, 0xAEE163E7, 0x15CC2053, 0x2151D178,
+    0x8D4817C6, 0x2209E73D, 0x4E5092EF, 0xD661DCCA,
+    /* 3Q */
+    0x5A4C047B, 0xF5E729D3, 0xBA4FDB3F, 0xED879112,
+    0x53E36FF3, 0x521CD39A, 0x3A52E719, 0xD180EF8D,
+    0x65E2E8A6, 0x7812432F, 0xF35BD8CC, 0x4BCC3347,
+    0x99F56CEE, 0x5E5F4F15, 0x66D59C7C, 0x82291892,
+    /* 5Q */
+    0xE832A2C5, 0x2CF74D99, 0x16B27487, 0x89BAD28E,
+    0x19E697C2, 0x08B8DC5C, 0xED089BD8, 0x4CD450CA,
+    0x9A1084A9, 0x9DD7AA2E, 0xE1D78CE8, 0xF3E846E7,
+    0x91A5DEBD, 0xB50F3424, 0x4392619F, 0xAD9F58E2,
+    /* 7Q */
+    0x544FD233, 0x5783568C, 0x3BB3B711, 0x19B38959,
+    0xA57402C1, 0x45C54681, 0x30F0D63E, 0xE28485B9,
+    0xA69877D2, 0x197A7282, 0x4AE40F6A, 0x3E743114,
+    0xD1E9AC7D, 0xFAAFD224, 0x15E9806F, 0xF5EDC770,
+    /* 9Q */
+    0xBAE4595E, 0x1BFF48CA, 0x0E372D51, 0x6E89827B,
+    0x44B62111, 0x5CA3A4C5, 0xA2A90D67, 0x3794C408,
+    0x09B530E4, 0x0AAF52D2, 0x7F1B7B2C, 0x21503996,
+    0xE3706AC7, 0x9B7CBC40, 0xA1E33AEB, 0xD74A0017,
+    /* 11Q */
+    0x5D77051F, 0xB26751AB, 0xED056377, 0x5A8908A4,
+    0x690D935C, 0xA3C0F07D, 0x3C6CA0AB, 0x81BA4DC3,
+    0x87207BA2, 0x0A8C4737, 0x8F534CC0, 0x82C5A3E0,
+    0xFEEDB950, 0x5EC47039, 0xD0B0896F, 0x3334F5C0,
+    /* 13Q */
+    0xF28B1B74, 0xA220D15A, 0x5400F683, 0xDBFA0F95,
+    0x5483BBFB, 0x062E2125, 0x51C74E8D, 0xB3F0E634,
+    0xEE7209C9, 0x2334396E, 0x90AC2030, 0xF1E46CB7,
+    0x3C67B7A6, 0xDE620710, 0x11D327E8, 0xCC145637,
+    /* 15Q */
+    0xB3AA62CC, 0x0728497B, 0x241D1351, 0x6DB2E9E1,
+    0xEDB67F80, 0x1A0C1BC5, 0x31437B79, 0x28F51F18,
+    0x2D0E724E, 0x4E6CA3E0, 0xC0110533, 0x77CEB610,
+    0x2B81C326, 0xE2886069, 0x47D5AAF4, 0x05B14508,
+    /* 17Q */
+    0x5B809A96, 0x1A52639E, 0xD82643B6, 0x1F398C23,
+    0x3CA446B6, 0x3102D0DF, 0x7EA92D15, 0x7B77F433,
+    0x242A4E4E, 0x27163273, 0xAA666668, 0x1C32777A,
+    0xD3C5556C, 0xBEC6223F, 0xDEE765CA, 0x5225C158,
+    /* 19Q */
+    0x7950EE9B, 0xDDC4EA48, 0x99DD492B, 0xCC363B36,
+    0xF903E211, 0x1777000B, 0x5CB828F7, 0x36B656BD,
+    0xA8B9D847, 0x4CA2A815, 0xCCDB76BC, 0xC28C7A48,
+    0xC7099DF4, 0x239C2091, 0x98942A8B, 0x6C919962,
+    /* 21Q */
+    0x596D3E5F, 0x809C69BD, 0xFD4FA63F, 0xF5299A71,
+    0xE65D6711, 0xDEEF73C4, 0x2C0DF704, 0x6CDB5F56,
+    0x83A25077, 0x4BF12D93, 0xA5ED572F, 0x0CD79CF7,
+    0x45CD4B5F, 0xA3E80558, 0xE8C217DB, 0xFE36F9E9,
+    /* 23Q */
+    0xF5DBDBB2, 0xE5390A38, 0x813D19D8, 0xC366B5BF,
+    0xECC2D5F7, 0xE3553BB0, 0x8FC9114A, 0x7BD774A2,
+    0x33D6A940, 0x930C3CAD, 0x1C453A72, 0x754E1E32,
+    0x55B9143C, 0xBBB997B1, 0xF7DD8F6C, 0x6298F769,
+    /* 25Q */
+    0x4C0D9080, 0x222BF01B, 0x61CB6B2D, 0x9998E413,
+    0x88045CFD, 0x19094A3B, 0x98598042, 0x2464F079,
+    0x97ABC088, 0x117775EB, 0x41D71948, 0x1F21753C,
+    0xC86B0C4B, 0xA6C7A893, 0x6B5D07A4, 0x4FA2EE5F,
+    /* 27Q */
+    0xAF1D9C02, 0x548D7782, 0x09435D32, 0x5481AE69,
+    0x96E6D18D, 0xF296A6B4, 0x8364B632, 0x88355E15,
+    0x2F7A0CFE, 0xDBB848AE, 0x85132B75, 0x188282B7,
+    0x99BA3E6A, 0x31259A45, 0xBA1EEF7E, 0xBCD388E4,
+    /* 29Q */
+    0xF13E95E1, 0x23A9C73C, 0xA0238EB7, 0x52B76C9B,
+    0xCD4AC36E, 0x49FB9E40, 0xD20E4FA3, 0x95A4A9EE,
+    0x3EF50EEC, 0x36FAC30F, 0x0B4122E2, 0xA63F9620,
+    0x63988D4B, 0xBACA9089, 0x573CBB3E, 0x60B27159,
+    /* 31Q */
+    0xA0BDFF68, 0xA038B404, 0xF1747BFB, 0xFF95004B,
+    0x5E615E18, 0x9C97106A, 0xD3CFB51D, 0x29AE62C8,
+    0x148E41F0, 0xAD9A6E96, 0x4D7D3C5F, 0xFE647AE2,
+    0x246A3C42, 0x8FB49B8D, 0x469BC1CD, 0x215B0C39
+};
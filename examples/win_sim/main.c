@@ -21,10 +21,49 @@
 #endif
 
 #include "smota.h"
+#include "smota_nor_flash.h"
+#include "smota_task.h"
 #include "port/smota_port.h"
+#include "tinycrypt/sha256.h"
+#include "tinycrypt/sha256_mb.h"
+#include "tinycrypt/aes.h"
+#include "tinycrypt/ctr_mode.h"
+#include "tinycrypt/chacha20_poly1305.h"
+#include "tinycrypt/ecc_dsa.h"
+#include "tinycrypt/constants.h"
 
 /*---------- macro ----------*/
 
+/**
+ * @brief  模拟 QSPI NOR 容量
+ */
+#define WIN_SIM_QSPI_SIZE (8 * 1024 * 1024)
+
+/**
+ * @brief  QSPI 外部存储设备编号（hal->ext_flash[0]）
+ */
+#define WIN_SIM_QSPI_DEV  1
+
+/**
+ * @brief  加密吞吐量测试的数据量
+ */
+#define WIN_SIM_CRYPTO_BENCH_SIZE (4 * 1024 * 1024)
+
+/**
+ * @brief  ECDSA 验签吞吐量测试的签名数量
+ */
+#define WIN_SIM_ECDSA_BENCH_NUM 256
+
+/**
+ * @brief  OTA 任务测试中推送的帧数
+ */
+#define WIN_SIM_TASK_BENCH_NUM 500
+
+/**
+ * @brief  OTA 任务测试末尾的空闲时间（毫秒）
+ */
+#define WIN_SIM_TASK_IDLE_MS 3000
+
 /*---------- type define ----------*/
 
 /*---------- variable prototype ----------*/
@@ -42,6 +81,17 @@ static struct smota_flash_driver g_flash_driver = {
     .flash_unlock = flash_unlock,
 };
 
+/*---------- 外部 QSPI NOR 驱动接口 ----------*/
+static const struct smota_nor_bus g_qspi_bus = {
+    .transfer = qspi_sim_transfer,
+};
+
+SMOTA_NOR_DEVICE_DEFINE(g_qspi_driver, &g_qspi_bus, WIN_SIM_QSPI_SIZE);
+
+static struct smota_flash_driver *const g_ext_flash[] = {
+    &g_qspi_driver,
+};
+
 /*---------- 通信驱动接口 ----------*/
 static struct smota_comm_driver g_comm_driver = {
     .init = comm_init,
@@ -51,19 +101,41 @@ static struct smota_comm_driver g_comm_driver = {
 };
 
 /*---------- 加密驱动接口 ----------*/
+/* 上下文存储由核心的静态上下文池提供（*_init_at），升级过程不分配堆内存 */
 static struct smota_crypto_driver g_crypto_driver = {
-    .sha256_init = tc_port_sha256_init,
     .sha256_update = tc_port_sha256_update,
     .sha256_final = tc_port_sha256_final,
-    .aes_init = tc_port_aes_init,
+    .sha256_batch = tc_port_sha256_batch,
     .aes_crypt = tc_port_aes_crypt,
     .ecdsa_verify = tc_port_ecdsa_verify,
+    .ecdsa_verify_fixed = tc_port_ecdsa_verify_fixed,
+    .block_mac = tc_port_block_mac,
+    .aead_decrypt = tc_port_aead_decrypt,
+    .sha256_ctx_size = tc_port_sha256_ctx_size,
+    .sha256_init_at = tc_port_sha256_init_at,
+    .aes_ctx_size = tc_port_aes_ctx_size,
+    .aes_init_at = tc_port_aes_init_at,
+    .blake2s_ctx_size = tc_port_blake2s_ctx_size,
+    .blake2s_init_at = tc_port_blake2s_init_at,
+    .blake2s_update = tc_port_blake2s_update,
+    .blake2s_final = tc_port_blake2s_final,
 };
 
 /*---------- 系统驱动接口 ----------*/
 static struct smota_system_driver g_system_driver = {
     .get_tick_ms = system_get_tick_ms,
     .system_reset = system_reset,
+    .get_tick_us = system_get_tick_us,
+};
+
+/*---------- RTOS 接口（主机线程模拟） ----------*/
+static const struct smota_os_driver g_os_driver = {
+    .sem_create = os_sim_sem_create,
+    .sem_delete = os_sim_sem_delete,
+    .sem_wait = os_sim_sem_wait,
+    .sem_post = os_sim_sem_post,
+    .task_create = os_sim_task_create,
+    .task_join = os_sim_task_join,
 };
 
 /*---------- HAL 综合接口 ----------*/
@@ -72,12 +144,230 @@ static struct smota_hal g_smota_hal = {
     .comm = &g_comm_driver,
     .crypto = &g_crypto_driver,
     .system = &g_system_driver,
+    .partitions = NULL, /* 运行时由 build_partition_table() 生成 */
+    .ext_flash = g_ext_flash,
+    .ext_flash_num = sizeof(g_ext_flash) / sizeof(g_ext_flash[0]),
 };
 
 /*---------- variable ----------*/
 
+/**
+ * @brief  运行时生成的分区表
+ */
+static struct smota_partition_table g_partition_table;
+
+/**
+ * @brief  数据块认证密钥（模拟器演示用，实际产品可用 KDF 以 "smOTA_Auth_v1" 上下文派生）
+ */
+static const uint8_t g_block_auth_key[16] = {
+    0x73, 0x6d, 0x4f, 0x54, 0x41, 0x2d, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x2d, 0x61, 0x75, 0x74, 0x68,
+};
+
+/**
+ * @brief  传输加密主密钥（模拟器演示用，实际产品只保存在发布工具中，设备烧录派生后的密钥）
+ */
+static const uint8_t g_transport_master_key[32] = {
+    0x73, 0x6d, 0x4f, 0x54, 0x41, 0x2d, 0x6d, 0x61, 0x73, 0x74, 0x65, 0x72, 0x2d, 0x6b, 0x65, 0x79,
+    0x2d, 0x64, 0x65, 0x6d, 0x6f, 0x2d, 0x6f, 0x6e, 0x6c, 0x79, 0x2d, 0x30, 0x30, 0x30, 0x30, 0x31,
+};
+
+/**
+ * @brief  模拟设备 UID（实际硬件上读取芯片唯一 ID）
+ */
+static const uint8_t g_device_uid[12] = {
+    0x57, 0x49, 0x4e, 0x53, 0x49, 0x4d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+};
+
+/**
+ * @brief  ECDSA 演示私钥（keys/ecdsa_private_key.pem，仅供模拟器自测签名，实际产品的私钥只保存在签名端）
+ */
+static const uint8_t g_ecdsa_demo_private_key[32] = {
+    0x20, 0x3f, 0x57, 0x3c, 0x87, 0x6d, 0xc9, 0x03, 0x61, 0x9e, 0x43, 0xc7, 0xcf, 0xde, 0xd4, 0x85,
+    0xf6, 0x6d, 0x6f, 0x5d, 0x31, 0x90, 0xd2, 0xe0, 0x08, 0x82, 0xa4, 0x4e, 0x70, 0xd0, 0x17, 0x38,
+};
+
 /*---------- function ----------*/
 
+/**
+ * @brief  派生本设备的传输密钥（一机一密）
+ * @param  key: 输出密钥（32字节，AEAD 取全部，AES-128-CTR 取前 16 字节）
+ * @return 0=成功, <0=失败
+ * @note   HMAC-SHA256(主密钥, UID || SMOTA_KDF_CONTEXT)，发布工具按同样方式为每台设备派生
+ */
+static int derive_transport_key(uint8_t key[32])
+{
+    return smota_kdf_derive(g_transport_master_key, g_device_uid, sizeof(g_device_uid), SMOTA_KDF_CONTEXT, key);
+}
+
+/**
+ * @brief       获取密钥（模拟器实现）
+ * @param[in]   key_id: 密钥 ID SMOTA_KEY_*
+ * @param[out]  out_key: 输出缓冲区
+ * @param[in]   len: 缓冲区长度
+ * @note        公钥取自 keys/ecdsa_public_key.c（HEADER_INFO 验签经 ecdsa_verify_fixed 使用同一文件中的预计算表），
+ *              设备传输密钥由演示主密钥和 UID 派生；实际产品使用 keygen.py --c-file 生成的 smota_keys.c
+ */
+void smota_get_key(uint8_t key_id, uint8_t *out_key, uint32_t len)
+{
+    uint8_t device_key[32];
+
+    memset(out_key, 0, len);
+
+    if (key_id == SMOTA_KEY_ECDSA_PUB && len >= SMOTA_ECDSA_PUB_KEY_SIZE) {
+        memcpy(out_key, smota_ecdsa_pub_key, SMOTA_ECDSA_PUB_KEY_SIZE);
+    }
+
+    if (key_id == SMOTA_KEY_AES_DEVICE && len >= 16 && derive_transport_key(device_key) == 0) {
+        memcpy(out_key, device_key, 16);
+    }
+    memset(device_key, 0, sizeof(device_key));
+}
+
+/**
+ * @brief  根据 Flash 容量生成分区表
+ * @param  flash_size: Flash 总容量（实际硬件上可从芯片容量寄存器读取）
+ * @param  qspi_staging: true=备份区放在外部 QSPI NOR 上
+ * @note   Bootloader 和元数据区大小固定，其余空间平分给 App 区和备份区，
+ *         同一 Bootloader 即可适配不同容量的板卡；
+ *         备份区放在 QSPI NOR 上时片内除 Bootloader 和元数据区外全部给 App 区
+ */
+static void build_partition_table(uint32_t flash_size, bool qspi_staging)
+{
+    struct smota_partition_table *table = &g_partition_table;
+    uint32_t meta_size = SMOTA_META_SECTOR_SIZE * SMOTA_META_SECTOR_NUM;
+    uint32_t slot_size;
+
+    smota_partition_table_default(table);
+
+    if (qspi_staging) {
+        slot_size = SMOTA_ALIGN_DOWN(flash_size - SMOTA_BOOTLOADER_SIZE - meta_size, SMOTA_FLASH_PAGE_SIZE);
+    } else {
+        slot_size = SMOTA_ALIGN_DOWN((flash_size - SMOTA_BOOTLOADER_SIZE - meta_size) / 2, SMOTA_FLASH_PAGE_SIZE);
+    }
+
+    for (uint8_t i = 0; i < table->count; i++) {
+        struct smota_partition *part = &table->entries[i];
+
+        switch (part->id) {
+        case SMOTA_PART_ID_APP:
+            part->addr = SMOTA_FLASH_BASE_ADDR + SMOTA_BOOTLOADER_SIZE;
+            part->size = slot_size;
+            break;
+        case SMOTA_PART_ID_BACKUP:
+            if (qspi_staging) {
+                /* 外部 NOR 按 64KB 块擦除、256 字节页编程 */
+                part->dev = WIN_SIM_QSPI_DEV;
+                part->addr = 0;
+                part->size = SMOTA_ALIGN_UP(slot_size, SMOTA_NOR_BLOCK_SIZE);
+                part->erase_size = SMOTA_NOR_BLOCK_SIZE;
+                part->write_size = SMOTA_NOR_PAGE_SIZE;
+            } else {
+                part->addr = SMOTA_FLASH_BASE_ADDR + SMOTA_BOOTLOADER_SIZE + slot_size;
+                part->size = slot_size;
+            }
+            break;
+        case SMOTA_PART_ID_META:
+            part->addr = SMOTA_FLASH_BASE_ADDR + flash_size - meta_size;
+            break;
+        default:
+            break;
+        }
+    }
+
+    smota_partition_table_seal(table);
+    g_smota_hal.partitions = table;
+}
+
+/**
+ * @brief  打印分区表
+ */
+static void show_partitions(void)
+{
+    printf("Partitions:\n");
+    for (uint8_t i = 0; i < smota_partition_count(); i++) {
+        const struct smota_partition *part = smota_partition_get(i);
+
+        printf("  %-8.8s id=%u dev=%u addr=0x%08X size=%uKB erase=%u\n",
+               part->name, (unsigned int)part->id, (unsigned int)part->dev,
+               (unsigned int)part->addr, (unsigned int)(part->size / 1024),
+               (unsigned int)part->erase_size);
+    }
+}
+
+/**
+ * @brief  打印下载区擦除计数
+ */
+static void show_wear(void)
+{
+    struct smota_wear_info info;
+    uint16_t counts[16];
+    uint16_t first = 0;
+    int num;
+
+    if (smota_wear_info_get(&info) < 0) {
+        return;
+    }
+
+    printf("Wear: %u units x %uB, %u unit(s)/counter, erases min=%u max=%u, stage 0x%X+%uKB\n",
+           (unsigned int)info.unit_num, (unsigned int)info.erase_size,
+           (unsigned int)info.unit_per_counter, (unsigned int)info.min_count,
+           (unsigned int)info.max_count, (unsigned int)info.stage_offset,
+           (unsigned int)(info.stage_size / 1024));
+
+    while ((num = smota_wear_counts_get(first, counts, 16)) > 0) {
+        printf("  [%3u]", (unsigned int)first);
+        for (int i = 0; i < num; i++) {
+            printf(" %u", (unsigned int)counts[i]);
+        }
+        printf("\n");
+        first += (uint16_t)num;
+    }
+}
+
+/**
+ * @brief  打印 Flash 操作统计（本次会话）
+ */
+static void show_flash_stats(void)
+{
+    struct smota_flash_summary summary;
+    struct smota_flash_region_stats region;
+
+    if (smota_stats_summary_get(&summary) < 0) {
+        return;
+    }
+
+    printf("Flash ops (session %ums, image %uB):\n",
+           (unsigned int)summary.elapsed_ms, (unsigned int)summary.image_size);
+    printf("  %-8s %-6s %8s %6s %10s %10s\n", "region", "op", "count", "err", "bytes", "time(us)");
+
+    for (uint8_t i = 0; i < smota_partition_count(); i++) {
+        const struct smota_partition *part = smota_partition_get(i);
+
+        if (smota_stats_region_get(i, &region) < 0) {
+            continue;
+        }
+
+        for (uint8_t op = 0; op < SMOTA_FLASH_OP_NUM; op++) {
+            const struct smota_flash_op_stats *item = &region.op[op];
+
+            if (item->count == 0) {
+                continue;
+            }
+            printf("  %-8.8s %-6s %8u %6u %10u %10u\n", part->name, smota_stats_op_name(op),
+                   (unsigned int)item->count, (unsigned int)item->errors,
+                   (unsigned int)item->bytes, (unsigned int)item->time_us);
+        }
+    }
+
+    if (summary.image_size > 0) {
+        printf("  staging: erased %uB (x%u.%02u), written %uB (x%u.%02u)\n",
+               (unsigned int)summary.stage_erase_bytes,
+               (unsigned int)(summary.erase_amp_x100 / 100), (unsigned int)(summary.erase_amp_x100 % 100),
+               (unsigned int)summary.stage_write_bytes,
+               (unsigned int)(summary.write_amp_x100 / 100), (unsigned int)(summary.write_amp_x100 % 100));
+    }
+}
+
 /**
  * @brief  打印使用帮助
  */
@@ -90,6 +380,10 @@ static void print_help(const char *prog)
     printf("  -s, --status     Show OTA status\n");
     printf("  -r, --run        Run OTA poll loop (simulate device)\n");
     printf("  -t, --test       Run self-test\n");
+    printf("  -q, --qspi       Place the backup slot on simulated QSPI NOR\n");
+    printf("  -b, --bench      Benchmark backup slot staging throughput on QSPI NOR\n");
+    printf("  -c, --crypto     Benchmark crypto throughput (SHA-256)\n");
+    printf("  -k, --task       Benchmark the OTA task (thread + semaphore) against the 1ms poll loop\n");
     printf("\nExample:\n");
     printf("  %s -r    # Run as device, waiting for OTA commands\n", prog);
     printf("  %s -t    # Run self-test\n", prog);
@@ -113,9 +407,156 @@ static void show_status(void)
                smota_get_error());
     }
 
+    show_partitions();
+    show_wear();
+    show_flash_stats();
+
     printf("==================\n\n");
 }
 
+#if SMOTA_FEED_BUF_SIZE > 0
+/**
+ * @brief  休眠
+ * @param  ms: 毫秒
+ */
+static void sim_sleep_ms(uint32_t ms)
+{
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    usleep(ms * 1000);
+#endif
+}
+
+/**
+ * @brief  自测试期间收到的握手应答数
+ */
+static volatile uint32_t g_feed_test_resp_num;
+
+/**
+ * @brief  最近一次握手应答的时间（微秒）
+ */
+static volatile uint64_t g_feed_test_resp_us;
+
+/**
+ * @brief  自测试期间最近一次头部信息应答的错误码
+ */
+static volatile uint32_t g_feed_test_header_err;
+
+/**
+ * @brief  自测试用发送函数：只统计握手应答并记录头部信息应答，不输出到 stdout
+ */
+static int feed_test_send(const uint8_t *data, uint32_t size)
+{
+    struct smota_frame frame;
+    struct smota_header_info_resp header_resp;
+
+    if (smota_frame_parse(data, (uint16_t)size, &frame) == 0) {
+        if (frame.header.cmd == SMOTA_CMD_HANDSHAKE_RESP) {
+            g_feed_test_resp_us = system_get_tick_us();
+            g_feed_test_resp_num++;
+        } else if (frame.header.cmd == SMOTA_CMD_HEADER_INFO_RESP && frame.header.length >= sizeof(header_resp)) {
+            memcpy(&header_resp, frame.payload, sizeof(header_resp));
+            g_feed_test_header_err = header_resp.error_code;
+        }
+    }
+    return (int)size;
+}
+#endif
+
+#if SMOTA_INSTANCE_THREAD_LOCAL && SMOTA_INSTANCE_MAX > 1
+/**
+ * @brief  按线程保存当前实例的测试参数
+ */
+struct tls_test {
+    struct smota_instance *inst; /* 测试线程进入的实例 */
+    void *entered;               /* 测试线程已进入实例 */
+    void *release;               /* 主线程检查完毕 */
+    int ok;                      /* 测试线程的检查结果 */
+};
+
+/**
+ * @brief  测试线程：进入实例后等主线程检查它自己的当前实例，再确认本线程的当前实例未被改动
+ */
+static void tls_test_thread(void *arg)
+{
+    struct tls_test *test = (struct tls_test *)arg;
+    struct smota_instance *prev = smota_instance_enter(test->inst);
+
+    os_sim_sem_post(test->entered);
+    test->ok = (os_sim_sem_wait(test->release, 1000) == 0) && (smota_instance_current() == test->inst) &&
+               (prev == smota_instance_default());
+    smota_instance_leave(prev);
+}
+#endif
+
+/**
+ * @brief  自测试用总线：芯片能识别但一直处于忙状态
+ */
+static int stuck_nor_transfer(const uint8_t *cmd, uint32_t cmd_len, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    static const uint8_t id[3] = { 0xEF, 0x40, 0x19 };
+
+    (void)cmd_len;
+    (void)tx;
+
+    for (uint32_t i = 0; rx != NULL && i < len; i++) {
+        rx[i] = (cmd[0] == 0x9F && i < sizeof(id)) ? id[i] : 0x01;
+    }
+    return 0;
+}
+
+/**
+ * @brief  自测试：读取元数据扇区代数
+ * @return 扇区代数，扇区头无效时为 0
+ */
+static uint32_t meta_test_generation(const struct smota_partition *meta, uint8_t sector)
+{
+    uint32_t hdr[2];
+
+    if (smota_partition_read(meta, (uint32_t)sector * SMOTA_META_SECTOR_SIZE, (uint8_t *)hdr, sizeof(hdr)) !=
+            (int)sizeof(hdr) ||
+        hdr[0] != SMOTA_META_MAGIC) {
+        return 0;
+    }
+
+    return hdr[1];
+}
+
+/**
+ * @brief  自测试：当前元数据扇区（代数最大的有效扇区）
+ */
+static uint8_t meta_test_current(const struct smota_partition *meta)
+{
+    uint8_t current = 0;
+
+    for (uint8_t i = 1; i < meta->size / SMOTA_META_SECTOR_SIZE; i++) {
+        if (meta_test_generation(meta, i) > meta_test_generation(meta, current)) {
+            current = i;
+        }
+    }
+
+    return current;
+}
+
+/**
+ * @brief  自测试：按记录头逐条跳过，返回扇区内第一个未写入的偏移（相对扇区起始）
+ */
+static uint32_t meta_test_end(const struct smota_partition *meta, uint8_t sector)
+{
+    uint32_t base = (uint32_t)sector * SMOTA_META_SECTOR_SIZE;
+    uint32_t off = SMOTA_ALIGN_UP(8U, SMOTA_META_ALIGN);
+    uint8_t hdr[8];
+
+    while (off + sizeof(hdr) <= SMOTA_META_SECTOR_SIZE &&
+           smota_partition_read(meta, base + off, hdr, sizeof(hdr)) == (int)sizeof(hdr) &&
+           !(hdr[0] == 0xFF && hdr[1] == 0xFF)) {
+        off += SMOTA_ALIGN_UP(8U + hdr[1], SMOTA_META_ALIGN);
+    }
+
+    return off;
+}
+
 /**
  * @brief  简单的自测试
  */
@@ -145,86 +586,1460 @@ static int run_self_test(void)
         return -1;
     }
 
-    /* 测试版本比较 */
-    printf("Testing version check... ");
-    if (smota_verify_version(version1, version2) == true && smota_verify_version(version1, version3) == false) {
-        printf("PASS\n");
-    } else {
-        printf("FAIL\n");
-        return -1;
+    /* 测试 SHA256 批量接口（与逐段计算结果一致） */
+    printf("Testing SHA256 batch... ");
+    {
+        static uint8_t batch_data[1000];
+        const uint8_t *data[16];
+        uint32_t size[16];
+        uint8_t batch_hash[16][32];
+        uint8_t single[32];
+        uint32_t i;
+
+        for (i = 0; i < sizeof(batch_data); i++) {
+            batch_data[i] = (uint8_t)(i * 7 + 1);
+        }
+        for (i = 0; i < 16; i++) {
+            data[i] = batch_data + i;
+            size[i] = i * 61;
+        }
+
+        ret = smota_sha256_compute_batch(data, size, batch_hash, 16);
+        for (i = 0; i < 16 && ret == 0; i++) {
+            if (smota_sha256_compute(data[i], size[i], single) < 0 || memcmp(single, batch_hash[i], 32) != 0) {
+                ret = -100 - (int)i;
+            }
+        }
+        if (ret == 0) {
+            printf("PASS (%u lanes)\n", tc_sha256_mb_lanes());
+        } else {
+            printf("FAIL (ret=%d)\n", ret);
+            return -1;
+        }
     }
 
-    /* 测试状态机 */
-    printf("Testing state machine... ");
-    smota_state_reset();
-    if (smota_state_get() == SMOTA_STATE_IDLE) {
-        printf("PASS\n");
-    } else {
-        printf("FAIL\n");
-        return -1;
+    /* 测试数据块认证标签：正确标签通过，篡改数据或偏移后拒绝 */
+    printf("Testing block tag... ");
+    {
+        uint8_t block[200];
+        uint8_t tag[SMOTA_BLOCK_TAG_SIZE];
+        int ok;
+
+        for (uint32_t i = 0; i < sizeof(block); i++) {
+            block[i] = (uint8_t)(i * 3 + 1);
+        }
+
+        ok = (tc_port_block_mac(0x1000, block, sizeof(block), tag) == 0) &&
+             (smota_verify_block_tag(0x1000, block, sizeof(block), tag) == 0) &&
+             (smota_verify_block_tag(0x1100, block, sizeof(block), tag) == -3);
+        block[99] ^= 0x01;
+        ok = ok && (smota_verify_block_tag(0x1000, block, sizeof(block), tag) == -3);
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
     }
 
-    printf("==================\n");
-    printf("All tests passed!\n\n");
+    /* 测试数据块 AEAD：上位机按一机一密密钥加密，设备认证解密；篡改密文、标签或偏移均拒绝 */
+    printf("Testing block AEAD... ");
+    {
+        uint8_t image_hash[32];
+        uint8_t plain[300];
+        uint8_t cipher[300];
+        uint8_t out[300];
+        uint8_t key[32];
+        uint8_t nonce[12];
+        uint8_t aad[6];
+        uint8_t tag[SMOTA_BLOCK_TAG_SIZE];
+        uint32_t offset = 0x2000;
+        int ok;
 
-    return 0;
-}
+        for (uint32_t i = 0; i < sizeof(plain); i++) {
+            plain[i] = (uint8_t)(i * 5 + 2);
+        }
+        for (uint32_t i = 0; i < sizeof(image_hash); i++) {
+            image_hash[i] = (uint8_t)(0xA0 + i);
+        }
 
-/**
- * @brief  模拟设备运行
- */
-static void simulate_device(void)
-{
-    clock_t last_tick = clock();
-    const int tick_interval = CLOCKS_PER_SEC / 1000; /* 1ms */
+        /* 上位机侧：nonce = 整包哈希前 8 字节 || offset，AAD = offset || length */
+        memcpy(nonce, image_hash, SMOTA_AEAD_NONCE_PREFIX_SIZE);
+        memcpy(&nonce[8], &offset, 4);
+        memcpy(aad, &offset, 4);
+        aad[4] = (uint8_t)(sizeof(plain));
+        aad[5] = (uint8_t)(sizeof(plain) >> 8);
 
-    printf("\n=== Device Simulation Started ===\n");
-    printf("Press Ctrl+C to exit\n\n");
+        ok = (derive_transport_key(key) == 0) &&
+             (tc_chacha20_poly1305_encrypt(cipher, tag, plain, sizeof(plain), aad, sizeof(aad), nonce, key) ==
+              TC_CRYPTO_SUCCESS) &&
+             (smota_aead_decrypt_block(image_hash, offset, cipher, out, sizeof(out), tag) == 0) &&
+             (memcmp(out, plain, sizeof(plain)) == 0) &&
+             (smota_aead_decrypt_block(image_hash, offset + 0x100, cipher, out, sizeof(out), tag) == -3);
+        memset(key, 0, sizeof(key));
 
-    while (1) {
-        /* 模拟 1ms 时间片 */
-        clock_t current = clock();
-        if (current - last_tick >= tick_interval) {
-            last_tick = current;
+        cipher[150] ^= 0x01;
+        ok = ok && (smota_aead_decrypt_block(image_hash, offset, cipher, out, sizeof(out), tag) == -3);
+        cipher[150] ^= 0x01;
+        tag[15] ^= 0x80;
+        ok = ok && (smota_aead_decrypt_block(image_hash, offset, cipher, out, sizeof(out), tag) == -3);
 
-            /* 调用 OTA poll */
-            smota_poll();
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
 
-            /* 可选: 打印状态变化 */
-            static smota_state_t last_state = SMOTA_STATE_MAX;
-            smota_state_t current_state = smota_get_state();
-            if (current_state != last_state) {
-                printf("[%llu] State: %s -> %s\n",
-                       (unsigned long long)system_get_tick_ms(),
-                       smota_state_to_string(last_state),
-                       smota_state_to_string(current_state));
-                last_state = current_state;
+    /* 测试分片清单：Merkle 根与上位机工具一致（5 个 100 字节分片），分片篡改后拒绝 */
+    printf("Testing chunk manifest... ");
+    {
+        static const uint8_t expect_root[32] = {
+            0x53, 0xb1, 0x0c, 0x10, 0x06, 0x36, 0x0c, 0xb5, 0x0a, 0xed, 0x79, 0xa2, 0x35, 0x60, 0x89, 0x63,
+            0x85, 0x21, 0x74, 0x6e, 0xe6, 0x35, 0xa7, 0x20, 0x7b, 0x15, 0x46, 0xd5, 0x93, 0x45, 0x10, 0x40,
+        };
+        static uint8_t image[3 * 4096];
+        uint8_t leaf[5][32];
+        uint8_t root[32];
+        int ok = 1;
+
+        for (uint32_t i = 0; i < sizeof(image); i++) {
+            image[i] = (uint8_t)(i * 5 + 3);
+        }
+
+        for (uint32_t i = 0; i < 5 && ok; i++) {
+            ok = (smota_chunk_leaf_hash(image + i * 100, 100, leaf[i]) == 0);
+        }
+        ok = ok && (smota_chunk_merkle_root((const uint8_t (*)[32])leaf, 5, root) == 0) &&
+             (memcmp(root, expect_root, sizeof(root)) == 0);
+
+#if SMOTA_CHUNK_MANIFEST
+        /* 会话：按擦除单元分片，200 字节一块流式校验，第 2 个分片篡改后回退到其起始 */
+        {
+            uint32_t chunk = smota_flash_backup_erase_size();
+            uint32_t size = 3 * chunk - 10;
+            uint32_t offset = 0;
+            int ret = 0;
+
+            ok = ok && (chunk > 0 && chunk <= 4096);
+            for (uint32_t i = 0; i < 3 && ok; i++) {
+                uint32_t len = (i < 2) ? chunk : chunk - 10;
+                ok = (smota_chunk_leaf_hash(image + i * chunk, len, leaf[i]) == 0);
             }
+            ok = ok && (smota_chunk_merkle_root((const uint8_t (*)[32])leaf, 3, root) == 0) &&
+                 (smota_chunk_begin(size, chunk, root) == 0) &&
+                 (smota_chunk_manifest_put(0, leaf[0], 2) == 2) &&
+                 (smota_chunk_manifest_put(2, leaf[2], 1) == 3) && smota_chunk_manifest_ready();
 
-            /* 错误处理 */
-            if (smota_get_error() != SMOTA_ERR_OK) {
-                printf("[%llu] Error: %s\n",
-                       (unsigned long long)system_get_tick_ms(),
-                       smota_get_error_string());
+            image[chunk + 7] ^= 0x01;
+            while (ok && offset < size && ret == 0) {
+                uint32_t len = (size - offset < 200) ? size - offset : 200;
+                ret = smota_chunk_update(offset, image + offset, len);
+                offset += len;
+            }
+            ok = ok && (ret == -3) && (smota_chunk_committed() == chunk);
+            image[chunk + 7] ^= 0x01;
+
+            offset = smota_chunk_committed();
+            ret = 0;
+            while (ok && offset < size && ret == 0) {
+                uint32_t len = (size - offset < 200) ? size - offset : 200;
+                ret = smota_chunk_update(offset, image + offset, len);
+                offset += len;
             }
+            ok = ok && (ret == 0) && (smota_chunk_committed() == size);
+        }
+#endif
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
         }
+    }
 
-/* 让出 CPU */
-#ifdef _WIN32
-        Sleep(0);
+    /* 测试加密上下文池：池用完后拒绝而不是分配堆内存，AES 往返解密一致 */
+    printf("Testing crypto context pool... ");
+    {
+        static const uint8_t key[16] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                         0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+        static const uint8_t iv[16] = { 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+                                        0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff };
+        struct smota_sha256_ctx sha[SMOTA_SHA256_CTX_NUM + 1];
+        struct smota_aes_ctx aes;
+        void *pool_ctx;
+        uint8_t plain[100];
+        uint8_t cipher[100];
+        int ok = 1;
+
+#if SMOTA_INSTANCE_THREAD_LOCAL
+        /* 池按实例平分，默认实例只能用自己的一段 */
+        const uint32_t sha_num = SMOTA_SHA256_CTX_NUM / SMOTA_INSTANCE_MAX;
 #else
-        usleep(1000);
+        const uint32_t sha_num = SMOTA_SHA256_CTX_NUM;
 #endif
-    }
-}
 
-int main(int argc, char *argv[])
-{
-    int ret;
-    bool init_flash = false;
-    bool show_status_flag = false;
-    bool run_device = false;
-    bool run_test = false;
+        for (uint32_t i = 0; i < sha_num && ok; i++) {
+            ok = (smota_sha256_start(&sha[i]) == 0) && (sha[i].slot >= 0);
+        }
+        /* 驱动能分配时也不回退到堆（SMOTA_CRYPTO_HEAP_FALLBACK=0） */
+        g_crypto_driver.sha256_init = tc_port_sha256_init;
+        ok = ok && (smota_sha256_start(&sha[sha_num]) == -4);
+        g_crypto_driver.sha256_init = NULL;
+        for (uint32_t i = 0; i < sha_num; i++) {
+            (void)smota_sha256_final(&sha[i], hash);
+        }
+        ok = ok && (smota_sha256_compute(test_data, sizeof(test_data) - 1, hash) == 0);
+
+        for (uint32_t i = 0; i < sizeof(plain); i++) {
+            plain[i] = (uint8_t)(i * 11 + 5);
+        }
+        ok = ok && (smota_aes_start(&aes, key, iv) == 0) && (smota_aes_crypt(&aes, plain, cipher, sizeof(cipher)) == 0);
+        pool_ctx = aes.hal_ctx;
+
+        /* 重新定位计数器：在原存储中重新初始化，不归还也不重新申请 */
+        ok = ok && (memcmp(plain, cipher, sizeof(plain)) != 0) && (smota_aes_rekey(&aes, key, iv) == 0) &&
+             (aes.hal_ctx == pool_ctx) && (aes.slot >= 0) &&
+             (smota_aes_crypt(&aes, cipher, cipher, sizeof(cipher)) == 0);
+        smota_aes_end(&aes);
+        ok = ok && (memcmp(plain, cipher, sizeof(plain)) == 0);
+
+        if (ok) {
+            printf("PASS (sha256 %u/%u bytes, aes %u/%u bytes)\n", tc_port_sha256_ctx_size(), SMOTA_SHA256_CTX_SIZE,
+                   tc_port_aes_ctx_size(), SMOTA_AES_CTX_SIZE);
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试 CTR 密钥流预取：空闲时填满窗口，按块解密与上位机加密一致，重传的旧偏移当场生成 */
+    printf("Testing CTR keystream prefetch... ");
+    {
+        static uint8_t plain[1000];
+        static uint8_t cipher[1000];
+        uint8_t out[200];
+        uint8_t image_hash[32];
+        int ok = 1;
+
+        for (uint32_t i = 0; i < sizeof(plain); i++) {
+            plain[i] = (uint8_t)(i * 13 + 7);
+        }
+        for (uint32_t i = 0; i < sizeof(image_hash); i++) {
+            image_hash[i] = (uint8_t)(0x5A ^ i);
+        }
+
+#if SMOTA_RELIABILITY_TRANSMISSION
+        {
+            struct tc_aes_key_sched_struct sched;
+            uint8_t key[16];
+            uint8_t ctr[16] = { 0 };
+            uint32_t offset;
+
+            /* 上位机侧：计数块 = 整包哈希前 12 字节 || 块号，从 0 开始 */
+            smota_get_key(SMOTA_KEY_AES_DEVICE, key, sizeof(key));
+            memcpy(ctr, image_hash, SMOTA_CTR_NONCE_SIZE);
+            ok = (tc_aes128_set_encrypt_key(&sched, key) == TC_CRYPTO_SUCCESS) &&
+                 (tc_ctr_mode(cipher, sizeof(cipher), plain, sizeof(plain), ctr, &sched) == TC_CRYPTO_SUCCESS);
+            memset(key, 0, sizeof(key));
+            memset(&sched, 0, sizeof(sched));
+
+            ok = ok && (smota_ctr_begin(image_hash) == 0) && (smota_ctr_ready(0) == 0) &&
+                 (smota_ctr_prefetch(0) == SMOTA_CTR_PREFETCH_SIZE);
+
+            /* 每块 196 字节（非 16 对齐），到达前预取 */
+            for (offset = 0; offset < sizeof(plain) && ok; offset += 196) {
+                uint32_t len = (sizeof(plain) - offset < 196) ? sizeof(plain) - offset : 196;
+                ok = (smota_ctr_prefetch(offset) >= 0) &&
+                     (smota_ctr_crypt(offset, cipher + offset, out, len) == 0) &&
+                     (memcmp(out, plain + offset, len) == 0);
+            }
+
+            /* 重传窗口之前的数据块 */
+            ok = ok && (smota_ctr_crypt(100, cipher + 100, out, 77) == 0) && (memcmp(out, plain + 100, 77) == 0);
+
+            smota_ctr_end();
+            ok = ok && (smota_ctr_ready(0) == 0) && (smota_ctr_crypt(0, cipher, out, 16) == -1);
+        }
+#else
+        (void)plain;
+        (void)cipher;
+        (void)out;
+        ok = ok && (smota_ctr_begin(image_hash) == -3);
+#endif
+
+        if (ok) {
+            printf("PASS (window %u bytes)\n", (unsigned int)SMOTA_CTR_PREFETCH_SIZE);
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+#if SMOTA_CTR_DEFERRED
+    /* 测试延迟解密：密文写入暂存区，安装拷贝时解密，应用区得到明文；
+       密文损坏或记录的哈希不符时在擦除前拒绝，应用区保持原样 */
+    printf("Testing deferred decryption... ");
+    {
+        static uint8_t plain[5000];
+        static uint8_t cipher[5000];
+        static uint8_t readback[5000];
+        const struct smota_partition *app = smota_partition_find(SMOTA_PART_ID_APP);
+        struct tc_aes_key_sched_struct sched;
+        struct smota_meta_image image;
+        uint8_t key[16];
+        uint8_t ctr[16] = { 0 };
+        uint32_t offset;
+        int ok;
+
+        for (uint32_t i = 0; i < sizeof(plain); i++) {
+            plain[i] = (uint8_t)(i * 17 + 3);
+        }
+
+        /* 上位机侧：按整包明文哈希生成计数块并加密 */
+        memset(&image, 0, sizeof(image));
+        image.hash_alg = SMOTA_HASH_ALG_SHA256;
+        image.size = sizeof(plain);
+        smota_get_key(SMOTA_KEY_AES_DEVICE, key, sizeof(key));
+        ok = (app != NULL) && (smota_hash_select(SMOTA_HASH_ALG_SHA256) == 0) &&
+             (smota_sha256_compute(plain, sizeof(plain), image.hash) == 0);
+        memcpy(ctr, image.hash, SMOTA_CTR_NONCE_SIZE);
+        ok = ok && (tc_aes128_set_encrypt_key(&sched, key) == TC_CRYPTO_SUCCESS) &&
+             (tc_ctr_mode(cipher, sizeof(cipher), plain, sizeof(plain), ctr, &sched) == TC_CRYPTO_SUCCESS);
+        memset(key, 0, sizeof(key));
+        memset(&sched, 0, sizeof(sched));
+
+        /* 设备侧：密文按 200 字节数据块原样写入暂存区 */
+        ok = ok && (smota_flash_erase_backup(sizeof(cipher)) == 0);
+        for (offset = 0; offset < sizeof(cipher) && ok; offset += 200) {
+            uint32_t len = (sizeof(cipher) - offset < 200) ? sizeof(cipher) - offset : 200;
+            ok = (smota_flash_write_backup(cipher + offset, len) == (int)len);
+        }
+        ok = ok && (smota_flash_flush_backup() == 0) &&
+             (smota_meta_write(SMOTA_META_TAG_IMAGE, &image, sizeof(image)) == 0) &&
+             (smota_flash_copy_firmware(smota_flash_backup_addr(), smota_flash_app_addr(), sizeof(plain)) == 0) &&
+             (smota_partition_read(app, 0, readback, sizeof(readback)) == (int)sizeof(readback)) &&
+             (memcmp(readback, plain, sizeof(plain)) == 0);
+
+        /* 暂存区密文损坏：签名哈希正确但解密结果不符 */
+        cipher[sizeof(cipher) - 1] ^= 0x80;
+        ok = ok && (smota_flash_erase_backup(sizeof(cipher)) == 0) &&
+             (smota_flash_write_backup(cipher, sizeof(cipher)) == (int)sizeof(cipher)) &&
+             (smota_flash_flush_backup() == 0) &&
+             (smota_flash_copy_firmware(smota_flash_backup_addr(), smota_flash_app_addr(), sizeof(plain)) == -5) &&
+             (smota_partition_read(app, 0, readback, sizeof(readback)) == (int)sizeof(readback)) &&
+             (memcmp(readback, plain, sizeof(plain)) == 0);
+
+        /* 记录的哈希不符 */
+        image.hash[31] ^= 0x01;
+        ok = ok && (smota_meta_write(SMOTA_META_TAG_IMAGE, &image, sizeof(image)) == 0) &&
+             (smota_flash_copy_firmware(smota_flash_backup_addr(), smota_flash_app_addr(), sizeof(plain)) == -5) &&
+             (smota_partition_read(app, 0, readback, sizeof(readback)) == (int)sizeof(readback)) &&
+             (memcmp(readback, plain, sizeof(plain)) == 0);
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+#endif
+    /* 测试头部签名：摘要与上位机工具一致，签名通过后篡改版本或签名均被拒绝 */
+    printf("Testing header signature... ");
+    {
+        static const uint8_t expect_digest[32] = {
+            0x41, 0x22, 0xe7, 0x64, 0x21, 0xcd, 0x7e, 0x97, 0xa3, 0x07, 0x46, 0x38, 0xc0, 0xea, 0x9f, 0x14,
+            0x4b, 0x4b, 0x87, 0xb8, 0x89, 0x4e, 0x97, 0x50, 0x38, 0x7b, 0x8c, 0x66, 0xc7, 0x70, 0xba, 0xb3,
+        };
+        struct smota_header_info_req req;
+        uint8_t version[3] = { 1, 2, 3 };
+        uint8_t digest[32];
+        uint8_t pub_key[SMOTA_ECDSA_PUB_KEY_SIZE];
+        uint8_t sig[64];
+        int ok;
+
+        for (uint32_t i = 0; i < sizeof(req.sha256_hash); i++) {
+            req.sha256_hash[i] = (uint8_t)(i * 7 + 1);
+        }
+
+        smota_get_key(SMOTA_KEY_ECDSA_PUB, pub_key, sizeof(pub_key));
+        ok = (smota_crypto_header_digest(req.sha256_hash, 0x12345, version, NULL, 0, digest) == 0) &&
+             (memcmp(digest, expect_digest, sizeof(digest)) == 0) &&
+             uECC_sign(g_ecdsa_demo_private_key, digest, sizeof(digest), sig, uECC_secp256r1());
+        memcpy(req.signature_r, sig, 32);
+        memcpy(req.signature_s, sig + 32, 32);
+        ok = ok && (tc_port_ecdsa_verify(digest, req.signature_r, req.signature_s, pub_key) == 0) &&
+             (tc_port_ecdsa_verify_fixed(digest, req.signature_r, req.signature_s) == 0);
+
+#if SMOTA_RELIABILITY_SOURCE
+        ok = ok && (smota_crypto_verify_header(&req, 0x12345, version, 0) == 0);
+        version[0] = 2;
+        ok = ok && (smota_crypto_verify_header(&req, 0x12345, version, 0) == -3);
+        version[0] = 1;
+        req.signature_s[5] ^= 0x01;
+        ok = ok && (smota_crypto_verify_header(&req, 0x12345, version, 0) == -3);
+#else
+        ok = ok && (smota_crypto_verify_header(&req, 0x12345, version, 0) == -1);
+#endif
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试内容哈希协商 */
+    printf("Testing content hash select... ");
+    {
+        static const uint8_t expect_abc[32] = {
+            0x50, 0x8c, 0x5e, 0x8c, 0x32, 0x7c, 0x14, 0xe2, 0xe1, 0xa7, 0x2b, 0xa3, 0x4e, 0xeb, 0x45, 0x2f,
+            0x37, 0x45, 0x8b, 0x20, 0x9e, 0xd6, 0x3a, 0x29, 0x4d, 0x99, 0x9b, 0x4c, 0x86, 0x67, 0x59, 0x82,
+        };
+        static const uint8_t expect_digest[32] = {
+            0x09, 0x5e, 0x51, 0x88, 0x76, 0x20, 0x29, 0x4e, 0x0d, 0x95, 0x53, 0xbf, 0xeb, 0xbe, 0xc2, 0x75,
+            0x1a, 0x3b, 0x4c, 0x90, 0x45, 0xd5, 0xc4, 0xf4, 0x69, 0xbe, 0x26, 0x65, 0xf5, 0x45, 0xd4, 0x27,
+        };
+        struct smota_hash_ctx hash_ctx;
+        uint8_t image_hash[32];
+        uint8_t version[3] = { 1, 2, 3 };
+        uint8_t alg = SMOTA_HASH_ALG_BLAKE2S;
+        uint8_t digest[32];
+        uint8_t digest_alg[32];
+        int ok;
+
+        for (uint32_t i = 0; i < sizeof(image_hash); i++) {
+            image_hash[i] = (uint8_t)(i * 7 + 1);
+        }
+
+        ok = smota_hash_supported(SMOTA_HASH_ALG_BLAKE2S) && !smota_hash_supported(0xFF) &&
+             (smota_hash_select(0xFF) < 0) && (smota_hash_select(SMOTA_HASH_ALG_BLAKE2S) == 0) &&
+             (smota_hash_current() == SMOTA_HASH_ALG_BLAKE2S);
+
+        /* 分两段更新，覆盖 BLAKE2s 保留末块的缓冲路径 */
+        ok = ok && (smota_hash_start(&hash_ctx) == 0) &&
+             (smota_hash_update(&hash_ctx, (const uint8_t *)"a", 1) == 0) &&
+             (smota_hash_update(&hash_ctx, (const uint8_t *)"bc", 2) == 0) &&
+             (smota_hash_final(&hash_ctx, digest) == 0) && (memcmp(digest, expect_abc, sizeof(digest)) == 0);
+
+        /* 签名摘要随算法变化，且覆盖附加信息中的算法字节 */
+        ok = ok && (smota_crypto_header_digest(image_hash, 0x12345, version, NULL, 0, digest) == 0) &&
+             (memcmp(digest, expect_digest, sizeof(digest)) == 0) &&
+             (smota_crypto_header_digest(image_hash, 0x12345, version, &alg, 1, digest_alg) == 0) &&
+             (memcmp(digest, digest_alg, sizeof(digest)) != 0);
+
+        ok = ok && (smota_hash_select(SMOTA_HASH_ALG_SHA256) == 0) &&
+             (smota_hash_current() == SMOTA_HASH_ALG_SHA256);
+
+#if SMOTA_HASH_BLAKE2S && SMOTA_FEED_BUF_SIZE > 0
+        /* HEADER_INFO 选择不支持的算法：应答 PROTOCOL_MISMATCH，停留在握手阶段，算法不变 */
+        {
+            struct smota_handshake_req req;
+            uint8_t header[sizeof(struct smota_header_info_req) + SMOTA_HEADER_TRAILER_LEN];
+            uint8_t frame[sizeof(header) + 32];
+            int frame_len;
+
+            memset(&req, 0, sizeof(req));
+            req.firmware_size = 2048;
+            memset(header, 0, sizeof(header));
+            header[sizeof(struct smota_header_info_req) + SMOTA_HEADER_CHUNK_INFO_LEN] = 0xFF;
+
+            g_comm_driver.send = feed_test_send;
+            g_feed_test_header_err = 0xFFFFFFFFU;
+            (void)smota_abort();
+
+            frame_len = smota_frame_build(SMOTA_CMD_HANDSHAKE, (const uint8_t *)&req, sizeof(req), frame, sizeof(frame));
+            ok = ok && (frame_len > 0) && (smota_feed(frame, (size_t)frame_len) == (size_t)frame_len) &&
+                 (smota_poll() == SMOTA_ERR_OK) && (smota_get_state() == SMOTA_STATE_HANDSHAKE);
+            frame_len = smota_frame_build(SMOTA_CMD_HEADER_INFO, header, sizeof(header), frame, sizeof(frame));
+            ok = ok && (frame_len > 0) && (smota_feed(frame, (size_t)frame_len) == (size_t)frame_len);
+            (void)smota_poll();
+            ok = ok && (g_feed_test_header_err == SMOTA_ERR_PROTOCOL_MISMATCH) &&
+                 (smota_get_state() == SMOTA_STATE_HANDSHAKE) && (smota_hash_current() == SMOTA_HASH_ALG_SHA256);
+
+            g_comm_driver.send = comm_send;
+            (void)smota_abort();
+        }
+#endif
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试中断推送接收队列：半帧不解析，帧完整才应答；队列下标回绕；一次推送两帧都能处理 */
+    printf("Testing feed queue... ");
+    {
+        int ok = 1;
+
+#if SMOTA_FEED_BUF_SIZE > 0
+        struct smota_handshake_req req;
+        uint8_t frame[128];
+        int frame_len;
+        uint32_t fed = 0;
+        uint32_t expect = 0;
+
+        memset(&req, 0, sizeof(req));
+        req.fw_version_major = 1;
+        req.firmware_size = 1024;
+        frame_len = smota_frame_build(SMOTA_CMD_HANDSHAKE, (const uint8_t *)&req, sizeof(req), frame, sizeof(frame) / 2);
+        ok = (frame_len > 0);
+        if (ok) {
+            memcpy(frame + frame_len, frame, (size_t)frame_len);
+        }
+
+        g_comm_driver.send = feed_test_send;
+        g_feed_test_resp_num = 0;
+
+        while (ok && fed <= SMOTA_FEED_BUF_SIZE) {
+            uint32_t half = (uint32_t)frame_len / 2;
+
+            ok = (smota_feed(frame, half) == half);
+            smota_poll();
+            ok = ok && (g_feed_test_resp_num == expect);
+
+            ok = ok && (smota_feed(frame + half, (size_t)frame_len - half) == (size_t)frame_len - half);
+            smota_poll();
+            ok = ok && (g_feed_test_resp_num == ++expect);
+
+            fed += (uint32_t)frame_len;
+        }
+
+        /* 两帧同时到达，第二帧在下一次轮询中处理，无需新数据 */
+        ok = ok && (smota_feed(frame, (size_t)frame_len * 2) == (size_t)frame_len * 2);
+        smota_poll();
+        smota_poll();
+        ok = ok && (g_feed_test_resp_num == expect + 2);
+
+        g_comm_driver.send = comm_send;
+        (void)smota_abort();
+#else
+        ok = (smota_feed((const uint8_t *)"smOTA", 5) == 0);
+#endif
+
+        if (ok) {
+            printf("PASS (queue %u bytes)\n", (unsigned int)SMOTA_FEED_BUF_SIZE);
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试多实例：两个实例交替轮询，会话状态互不影响；槽位用完时拒绝新实例 */
+    printf("Testing multi-instance... ");
+    {
+        static struct smota_instance node;
+        static struct smota_instance spare;
+        int ok = 1;
+
+#if SMOTA_INSTANCE_MAX > 1 && SMOTA_FEED_BUF_SIZE > 0
+        struct smota_handshake_req req;
+        uint8_t header[sizeof(struct smota_header_info_req) + SMOTA_HEADER_TRAILER_LEN];
+        uint8_t frame[64];
+        uint8_t header_frame[sizeof(header) + 32];
+        int frame_len;
+        int header_len;
+
+        memset(&req, 0, sizeof(req));
+        req.firmware_size = 2048;
+        frame_len = smota_frame_build(SMOTA_CMD_HANDSHAKE, (const uint8_t *)&req, sizeof(req), frame, sizeof(frame));
+        memset(header, 0, sizeof(header));
+        header_len = smota_frame_build(SMOTA_CMD_HEADER_INFO, header, sizeof(header), header_frame,
+                                       sizeof(header_frame));
+
+        g_comm_driver.send = feed_test_send;
+        g_feed_test_resp_num = 0;
+
+        ok = (frame_len > 0) && (smota_instance_init(&node, &g_smota_hal) == SMOTA_ERR_OK);
+        ok = ok && (smota_instance_feed(&node, frame, (size_t)frame_len) == (size_t)frame_len);
+        ok = ok && (smota_instance_poll(&node) == SMOTA_ERR_OK) && (smota_poll() == SMOTA_ERR_OK);
+        ok = ok && (g_feed_test_resp_num == 1) && (smota_instance_get_state(&node) == SMOTA_STATE_HANDSHAKE) &&
+             (smota_get_state() == SMOTA_STATE_IDLE) && (smota_instance_current() == smota_instance_default());
+
+        /* 默认实例开始自己的会话，node 的上下文不变 */
+        ok = ok && (smota_feed(frame, (size_t)frame_len) == (size_t)frame_len) && (smota_poll() == SMOTA_ERR_OK);
+        ok = ok && (g_feed_test_resp_num == 2) && (smota_get_state() == SMOTA_STATE_HANDSHAKE) &&
+             (smota_instance_get_state(&node) == SMOTA_STATE_HANDSHAKE);
+
+#if SMOTA_INSTANCE_MAX == 2
+        ok = ok && (smota_instance_init(&spare, &g_smota_hal) == SMOTA_ERR_BUSY);
+#endif
+
+#if !SMOTA_RELIABILITY_SOURCE && !SMOTA_CHUNK_MANIFEST && !SMOTA_HASH_BLAKE2S
+        /* 两个会话同时进入 HEADER_INFO：开启传输加密时各自持有一个 AES 上下文直到传输结束 */
+        ok = ok && (header_len > 0) &&
+             (smota_instance_feed(&node, header_frame, (size_t)header_len) == (size_t)header_len) &&
+             (smota_instance_poll(&node) == SMOTA_ERR_OK);
+        ok = ok && (smota_feed(header_frame, (size_t)header_len) == (size_t)header_len) && (smota_poll() == SMOTA_ERR_OK);
+        ok = ok && (smota_instance_get_state(&node) == SMOTA_STATE_HEADER_INFO) &&
+             (smota_get_state() == SMOTA_STATE_HEADER_INFO);
+#else
+        (void)header_len;
+#endif
+
+        ok = ok && (smota_instance_abort(&node) == SMOTA_ERR_OK) && (smota_instance_deinit(&node) == SMOTA_ERR_OK);
+        ok = ok && (smota_instance_get_state(&node) == SMOTA_STATE_IDLE) && (smota_get_state() != SMOTA_STATE_IDLE);
+
+        g_comm_driver.send = comm_send;
+        (void)smota_abort();
+#elif SMOTA_INSTANCE_MAX == 1
+        (void)node;
+        ok = (smota_instance_init(&spare, &g_smota_hal) == SMOTA_ERR_BUSY);
+#else
+        (void)node;
+        (void)spare;
+#endif
+
+        if (ok) {
+            printf("PASS (%u slots)\n", (unsigned int)SMOTA_INSTANCE_MAX);
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试 OTA 任务：中断上下文推送一帧，任务被信号量唤醒后应答，停止时等待任务退出 */
+    printf("Testing OTA task... ");
+    {
+        static struct smota_task task;
+        int ok = 1;
+
+#if SMOTA_FEED_BUF_SIZE > 0 && (SMOTA_INSTANCE_MAX == 1 || SMOTA_INSTANCE_THREAD_LOCAL)
+        struct smota_handshake_req req;
+        uint8_t frame[64];
+        int frame_len;
+
+        memset(&req, 0, sizeof(req));
+        req.firmware_size = 4096;
+        frame_len = smota_frame_build(SMOTA_CMD_HANDSHAKE, (const uint8_t *)&req, sizeof(req), frame, sizeof(frame));
+
+        g_comm_driver.send = feed_test_send;
+        g_feed_test_resp_num = 0;
+
+        ok = (frame_len > 0) && (smota_task_start(&task, smota_instance_default(), &g_os_driver) == 0);
+        ok = ok && (smota_task_feed(&task, frame, (size_t)frame_len) == (size_t)frame_len);
+        for (int i = 0; ok && i < 1000 && g_feed_test_resp_num == 0; i++) {
+            sim_sleep_ms(1);
+        }
+        ok = ok && (smota_task_stop(&task) == 0);
+        ok = ok && (g_feed_test_resp_num == 1) && (task.wakeups >= 1) && (smota_get_state() == SMOTA_STATE_HANDSHAKE);
+
+        g_comm_driver.send = comm_send;
+        (void)smota_abort();
+#elif SMOTA_FEED_BUF_SIZE > 0
+        /* 当前实例为全局指针时拒绝在多实例工程中启动任务 */
+        ok = (smota_task_start(&task, smota_instance_default(), &g_os_driver) == -5);
+#else
+        ok = (smota_task_start(&task, smota_instance_default(), &g_os_driver) == -4);
+#endif
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试按线程保存的当前实例：另一线程进入实例不影响本线程；任务驱动 node 的同时主线程驱动默认实例 */
+    printf("Testing per-thread instance... ");
+    {
+        static struct smota_instance node;
+        static struct smota_task task;
+        int ok = 1;
+
+#if SMOTA_INSTANCE_THREAD_LOCAL && SMOTA_INSTANCE_MAX > 1 && SMOTA_FEED_BUF_SIZE > 0
+        struct tls_test test;
+        struct smota_handshake_req req;
+        uint8_t frame[64];
+        void *thread;
+        int frame_len;
+
+        test.inst = &node;
+        test.entered = os_sim_sem_create();
+        test.release = os_sim_sem_create();
+        test.ok = 0;
+
+        ok = (smota_instance_init(&node, &g_smota_hal) == SMOTA_ERR_OK) && (test.entered != NULL) &&
+             (test.release != NULL);
+        thread = ok ? os_sim_task_create(tls_test_thread, &test, "tls", 64 * 1024, 0) : NULL;
+        ok = ok && (thread != NULL) && (os_sim_sem_wait(test.entered, 1000) == 0) &&
+             (smota_instance_current() == smota_instance_default());
+        if (thread != NULL) {
+            os_sim_sem_post(test.release);
+            os_sim_task_join(thread);
+        }
+        ok = ok && test.ok;
+        if (test.entered != NULL) {
+            os_sim_sem_delete(test.entered);
+        }
+        if (test.release != NULL) {
+            os_sim_sem_delete(test.release);
+        }
+
+        memset(&req, 0, sizeof(req));
+        req.firmware_size = 4096;
+        frame_len = smota_frame_build(SMOTA_CMD_HANDSHAKE, (const uint8_t *)&req, sizeof(req), frame, sizeof(frame));
+
+        g_comm_driver.send = feed_test_send;
+        g_feed_test_resp_num = 0;
+
+        ok = ok && (frame_len > 0) && (smota_task_start(&task, &node, &g_os_driver) == 0);
+        if (ok) {
+            (void)smota_task_feed(&task, frame, (size_t)frame_len);
+            (void)smota_feed(frame, (size_t)frame_len);
+            for (int i = 0; i < 1000 && g_feed_test_resp_num < 2; i++) {
+                (void)smota_poll();
+                sim_sleep_ms(1);
+            }
+            ok = (smota_task_stop(&task) == 0);
+        }
+        ok = ok && (smota_instance_get_state(&node) == SMOTA_STATE_HANDSHAKE) &&
+             (smota_get_state() == SMOTA_STATE_HANDSHAKE) && (smota_instance_current() == smota_instance_default());
+
+        (void)smota_instance_abort(&node);
+        (void)smota_instance_deinit(&node);
+        g_comm_driver.send = comm_send;
+        (void)smota_abort();
+#else
+        (void)node;
+        (void)task;
+#endif
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试轮询期限：空闲时无限等待，握手后按数据包超时和总超时给出期限，多帧未处理完时为 0，超时只报告一次 */
+    printf("Testing poll deadline... ");
+    {
+        int ok = 1;
+
+#if SMOTA_FEED_BUF_SIZE > 0
+        struct smota_handshake_req req;
+        uint8_t frame[128];
+        int frame_len;
+        uint32_t wait_ms = 0;
+
+        g_comm_driver.send = feed_test_send;
+        (void)smota_abort();
+
+        ok = (smota_poll_deadline(&wait_ms) == SMOTA_ERR_OK) && (wait_ms == SMOTA_WAIT_FOREVER);
+
+        memset(&req, 0, sizeof(req));
+        req.firmware_size = 4096;
+        req.block_timeout = 200;
+        req.total_timeout = 50;
+        frame_len = smota_frame_build(SMOTA_CMD_HANDSHAKE, (const uint8_t *)&req, sizeof(req), frame, sizeof(frame) / 2);
+        ok = ok && (frame_len > 0);
+        if (ok) {
+            memcpy(frame + frame_len, frame, (size_t)frame_len);
+        }
+
+        /* 两帧同时到达：处理第一帧后期限为 0 */
+        ok = ok && (smota_feed(frame, (size_t)frame_len * 2) == (size_t)frame_len * 2);
+        ok = ok && (smota_poll_deadline(&wait_ms) == SMOTA_ERR_OK) && (wait_ms == 0);
+        ok = ok && (smota_poll_deadline(&wait_ms) == SMOTA_ERR_OK) && (wait_ms > 0);
+        (void)smota_abort();
+
+        /* 握手后期限为总超时（比数据包超时先到期） */
+        ok = ok && (smota_feed(frame, (size_t)frame_len) == (size_t)frame_len);
+        ok = ok && (smota_poll_deadline(&wait_ms) == SMOTA_ERR_OK) && (wait_ms > 0) && (wait_ms <= 51);
+        ok = ok && (smota_get_state() == SMOTA_STATE_HANDSHAKE);
+
+        /* 到期后轮询一次报告超时，之后只剩数据包超时 */
+        sim_sleep_ms(wait_ms + 1);
+        ok = ok && (smota_poll_deadline(&wait_ms) == SMOTA_ERR_TIMEOUT) && (smota_get_state() == SMOTA_STATE_ERROR);
+        ok = ok && (wait_ms > 0) && (wait_ms <= 201);
+        ok = ok && (smota_poll_deadline(&wait_ms) == SMOTA_ERR_OK);
+
+        sim_sleep_ms(wait_ms + 1);
+        ok = ok && (smota_poll_deadline(&wait_ms) == SMOTA_ERR_TIMEOUT) && (wait_ms == SMOTA_WAIT_FOREVER);
+        ok = ok && (smota_poll_deadline(&wait_ms) == SMOTA_ERR_OK) && (wait_ms == SMOTA_WAIT_FOREVER);
+
+        g_comm_driver.send = comm_send;
+        (void)smota_abort();
+#endif
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试多颗 NOR 芯片互不影响，以及没有时钟时忙等待有上限 */
+    printf("Testing NOR devices... ");
+    {
+        static const struct smota_nor_bus stuck_bus = {
+            .transfer = stuck_nor_transfer,
+        };
+        struct smota_nor_dev stuck_dev;
+        uint64_t (*get_tick_ms)(void) = g_system_driver.get_tick_ms;
+        uint8_t buf[16];
+        bool ok;
+
+        ok = smota_nor_dev_attach(&stuck_dev, &stuck_bus, 32 * 1024 * 1024) == 0 &&
+             smota_nor_dev_init(&stuck_dev) == 0 && stuck_dev.addr_len == 4 && stuck_dev.jedec_id[2] == 0x19 &&
+             g_qspi_driver.init() == 0 && g_qspi_driver_dev.addr_len == 3;
+
+        g_system_driver.get_tick_ms = NULL;
+        ok = ok && smota_nor_dev_erase(&stuck_dev, 0, SMOTA_NOR_SECTOR_SIZE) == -4;
+        g_system_driver.get_tick_ms = get_tick_ms;
+
+        ok = ok && g_qspi_driver.read(0, buf, sizeof(buf)) == (int)sizeof(buf);
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试元数据存储：追加与查找、跳过撕裂记录、写满整理、按代数选择扇区、整理中断后恢复 */
+    printf("Testing metadata store... ");
+    {
+        const struct smota_partition *meta = smota_partition_find(SMOTA_PART_ID_META);
+        const uint8_t tag_a = SMOTA_META_TAG_USER;
+        const uint8_t tag_b = SMOTA_META_TAG_USER + 1;
+        uint8_t version[3] = { 0 };
+        uint8_t check[3] = { 0 };
+        uint8_t record[16];
+        uint32_t value = 0;
+        uint32_t gen;
+        uint32_t end;
+        uint16_t crc;
+        uint8_t sector;
+        uint8_t other;
+        int version_len;
+        int ok;
+
+        ok = (meta != NULL) && (meta->size / SMOTA_META_SECTOR_SIZE >= 2);
+        version_len = smota_meta_read(SMOTA_META_TAG_VERSION, version, sizeof(version));
+
+        /* 追加与查找：后写入的记录覆盖先写入的，未写过的标签不存在 */
+        value = 0x11111111U;
+        ok = ok && (smota_meta_write(tag_a, &value, sizeof(value)) == 0);
+        value = 0x22222222U;
+        ok = ok && (smota_meta_write(tag_a, &value, sizeof(value)) == 0) &&
+             (smota_meta_write(tag_b, &value, sizeof(value)) == 0);
+        value = 0;
+        ok = ok && (smota_meta_read(tag_a, &value, sizeof(value)) == (int)sizeof(value)) && (value == 0x22222222U) &&
+             smota_meta_exists(tag_b) && !smota_meta_exists(SMOTA_META_TAG_USER + 2) &&
+             (smota_meta_read(SMOTA_META_TAG_USER + 2, &value, sizeof(value)) == -3);
+
+        /* 撕裂记录：记录头已写入、内容只写了一半，重新扫描时 CRC 不符，停在该处，之前的记录仍有效 */
+        sector = ok ? meta_test_current(meta) : 0;
+        gen = ok ? meta_test_generation(meta, sector) : 0;
+        end = ok ? meta_test_end(meta, sector) : 0;
+        ok = ok && (end + sizeof(record) <= SMOTA_META_SECTOR_SIZE);
+        if (ok) {
+            value = 0x33333333U;
+            memset(record, 0xFF, sizeof(record));
+            record[0] = tag_a;
+            record[1] = sizeof(value);
+            record[2] = 0;
+            record[3] = 0;
+            memset(&record[4], 0x7F, 4);
+            memcpy(&record[8], &value, sizeof(value));
+            crc = smota_crc16_compute(record, 8 + sizeof(value));
+            record[2] = (uint8_t)crc;
+            record[3] = (uint8_t)(crc >> 8);
+            memset(&record[10], 0xFF, 2);
+            smota_partition_unlock(meta);
+            ok = (smota_partition_write(meta, (uint32_t)sector * SMOTA_META_SECTOR_SIZE + end, record, sizeof(record)) ==
+                  (int)sizeof(record));
+            smota_partition_lock(meta);
+        }
+        ok = ok && (smota_meta_init() == 0) && (smota_meta_read(tag_a, &value, sizeof(value)) == (int)sizeof(value)) &&
+             (value == 0x22222222U);
+
+        /* 撕裂记录之后不再追加：下一次写入整理到另一个扇区，代数加一 */
+        value = 0x44444444U;
+        ok = ok && (smota_meta_write(tag_a, &value, sizeof(value)) == 0) && (meta_test_current(meta) != sector) &&
+             (meta_test_generation(meta, meta_test_current(meta)) == gen + 1);
+
+        /* 两个扇区头都有效：重新初始化选择代数大的扇区 */
+        other = sector;
+        sector = meta_test_current(meta);
+        ok = ok && (meta_test_generation(meta, other) == gen) && (smota_meta_init() == 0);
+        value = 0;
+        ok = ok && (smota_meta_read(tag_a, &value, sizeof(value)) == (int)sizeof(value)) && (value == 0x44444444U) &&
+             (smota_meta_read(tag_b, &value, sizeof(value)) == (int)sizeof(value)) && (value == 0x22222222U);
+
+        /* 写满扇区：反复更新同一标签直到整理，整理后其他标签保留 */
+        gen = meta_test_generation(meta, sector);
+        for (uint32_t i = 0; ok && i < SMOTA_META_SECTOR_SIZE / 8 && meta_test_current(meta) == sector; i++) {
+            value = 0x50000000U + i;
+            ok = (smota_meta_write(tag_b, &value, sizeof(value)) == 0);
+        }
+        ok = ok && (meta_test_current(meta) != sector) && (meta_test_generation(meta, meta_test_current(meta)) == gen + 1);
+        end = value;
+        ok = ok && (smota_meta_read(tag_b, &value, sizeof(value)) == (int)sizeof(value)) && (value == end) &&
+             (smota_meta_read(tag_a, &value, sizeof(value)) == (int)sizeof(value)) && (value == 0x44444444U);
+
+        /* 整理中断：下一个扇区已擦除并写入部分记录，但扇区头尚未写入，重新初始化仍使用当前扇区 */
+        other = meta_test_current(meta) ^ 1U;
+        sector = meta_test_current(meta);
+        if (ok) {
+            uint8_t copy[64];
+
+            smota_partition_unlock(meta);
+            ok = (smota_partition_erase(meta, (uint32_t)other * SMOTA_META_SECTOR_SIZE, SMOTA_META_SECTOR_SIZE) == 0) &&
+                 (smota_partition_read(meta, (uint32_t)sector * SMOTA_META_SECTOR_SIZE + 8, copy, sizeof(copy)) ==
+                  (int)sizeof(copy)) &&
+                 (smota_partition_write(meta, (uint32_t)other * SMOTA_META_SECTOR_SIZE + 8, copy, sizeof(copy)) ==
+                  (int)sizeof(copy));
+            smota_partition_lock(meta);
+        }
+        ok = ok && (meta_test_generation(meta, other) == 0) && (smota_meta_init() == 0) &&
+             (meta_test_current(meta) == sector) &&
+             (smota_meta_read(tag_a, &value, sizeof(value)) == (int)sizeof(value)) && (value == 0x44444444U);
+
+        /* 再次写满时重新擦除该扇区完成整理 */
+        gen = meta_test_generation(meta, sector);
+        for (uint32_t i = 0; ok && i < SMOTA_META_SECTOR_SIZE / 8 && meta_test_current(meta) == sector; i++) {
+            value = 0x60000000U + i;
+            ok = (smota_meta_write(tag_b, &value, sizeof(value)) == 0);
+        }
+        ok = ok && (meta_test_current(meta) == other) && (meta_test_generation(meta, other) == gen + 1) &&
+             (smota_meta_init() == 0) && (smota_meta_read(tag_a, &value, sizeof(value)) == (int)sizeof(value)) &&
+             (value == 0x44444444U);
+
+        /* 固件自身的记录在多次整理后保持不变 */
+        ok = ok && (smota_meta_read(SMOTA_META_TAG_VERSION, check, sizeof(check)) == version_len) &&
+             (memcmp(version, check, sizeof(check)) == 0);
+
+        if (ok) {
+            printf("PASS\n");
+        } else {
+            printf("FAIL\n");
+            return -1;
+        }
+    }
+
+    /* 测试版本比较 */
+    printf("Testing version check... ");
+    if (smota_verify_version(version1, version2) == true && smota_verify_version(version1, version3) == false) {
+        printf("PASS\n");
+    } else {
+        printf("FAIL\n");
+        return -1;
+    }
+
+    /* 测试状态机 */
+    printf("Testing state machine... ");
+    smota_state_reset();
+    if (smota_state_get() == SMOTA_STATE_IDLE) {
+        printf("PASS\n");
+    } else {
+        printf("FAIL\n");
+        return -1;
+    }
+
+    printf("==================\n");
+    printf("All tests passed!\n\n");
+
+    return 0;
+}
+
+/**
+ * @brief  下载区写入吞吐量测试（虚拟时钟）
+ * @param  image_size: 模拟固件大小
+ * @param  block_size: 每个数据块大小（模拟 DATA_BLOCK 负载）
+ */
+static void bench_staging_once(uint32_t image_size, uint32_t block_size)
+{
+    static uint8_t block[SMOTA_WORK_BUF_SIZE];
+    struct qspi_sim_stats erase_stats;
+    struct qspi_sim_stats stats;
+    uint32_t written = 0;
+
+    for (uint32_t i = 0; i < sizeof(block); i++) {
+        block[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    qspi_sim_reset_stats();
+    smota_stats_begin(image_size);
+    if (smota_flash_erase_backup(image_size) < 0) {
+        printf("  erase failed\n");
+        return;
+    }
+    qspi_sim_get_stats(&erase_stats);
+
+    while (written < image_size) {
+        uint32_t chunk = (image_size - written < block_size) ? (image_size - written) : block_size;
+
+        if (smota_flash_write_backup(block, chunk) != (int)chunk) {
+            printf("  write failed at %u\n", (unsigned int)written);
+            return;
+        }
+        written += chunk;
+    }
+    smota_flash_flush_backup();
+    qspi_sim_get_stats(&stats);
+
+    double erase_ms = erase_stats.elapsed_ns / 1e6;
+    double total_ms = stats.elapsed_ns / 1e6;
+    double prog_ms = total_ms - erase_ms;
+
+    printf("  block %5u B: erase %8.1f ms (%u x 64KB, %u x 4KB), program %8.1f ms "
+           "(%u pages, %u partial), %.2f MB/s program, %.2f MB/s total\n",
+           (unsigned int)block_size, erase_ms,
+           (unsigned int)stats.block_erases, (unsigned int)stats.sector_erases,
+           prog_ms, (unsigned int)stats.page_programs, (unsigned int)stats.partial_programs,
+           image_size / 1048576.0 / (prog_ms / 1000.0),
+           image_size / 1048576.0 / (total_ms / 1000.0));
+
+    /* 擦写量超出固件所需说明核心多擦或重写了 */
+    struct smota_flash_summary summary;
+    if (smota_stats_summary_get(&summary) == 0) {
+        printf("                 staging erase x%u.%02u (%u calls), write x%u.%02u (%u calls)\n",
+               (unsigned int)(summary.erase_amp_x100 / 100), (unsigned int)(summary.erase_amp_x100 % 100),
+               (unsigned int)summary.stage_erase_count,
+               (unsigned int)(summary.write_amp_x100 / 100), (unsigned int)(summary.write_amp_x100 % 100),
+               (unsigned int)summary.stage_write_count);
+    }
+}
+
+/**
+ * @brief  下载区写入吞吐量测试
+ */
+static void run_staging_bench(void)
+{
+    static const uint32_t block_sizes[] = { 200, 256, 1024, 2048 };
+    uint32_t image_size = smota_flash_backup_size();
+
+    printf("\n=== QSPI Staging Benchmark ===\n");
+    printf("Backup slot: dev=%u size=%uKB, simulated 80MHz QSPI, tPP=0.4ms, tSE=45ms, tBE=150ms\n",
+           (unsigned int)WIN_SIM_QSPI_DEV, (unsigned int)(image_size / 1024));
+
+    for (uint32_t i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); i++) {
+        bench_staging_once(image_size, block_sizes[i]);
+    }
+
+    printf("==============================\n\n");
+}
+
+/**
+ * @brief  SHA-256 吞吐量测试（使用当前选中的后端）
+ * @param  data: 输入数据
+ * @param  size: 数据总量
+ * @param  chunk: 每次 tc_sha256_update 的长度
+ * @return MB/s
+ */
+static double bench_sha256_once(const uint8_t *data, uint32_t size, uint32_t chunk)
+{
+    struct tc_sha256_state_struct s;
+    uint8_t digest[TC_SHA256_DIGEST_SIZE];
+    uint64_t start = system_get_tick_us();
+    uint64_t elapsed;
+
+    (void)tc_sha256_init(&s);
+    for (uint32_t offset = 0; offset < size; offset += chunk) {
+        uint32_t len = (size - offset < chunk) ? (size - offset) : chunk;
+        (void)tc_sha256_update(&s, data + offset, len);
+    }
+    (void)tc_sha256_final(digest, &s);
+
+    elapsed = system_get_tick_us() - start;
+    return (elapsed > 0) ? size / 1048576.0 / (elapsed / 1e6) : 0.0;
+}
+
+/**
+ * @brief  AES-128-CTR 吞吐量测试（使用当前选中的后端）
+ * @param  data: 输入数据
+ * @param  out: 输出缓冲区
+ * @param  size: 数据总量
+ * @return MB/s
+ */
+static double bench_aes_ctr_once(const uint8_t *data, uint8_t *out, uint32_t size)
+{
+    static const uint8_t key[TC_AES_KEY_SIZE] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                                  0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+    struct tc_aes_key_sched_struct sched;
+    uint8_t ctr[TC_AES_BLOCK_SIZE] = { 0 };
+    uint64_t start;
+    uint64_t elapsed;
+
+    (void)tc_aes128_set_encrypt_key(&sched, key);
+
+    start = system_get_tick_us();
+    for (uint32_t offset = 0; offset < size; offset += 4096) {
+        uint32_t len = (size - offset < 4096) ? (size - offset) : 4096;
+        (void)tc_ctr_mode(out + offset, len, data + offset, len, ctr, &sched);
+    }
+    elapsed = system_get_tick_us() - start;
+
+    return (elapsed > 0) ? size / 1048576.0 / (elapsed / 1e6) : 0.0;
+}
+
+/**
+ * @brief  ECDSA P-256 验签吞吐量测试：逐个 uECC_verify 与 uECC_verify_batch 对比
+ * @note   私钥固定，只用于生成测试签名
+ */
+static void bench_ecdsa_verify(void)
+{
+    static uint8_t hash[WIN_SIM_ECDSA_BENCH_NUM][32];
+    static uint8_t sig[WIN_SIM_ECDSA_BENCH_NUM][64];
+    static const uint8_t *keys[WIN_SIM_ECDSA_BENCH_NUM];
+    static const uint8_t *hashes[WIN_SIM_ECDSA_BENCH_NUM];
+    static const uint8_t *sigs[WIN_SIM_ECDSA_BENCH_NUM];
+    static uint8_t results[WIN_SIM_ECDSA_BENCH_NUM];
+    uint8_t private_key[32];
+    uint8_t public_key[64];
+    uECC_Curve curve = uECC_secp256r1();
+    uint64_t start;
+    uint64_t elapsed;
+    int valid = 0;
+
+    for (uint32_t i = 0; i < sizeof(private_key); i++) {
+        private_key[i] = (uint8_t)(i + 1);
+    }
+    if (!uECC_compute_public_key(private_key, public_key, curve)) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < WIN_SIM_ECDSA_BENCH_NUM; i++) {
+        for (uint32_t j = 0; j < 32; j++) {
+            hash[i][j] = (uint8_t)(i * 13 + j * 7);
+        }
+        if (!uECC_sign(private_key, hash[i], sizeof(hash[i]), sig[i], curve)) {
+            printf("  ecdsa-p256 sign failed\n");
+            return;
+        }
+        keys[i] = public_key;
+        hashes[i] = hash[i];
+        sigs[i] = sig[i];
+    }
+
+    start = system_get_tick_us();
+    for (uint32_t i = 0; i < WIN_SIM_ECDSA_BENCH_NUM; i++) {
+        valid += uECC_verify(keys[i], hashes[i], 32, sigs[i], curve);
+    }
+    elapsed = system_get_tick_us() - start;
+    printf("  ecdsa-p256 verify x%u: %8.0f sig/s (%d valid)\n", (unsigned int)WIN_SIM_ECDSA_BENCH_NUM,
+           (elapsed > 0) ? WIN_SIM_ECDSA_BENCH_NUM / (elapsed / 1e6) : 0.0, valid);
+
+    start = system_get_tick_us();
+    valid = uECC_verify_batch(keys, hashes, 32, sigs, results, WIN_SIM_ECDSA_BENCH_NUM, curve);
+    elapsed = system_get_tick_us() - start;
+    printf("  ecdsa-p256 batch  x%u: %8.0f sig/s (%d valid, %s)\n", (unsigned int)WIN_SIM_ECDSA_BENCH_NUM,
+           (elapsed > 0) ? WIN_SIM_ECDSA_BENCH_NUM / (elapsed / 1e6) : 0.0, valid,
+           uECC_verify_batch_accelerated() ? "64-bit" : "fallback");
+}
+
+/**
+ * @brief  KDF 吞吐量测试：每次重新设置主密钥与缓存主密钥中间状态对比
+ * @note   模拟发布工具为大量设备 UID 派生一机一密密钥
+ */
+static void bench_kdf(void)
+{
+    static const uint8_t master_key[32] = { 0x5a };
+    struct tc_hmac_key_struct kdf_key;
+    uint8_t uid[12] = { 0 };
+    uint8_t key1[32];
+    uint8_t key2[32];
+    const uint32_t num = 20000;
+    uint64_t start;
+    uint64_t elapsed_plain;
+    uint64_t elapsed_cached;
+    bool match;
+
+    start = system_get_tick_us();
+    for (uint32_t i = 0; i < num; i++) {
+        memcpy(uid, &i, sizeof(i));
+        (void)smota_kdf_derive(master_key, uid, sizeof(uid), SMOTA_KDF_CONTEXT, key1);
+    }
+    elapsed_plain = system_get_tick_us() - start;
+
+    start = system_get_tick_us();
+    (void)smota_kdf_key_init(&kdf_key, master_key);
+    for (uint32_t i = 0; i < num; i++) {
+        memcpy(uid, &i, sizeof(i));
+        (void)smota_kdf_derive_with_key(&kdf_key, uid, sizeof(uid), SMOTA_KDF_CONTEXT, key2);
+    }
+    elapsed_cached = system_get_tick_us() - start;
+
+    /* 最后一个 UID 两种方式的结果必须一致 */
+    match = (memcmp(key1, key2, sizeof(key1)) == 0);
+    memset(&kdf_key, 0, sizeof(kdf_key));
+
+    printf("  kdf derive        x%u: %8.0f key/s\n", (unsigned int)num,
+           (elapsed_plain > 0) ? num / (elapsed_plain / 1e6) : 0.0);
+    printf("  kdf derive cached x%u: %8.0f key/s (%s)\n", (unsigned int)num,
+           (elapsed_cached > 0) ? num / (elapsed_cached / 1e6) : 0.0, match ? "match" : "MISMATCH");
+}
+
+/**
+ * @brief  加密吞吐量测试
+ * @note   chunk=1 只走逐字节缓存路径；DATA_BLOCK 负载大小和 4KB 走整块直接压缩路径
+ */
+static void run_crypto_bench(void)
+{
+    static const uint32_t chunk_sizes[] = { 1, 64, 200, SMOTA_WORK_BUF_SIZE, 4096 };
+    uint8_t *data = malloc(WIN_SIM_CRYPTO_BENCH_SIZE);
+
+    if (data == NULL) {
+        printf("Error: out of memory\n");
+        return;
+    }
+
+    for (uint32_t i = 0; i < WIN_SIM_CRYPTO_BENCH_SIZE; i++) {
+        data[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    printf("\n=== Crypto Benchmark (%uMB) ===\n", (unsigned int)(WIN_SIM_CRYPTO_BENCH_SIZE / 1048576));
+    unsigned int detected = tc_sha256_backend_current();
+    for (unsigned int backend = 0; backend < TC_SHA256_BACKEND_NUM; backend++) {
+        if (tc_sha256_backend_select(backend) != TC_CRYPTO_SUCCESS) {
+            printf("  sha256 [%-8s] not supported on this CPU\n", tc_sha256_backend_name(backend));
+            continue;
+        }
+        for (uint32_t i = 0; i < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); i++) {
+            printf("  sha256 [%-8s] update %5u B: %8.2f MB/s\n", tc_sha256_backend_name(backend),
+                   (unsigned int)chunk_sizes[i], bench_sha256_once(data, WIN_SIM_CRYPTO_BENCH_SIZE, chunk_sizes[i]));
+        }
+    }
+    (void)tc_sha256_backend_select(detected);
+
+    /* 多缓冲：1024 个 4KB 固件段 */
+    const uint32_t batch_count = WIN_SIM_CRYPTO_BENCH_SIZE / 4096;
+    const uint8_t **batch_data = malloc(batch_count * sizeof(*batch_data));
+    uint32_t *batch_size = malloc(batch_count * sizeof(*batch_size));
+    uint8_t (*batch_hash)[32] = malloc(batch_count * sizeof(*batch_hash));
+    unsigned int detected_lanes = tc_sha256_mb_lanes();
+
+    if (batch_data != NULL && batch_size != NULL && batch_hash != NULL) {
+        for (uint32_t i = 0; i < batch_count; i++) {
+            batch_data[i] = data + i * 4096;
+            batch_size[i] = 4096;
+        }
+        for (unsigned int lanes = 1; lanes <= TC_SHA256_MB_LANES_MAX; lanes <<= 1) {
+            if (tc_sha256_mb_select(lanes) != TC_CRYPTO_SUCCESS) {
+                continue;
+            }
+            uint64_t start = system_get_tick_us();
+            (void)smota_sha256_compute_batch(batch_data, batch_size, batch_hash, batch_count);
+            uint64_t elapsed = system_get_tick_us() - start;
+            printf("  sha256 batch %u x 4KB, %u lane(s): %8.2f MB/s\n", (unsigned int)batch_count, lanes,
+                   (elapsed > 0) ? WIN_SIM_CRYPTO_BENCH_SIZE / 1048576.0 / (elapsed / 1e6) : 0.0);
+        }
+        (void)tc_sha256_mb_select(detected_lanes);
+    }
+    free(batch_data);
+    free(batch_size);
+    free(batch_hash);
+
+    /* AES-128-CTR：按 4KB 分段，与 crypto->aes_crypt 的调用粒度相近 */
+    uint8_t *out = malloc(WIN_SIM_CRYPTO_BENCH_SIZE);
+    unsigned int aes_detected = tc_aes_backend_current();
+
+    if (out != NULL) {
+        for (unsigned int backend = 0; backend < TC_AES_BACKEND_NUM; backend++) {
+            if (tc_aes_backend_select(backend) != TC_CRYPTO_SUCCESS) {
+                printf("  aes-ctr [%-8s] not supported on this CPU\n", tc_aes_backend_name(backend));
+                continue;
+            }
+            printf("  aes-ctr [%-8s] 4096 B: %8.2f MB/s\n", tc_aes_backend_name(backend),
+                   bench_aes_ctr_once(data, out, WIN_SIM_CRYPTO_BENCH_SIZE));
+        }
+        (void)tc_aes_backend_select(aes_detected);
+    }
+    free(out);
+
+    bench_ecdsa_verify();
+    bench_kdf();
+    printf("===============================\n\n");
+
+    free(data);
+}
+
+/**
+ * @brief  OTA 任务测试
+ * @note   主线程模拟串口中断，每隔约 1ms 推送一个握手帧，OTA 任务被信号量唤醒后应答；
+ *         之后空闲 WIN_SIM_TASK_IDLE_MS。统计应答延迟和任务唤醒次数，
+ *         与主循环每 1ms 调用一次 smota_poll() 的轮询次数对比
+ */
+static void run_task_bench(void)
+{
+#if SMOTA_FEED_BUF_SIZE > 0
+    static struct smota_task task;
+    struct smota_handshake_req req;
+    uint8_t frame[64];
+    int frame_len;
+    uint64_t start_us;
+    uint64_t feed_us;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    uint64_t elapsed_ms;
+    uint32_t busy_wakeups;
+    uint32_t busy_polls;
+    uint32_t done = 0;
+
+    memset(&req, 0, sizeof(req));
+    req.firmware_size = 4096;
+    frame_len = smota_frame_build(SMOTA_CMD_HANDSHAKE, (const uint8_t *)&req, sizeof(req), frame, sizeof(frame));
+
+    g_comm_driver.send = feed_test_send;
+    g_feed_test_resp_num = 0;
+
+    if (frame_len <= 0 || smota_task_start(&task, smota_instance_default(), &g_os_driver) < 0) {
+        printf("Error: OTA task start failed\n");
+        g_comm_driver.send = comm_send;
+        return;
+    }
+
+    printf("\n=== OTA Task Benchmark ===\n");
+    printf("Frames: %u, idle tail: %u ms, task idle wait: %u ms\n\n", (unsigned int)WIN_SIM_TASK_BENCH_NUM,
+           (unsigned int)WIN_SIM_TASK_IDLE_MS, (unsigned int)SMOTA_TASK_IDLE_MS);
+
+    start_us = system_get_tick_us();
+    for (uint32_t i = 0; i < WIN_SIM_TASK_BENCH_NUM; i++) {
+        feed_us = system_get_tick_us();
+        (void)smota_task_feed(&task, frame, (size_t)frame_len);
+
+        /* 等待应答（延迟按任务中发送应答的时刻计算） */
+        while (g_feed_test_resp_num == done && system_get_tick_us() - feed_us < 1000000) {
+            sim_sleep_ms(0);
+        }
+        if (g_feed_test_resp_num == done) {
+            break;
+        }
+
+        done = g_feed_test_resp_num;
+        total_us += g_feed_test_resp_us - feed_us;
+        if (g_feed_test_resp_us - feed_us > max_us) {
+            max_us = g_feed_test_resp_us - feed_us;
+        }
+
+        sim_sleep_ms(1);
+    }
+
+    busy_wakeups = task.wakeups;
+    busy_polls = task.polls;
+    sim_sleep_ms(WIN_SIM_TASK_IDLE_MS);
+    elapsed_ms = (system_get_tick_us() - start_us) / 1000;
+
+    (void)smota_task_stop(&task);
+    g_comm_driver.send = comm_send;
+    (void)smota_abort();
+
+    printf("%-26s %10u / %u\n", "Responses", (unsigned int)done, (unsigned int)WIN_SIM_TASK_BENCH_NUM);
+    printf("%-26s %10.1f us (max %llu us)\n", "Feed -> response latency", done ? (double)total_us / done : 0.0,
+           (unsigned long long)max_us);
+    printf("%-26s %10u (polls %u)\n", "Task wakeups (traffic)", (unsigned int)busy_wakeups, (unsigned int)busy_polls);
+    printf("%-26s %10u\n", "Task wakeups (idle)", (unsigned int)(task.wakeups - busy_wakeups));
+    printf("%-26s %10llu (1 per ms over %llu ms)\n", "Super-loop polls", (unsigned long long)elapsed_ms,
+           (unsigned long long)elapsed_ms);
+#else
+    printf("OTA task requires SMOTA_FEED_BUF_SIZE > 0\n");
+#endif
+}
+
+/**
+ * @brief  模拟设备运行
+ * @note   按 smota_poll_deadline() 给出的期限休眠，数据到达（模拟接收中断）时提前唤醒；
+ *         stdin 关闭后退出并打印唤醒次数
+ */
+static void simulate_device(void)
+{
+    smota_state_t last_state = SMOTA_STATE_MAX;
+    smota_err_t last_error = SMOTA_ERR_OK;
+    uint64_t start_ms = system_get_tick_ms();
+    uint64_t elapsed_ms;
+    uint32_t wait_ms = 0;
+    uint32_t wakeups = 0;
+
+    printf("\n=== Device Simulation Started ===\n");
+    printf("Press Ctrl+C (or close stdin) to exit\n\n");
+
+    /* 核心不调用 comm->init，stdio 传输在这里打开 */
+    (void)comm_init();
+
+    while (1) {
+#if SMOTA_FEED_BUF_SIZE > 0
+        /* 模拟串口空闲中断：等待数据或期限到达，把收到的数据推送给 smOTA */
+        {
+            uint8_t rx[256];
+            int n = comm_receive(rx, sizeof(rx), wait_ms);
+
+            if (n < 0) {
+                break;
+            }
+            if (n > 0) {
+                (void)smota_feed(rx, (size_t)n);
+            }
+        }
+#else
+        /* 等待数据或期限到达，smota_poll 自己调用 comm->receive */
+        if (comm_wait(wait_ms) < 0) {
+            break;
+        }
+#endif
+        wakeups++;
+
+        /* 调用 OTA poll，得到下次需要轮询的时间 */
+        (void)smota_poll_deadline(&wait_ms);
+
+        /* 可选: 打印状态变化 */
+        smota_state_t current_state = smota_get_state();
+        if (current_state != last_state) {
+            printf("[%llu] State: %s -> %s\n",
+                   (unsigned long long)system_get_tick_ms(),
+                   smota_state_to_string(last_state),
+                   smota_state_to_string(current_state));
+            last_state = current_state;
+
+            /* 传输完成后打印本次会话的 Flash 操作统计 */
+            if (current_state == SMOTA_STATE_COMPLETE) {
+                show_flash_stats();
+            }
+        }
+
+        /* 错误处理 */
+        if (smota_get_error() != last_error) {
+            last_error = smota_get_error();
+            if (last_error != SMOTA_ERR_OK) {
+                printf("[%llu] Error: %s\n",
+                       (unsigned long long)system_get_tick_ms(),
+                       smota_get_error_string());
+            }
+        }
+    }
+
+    elapsed_ms = system_get_tick_ms() - start_ms;
+    printf("\n=== Device Simulation Stopped ===\n");
+    printf("Wakeups: %u in %llu ms (1ms poll loop: %llu)\n", (unsigned int)wakeups, (unsigned long long)elapsed_ms,
+           (unsigned long long)elapsed_ms);
+}
+
+int main(int argc, char *argv[])
+{
+    int ret;
+    bool init_flash = false;
+    bool show_status_flag = false;
+    bool run_device = false;
+    bool run_test = false;
+    bool qspi_staging = false;
+    bool run_bench = false;
+    bool run_crypto = false;
+    bool run_task = false;
 
     /* 解析命令行参数 */
     for (int i = 1; i < argc; i++) {
@@ -239,6 +2054,15 @@ int main(int argc, char *argv[])
             run_device = true;
         } else if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--test") == 0) {
             run_test = true;
+        } else if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--qspi") == 0) {
+            qspi_staging = true;
+        } else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--bench") == 0) {
+            run_bench = true;
+            qspi_staging = true;
+        } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--crypto") == 0) {
+            run_crypto = true;
+        } else if (strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--task") == 0) {
+            run_task = true;
         }
     }
 
@@ -246,13 +2070,35 @@ int main(int argc, char *argv[])
     if (init_flash) {
         printf("Initializing Flash...\n");
         flash_init();
-        flash_erase(0, SMOTA_FLASH_SIZE);
+        flash_erase(SMOTA_FLASH_BASE_ADDR, SMOTA_FLASH_SIZE);
         flash_deinit();
         printf("Flash initialized.\n");
         return 0;
     }
 
-    /* 注册 HAL 接口到 smOTA */
+    /* 模拟外部 QSPI NOR（仅保存在内存中） */
+    if (qspi_sim_init(WIN_SIM_QSPI_SIZE) < 0) {
+        printf("Error: QSPI NOR simulation init failed\n");
+        return -1;
+    }
+
+    /* 按 CPU 特性选择 SHA-256/AES 后端（crypto->sha256_*、aes_* 经 TinyCrypt 使用） */
+    (void)tc_sha256_backend_detect();
+    (void)tc_sha256_mb_detect();
+    (void)tc_aes_backend_detect();
+    (void)tc_port_block_mac_set_key(g_block_auth_key);
+    {
+        uint8_t aead_key[32];
+
+        if (derive_transport_key(aead_key) == 0) {
+            (void)tc_port_aead_set_key(aead_key);
+        }
+        memset(aead_key, 0, sizeof(aead_key));
+    }
+
+    /* 生成分区表并注册 HAL 接口到 smOTA */
+    build_partition_table(SMOTA_FLASH_SIZE, qspi_staging);
+
     ret = smota_hal_register(&g_smota_hal);
     if (ret < 0) {
         SMOTA_DEBUG_PRINTF("Error: smota_hal_register failed: %d\n", ret);
@@ -262,6 +2108,9 @@ int main(int argc, char *argv[])
     printf("smOTA initialized successfully (Win32 Simulation)\n");
     printf("HAL: Flash=%s, Comm=stdio, Crypto=OpenSSL\n",
            init_flash ? "file" : "memory");
+    printf("SHA-256 backend: %s, batch lanes: %u\n", tc_sha256_backend_name(tc_sha256_backend_current()),
+           tc_sha256_mb_lanes());
+    printf("AES backend: %s\n", tc_aes_backend_name(tc_aes_backend_current()));
 
     /* 初始化 OTA 模块 */
     ret = smota_init();
@@ -273,8 +2122,14 @@ int main(int argc, char *argv[])
     /* 执行选定的操作 */
     if (show_status_flag) {
         show_status();
+    } else if (run_bench) {
+        run_staging_bench();
+    } else if (run_crypto) {
+        run_crypto_bench();
+    } else if (run_task) {
+        run_task_bench();
     } else if (run_test) {
-        run_self_test();
+        ret = run_self_test();
     } else if (run_device) {
         simulate_device();
     } else {
@@ -287,8 +2142,10 @@ int main(int argc, char *argv[])
     /* 清理 */
     smota_deinit();
     flash_deinit();
+    qspi_sim_deinit();
 
-    return 0;
+    /* 自测试失败时以非 0 退出，供 ctest 判定 */
+    return (ret < 0) ? 1 : 0;
 }
 
 /*---------- end of file ----------*/
@@ -20,18 +20,25 @@
 #include <windows.h>
 #else
 #include <sys/time.h>
+#include <sys/select.h>
 #include <unistd.h>
 #endif
 
 #include "smota_user_config.h"
+#include "smota_config.h"
 
 /* TinyCrypt 加密库头文件 */
 #include <tinycrypt/sha256.h>
+#include <tinycrypt/sha256_mb.h>
+#include <tinycrypt/blake2s.h>
+#include <tinycrypt/chacha20_poly1305.h>
 #include <tinycrypt/aes.h>
 #include <tinycrypt/ctr_mode.h>
 #include <tinycrypt/hmac.h>
+#include <tinycrypt/cmac_mode.h>
 #include <tinycrypt/ecc.h>
 #include <tinycrypt/ecc_dsa.h>
+#include <tinycrypt/utils.h>
 
 /*---------- macro ----------*/
 
@@ -57,6 +64,7 @@ struct smota_port_flash_ctx {
  */
 struct smota_port_comm_ctx {
     int is_init; /* 是否已初始化 */
+    int eof;     /* stdin 已关闭 */
 };
 
 /**
@@ -64,18 +72,22 @@ struct smota_port_comm_ctx {
  */
 struct tc_sha256_ctx {
     struct tc_sha256_state_struct state;
+    uint8_t heap;  /* 1=由 tc_port_sha256_init 分配，完成时释放 */
 };
 
 /**
  * @brief  TinyCrypt AES-CTR 上下文
  */
 struct tc_aes_ctx {
-    TCAesKeySched_t sched;  /* AES 密钥调度 */
-    uint8_t ctr[16];        /* 计数器 (IV) */
+    struct tc_aes_key_sched_struct sched;  /* AES 密钥调度 */
+    uint8_t ctr[16];                       /* 计数器 (IV) */
 };
 
 /*---------- variable prototype ----------*/
 
+/* 公钥验签预计算表（keys/ecdsa_public_key.c，keygen.py 生成） */
+extern const unsigned int smota_ecdsa_pub_table[16 * 16];
+
 static struct smota_port_flash_ctx g_flash_ctx = {0};
 static struct smota_port_comm_ctx  g_comm_ctx = {0};
 
@@ -83,11 +95,23 @@ static struct smota_port_comm_ctx  g_comm_ctx = {0};
 
 /*---------- TinyCrypt SHA-256 驱动函数 (端口封装) ----------*/
 void *tc_port_sha256_init(void);
+uint32_t tc_port_sha256_ctx_size(void);
+int tc_port_sha256_init_at(void *ctx);
 int tc_port_sha256_update(void *ctx, const uint8_t *data, uint32_t size);
 int tc_port_sha256_final(void *ctx, uint8_t hash[32]);
+int tc_port_sha256_batch(const uint8_t *const *data, const uint32_t *size, uint8_t (*hash)[32], uint32_t count);
+
+/*---------- TinyCrypt BLAKE2s 驱动函数 (端口封装) ----------*/
+uint32_t tc_port_blake2s_ctx_size(void);
+int tc_port_blake2s_init_at(void *ctx);
+int tc_port_blake2s_update(void *ctx, const uint8_t *data, uint32_t size);
+int tc_port_blake2s_final(void *ctx, uint8_t hash[32]);
 
 /*---------- TinyCrypt AES-128-CTR 驱动函数 (端口封装) ----------*/
 void *tc_port_aes_init(const uint8_t *key, const uint8_t *iv);
+void tc_port_aes_deinit(void *ctx);
+uint32_t tc_port_aes_ctx_size(void);
+int tc_port_aes_init_at(void *ctx, const uint8_t *key, const uint8_t *iv);
 int tc_port_aes_crypt(void *ctx, const uint8_t *input, uint8_t *output, uint32_t size);
 
 /*---------- TinyCrypt ECDSA-P256 驱动函数 (端口封装) ----------*/
@@ -95,8 +119,18 @@ int tc_port_ecdsa_verify(const uint8_t *hash,
                          const uint8_t *sig_r,
                          const uint8_t *sig_s,
                          const uint8_t *pub_key);
+int tc_port_ecdsa_verify_fixed(const uint8_t *hash, const uint8_t *sig_r, const uint8_t *sig_s);
+
+/*---------- 数据块认证 (AES-128-CMAC) ----------*/
+int tc_port_block_mac_set_key(const uint8_t key[16]);
+int tc_port_block_mac(uint32_t offset, const uint8_t *data, uint16_t size, uint8_t tag[16]);
 
 /*---------- KDF 密钥派生函数 ----------*/
+int smota_kdf_key_init(struct tc_hmac_key_struct *kdf_key, const uint8_t *master_key);
+int smota_kdf_derive_with_key(const struct tc_hmac_key_struct *kdf_key,
+                              const uint8_t *uid, uint32_t uid_len,
+                              const char *context,
+                              uint8_t output[32]);
 int smota_kdf_derive(const uint8_t *master_key,
                      const uint8_t *uid, uint32_t uid_len,
                      const char *context,
@@ -104,6 +138,22 @@ int smota_kdf_derive(const uint8_t *master_key,
 
 /*---------- Flash 驱动实现 ----------*/
 
+/**
+ * @brief  绝对地址转换为模拟缓冲区偏移
+ * @param  addr: Flash 绝对地址（如 0x08010000）
+ * @param  offset: 输出缓冲区偏移
+ * @return 0=成功, <0=地址越界
+ */
+static int flash_addr_to_offset(uint32_t addr, uint32_t *offset)
+{
+    if (addr < SMOTA_FLASH_BASE_ADDR || addr - SMOTA_FLASH_BASE_ADDR >= g_flash_ctx.size) {
+        return -1;
+    }
+
+    *offset = addr - SMOTA_FLASH_BASE_ADDR;
+    return 0;
+}
+
 /**
  * @brief  Flash 初始化
  */
@@ -114,12 +164,15 @@ int flash_init(void)
     }
 
     g_flash_ctx.size = SMOTA_FLASH_SIZE;
-    g_flash_ctx.buffer = (uint8_t *)calloc(1, g_flash_ctx.size);
+    g_flash_ctx.buffer = (uint8_t *)malloc(g_flash_ctx.size);
     if (g_flash_ctx.buffer == NULL) {
         SMOTA_DEBUG_PRINTF("Error: Failed to allocate flash buffer\r\n");
         return -1;
     }
 
+    /* 未加载文件时模拟出厂擦除状态 */
+    memset(g_flash_ctx.buffer, 0xFF, g_flash_ctx.size);
+
     /* 尝试从文件加载已有数据 */
     FILE *fp = fopen(SMOTA_PORT_FLASH_FILE, "rb");
     if (fp != NULL) {
@@ -127,7 +180,7 @@ int flash_init(void)
         fclose(fp);
         SMOTA_DEBUG_PRINTF("Flash loaded from file: %s\r\n", SMOTA_PORT_FLASH_FILE);
     } else {
-        SMOTA_DEBUG_PRINTF("Flash initialized with zeros\r\n");
+        SMOTA_DEBUG_PRINTF("Flash initialized as erased (0xFF)\r\n");
     }
 
     g_flash_ctx.is_open = 1;
@@ -169,7 +222,7 @@ int flash_read(uint32_t addr, uint8_t *data, uint32_t size)
         return -1;
     }
 
-    if (addr >= g_flash_ctx.size) {
+    if (flash_addr_to_offset(addr, &addr) < 0) {
         SMOTA_DEBUG_PRINTF("Error: Flash read addr out of range: 0x%08X\r\n", addr);
         return -1;
     }
@@ -190,7 +243,7 @@ int flash_write(uint32_t addr, const uint8_t *data, uint32_t size)
         return -1;
     }
 
-    if (addr >= g_flash_ctx.size) {
+    if (flash_addr_to_offset(addr, &addr) < 0) {
         SMOTA_DEBUG_PRINTF("Error: Flash write addr out of range: 0x%08X\r\n", addr);
         return -1;
     }
@@ -211,7 +264,7 @@ int flash_erase(uint32_t addr, uint32_t size)
         return -1;
     }
 
-    if (addr >= g_flash_ctx.size) {
+    if (flash_addr_to_offset(addr, &addr) < 0) {
         SMOTA_DEBUG_PRINTF("Error: Flash erase addr out of range: 0x%08X\r\n", addr);
         return -1;
     }
@@ -281,8 +334,39 @@ int comm_send(const uint8_t *data, uint32_t size)
     return (int)size;
 }
 
+/**
+ * @brief  等待数据到达（模拟接收中断）
+ * @param  timeout: 最长等待时间（毫秒），SMOTA_WAIT_FOREVER=一直等待
+ * @return 1=有数据可读, 0=超时, -1=stdin 已关闭
+ * @note   Windows 下 stdin 可能是管道，无法按超时等待，直接返回可读
+ */
+int comm_wait(uint32_t timeout)
+{
+    if (g_comm_ctx.eof) {
+        return -1;
+    }
+
+#ifdef _WIN32
+    (void)timeout;
+    return 1;
+#else
+    fd_set fds;
+    struct timeval tv;
+    int ret;
+
+    FD_ZERO(&fds);
+    FD_SET(STDIN_FILENO, &fds);
+    tv.tv_sec = (time_t)(timeout / 1000);
+    tv.tv_usec = (suseconds_t)(timeout % 1000) * 1000;
+
+    ret = select(STDIN_FILENO + 1, &fds, NULL, NULL, (timeout == SMOTA_WAIT_FOREVER) ? NULL : &tv);
+    return (ret > 0) ? 1 : 0;
+#endif
+}
+
 /**
  * @brief  接收数据（模拟：从 stdin 读取）
+ * @note   Linux 下按 timeout 等待后只读取已到达的数据；Windows 下阻塞读取
  */
 int comm_receive(uint8_t *data, uint32_t size, uint32_t timeout)
 {
@@ -290,11 +374,27 @@ int comm_receive(uint8_t *data, uint32_t size, uint32_t timeout)
         return -1;
     }
 
-    (void)timeout; /* 模拟器忽略超时 */
+    int ret = comm_wait(timeout);
+    if (ret <= 0) {
+        return ret;
+    }
 
     /* 从标准输入读取 */
+#ifdef _WIN32
     size_t read_size = fread(data, 1, size, stdin);
+    if (read_size == 0 && feof(stdin)) {
+        g_comm_ctx.eof = 1;
+        return -1;
+    }
+    return (int)read_size;
+#else
+    ssize_t read_size = read(STDIN_FILENO, data, size);
+    if (read_size <= 0) {
+        g_comm_ctx.eof = 1;
+        return -1;
+    }
     return (int)read_size;
+#endif
 }
 
 /*---------- 系统驱动实现 ----------*/
@@ -313,6 +413,25 @@ uint64_t system_get_tick_ms(void)
 #endif
 }
 
+/**
+ * @brief  获取微秒时间戳（Flash 操作耗时统计）
+ */
+uint64_t system_get_tick_us(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)(count.QuadPart / freq.QuadPart * 1000000ULL +
+                      count.QuadPart % freq.QuadPart * 1000000ULL / freq.QuadPart);
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
+#endif
+}
+
 /**
  * @brief  系统复位（模拟器：直接退出）
  */
@@ -337,14 +456,42 @@ void *tc_port_sha256_init(void)
         return NULL;
     }
 
-    if (tc_sha256_init(&ctx->state) != TC_CRYPTO_SUCCESS) {
+    if (tc_port_sha256_init_at(ctx) < 0) {
         free(ctx);
         return NULL;
     }
 
+    ctx->heap = 1;
     return ctx;
 }
 
+/**
+ * @brief  TinyCrypt SHA256 上下文大小 (端口封装)
+ */
+uint32_t tc_port_sha256_ctx_size(void)
+{
+    return (uint32_t)sizeof(struct tc_sha256_ctx);
+}
+
+/**
+ * @brief  TinyCrypt SHA256 在调用者提供的存储中初始化 (端口封装)
+ */
+int tc_port_sha256_init_at(void *ctx)
+{
+    struct tc_sha256_ctx *sha_ctx = (struct tc_sha256_ctx *)ctx;
+
+    if (ctx == NULL) {
+        return -1;
+    }
+
+    if (tc_sha256_init(&sha_ctx->state) != TC_CRYPTO_SUCCESS) {
+        return -2;
+    }
+
+    sha_ctx->heap = 0;
+    return 0;
+}
+
 /**
  * @brief  TinyCrypt SHA256 更新 (端口封装)
  */
@@ -378,7 +525,96 @@ int tc_port_sha256_final(void *ctx, uint8_t hash[32])
         return -2;
     }
 
-    free(ctx);
+    if (sha_ctx->heap) {
+        free(ctx);
+    }
+    return 0;
+}
+
+/**
+ * @brief  TinyCrypt 多缓冲 SHA256 批量计算 (端口封装)
+ * @note   长度数组按 256 段一组转换为 size_t 后交给 tc_sha256_mb
+ */
+int tc_port_sha256_batch(const uint8_t *const *data, const uint32_t *size, uint8_t (*hash)[32], uint32_t count)
+{
+    size_t len[256];
+    uint32_t done = 0;
+
+    if (data == NULL || size == NULL || hash == NULL) {
+        return -1;
+    }
+
+    while (done < count) {
+        uint32_t num = (count - done < 256) ? (count - done) : 256;
+
+        for (uint32_t i = 0; i < num; i++) {
+            len[i] = size[done + i];
+        }
+
+        if (tc_sha256_mb(hash[done], data + done, len, num) != TC_CRYPTO_SUCCESS) {
+            return -2;
+        }
+        done += num;
+    }
+
+    return 0;
+}
+
+/*---------- TinyCrypt BLAKE2s 驱动实现 (端口封装) ----------*/
+
+/**
+ * @brief  TinyCrypt BLAKE2s 上下文大小 (端口封装)
+ */
+uint32_t tc_port_blake2s_ctx_size(void)
+{
+    return (uint32_t)sizeof(struct tc_blake2s_state_struct);
+}
+
+/**
+ * @brief  TinyCrypt BLAKE2s 在调用者提供的存储中初始化 (端口封装)
+ */
+int tc_port_blake2s_init_at(void *ctx)
+{
+    if (ctx == NULL) {
+        return -1;
+    }
+
+    if (tc_blake2s_init((TCBlake2sState_t)ctx) != TC_CRYPTO_SUCCESS) {
+        return -2;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  TinyCrypt BLAKE2s 更新 (端口封装)
+ */
+int tc_port_blake2s_update(void *ctx, const uint8_t *data, uint32_t size)
+{
+    if (ctx == NULL || data == NULL || size == 0) {
+        return -1;
+    }
+
+    if (tc_blake2s_update((TCBlake2sState_t)ctx, data, size) != TC_CRYPTO_SUCCESS) {
+        return -2;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  TinyCrypt BLAKE2s 完成 (端口封装)
+ */
+int tc_port_blake2s_final(void *ctx, uint8_t hash[32])
+{
+    if (ctx == NULL || hash == NULL) {
+        return -1;
+    }
+
+    if (tc_blake2s_final(hash, (TCBlake2sState_t)ctx) != TC_CRYPTO_SUCCESS) {
+        return -2;
+    }
+
     return 0;
 }
 
@@ -402,24 +638,57 @@ void *tc_port_aes_init(const uint8_t *key, const uint8_t *iv)
         return NULL;
     }
 
-    /* 分配密钥调度结构 */
-    ctx->sched = (TCAesKeySched_t)malloc(sizeof(struct tc_aes_key_sched_struct));
-    if (ctx->sched == NULL) {
+    if (tc_port_aes_init_at(ctx, key, iv) < 0) {
         free(ctx);
         return NULL;
     }
 
+    return ctx;
+}
+
+/**
+ * @brief  TinyCrypt AES-128-CTR 释放 (端口封装)
+ * @note   先清零密钥调度和计数器，堆上不残留密钥材料
+ */
+void tc_port_aes_deinit(void *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+
+    memset(ctx, 0, sizeof(struct tc_aes_ctx));
+    free(ctx);
+}
+
+/**
+ * @brief  TinyCrypt AES-128-CTR 上下文大小 (端口封装)
+ * @note   密钥调度与计数器在同一结构中，不再单独分配
+ */
+uint32_t tc_port_aes_ctx_size(void)
+{
+    return (uint32_t)sizeof(struct tc_aes_ctx);
+}
+
+/**
+ * @brief  TinyCrypt AES-128-CTR 在调用者提供的存储中初始化 (端口封装)
+ */
+int tc_port_aes_init_at(void *ctx, const uint8_t *key, const uint8_t *iv)
+{
+    struct tc_aes_ctx *aes_ctx = (struct tc_aes_ctx *)ctx;
+
+    if (ctx == NULL || key == NULL || iv == NULL) {
+        return -1;
+    }
+
     /* 设置加密密钥 */
-    if (tc_aes128_set_encrypt_key(ctx->sched, key) != TC_CRYPTO_SUCCESS) {
-        free(ctx->sched);
-        free(ctx);
-        return NULL;
+    if (tc_aes128_set_encrypt_key(&aes_ctx->sched, key) != TC_CRYPTO_SUCCESS) {
+        return -2;
     }
 
     /* 保存计数器 (IV) - 小端格式 */
-    memcpy(ctx->ctr, iv, 16);
+    memcpy(aes_ctx->ctr, iv, 16);
 
-    return ctx;
+    return 0;
 }
 
 /**
@@ -435,7 +704,7 @@ int tc_port_aes_crypt(void *ctx, const uint8_t *input, uint8_t *output, uint32_t
     }
 
     /* 使用 CTR 模式进行加密/解密 */
-    if (tc_ctr_mode(output, size, input, size, aes_ctx->ctr, aes_ctx->sched) != TC_CRYPTO_SUCCESS) {
+    if (tc_ctr_mode(output, size, input, size, aes_ctx->ctr, &aes_ctx->sched) != TC_CRYPTO_SUCCESS) {
         return -2;
     }
 
@@ -475,70 +744,249 @@ int tc_port_ecdsa_verify(const uint8_t *hash,
     return 0;
 }
 
-/*---------- KDF 密钥派生函数实现 ----------*/
+/**
+ * @brief  TinyCrypt ECDSA-P256 用固化公钥签名验证 (端口封装)
+ * @note   公钥的验签预计算表来自 keys/ecdsa_public_key.c（keygen.py 生成），
+ *         uECC_verify_with_table() 省去公钥转换、倍点计算和模逆
+ */
+int tc_port_ecdsa_verify_fixed(const uint8_t *hash, const uint8_t *sig_r, const uint8_t *sig_s)
+{
+    uint8_t signature[64];
+
+    if (hash == NULL || sig_r == NULL || sig_s == NULL) {
+        return -1;
+    }
+
+    memcpy(signature, sig_r, 32);
+    memcpy(signature + 32, sig_s, 32);
+
+    if (uECC_verify_with_table(smota_ecdsa_pub_table, hash, 32, signature, uECC_secp256r1()) != TC_CRYPTO_SUCCESS) {
+        return -2;
+    }
+
+    return 0;
+}
+
+/*---------- 数据块认证实现 ----------*/
 
 /**
- * @brief  基于 HMAC-SHA256 的密钥派生函数
- * @details 算法: HMAC-SHA256(master_key, uid || context)
- * @param  master_key: 主密钥 (32字节)
- * @param  uid: 设备唯一标识
- * @param  uid_len: UID 长度
- * @param  context: 上下文字符串 (如 "smOTA_Enc_v1")
- * @param  output: 输出的派生密钥 (32字节)
+ * @brief  数据块认证的 AES 轮密钥
+ */
+static struct tc_aes_key_sched_struct g_block_mac_sched;
+
+/**
+ * @brief  已完成子密钥计算的 CMAC 状态（每次计算复制一份）
+ */
+static struct tc_cmac_struct g_block_mac_state;
+
+/**
+ * @brief  数据块认证密钥是否已设置
+ */
+static bool g_block_mac_ready = false;
+
+/**
+ * @brief  设置数据块认证密钥
+ * @param  key: AES-128 密钥（16字节），与上位机一致
  * @return 0=成功, <0=失败
+ * @note   轮密钥和 CMAC 子密钥只在此计算一次
  */
-int smota_kdf_derive(const uint8_t *master_key,
-                     const uint8_t *uid, uint32_t uid_len,
-                     const char *context,
-                     uint8_t output[32])
+int tc_port_block_mac_set_key(const uint8_t key[16])
 {
-    struct tc_hmac_state_struct hmac_state;
-    uint8_t key_material[64];
-    uint8_t context_len;
-    int ret;
+    if (key == NULL) {
+        return -1;
+    }
+
+    if (tc_cmac_setup(&g_block_mac_state, key, &g_block_mac_sched) != TC_CRYPTO_SUCCESS) {
+        g_block_mac_ready = false;
+        return -2;
+    }
+
+    g_block_mac_ready = true;
+    return 0;
+}
+
+/**
+ * @brief  计算数据块认证标签
+ * @details 算法: AES-128-CMAC(key, offset(LE32) || length(LE16) || data)
+ * @param  offset: 数据块在固件中的偏移
+ * @param  data: 数据块
+ * @param  size: 数据长度
+ * @param  tag: 输出标签（16字节）
+ * @return 0=成功, <0=失败
+ */
+int tc_port_block_mac(uint32_t offset, const uint8_t *data, uint16_t size, uint8_t tag[16])
+{
+    struct tc_cmac_struct state;
+    uint8_t header[6];
+
+    if (!g_block_mac_ready || tag == NULL || (data == NULL && size > 0)) {
+        return -1;
+    }
+
+    header[0] = (uint8_t)(offset);
+    header[1] = (uint8_t)(offset >> 8);
+    header[2] = (uint8_t)(offset >> 16);
+    header[3] = (uint8_t)(offset >> 24);
+    header[4] = (uint8_t)(size);
+    header[5] = (uint8_t)(size >> 8);
+
+    state = g_block_mac_state;
+    (void)tc_cmac_init(&state);
+    (void)tc_cmac_update(&state, header, sizeof(header));
+    if (size > 0) {
+        (void)tc_cmac_update(&state, data, size);
+    }
+
+    /* tc_cmac_final 同时清除本次计算的状态 */
+    return (tc_cmac_final(tag, &state) == TC_CRYPTO_SUCCESS) ? 0 : -2;
+}
+
+/*---------- 数据块 AEAD 实现 ----------*/
 
-    if (master_key == NULL || output == NULL) {
+/**
+ * @brief  数据块 AEAD 密钥（ChaCha20 无密钥扩展，直接保存）
+ */
+static uint8_t g_aead_key[TC_CHACHA20_KEY_SIZE];
+
+/**
+ * @brief  数据块 AEAD 密钥是否已设置
+ */
+static bool g_aead_ready = false;
+
+/**
+ * @brief  设置数据块 AEAD 密钥
+ * @param  key: ChaCha20 密钥（32字节）
+ * @return 0=成功, <0=失败
+ */
+int tc_port_aead_set_key(const uint8_t key[32])
+{
+    if (key == NULL) {
         return -1;
     }
 
-    /* 计算上下文字符串长度 */
-    context_len = (context != NULL) ? (uint8_t)strlen(context) : 0;
+    memcpy(g_aead_key, key, sizeof(g_aead_key));
+    g_aead_ready = true;
+    return 0;
+}
 
-    /* 组合输入数据: uid || context */
-    if (uid_len > 0 && uid != NULL) {
-        memcpy(key_material, uid, uid_len);
+/**
+ * @brief  认证并解密数据块
+ * @details 算法: ChaCha20-Poly1305（RFC 8439），标签不符时 TinyCrypt 清零输出
+ */
+int tc_port_aead_decrypt(const uint8_t nonce[12], const uint8_t *aad, uint32_t aad_len, const uint8_t *input,
+                         uint8_t *output, uint32_t size, const uint8_t tag[16])
+{
+    if (!g_aead_ready || nonce == NULL || output == NULL || tag == NULL) {
+        return -1;
     }
-    if (context_len > 0 && context != NULL) {
-        memcpy(key_material + uid_len, context, context_len);
+
+    if (tc_chacha20_poly1305_decrypt(output, input, size, aad, aad_len, tag, nonce, g_aead_key) !=
+        TC_CRYPTO_SUCCESS) {
+        return -2;
     }
 
-    /* 设置 HMAC 密钥 */
-    ret = tc_hmac_set_key(&hmac_state, master_key, 32);
-    if (ret != TC_CRYPTO_SUCCESS) {
+    return 0;
+}
+
+/*---------- KDF 密钥派生函数实现 ----------*/
+
+/**
+ * @brief  准备 KDF 主密钥（缓存 HMAC 的 ipad/opad 中间状态）
+ * @param  kdf_key: 输出的主密钥对象
+ * @param  master_key: 主密钥 (32字节)
+ * @return 0=成功, <0=失败
+ */
+int smota_kdf_key_init(struct tc_hmac_key_struct *kdf_key, const uint8_t *master_key)
+{
+    if (kdf_key == NULL || master_key == NULL) {
+        return -1;
+    }
+
+    if (tc_hmac_key_setup(kdf_key, master_key, 32) != TC_CRYPTO_SUCCESS) {
         return -2;
     }
 
-    /* 初始化 HMAC */
-    ret = tc_hmac_init(&hmac_state);
-    if (ret != TC_CRYPTO_SUCCESS) {
+    return 0;
+}
+
+/**
+ * @brief  用已准备的主密钥派生设备密钥
+ * @details 算法: HMAC-SHA256(master_key, uid || context)，uid 和 context 直接送入
+ *          哈希，不经过中间缓冲区，长度不受限制
+ * @param  kdf_key: smota_kdf_key_init() 准备的主密钥对象
+ * @param  uid: 设备唯一标识
+ * @param  uid_len: UID 长度
+ * @param  context: 上下文字符串 (如 "smOTA_Enc_v1")
+ * @param  output: 输出的派生密钥 (32字节)
+ * @return 0=成功, <0=失败
+ */
+int smota_kdf_derive_with_key(const struct tc_hmac_key_struct *kdf_key,
+                              const uint8_t *uid, uint32_t uid_len,
+                              const char *context,
+                              uint8_t output[32])
+{
+    struct tc_sha256_state_struct state;
+    size_t context_len;
+
+    if (kdf_key == NULL || output == NULL || (uid == NULL && uid_len > 0)) {
+        return -1;
+    }
+
+    context_len = (context != NULL) ? strlen(context) : 0;
+
+    if (tc_hmac_key_start(&state, kdf_key) != TC_CRYPTO_SUCCESS) {
         return -3;
     }
 
-    /* 更新 HMAC (输入数据) */
-    ret = tc_hmac_update(&hmac_state, key_material, uid_len + context_len);
-    if (ret != TC_CRYPTO_SUCCESS) {
+    /* 输入数据: uid || context */
+    if (uid_len > 0 && tc_sha256_update(&state, uid, uid_len) != TC_CRYPTO_SUCCESS) {
+        return -4;
+    }
+    if (context_len > 0 && tc_sha256_update(&state, (const uint8_t *)context, context_len) != TC_CRYPTO_SUCCESS) {
         return -4;
     }
 
     /* 完成 HMAC，输出 32 字节密钥 */
-    ret = tc_hmac_final(output, 32, &hmac_state);
-    if (ret != TC_CRYPTO_SUCCESS) {
+    if (tc_hmac_key_finish(output, 32, &state, kdf_key) != TC_CRYPTO_SUCCESS) {
         return -5;
     }
 
     return 0;
 }
 
+/**
+ * @brief  基于 HMAC-SHA256 的密钥派生函数
+ * @details 算法: HMAC-SHA256(master_key, uid || context)
+ * @param  master_key: 主密钥 (32字节)
+ * @param  uid: 设备唯一标识
+ * @param  uid_len: UID 长度
+ * @param  context: 上下文字符串 (如 "smOTA_Enc_v1")
+ * @param  output: 输出的派生密钥 (32字节)
+ * @return 0=成功, <0=失败
+ * @note   同一主密钥派生多次时，先调用 smota_kdf_key_init() 再用
+ *         smota_kdf_derive_with_key()，每次可省去两次 SHA-256 压缩
+ */
+int smota_kdf_derive(const uint8_t *master_key,
+                     const uint8_t *uid, uint32_t uid_len,
+                     const char *context,
+                     uint8_t output[32])
+{
+    struct tc_hmac_key_struct kdf_key;
+    int ret;
+
+    ret = smota_kdf_key_init(&kdf_key, master_key);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = smota_kdf_derive_with_key(&kdf_key, uid, uid_len, context, output);
+
+    /* 销毁主密钥中间状态 */
+    _set(&kdf_key, 0, sizeof(kdf_key));
+
+    return ret;
+}
+
 /*---------- TinyCrypt Windows CSPRNG 实现 ----------*/
 
 #ifdef _WIN32
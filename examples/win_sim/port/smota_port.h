@@ -17,10 +17,16 @@ extern "C" {
 
 /*---------- includes ----------*/
 #include <stdint.h>
+#include <tinycrypt/hmac.h>
 
 /*---------- macro ----------*/
 /*---------- type define ----------*/
 /*---------- variable prototype ----------*/
+
+/* 签名公钥及其验签预计算表（keys/ecdsa_public_key.c，keygen.py 生成） */
+extern const uint8_t smota_ecdsa_pub_key[64];
+extern const unsigned int smota_ecdsa_pub_table[16 * 16];
+
 /*---------- function prototype ----------*/
 
 /*---------- Flash 驱动函数 ----------*/
@@ -33,16 +39,51 @@ int flash_erase(uint32_t addr, uint32_t size);
 int flash_lock(void);
 int flash_unlock(void);
 
+/*---------- QSPI NOR 模拟器件 ----------*/
+
+/**
+ * @brief  QSPI 模拟器件时序统计
+ */
+struct qspi_sim_stats {
+    uint64_t elapsed_ns;        /* 虚拟时钟（总线传输 + 等待） */
+    uint64_t busy_ns;           /* 器件内部操作累计时间 */
+    uint32_t page_programs;     /* 页编程次数 */
+    uint32_t partial_programs;  /* 不满一页的编程次数 */
+    uint32_t sector_erases;     /* 4KB 扇区擦除次数 */
+    uint32_t block_erases;      /* 64KB 块擦除次数 */
+    uint32_t status_polls;      /* 忙等待状态轮询次数 */
+    uint64_t program_bytes;     /* 编程字节数 */
+    uint64_t read_bytes;        /* 读取字节数 */
+};
+
+int qspi_sim_init(uint32_t size);
+void qspi_sim_deinit(void);
+int qspi_sim_transfer(const uint8_t *cmd, uint32_t cmd_len, const uint8_t *tx, uint8_t *rx, uint32_t len);
+void qspi_sim_reset_stats(void);
+void qspi_sim_get_stats(struct qspi_sim_stats *stats);
+
+/*---------- RTOS 接口模拟（主机线程） ----------*/
+
+void *os_sim_sem_create(void);
+void os_sim_sem_delete(void *sem);
+int os_sim_sem_wait(void *sem, uint32_t timeout_ms);
+void os_sim_sem_post(void *sem);
+void *os_sim_task_create(void (*entry)(void *arg), void *arg, const char *name, uint32_t stack_size,
+                         uint32_t priority);
+void os_sim_task_join(void *task);
+
 /*---------- 通信驱动函数 ----------*/
 
 int comm_init(void);
 int comm_deinit(void);
 int comm_send(const uint8_t *data, uint32_t size);
 int comm_receive(uint8_t *data, uint32_t size, uint32_t timeout);
+int comm_wait(uint32_t timeout);
 
 /*---------- 系统驱动函数 ----------*/
 
 uint64_t system_get_tick_ms(void);
+uint64_t system_get_tick_us(void);
 void system_reset(void);
 
 /*---------- TinyCrypt 加密驱动端口函数 ----------*/
@@ -53,6 +94,20 @@ void system_reset(void);
  */
 void *tc_port_sha256_init(void);
 
+/**
+ * @brief  TinyCrypt SHA256 上下文大小 (端口封装)
+ * @return 字节数
+ */
+uint32_t tc_port_sha256_ctx_size(void);
+
+/**
+ * @brief  TinyCrypt SHA256 在调用者提供的存储中初始化 (端口封装)
+ * @param  ctx: 存储（tc_port_sha256_ctx_size() 字节）
+ * @return 0=成功, <0=失败
+ * @note   tc_port_sha256_final 不释放此存储
+ */
+int tc_port_sha256_init_at(void *ctx);
+
 /**
  * @brief  TinyCrypt SHA256 更新 (端口封装)
  * @param  ctx: 上下文指针
@@ -70,6 +125,46 @@ int tc_port_sha256_update(void *ctx, const uint8_t *data, uint32_t size);
  */
 int tc_port_sha256_final(void *ctx, uint8_t hash[32]);
 
+/**
+ * @brief  TinyCrypt 多缓冲 SHA256 批量计算 (端口封装)
+ * @param  data: 数据指针数组
+ * @param  size: 数据长度数组
+ * @param  hash: 输出哈希值数组
+ * @param  count: 数据段数量
+ * @return 0=成功, <0=失败
+ */
+int tc_port_sha256_batch(const uint8_t *const *data, const uint32_t *size, uint8_t (*hash)[32], uint32_t count);
+
+/**
+ * @brief  TinyCrypt BLAKE2s 上下文大小 (端口封装)
+ * @return 字节数
+ */
+uint32_t tc_port_blake2s_ctx_size(void);
+
+/**
+ * @brief  TinyCrypt BLAKE2s 在调用者提供的存储中初始化 (端口封装)
+ * @param  ctx: 存储（tc_port_blake2s_ctx_size() 字节）
+ * @return 0=成功, <0=失败
+ */
+int tc_port_blake2s_init_at(void *ctx);
+
+/**
+ * @brief  TinyCrypt BLAKE2s 更新 (端口封装)
+ * @param  ctx: 上下文指针
+ * @param  data: 待计算数据
+ * @param  size: 数据长度
+ * @return 0=成功, <0=失败
+ */
+int tc_port_blake2s_update(void *ctx, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief  TinyCrypt BLAKE2s 完成 (端口封装)
+ * @param  ctx: 上下文指针
+ * @param  hash: 输出哈希值（32字节）
+ * @return 0=成功, <0=失败
+ */
+int tc_port_blake2s_final(void *ctx, uint8_t hash[32]);
+
 /**
  * @brief  TinyCrypt AES-128-CTR 初始化 (端口封装)
  * @param  key: 密钥（16字节）
@@ -78,6 +173,27 @@ int tc_port_sha256_final(void *ctx, uint8_t hash[32]);
  */
 void *tc_port_aes_init(const uint8_t *key, const uint8_t *iv);
 
+/**
+ * @brief  TinyCrypt AES-128-CTR 清零并释放 tc_port_aes_init 分配的上下文 (端口封装)
+ * @param  ctx: 上下文指针
+ */
+void tc_port_aes_deinit(void *ctx);
+
+/**
+ * @brief  TinyCrypt AES-128-CTR 上下文大小 (端口封装)
+ * @return 字节数（含密钥调度）
+ */
+uint32_t tc_port_aes_ctx_size(void);
+
+/**
+ * @brief  TinyCrypt AES-128-CTR 在调用者提供的存储中初始化 (端口封装)
+ * @param  ctx: 存储（tc_port_aes_ctx_size() 字节）
+ * @param  key: 密钥（16字节）
+ * @param  iv: 初始化向量（16字节）
+ * @return 0=成功, <0=失败
+ */
+int tc_port_aes_init_at(void *ctx, const uint8_t *key, const uint8_t *iv);
+
 /**
  * @brief  TinyCrypt AES-128-CTR 加密/解密 (端口封装)
  * @param  ctx: 上下文指针
@@ -101,8 +217,85 @@ int tc_port_ecdsa_verify(const uint8_t *hash,
                          const uint8_t *sig_s,
                          const uint8_t *pub_key);
 
+/**
+ * @brief  TinyCrypt ECDSA-P256 用固化公钥签名验证 (端口封装)
+ * @param  hash: 消息哈希（32字节）
+ * @param  sig_r: 签名 r 分量（32字节）
+ * @param  sig_s: 签名 s 分量（32字节）
+ * @return 0=验证成功, <0=验证失败
+ * @note   使用 keys/ecdsa_public_key.c 中的验签预计算表（uECC_verify_with_table）
+ */
+int tc_port_ecdsa_verify_fixed(const uint8_t *hash, const uint8_t *sig_r, const uint8_t *sig_s);
+
+/*---------- 数据块认证 (AES-128-CMAC) ----------*/
+
+/**
+ * @brief  设置数据块认证密钥
+ * @param  key: AES-128 密钥（16字节），与上位机一致
+ * @return 0=成功, <0=失败
+ */
+int tc_port_block_mac_set_key(const uint8_t key[16]);
+
+/**
+ * @brief  计算数据块认证标签（HAL crypto->block_mac）
+ * @details 算法: AES-128-CMAC(key, offset(LE32) || length(LE16) || data)
+ * @param  offset: 数据块在固件中的偏移
+ * @param  data: 数据块
+ * @param  size: 数据长度
+ * @param  tag: 输出标签（16字节）
+ * @return 0=成功, <0=失败
+ */
+int tc_port_block_mac(uint32_t offset, const uint8_t *data, uint16_t size, uint8_t tag[16]);
+
+/*---------- 数据块 AEAD 加密 (ChaCha20-Poly1305) ----------*/
+
+/**
+ * @brief  设置数据块 AEAD 密钥
+ * @param  key: ChaCha20 密钥（32字节），由 smota_kdf_derive() 按设备 UID 派生
+ * @return 0=成功, <0=失败
+ */
+int tc_port_aead_set_key(const uint8_t key[32]);
+
+/**
+ * @brief  认证并解密数据块（HAL crypto->aead_decrypt）
+ * @details 算法: ChaCha20-Poly1305（RFC 8439），一次遍历完成认证和解密
+ * @param  nonce: 随机数（12字节）
+ * @param  aad: 附加认证数据
+ * @param  aad_len: 附加认证数据长度
+ * @param  input: 密文
+ * @param  output: 明文输出
+ * @param  size: 数据长度
+ * @param  tag: 收到的标签（16字节）
+ * @return 0=成功, <0=未设置密钥或标签不符
+ */
+int tc_port_aead_decrypt(const uint8_t nonce[12], const uint8_t *aad, uint32_t aad_len, const uint8_t *input,
+                         uint8_t *output, uint32_t size, const uint8_t tag[16]);
+
 /*---------- KDF 密钥派生函数 ----------*/
 
+/**
+ * @brief  准备 KDF 主密钥（缓存 HMAC 的 ipad/opad 中间状态）
+ * @param  kdf_key: 输出的主密钥对象，使用完毕后应清零
+ * @param  master_key: 主密钥 (32字节)
+ * @return 0=成功, <0=失败
+ */
+int smota_kdf_key_init(struct tc_hmac_key_struct *kdf_key, const uint8_t *master_key);
+
+/**
+ * @brief  用已准备的主密钥派生设备密钥
+ * @details 算法: HMAC-SHA256(master_key, uid || context)，比 smota_kdf_derive() 少两次 SHA-256 压缩
+ * @param  kdf_key: smota_kdf_key_init() 准备的主密钥对象
+ * @param  uid: 设备唯一标识
+ * @param  uid_len: UID 长度
+ * @param  context: 上下文字符串 (如 "smOTA_Enc_v1")
+ * @param  output: 输出的派生密钥 (32字节)
+ * @return 0=成功, <0=失败
+ */
+int smota_kdf_derive_with_key(const struct tc_hmac_key_struct *kdf_key,
+                              const uint8_t *uid, uint32_t uid_len,
+                              const char *context,
+                              uint8_t output[32]);
+
 /**
  * @brief  基于 HMAC-SHA256 的密钥派生函数
  * @details 算法: HMAC-SHA256(master_key, uid || context)
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_port_os.c
+ * @Author       : lxf
+ * @Date         : 2026-10-19 09:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-19 09:00:00
+ * @Brief        : smOTA 模拟平台 RTOS 接口（smota_task 参考集成）
+ * @details      用主机线程实现 struct smota_os_driver，使 OTA 任务集成可以在 win_sim 中运行和测量：
+ *              - Linux：POSIX 线程，二值信号量由互斥锁 + 条件变量实现
+ *              - Windows：自动复位事件 + CreateThread
+ *              主机线程没有 RTOS 优先级语义，priority 参数忽略；栈大小按字节传给线程属性。
+ */
+
+/*---------- includes ----------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <limits.h>
+#include <time.h>
+#include <errno.h>
+#endif
+
+#include "smota_config.h"
+#include "smota_port.h"
+
+/*---------- macro ----------*/
+
+/*---------- type define ----------*/
+
+/**
+ * @brief  模拟任务
+ */
+struct os_sim_task {
+#ifdef _WIN32
+    HANDLE thread;             /* 线程句柄 */
+#else
+    pthread_t thread;          /* 线程 */
+#endif
+    void (*entry)(void *arg);  /* 任务函数 */
+    void *arg;                 /* 任务参数 */
+};
+
+#ifndef _WIN32
+/**
+ * @brief  模拟二值信号量
+ */
+struct os_sim_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int count;                 /* 0 或 1 */
+};
+#endif
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+
+/*---------- function ----------*/
+
+#ifdef _WIN32
+
+void *os_sim_sem_create(void)
+{
+    return CreateEvent(NULL, FALSE, FALSE, NULL);
+}
+
+void os_sim_sem_delete(void *sem)
+{
+    CloseHandle((HANDLE)sem);
+}
+
+int os_sim_sem_wait(void *sem, uint32_t timeout_ms)
+{
+    /* SMOTA_WAIT_FOREVER 与 INFINITE 取值相同 */
+    return (WaitForSingleObject((HANDLE)sem, timeout_ms) == WAIT_OBJECT_0) ? 0 : -1;
+}
+
+void os_sim_sem_post(void *sem)
+{
+    SetEvent((HANDLE)sem);
+}
+
+/**
+ * @brief  线程入口适配
+ */
+static DWORD WINAPI os_sim_thread(LPVOID param)
+{
+    struct os_sim_task *task = (struct os_sim_task *)param;
+
+    task->entry(task->arg);
+    return 0;
+}
+
+void *os_sim_task_create(void (*entry)(void *arg), void *arg, const char *name, uint32_t stack_size,
+                         uint32_t priority)
+{
+    struct os_sim_task *task = (struct os_sim_task *)calloc(1, sizeof(*task));
+
+    (void)name;
+    (void)priority;
+
+    if (task == NULL) {
+        return NULL;
+    }
+
+    task->entry = entry;
+    task->arg = arg;
+    task->thread = CreateThread(NULL, stack_size, os_sim_thread, task, 0, NULL);
+    if (task->thread == NULL) {
+        free(task);
+        return NULL;
+    }
+
+    return task;
+}
+
+void os_sim_task_join(void *handle)
+{
+    struct os_sim_task *task = (struct os_sim_task *)handle;
+
+    WaitForSingleObject(task->thread, INFINITE);
+    CloseHandle(task->thread);
+    free(task);
+}
+
+#else
+
+void *os_sim_sem_create(void)
+{
+    struct os_sim_sem *sem = (struct os_sim_sem *)calloc(1, sizeof(*sem));
+
+    if (sem == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    return sem;
+}
+
+void os_sim_sem_delete(void *handle)
+{
+    struct os_sim_sem *sem = (struct os_sim_sem *)handle;
+
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+}
+
+int os_sim_sem_wait(void *handle, uint32_t timeout_ms)
+{
+    struct os_sim_sem *sem = (struct os_sim_sem *)handle;
+    struct timespec ts;
+    int ret = 0;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0 && ret != ETIMEDOUT) {
+        if (timeout_ms == SMOTA_WAIT_FOREVER) {
+            ret = pthread_cond_wait(&sem->cond, &sem->lock);
+        } else {
+            ret = pthread_cond_timedwait(&sem->cond, &sem->lock, &ts);
+        }
+    }
+    if (sem->count > 0) {
+        sem->count = 0;
+        ret = 0;
+    }
+    pthread_mutex_unlock(&sem->lock);
+
+    return (ret == 0) ? 0 : -1;
+}
+
+void os_sim_sem_post(void *handle)
+{
+    struct os_sim_sem *sem = (struct os_sim_sem *)handle;
+
+    pthread_mutex_lock(&sem->lock);
+    sem->count = 1;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+}
+
+/**
+ * @brief  线程入口适配
+ */
+static void *os_sim_thread(void *param)
+{
+    struct os_sim_task *task = (struct os_sim_task *)param;
+
+    task->entry(task->arg);
+    return NULL;
+}
+
+void *os_sim_task_create(void (*entry)(void *arg), void *arg, const char *name, uint32_t stack_size,
+                         uint32_t priority)
+{
+    struct os_sim_task *task = (struct os_sim_task *)calloc(1, sizeof(*task));
+    pthread_attr_t attr;
+    int ret;
+
+    (void)name;
+    (void)priority;
+
+    if (task == NULL) {
+        return NULL;
+    }
+
+    task->entry = entry;
+    task->arg = arg;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, (stack_size < PTHREAD_STACK_MIN) ? PTHREAD_STACK_MIN : stack_size);
+    ret = pthread_create(&task->thread, &attr, os_sim_thread, task);
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0) {
+        free(task);
+        return NULL;
+    }
+
+    return task;
+}
+
+void os_sim_task_join(void *handle)
+{
+    struct os_sim_task *task = (struct os_sim_task *)handle;
+
+    pthread_join(task->thread, NULL);
+    free(task);
+}
+
+#endif
+
+/*---------- end of file ----------*/
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_port_qspi.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 14:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 14:00:00
+ * @Brief        : smOTA 模拟平台 QSPI NOR Flash 器件
+ * @details      在内存中模拟一颗 QSPI NOR Flash（JEDEC 命令集），供 smota_nor_flash 参考驱动使用。
+ *              带时序模型：总线传输按 QSPI 时钟和线宽计时，页编程/扇区擦除/块擦除
+ *              期间状态寄存器 WIP 置位，所有时间累计到虚拟时钟，用于评估下载区写入吞吐量。
+ *              时序参数取自常见 W25Q 系列数据手册的典型值。
+ */
+
+/*---------- includes ----------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "smota_config.h"
+#include "smota_port.h"
+
+/*---------- macro ----------*/
+
+/* 模拟器件 JEDEC ID（Winbond W25Q64JV） */
+#define QSPI_SIM_JEDEC_ID      { 0xEF, 0x40, 0x17 }
+
+/* QSPI 时钟 80MHz：命令/地址单线传输，数据四线传输 */
+#define QSPI_SIM_CLK_NS        12.5
+#define QSPI_SIM_CMD_NS        (QSPI_SIM_CLK_NS * 8) /* 单线每字节 8 个时钟 */
+#define QSPI_SIM_DATA_NS       (QSPI_SIM_CLK_NS * 2) /* 四线每字节 2 个时钟 */
+
+/* 典型操作时间 */
+#define QSPI_SIM_PAGE_PROG_NS  400000ULL   /* 页编程 0.4ms */
+#define QSPI_SIM_SECTOR_ERS_NS 45000000ULL  /* 4KB 扇区擦除 45ms */
+#define QSPI_SIM_BLOCK_ERS_NS  150000000ULL /* 64KB 块擦除 150ms */
+
+/* 忙等待期间两次状态轮询之间的间隔（含 MCU 开销） */
+#define QSPI_SIM_POLL_NS       10000ULL
+
+/*---------- type define ----------*/
+
+/**
+ * @brief  QSPI 模拟器件上下文
+ */
+struct qspi_sim_ctx {
+    uint8_t *buffer;         /* 存储阵列 */
+    uint32_t size;           /* 容量 */
+    int write_enabled;       /* 写使能锁存 (WEL) */
+    uint64_t now_ns;         /* 虚拟时钟 */
+    uint64_t busy_until_ns;  /* 内部操作完成时间 */
+    struct qspi_sim_stats stats;
+};
+
+/*---------- variable prototype ----------*/
+
+static struct qspi_sim_ctx g_qspi_ctx = {0};
+
+/*---------- function prototype ----------*/
+
+/*---------- function ----------*/
+
+/**
+ * @brief  从命令阶段解析 24 位地址
+ */
+static uint32_t qspi_sim_addr(const uint8_t *cmd, uint32_t cmd_len)
+{
+    if (cmd_len < 4) {
+        return 0;
+    }
+    return ((uint32_t)cmd[1] << 16) | ((uint32_t)cmd[2] << 8) | cmd[3];
+}
+
+/**
+ * @brief  器件是否正在执行内部操作
+ */
+static int qspi_sim_busy(void)
+{
+    return g_qspi_ctx.now_ns < g_qspi_ctx.busy_until_ns;
+}
+
+/**
+ * @brief  开始一次内部操作（编程/擦除）
+ */
+static void qspi_sim_start_op(uint64_t duration_ns)
+{
+    g_qspi_ctx.busy_until_ns = g_qspi_ctx.now_ns + duration_ns;
+    g_qspi_ctx.stats.busy_ns += duration_ns;
+    g_qspi_ctx.write_enabled = 0;
+}
+
+/**
+ * @brief  初始化模拟器件
+ * @param  size: 容量（字节）
+ * @return 0=成功, <0=失败
+ */
+int qspi_sim_init(uint32_t size)
+{
+    if (g_qspi_ctx.buffer != NULL) {
+        return 0;
+    }
+
+    g_qspi_ctx.buffer = (uint8_t *)malloc(size);
+    if (g_qspi_ctx.buffer == NULL) {
+        return -1;
+    }
+
+    /* 出厂擦除状态 */
+    memset(g_qspi_ctx.buffer, 0xFF, size);
+    g_qspi_ctx.size = size;
+    g_qspi_ctx.write_enabled = 0;
+    qspi_sim_reset_stats();
+
+    SMOTA_DEBUG_PRINTF("QSPI NOR simulated: %u KB\r\n", (unsigned int)(size / 1024));
+    return 0;
+}
+
+/**
+ * @brief  释放模拟器件
+ */
+void qspi_sim_deinit(void)
+{
+    free(g_qspi_ctx.buffer);
+    g_qspi_ctx.buffer = NULL;
+    g_qspi_ctx.size = 0;
+}
+
+/**
+ * @brief  清零虚拟时钟和统计
+ */
+void qspi_sim_reset_stats(void)
+{
+    g_qspi_ctx.now_ns = 0;
+    g_qspi_ctx.busy_until_ns = 0;
+    memset(&g_qspi_ctx.stats, 0, sizeof(g_qspi_ctx.stats));
+}
+
+/**
+ * @brief  获取时序统计
+ */
+void qspi_sim_get_stats(struct qspi_sim_stats *stats)
+{
+    if (stats != NULL) {
+        *stats = g_qspi_ctx.stats;
+        stats->elapsed_ns = g_qspi_ctx.now_ns;
+    }
+}
+
+/**
+ * @brief  执行一次 SPI 事务（struct smota_nor_bus::transfer）
+ */
+int qspi_sim_transfer(const uint8_t *cmd, uint32_t cmd_len, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    uint32_t addr;
+
+    if (g_qspi_ctx.buffer == NULL || cmd == NULL || cmd_len == 0) {
+        return -1;
+    }
+
+    /* 总线传输时间 */
+    g_qspi_ctx.now_ns += (uint64_t)(cmd_len * QSPI_SIM_CMD_NS + len * QSPI_SIM_DATA_NS);
+
+    /* 忙时只响应读状态命令 */
+    if (qspi_sim_busy() && cmd[0] != 0x05) {
+        return 0;
+    }
+
+    switch (cmd[0]) {
+    case 0x9F: /* 读 JEDEC ID */
+    {
+        const uint8_t id[3] = QSPI_SIM_JEDEC_ID;
+        for (uint32_t i = 0; rx != NULL && i < len; i++) {
+            rx[i] = (i < sizeof(id)) ? id[i] : 0xFF;
+        }
+        break;
+    }
+
+    case 0xAB: /* 唤醒 */
+        break;
+
+    case 0x05: /* 读状态寄存器 */
+        if (qspi_sim_busy()) {
+            g_qspi_ctx.now_ns += QSPI_SIM_POLL_NS;
+            g_qspi_ctx.stats.status_polls++;
+        }
+        if (rx != NULL && len > 0) {
+            rx[0] = (uint8_t)((qspi_sim_busy() ? 0x01 : 0x00) | (g_qspi_ctx.write_enabled ? 0x02 : 0x00));
+        }
+        break;
+
+    case 0x06: /* 写使能 */
+        g_qspi_ctx.write_enabled = 1;
+        break;
+
+    case 0x04: /* 写禁止 */
+        g_qspi_ctx.write_enabled = 0;
+        break;
+
+    case 0x03: /* 读 */
+    case 0x0B: /* 快速读 */
+        addr = qspi_sim_addr(cmd, cmd_len);
+        if (rx == NULL || addr >= g_qspi_ctx.size || len > g_qspi_ctx.size - addr) {
+            return -2;
+        }
+        memcpy(rx, g_qspi_ctx.buffer + addr, len);
+        g_qspi_ctx.stats.read_bytes += len;
+        break;
+
+    case 0x02: /* 页编程：只能将 1 写为 0，超出页尾回卷 */
+        addr = qspi_sim_addr(cmd, cmd_len);
+        if (!g_qspi_ctx.write_enabled || tx == NULL || addr >= g_qspi_ctx.size) {
+            break;
+        }
+        for (uint32_t i = 0; i < len; i++) {
+            uint32_t page = addr - (addr % SMOTA_NOR_PAGE_SIZE);
+            uint32_t pos = page + ((addr + i) % SMOTA_NOR_PAGE_SIZE);
+            g_qspi_ctx.buffer[pos] &= tx[i];
+        }
+        g_qspi_ctx.stats.page_programs++;
+        if (len < SMOTA_NOR_PAGE_SIZE) {
+            g_qspi_ctx.stats.partial_programs++;
+        }
+        g_qspi_ctx.stats.program_bytes += len;
+        qspi_sim_start_op(QSPI_SIM_PAGE_PROG_NS);
+        break;
+
+    case 0x20: /* 4KB 扇区擦除 */
+    case 0xD8: /* 64KB 块擦除 */
+    {
+        uint32_t unit = (cmd[0] == 0x20) ? SMOTA_NOR_SECTOR_SIZE : SMOTA_NOR_BLOCK_SIZE;
+
+        addr = qspi_sim_addr(cmd, cmd_len);
+        if (!g_qspi_ctx.write_enabled || addr >= g_qspi_ctx.size) {
+            break;
+        }
+        addr -= addr % unit;
+        memset(g_qspi_ctx.buffer + addr, 0xFF, unit);
+        if (cmd[0] == 0x20) {
+            g_qspi_ctx.stats.sector_erases++;
+            qspi_sim_start_op(QSPI_SIM_SECTOR_ERS_NS);
+        } else {
+            g_qspi_ctx.stats.block_erases++;
+            qspi_sim_start_op(QSPI_SIM_BLOCK_ERS_NS);
+        }
+        break;
+    }
+
+    default:
+        /* 未实现的命令（含 4 字节地址命令，模拟器件容量不超过 16MB） */
+        return -3;
+    }
+
+    return 0;
+}
+
+/*---------- end of file ----------*/
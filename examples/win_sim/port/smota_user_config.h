@@ -30,7 +30,9 @@ extern "C" {
  * @brief 升级模式
  * @note   STM32G0B1 支持双 Bank 硬件交换，推荐使用模式 0
  */
+#ifndef SMOTA_MODE
 #define SMOTA_MODE 0  // 双 Bank 硬件交换模式
+#endif
 
 /*==============================================================================
  * 2. 可靠性配置
@@ -46,7 +48,21 @@ extern "C" {
  * @brief 过程可靠性（AES 加密传输）
  * @note   根据安全需求选择
  */
+#ifndef SMOTA_RELIABILITY_TRANSMISSION
 #define SMOTA_RELIABILITY_TRANSMISSION 0
+#endif
+
+/**
+ * @brief 数据块认证（AES-128-CMAC 标签，写入前校验）
+ * @note   开启后上位机须在每个数据块后附带标签（tc_port_block_mac）
+ */
+#define SMOTA_BLOCK_AUTH 0
+
+/**
+ * @brief 分片清单（Merkle 根随 HEADER_INFO 下发，分片收齐即校验）
+ * @note   开启后上位机须在 HEADER_INFO 后附带分片信息，并在数据传输前下发分片哈希（keygen.py --manifest）
+ */
+#define SMOTA_CHUNK_MANIFEST 0
 
 /**
  * @brief 版本可靠性（防回滚）
@@ -77,10 +93,10 @@ extern "C" {
 /**
  * @brief 应用程序区大小
  * @note   双 Bank 模式下，这是单个 Bank 的大小
- *         Flash = 256KB, Bootloader = 8KB
- *         每个 Bank = (256KB - 8KB) / 2 = 124KB
+ *         Flash = 256KB, Bootloader = 8KB, 元数据区 = 2 x 2KB
+ *         每个 Bank = (256KB - 8KB - 4KB) / 2 = 122KB
  */
-#define SMOTA_APP_SIZE 0x1F000  // 124KB (单个 Bank，对齐到 2KB 页边界)
+#define SMOTA_APP_SIZE 0x1E800  // 122KB (单个 Bank，对齐到 2KB 页边界)
 
 /**
  * @brief Flash 页大小
@@ -112,6 +128,27 @@ extern "C" {
  */
 #define SMOTA_DECRYPT_BUF_SIZE 1024  // 字节
 
+/**
+ * @brief 中断推送接收队列大小
+ * @note   模拟器在主循环中读取 stdin 后调用 smota_feed()，模拟串口空闲中断
+ */
+#define SMOTA_FEED_BUF_SIZE 2048  // 字节
+
+/**
+ * @brief 实例数量上限
+ * @note   自测试额外创建一个实例，与默认实例交替轮询；
+ *         SHA-256/AES 上下文池按默认值随实例数放大（SMOTA_SHA256_CTX_NUM / SMOTA_AES_CTX_NUM）
+ */
+#define SMOTA_INSTANCE_MAX 2
+
+/**
+ * @brief 当前实例按线程保存
+ * @note   自测试在 OTA 任务驱动一个实例的同时由主线程驱动默认实例
+ */
+#ifndef SMOTA_INSTANCE_THREAD_LOCAL
+#define SMOTA_INSTANCE_THREAD_LOCAL 1
+#endif
+
 /*==============================================================================
  * 6. 调试配置
  *============================================================================*/
@@ -127,6 +164,11 @@ extern "C" {
 #include <stdio.h>
 #define SMOTA_DEBUG_PRINTF(...) printf("[smOTA] " __VA_ARGS__)
 
+/**
+ * @brief 启用 Flash 操作统计（--status 输出）
+ */
+#define SMOTA_FLASH_STATS 1
+
 /*==============================================================================
  * 7. 超时配置
  *============================================================================*/
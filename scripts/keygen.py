@@ -9,16 +9,23 @@ smOTA 密钥生成工具
     python keygen.py --ecdsa            # 仅生成 ECDSA 密钥对
     python keygen.py --aes              # 仅生成 AES 密钥
     python keygen.py --output keys/     # 指定输出目录
+    python keygen.py --digest fw/*.bin  # 并行计算多个固件的 SHA-256
+    python keygen.py --manifest fw.bin --chunk-size 4096  # 生成分片清单（Merkle 根）
+    python keygen.py --header fw.bin --fw-version 1.2.3 --key keys/ecdsa_private_key.pem  # 签名并生成 HEADER_INFO 负载
+    python keygen.py --pubkey keys/ecdsa_public_key.bin  # 由已有公钥重新生成 ecdsa_public_key.c
 """
 
 import os
 import sys
 import argparse
+import hashlib
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 
 try:
     from cryptography.hazmat.primitives.asymmetric import ec
-    from cryptography.hazmat.primitives import serialization
+    from cryptography.hazmat.primitives.asymmetric.utils import Prehashed, decode_dss_signature
+    from cryptography.hazmat.primitives import hashes, serialization
     from cryptography.hazmat.backends import default_backend
     CRYPTO_AVAILABLE = True
 except ImportError:
@@ -31,6 +38,13 @@ except ImportError:
 KEY_ID_AES_MASTER = 0
 KEY_ID_ECDSA_PUB = 1
 
+# NIST P-256 曲线参数（用于生成验签预计算表）
+P256_P = 0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF
+P256_B = 0x5AC635D8AA3A93E7B3EBBD55769886BC651D06B0CC53B0F63BCE3C3E27D2604B
+
+# 验签预计算表: Q, 3Q, ..., 31Q（与 TinyCrypt uECC_VERIFY_TABLE_POINTS 一致）
+VERIFY_TABLE_POINTS = 16
+
 
 def generate_ecdsa_keypair():
     """生成 ECDSA-P256 密钥对"""
@@ -80,8 +94,13 @@ def format_byte_array(bytes_data, var_name, size=8):
     return "\n".join(lines)
 
 
-def ecdsa_public_key_to_c_array(public_key_bytes, var_name="smota_ecdsa_pub_key"):
-    """将 ECDSA 公钥转换为 C 数组格式"""
+def ecdsa_public_key_to_c_array(public_key_bytes, var_name="smota_ecdsa_pub_key",
+                                table_name="smota_ecdsa_pub_table"):
+    """将 ECDSA 公钥转换为 C 源文件（附带验签预计算表）
+
+    数组为外部链接，文件直接加入工程编译，移植层以 extern 声明引用
+    （如 ECDSA 验签驱动把预计算表交给 uECC_verify_with_table()）。
+    """
     # X962 编码会在公钥前加 0x04 前缀，需要跳过
     if public_key_bytes[0] == 0x04:
         public_key_bytes = public_key_bytes[1:]
@@ -96,23 +115,112 @@ def ecdsa_public_key_to_c_array(public_key_bytes, var_name="smota_ecdsa_pub_key"
     y_lines = format_byte_array(y_coord, f"{var_name}_y", 8)
     full_lines = format_byte_array(public_key_bytes, var_name, 8)
 
-    c_code = f"""// ECDSA-P256 公钥 (未压缩格式)
+    c_code = f"""// 此文件由 scripts/keygen.py 生成，加入工程编译后以 extern 声明引用：
+//   extern const uint8_t {var_name}[64];
+//   extern const unsigned int {table_name}[{VERIFY_TABLE_POINTS} * 16];
+
+#include <stdint.h>
+
+// ECDSA-P256 公钥 (未压缩格式)
 // X 坐标 (32 bytes)
-static const uint8_t {var_name}_x[32] = {{
+const uint8_t {var_name}_x[32] = {{
 {x_lines}
 }};
 
 // Y 坐标 (32 bytes)
-static const uint8_t {var_name}_y[32] = {{
+const uint8_t {var_name}_y[32] = {{
 {y_lines}
 }};
 
 // 完整公钥 (64 bytes)
-static const uint8_t {var_name}[64] = {{
+const uint8_t {var_name}[64] = {{
 {full_lines}
 }};
+
 """
-    return c_code
+    return c_code + ecdsa_verify_table_to_c_array(public_key_bytes, table_name)
+
+
+def p256_add(p1, p2):
+    """P-256 仿射坐标点加（None 表示无穷远点）"""
+    if p1 is None:
+        return p2
+    if p2 is None:
+        return p1
+    x1, y1 = p1
+    x2, y2 = p2
+    if x1 == x2:
+        if (y1 + y2) % P256_P == 0:
+            return None
+        lam = (3 * x1 * x1 - 3) * pow(2 * y1, -1, P256_P) % P256_P
+    else:
+        lam = (y2 - y1) * pow(x2 - x1, -1, P256_P) % P256_P
+    x3 = (lam * lam - x1 - x2) % P256_P
+    return x3, (lam * (x1 - x3) - y1) % P256_P
+
+
+def ecdsa_verify_table(public_key_bytes):
+    """
+    计算公钥 Q 的奇数倍点 Q, 3Q, ..., 31Q（仿射坐标）
+
+    设备端 uECC_verify_with_table() 直接使用该表，省去每次验签时的公钥转换、
+    倍点计算和模逆。
+    """
+    if public_key_bytes[0] == 0x04 and len(public_key_bytes) == 65:
+        public_key_bytes = public_key_bytes[1:]
+    if len(public_key_bytes) != 64:
+        raise ValueError(f"公钥长度应为 64 字节，实际为 {len(public_key_bytes)} 字节")
+
+    x = int.from_bytes(public_key_bytes[:32], "big")
+    y = int.from_bytes(public_key_bytes[32:], "big")
+    if (y * y - (x * x * x - 3 * x + P256_B)) % P256_P != 0:
+        raise ValueError("公钥不在 P-256 曲线上")
+
+    q = (x, y)
+    q2 = p256_add(q, q)
+    points = [q]
+    for _ in range(VERIFY_TABLE_POINTS - 1):
+        points.append(p256_add(points[-1], q2))
+    return points
+
+
+def ecdsa_verify_table_to_c_array(public_key_bytes, var_name="smota_ecdsa_pub_table"):
+    """将验签预计算表转换为 C 数组（uECC_word_t 字序：低位字在前）"""
+    lines = []
+    for i, (x, y) in enumerate(ecdsa_verify_table(public_key_bytes)):
+        words = [(v >> (32 * k)) & 0xFFFFFFFF for v in (x, y) for k in range(8)]
+        lines.append(f"    /* {2 * i + 1}Q */")
+        for row in range(0, 16, 4):
+            line = "    " + ", ".join(f"0x{w:08X}" for w in words[row:row + 4])
+            if i < VERIFY_TABLE_POINTS - 1 or row < 12:
+                line += ","
+            lines.append(line)
+    body = "\n".join(lines)
+
+    return f"""// ECDSA-P256 验签预计算表 (uECC_verify_with_table 使用)
+// 奇数倍点 Q, 3Q, ..., {2 * VERIFY_TABLE_POINTS - 1}Q，每点 x、y 各 8 个 32 位字，低位字在前
+const unsigned int {var_name}[{VERIFY_TABLE_POINTS} * 16] = {{
+{body}
+}};
+"""
+
+
+def load_public_key(path):
+    """读取已有公钥：.bin（64/65 字节）或 .pem（公钥或私钥，需要 cryptography）"""
+    data = Path(path).read_bytes()
+    if not data.startswith(b"-----BEGIN"):
+        return data[1:] if (len(data) == 65 and data[0] == 0x04) else data
+
+    if not CRYPTO_AVAILABLE:
+        raise RuntimeError("读取 PEM 需要 cryptography 库")
+    if b"PRIVATE KEY" in data:
+        key = serialization.load_pem_private_key(data, password=None, backend=default_backend()).public_key()
+    else:
+        key = serialization.load_pem_public_key(data, backend=default_backend())
+    return key.public_bytes(
+        encoding=serialization.Encoding.X962,
+        format=serialization.PublicFormat.UncompressedPoint
+    )[1:]
 
 
 def aes_key_to_c_array(key_bytes, var_name="smota_aes_master_key"):
@@ -168,6 +276,7 @@ def generate_smota_keys_c(aes_key=None, ecdsa_pub_key=None, output_path=None):
         lines.append(y_lines)
         lines.append("};")
         lines.append("")
+        lines.append(ecdsa_verify_table_to_c_array(ecdsa_pub_key, "g_ecdsa_pub_table"))
 
     if aes_key is not None:
         key_hex = ", ".join(f"0x{b:02X}" for b in aes_key)
@@ -219,14 +328,182 @@ def generate_smota_keys_c(aes_key=None, ecdsa_pub_key=None, output_path=None):
     return content
 
 
+# 内容哈希算法 ID（与设备端 SMOTA_HASH_ALG_* 一致），hashlib 中 blake2s 默认输出 32 字节
+HASH_ALG_IDS = {"sha256": 0, "blake2s": 1}
+
+
+def sha256_file(path, chunk_size=1 << 20, hash_name="sha256"):
+    """计算单个文件的 SHA-256（或 hash_name 指定的内容哈希）"""
+    h = hashlib.new(hash_name)
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(chunk_size), b""):
+            h.update(chunk)
+    return h.digest()
+
+
+def sha256_batch(paths, jobs=None, hash_name="sha256"):
+    """
+    批量计算固件摘要
+
+    hashlib 在计算大块数据时释放 GIL，线程池可按 CPU 核数并行；
+    每个线程内由 OpenSSL 选择 SHA-NI/ARMv8 等硬件实现。
+    """
+    with ThreadPoolExecutor(max_workers=jobs or os.cpu_count() or 1) as pool:
+        return list(pool.map(lambda path: sha256_file(path, hash_name=hash_name), paths))
+
+
+def chunk_leaf_hash(chunk, hash_name="sha256"):
+    """分片叶子哈希: H(0x00 || 分片数据)"""
+    h = hashlib.new(hash_name, b"\x00")
+    h.update(chunk)
+    return h.digest()
+
+
+def merkle_root(leaves, hash_name="sha256"):
+    """
+    计算 Merkle 根（与设备端 smota_chunk_merkle_root 一致）
+
+    内部节点为 H(0x01 || 左 || 右)，奇数个节点时最后一个直接上移。
+    """
+    level = list(leaves)
+    while len(level) > 1:
+        level = [hashlib.new(hash_name, b"\x01" + level[i] + level[i + 1]).digest() if i + 1 < len(level) else level[i]
+                 for i in range(0, len(level), 2)]
+    return level[0]
+
+
+def chunk_manifest(path, chunk_size, jobs=None, hash_name="sha256"):
+    """
+    生成分片清单
+
+    分片哈希之间相互独立，按 CPU 核数在线程池中并行计算。
+    返回 (整包哈希, 分片哈希列表, Merkle 根, 固件大小)。
+    """
+    data = memoryview(Path(path).read_bytes())
+    if len(data) == 0:
+        raise ValueError(f"{path}: 固件为空")
+
+    chunks = [data[i:i + chunk_size] for i in range(0, len(data), chunk_size)]
+    with ThreadPoolExecutor(max_workers=jobs or os.cpu_count() or 1) as pool:
+        leaves = list(pool.map(lambda chunk: chunk_leaf_hash(chunk, hash_name), chunks))
+
+    image_hash = hashlib.new(hash_name, data).digest()
+    root = merkle_root(leaves, hash_name)
+    return image_hash, leaves, root, len(data)
+
+
+def parse_version(text):
+    """解析 major.minor.patch 版本号"""
+    parts = [int(x) for x in text.split(".")]
+    if len(parts) != 3 or any(x < 0 or x > 255 for x in parts):
+        raise ValueError(f"版本号格式应为 major.minor.patch (0~255): {text}")
+    return bytes(parts)
+
+
+def header_digest(image_hash, image_size, version, trailer=b"", hash_name="sha256"):
+    """
+    头部签名摘要（与设备端 smota_crypto_header_digest 一致）
+
+    H(整包哈希 || 固件大小(LE32) || major || minor || patch || 附加信息)，
+    附加信息为 HEADER_INFO 中签名之后的字节（[chunk_size(LE32) || 根] [|| 哈希算法]）。
+    把握手声明的大小和版本与整包哈希一起签名，设备在擦除 Flash 之前即可验签。
+    """
+    data = image_hash + image_size.to_bytes(4, "little") + version + trailer
+    return hashlib.new(hash_name, data).digest()
+
+
+def sign_digest(private_key_path, digest):
+    """用 ECDSA-P256 私钥对摘要签名，返回 r || s (64 字节)"""
+    private_key = serialization.load_pem_private_key(Path(private_key_path).read_bytes(), password=None,
+                                                     backend=default_backend())
+    der = private_key.sign(digest, ec.ECDSA(Prehashed(hashes.SHA256())))
+    r, s = decode_dss_signature(der)
+    return r.to_bytes(32, "big") + s.to_bytes(32, "big")
+
+
 def main():
     parser = argparse.ArgumentParser(description="smOTA 密钥生成工具")
     parser.add_argument("--ecdsa", action="store_true", help="生成 ECDSA-P256 密钥对")
     parser.add_argument("--aes", action="store_true", help="生成 AES-128 密钥")
     parser.add_argument("--output", "-o", default="keys", help="输出目录 (默认: keys/)")
     parser.add_argument("--c-file", action="store_true", help="生成 smota_keys.c 文件")
+    parser.add_argument("--digest", nargs="+", metavar="FILE", help="计算固件 SHA-256 (sha256sum 格式输出)，不生成密钥")
+    parser.add_argument("--jobs", "-j", type=int, default=None, help="--digest/--manifest 并行线程数 (默认: CPU 核数)")
+    parser.add_argument("--manifest", metavar="FILE", help="生成固件分片清单 (<FILE名>.manifest)，输出 Merkle 根，不生成密钥")
+    parser.add_argument("--chunk-size", type=int, default=None,
+                        help="分片大小，须为设备下载分区擦除单元的整数倍 (--manifest 默认 4096；--header 指定时附带分片信息)")
+    parser.add_argument("--header", metavar="FILE", help="计算头部签名摘要；配合 --key 签名并生成 HEADER_INFO 负载 (<FILE名>.header)")
+    parser.add_argument("--fw-version", metavar="X.Y.Z", help="--header 固件版本，须与握手请求一致")
+    parser.add_argument("--key", metavar="PEM", help="--header 签名私钥 (ecdsa_private_key.pem)")
+    parser.add_argument("--hash", choices=sorted(HASH_ALG_IDS), default=None,
+                        help="内容哈希算法 (默认 sha256)；--header 指定时附带哈希算法字节，对应设备 SMOTA_HASH_BLAKE2S=1")
+    parser.add_argument("--pubkey", metavar="FILE", help="由已有公钥 (.bin/.pem) 重新生成 ecdsa_public_key.c（含验签预计算表），不生成密钥")
 
     args = parser.parse_args()
+    hash_name = args.hash or "sha256"
+
+    if args.digest:
+        for path, digest in zip(args.digest, sha256_batch(args.digest, args.jobs, hash_name)):
+            print(f"{digest.hex()}  {path}")
+        return
+
+    if args.manifest:
+        chunk_size = args.chunk_size or 4096
+        image_hash, leaves, root, _ = chunk_manifest(args.manifest, chunk_size, args.jobs, hash_name)
+        output_dir = Path(args.output)
+        output_dir.mkdir(parents=True, exist_ok=True)
+        manifest_path = output_dir / (Path(args.manifest).name + ".manifest")
+        manifest_path.write_bytes(b"".join(leaves))
+        print(f"image_hash:   {image_hash.hex()} ({hash_name})")
+        print(f"chunk_size:   {chunk_size}")
+        print(f"chunk_count:  {len(leaves)}")
+        print(f"chunk_root:   {root.hex()}")
+        print(f"已生成: {manifest_path}")
+        return
+
+    if args.header:
+        if not args.fw_version:
+            parser.error("--header 需要 --fw-version")
+        version = parse_version(args.fw_version)
+        if args.chunk_size:
+            image_hash, _, root, image_size = chunk_manifest(args.header, args.chunk_size, args.jobs, hash_name)
+            trailer = args.chunk_size.to_bytes(4, "little") + root
+        else:
+            image_hash = sha256_file(args.header, hash_name=hash_name)
+            image_size = Path(args.header).stat().st_size
+            root = None
+            trailer = b""
+        if args.hash:
+            trailer += bytes([HASH_ALG_IDS[args.hash]])
+        digest = header_digest(image_hash, image_size, version, trailer, hash_name)
+        print(f"image_hash:   {image_hash.hex()} ({hash_name})")
+        print(f"image_size:   {image_size}")
+        print(f"fw_version:   {args.fw_version}")
+        if root is not None:
+            print(f"chunk_size:   {args.chunk_size}")
+            print(f"chunk_root:   {root.hex()}")
+        print(f"sign_digest:  {digest.hex()}")
+        if args.key:
+            if not CRYPTO_AVAILABLE:
+                print("错误: 签名需要 cryptography 库")
+                sys.exit(1)
+            signature = sign_digest(args.key, digest)
+            output_dir = Path(args.output)
+            output_dir.mkdir(parents=True, exist_ok=True)
+            header_path = output_dir / (Path(args.header).name + ".header")
+            header_path.write_bytes(image_hash + signature + trailer)
+            print(f"signature_r:  {signature[:32].hex()}")
+            print(f"signature_s:  {signature[32:].hex()}")
+            print(f"已生成: {header_path}")
+        return
+
+    if args.pubkey:
+        output_dir = Path(args.output)
+        output_dir.mkdir(parents=True, exist_ok=True)
+        ecdsa_c_path = output_dir / "ecdsa_public_key.c"
+        ecdsa_c_path.write_text(ecdsa_public_key_to_c_array(load_public_key(args.pubkey)), encoding="utf-8")
+        print(f"已生成: {ecdsa_c_path}")
+        return
 
     # 默认生成所有密钥
     gen_ecdsa = args.ecdsa or not (args.ecdsa or args.aes)
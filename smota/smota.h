@@ -42,13 +42,18 @@ extern "C" {
 #include "smota_core/inc/smota_packet.h"
 #include "smota_core/inc/smota_verify.h"
 #include "smota_core/inc/smota_flash.h"
+#include "smota_core/inc/smota_partition.h"
+#include "smota_core/inc/smota_meta.h"
+#include "smota_core/inc/smota_wear.h"
+#include "smota_core/inc/smota_stats.h"
+#include "smota_core/inc/smota_chunk.h"
+#include "smota_core/inc/smota_ctr.h"
+#include "smota_core/inc/smota_instance.h"
 
 /*==============================================================================
- * 4. 加密模块（根据配置条件包含）
+ * 4. 加密模块（签名校验受 SMOTA_RELIABILITY_SOURCE 控制）
  *============================================================================*/
-#if SMOTA_RELIABILITY_CONTENT || SMOTA_RELIABILITY_SOURCE || SMOTA_RELIABILITY_TRANSMISSION
-#include "smota_crypto.h"
-#endif
+#include "smota_core/inc/smota_crypto.h"
 
 /*==============================================================================
  * 5. Bootloader（仅 Bootloader 项目需要）
@@ -69,14 +74,37 @@ smota_err_t smota_init(void);
 
 /**
  * @brief       去初始化 OTA 模块
+ * @return      smota_err_t 错误码
  */
-void smota_deinit(void);
+smota_err_t smota_deinit(void);
 
 /**
  * @brief       OTA 主轮询函数
+ * @return      smota_err_t 错误码
  * @note        需要在主循环中周期性调用，建议每1ms调用一次
  */
-void smota_poll(void);
+smota_err_t smota_poll(void);
+
+/**
+ * @brief       OTA 轮询并给出下次需要轮询的时间（低功耗/tickless）
+ * @param[out]  wait_ms: 距下次需要轮询的毫秒数：数据包超时、会话总超时、未处理完的帧中最早的一个；
+ *                       0=立即再调用，SMOTA_WAIT_FOREVER=只在新数据到达时调用
+ * @return      smota_err_t 错误码
+ * @note        主循环可休眠到 wait_ms 到期或接收中断到来，不必每 1ms 轮询；
+ *              wait_ms 在本次轮询结束时计算，新数据到达后须重新调用
+ */
+smota_err_t smota_poll_deadline(uint32_t *wait_ms);
+
+/**
+ * @brief       推送收到的数据（可在 DMA 完成/串口空闲中断中调用）
+ * @param[in]   data: 数据
+ * @param[in]   len: 长度
+ * @return      size_t 写入接收队列的字节数，队列满时小于 len
+ * @note        需开启 SMOTA_FEED_BUF_SIZE，否则返回 0；队列为单生产者单消费者无锁队列，
+ *              只能在一个中断（或一个任务）中调用。smota_poll() 从队列取数据，收到完整帧才解析，
+ *              主循环可在推送后唤醒再调用 smota_poll()；超时检查的时机见 smota_poll_deadline()
+ */
+size_t smota_feed(const uint8_t *data, size_t len);
 
 /**
  * @brief       启动 OTA 升级（主动触发）
@@ -120,6 +148,100 @@ const char *smota_get_error_string(void);
  */
 bool smota_is_running(void);
 
+/*==============================================================================
+ * 7. 多实例 API（以上接口操作默认实例，见 smota_instance.h）
+ *============================================================================*/
+
+/**
+ * @brief       初始化实例
+ * @param[in]   inst: 实例（调用者分配并清零，初始化后不得移动）
+ * @param[in]   hal: 绑定的 HAL，NULL=使用已在该实例上注册的 HAL
+ * @return      smota_err_t 错误码，SMOTA_ERR_BUSY=实例槽位已用完（增大 SMOTA_INSTANCE_MAX）
+ */
+smota_err_t smota_instance_init(struct smota_instance *inst, const struct smota_hal *hal);
+
+/**
+ * @brief       去初始化实例并释放槽位
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_deinit(struct smota_instance *inst);
+
+/**
+ * @brief       轮询实例
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ * @note        所有实例接口须在同一线程中调用；一个事件循环可轮流轮询多个实例
+ */
+smota_err_t smota_instance_poll(struct smota_instance *inst);
+
+/**
+ * @brief       轮询实例并给出下次需要轮询的时间
+ * @param[in]   inst: 实例
+ * @param[out]  wait_ms: 距下次需要轮询的毫秒数，0=立即，SMOTA_WAIT_FOREVER=只在新数据到达时
+ * @return      smota_err_t 错误码
+ * @note        网关轮流驱动多个实例时取所有实例 wait_ms 的最小值作为休眠时间
+ */
+smota_err_t smota_instance_poll_deadline(struct smota_instance *inst, uint32_t *wait_ms);
+
+/**
+ * @brief       向实例推送收到的数据（可在中断中调用）
+ * @param[in]   inst: 实例
+ * @param[in]   data: 数据
+ * @param[in]   len: 长度
+ * @return      size_t 写入接收队列的字节数
+ */
+size_t smota_instance_feed(struct smota_instance *inst, const uint8_t *data, size_t len);
+
+/**
+ * @brief       检查实例是否有待处理的接收数据
+ * @param[in]   inst: 实例
+ * @return      bool true=接收队列非空或有完整帧待解析, false=可以阻塞等待
+ */
+bool smota_instance_pending(const struct smota_instance *inst);
+
+/**
+ * @brief       启动实例的 OTA 升级
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_start(struct smota_instance *inst);
+
+/**
+ * @brief       中止实例的 OTA 升级
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_abort(struct smota_instance *inst);
+
+/**
+ * @brief       获取实例的升级进度
+ * @param[in]   inst: 实例
+ * @return      uint8_t 进度百分比 (0-100)
+ */
+uint8_t smota_instance_get_progress(const struct smota_instance *inst);
+
+/**
+ * @brief       获取实例的当前状态
+ * @param[in]   inst: 实例
+ * @return      smota_state_t 当前状态
+ */
+smota_state_t smota_instance_get_state(const struct smota_instance *inst);
+
+/**
+ * @brief       获取实例最近一次错误码
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_get_error(const struct smota_instance *inst);
+
+/**
+ * @brief       检查实例是否正在升级
+ * @param[in]   inst: 实例
+ * @return      bool true=运行中, false=空闲
+ */
+bool smota_instance_is_running(const struct smota_instance *inst);
+
 #ifdef __cplusplus
 }
 #endif
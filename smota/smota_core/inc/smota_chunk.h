@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_chunk.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 20:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 20:00:00
+ * @Brief        : smOTA 分片清单（Merkle 树）校验
+ * @details      整包 SHA-256 只能在传输完成后校验，续传、重传或乱序的数据无法单独确认。
+ *              本模块把固件按 chunk_size 分片，每个分片的哈希作为 Merkle 树的叶子：
+ *
+ *              - 叶子  = H(0x00 || 分片数据)
+ *              - 节点  = H(0x01 || 左子节点 || 右子节点)，奇数个节点时最后一个直接上移
+ *              - H     为本次会话协商的内容哈希（SHA-256 或 BLAKE2s-256，见 smota_hash_select()）
+ *              - 根    随 HEADER_INFO 下发，由头部签名覆盖（smota_crypto_header_digest()）
+ *
+ *              分片哈希清单在数据传输前下发，收齐后重新计算根并比较；数据块到达时
+ *              流式计算当前分片的哈希，分片收齐即与清单比较，通过的分片立即提交。
+ *              需开启 SMOTA_CHUNK_MANIFEST，否则会话接口返回失败且不占用 RAM。
+ */
+
+#ifndef SMOTA_CHUNK_H
+#define SMOTA_CHUNK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* Merkle 树最大层数（分片数为 uint16_t） */
+#define SMOTA_CHUNK_TREE_DEPTH 17
+
+/*---------- type define ----------*/
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief       计算分片叶子哈希
+ * @param[in]   data: 分片数据
+ * @param[in]   size: 分片长度
+ * @param[out]  hash: 输出叶子哈希（32字节）
+ * @return      0=成功, <0=失败
+ */
+int smota_chunk_leaf_hash(const uint8_t *data, uint32_t size, uint8_t hash[32]);
+
+/**
+ * @brief       由叶子哈希计算 Merkle 根
+ * @param[in]   leaf: 叶子哈希数组
+ * @param[in]   count: 叶子数量
+ * @param[out]  root: 输出根（32字节）
+ * @return      0=成功, <0=失败
+ * @note        逐个压入叶子、同层合并，栈深度不超过 SMOTA_CHUNK_TREE_DEPTH，不修改 leaf
+ */
+int smota_chunk_merkle_root(const uint8_t (*leaf)[32], uint16_t count, uint8_t root[32]);
+
+/**
+ * @brief       开始新的分片会话
+ * @param[in]   image_size: 固件大小
+ * @param[in]   chunk_size: 分片大小（须为下载分区擦除单元的整数倍）
+ * @param[in]   root: Merkle 根
+ * @return      0=成功, -1=参数无效, -2=分片数超过 SMOTA_CHUNK_MAX, -3=未开启 SMOTA_CHUNK_MANIFEST
+ * @note        分片大小按擦除单元对齐，分片校验失败时可从分片起始回退重写
+ */
+int smota_chunk_begin(uint32_t image_size, uint32_t chunk_size, const uint8_t root[32]);
+
+/**
+ * @brief       写入一页分片哈希
+ * @param[in]   index: 第一个分片编号（须等于已收到的数量）
+ * @param[in]   hash: count 个分片哈希
+ * @param[in]   count: 数量
+ * @return      已收到的分片哈希数, -1=会话未开始或编号不连续, -2=计算失败, -3=与 Merkle 根不符
+ * @note        收齐后计算根并比较；失败时清空清单，上位机从 0 重发
+ */
+int smota_chunk_manifest_put(uint16_t index, const uint8_t *hash, uint16_t count);
+
+/**
+ * @brief       清单是否已收齐并通过 Merkle 根校验
+ * @return      true=已就绪
+ */
+bool smota_chunk_manifest_ready(void);
+
+/**
+ * @brief       获取已收到的分片哈希数
+ * @return      数量
+ */
+uint16_t smota_chunk_manifest_received(void);
+
+/**
+ * @brief       获取分片总数
+ * @return      数量，0=会话未开始
+ */
+uint16_t smota_chunk_total(void);
+
+/**
+ * @brief       流式校验数据
+ * @param[in]   offset: 数据在固件中的偏移（须连续）
+ * @param[in]   data: 数据
+ * @param[in]   size: 长度
+ * @return      0=通过（分片未收齐或已提交）, -1=清单未就绪或偏移不连续, -2=计算失败, -3=分片哈希不符
+ * @note        在写入 Flash 之前调用；失败时回退到本次调用开始时所在分片的起始，
+ *              调用者丢弃该数据块并从 smota_chunk_committed() 重新接收
+ */
+int smota_chunk_update(uint32_t offset, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief       获取已校验提交的字节数
+ * @return      字节数（分片边界或固件大小）
+ */
+uint32_t smota_chunk_committed(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_CHUNK_H
@@ -76,7 +76,8 @@ extern "C" {
 
 /**
  * @brief 过程可靠性（Transmission Reliability）
- * @details 防止固件被黑客通过总线监听进行逆向工程
+ * @details 防止固件被黑客通过总线监听进行逆向工程。握手声明 SMOTA_CAP_ENCRYPT，
+ *          数据块为 AES-128-CTR 密文，解密后写入 Flash；密钥流在空闲时预取（SMOTA_CTR_PREFETCH_SIZE）
  *          技术：AES-128-CTR 对称加密 + HMAC-SHA256 密钥派生
  *          状态：【可选】
  */
@@ -84,6 +85,69 @@ extern "C" {
 #define SMOTA_RELIABILITY_TRANSMISSION 0
 #endif
 
+/**
+ * @brief 延迟解密（Deferred Decryption）
+ * @details 开启 SMOTA_RELIABILITY_TRANSMISSION 后的可选模式：数据块以密文写入暂存区，
+ *          接收路径不做 AES 运算，流式哈希按密文计算（与 DATA_COMPLETE 附带的密文哈希比较）；
+ *          解密和明文哈希校验合并到安装拷贝 smota_flash_copy_firmware() 中，
+ *          每个字节只解密一次，重传不再重复解密，暂存区中不出现明文。
+ *          仅双槽位拷贝模式（SMOTA_MODE 1）可用，不支持 SMOTA_CHUNK_MANIFEST
+ *          状态：【可选】
+ */
+#ifndef SMOTA_CTR_DEFERRED
+#define SMOTA_CTR_DEFERRED 0
+#endif
+
+/**
+ * @brief 数据块认证（Block Authentication）
+ * @details 每个数据块附带认证标签，写入 Flash 前校验；损坏或伪造的数据块
+ *          立即应答 SMOTA_ERR_DATA_BLOCK，上位机只重发该块，不必等到传输完成后的
+ *          SHA-256 校验失败再整包重传
+ *          技术：AES-128-CMAC 或 HMAC-SHA256（由 HAL crypto->block_mac 实现）
+ *          状态：【可选】
+ */
+#ifndef SMOTA_BLOCK_AUTH
+#define SMOTA_BLOCK_AUTH 0
+#endif
+
+/**
+ * @brief 数据块 AEAD 加密（ChaCha20-Poly1305）
+ * @details 握手声明 SMOTA_CAP_CHACHA20_POLY1305，上位机用一机一密密钥加密每个数据块，
+ *          data 之后附带 Poly1305 标签；设备一次遍历完成认证和解密（HAL crypto->aead_decrypt），
+ *          标签不符的数据块不写入并应答 SMOTA_ERR_DATA_BLOCK。
+ *          无 AES 加速器的 MCU（Cortex-M0/M3）上 ChaCha20 比软件 AES 快数倍且无查表
+ *          技术：ChaCha20-Poly1305（RFC 8439），密钥由 HMAC-SHA256 KDF 以 SMOTA_KDF_CONTEXT 派生
+ *          状态：【可选】
+ */
+#ifndef SMOTA_CHACHA20_POLY1305
+#define SMOTA_CHACHA20_POLY1305 0
+#endif
+
+/**
+ * @brief 分片清单（Chunk Manifest）
+ * @details 固件按分片计算哈希，HEADER_INFO 携带分片哈希的 Merkle 根（随签名一起认证），
+ *          分片哈希在数据传输前由 SMOTA_CMD_CHUNK_MANIFEST 下发并对照根校验；
+ *          每个分片收齐后立即校验并提交，不符时只重发该分片，
+ *          已提交的分片可作为断点续传和乱序重传的起点
+ *          技术：SHA-256 Merkle 树（叶子与内部节点按前缀 0x00/0x01 区分）
+ *          状态：【可选】
+ */
+#ifndef SMOTA_CHUNK_MANIFEST
+#define SMOTA_CHUNK_MANIFEST 0
+#endif
+
+/**
+ * @brief 内容哈希协商（BLAKE2s）
+ * @details HAL 提供 blake2s_* 时握手声明 SMOTA_CAP_HASH_BLAKE2S，HEADER_INFO 末尾附带上位机
+ *          选定的算法；整包哈希、分片哈希和签名摘要统一使用该算法。
+ *          无哈希加速器的 32 位 MCU 上 BLAKE2s 软件实现明显快于 SHA-256
+ *          技术：BLAKE2s-256（RFC 7693）
+ *          状态：【可选】
+ */
+#ifndef SMOTA_HASH_BLAKE2S
+#define SMOTA_HASH_BLAKE2S 0
+#endif
+
 /**
  * @brief 版本可靠性（Version Reliability）
  * @details 防止黑客通过重放（Replay）带有已知漏洞的旧版合法固件攻击系统
@@ -133,6 +197,14 @@ extern "C" {
 #define SMOTA_FLASH_PAGE_SIZE 0x800 // 2KB
 #endif
 
+/**
+ * @brief Flash 最小编程单元
+ * @note   如 STM32F1 为 2 字节（半字），STM32G0/L4 为 8 字节（双字）
+ */
+#ifndef SMOTA_FLASH_WRITE_SIZE
+#define SMOTA_FLASH_WRITE_SIZE 8
+#endif
+
 /**
  * @brief Flash 总容量
  * @note   必须根据实际 MCU 型号设置
@@ -143,6 +215,97 @@ extern "C" {
 #define SMOTA_FLASH_SIZE 0x80000 // 512KB
 #endif
 
+/**
+ * @brief 元数据扇区大小
+ * @note   元数据（版本号、启动标志、暂存位置、擦除计数）以追加写记录的形式保存，
+ *         必须是可独立擦除的最小单元（页/扇区）的整数倍
+ */
+#ifndef SMOTA_META_SECTOR_SIZE
+#define SMOTA_META_SECTOR_SIZE SMOTA_FLASH_PAGE_SIZE
+#endif
+
+/**
+ * @brief 元数据扇区数量
+ * @note   至少 2 个，写满一个扇区后整理到下一个扇区，保证掉电安全
+ */
+#ifndef SMOTA_META_SECTOR_NUM
+#define SMOTA_META_SECTOR_NUM 2
+#endif
+
+/**
+ * @brief 元数据区起始地址
+ * @note   默认放在 Flash 末尾，不能与 App 区/备份区重叠
+ */
+#ifndef SMOTA_META_ADDR
+#define SMOTA_META_ADDR (SMOTA_FLASH_BASE_ADDR + SMOTA_FLASH_SIZE - SMOTA_META_SECTOR_SIZE * SMOTA_META_SECTOR_NUM)
+#endif
+
+/**
+ * @brief 元数据记录写入对齐
+ * @note   不小于 Flash 最小编程单元，且至少 4 字节
+ */
+#ifndef SMOTA_META_ALIGN
+#define SMOTA_META_ALIGN (SMOTA_FLASH_WRITE_SIZE < 4 ? 4 : SMOTA_FLASH_WRITE_SIZE)
+#endif
+
+/**
+ * @brief 单条元数据记录最大长度
+ */
+#ifndef SMOTA_META_VALUE_MAX
+#define SMOTA_META_VALUE_MAX 64 // 字节
+#endif
+
+/**
+ * @brief 元数据标签数量上限
+ * @note   决定 RAM 索引大小，标签取值范围为 1 ~ SMOTA_META_TAG_MAX-1；
+ *         一个扇区须放得下每个标签各一条最长记录（smota_meta.c 编译时检查），
+ *         默认 2KB 扇区、8 字节对齐时 24 x 72 + 8 = 1736 字节
+ */
+#ifndef SMOTA_META_TAG_MAX
+#define SMOTA_META_TAG_MAX 24
+#endif
+
+/**
+ * @brief 外部 NOR Flash 编程页大小
+ * @note   SPI/QSPI NOR 参考驱动（smota_nor_flash.c）按页编程，常见为 256 字节
+ */
+#ifndef SMOTA_NOR_PAGE_SIZE
+#define SMOTA_NOR_PAGE_SIZE 256
+#endif
+
+/**
+ * @brief 外部 NOR Flash 扇区大小（最小擦除单元，命令 0x20）
+ */
+#ifndef SMOTA_NOR_SECTOR_SIZE
+#define SMOTA_NOR_SECTOR_SIZE 0x1000 // 4KB
+#endif
+
+/**
+ * @brief 外部 NOR Flash 块大小（块擦除单元，命令 0xD8）
+ * @note   地址和剩余长度满足块对齐时优先使用块擦除，速度远高于逐扇区擦除
+ */
+#ifndef SMOTA_NOR_BLOCK_SIZE
+#define SMOTA_NOR_BLOCK_SIZE 0x10000 // 64KB
+#endif
+
+/**
+ * @brief 下载区擦除计数器数量
+ * @note   每个计数器记录下载分区中一组擦除单元的擦除次数，保存在元数据区；
+ *         擦除单元数超过此值时相邻单元合用一个计数器，0=关闭擦除计数
+ */
+#ifndef SMOTA_WEAR_COUNTER_NUM
+#define SMOTA_WEAR_COUNTER_NUM 128
+#endif
+
+/**
+ * @brief 下载区暂存位置轮换
+ * @note   1=每次升级从擦除次数最少的位置开始暂存，分散下载分区的磨损；
+ *         仅在下载分区大于固件时生效，单分区模式（下载到 App 区）不轮换
+ */
+#ifndef SMOTA_WEAR_ROTATE
+#define SMOTA_WEAR_ROTATE 0
+#endif
+
 /*==============================================================================
  * 5. 固件包配置
  *============================================================================*/
@@ -175,6 +338,125 @@ extern "C" {
 #define SMOTA_DECRYPT_BUF_SIZE 1024 // 字节
 #endif
 
+/**
+ * @brief 下载区写合并缓冲区大小
+ * @note   数据块未对齐到分区编程单元（write_size）时先缓存在此，凑满一个编程单元再写入，
+ *         使外部 NOR 始终整页编程；分区 write_size 超过此值时不合并，直接写入
+ */
+#ifndef SMOTA_FLASH_WRITE_BUF_SIZE
+#define SMOTA_FLASH_WRITE_BUF_SIZE 256 // 字节
+#endif
+
+/**
+ * @brief SHA-256 上下文池
+ * @note   HAL 提供 sha256_init_at 时，核心从这里取上下文存储，升级过程不再动态分配；
+ *         SIZE 须不小于 HAL sha256_ctx_size()（TinyCrypt 约 112 字节），
+ *         NUM 为可同时进行的 SHA-256 计算数（分片校验、Merkle 节点、整包校验）；
+ *         池为所有实例共享，每个会话在传输期间持有一个整包哈希上下文，默认按每实例 3 个分配
+ */
+#ifndef SMOTA_SHA256_CTX_SIZE
+#define SMOTA_SHA256_CTX_SIZE 128 // 字节
+#endif
+
+#ifndef SMOTA_SHA256_CTX_NUM
+#define SMOTA_SHA256_CTX_NUM (3 * SMOTA_INSTANCE_MAX)
+#endif
+
+/**
+ * @brief AES-128-CTR 上下文池
+ * @note   HAL 提供 aes_init_at 时使用；SIZE 须不小于 HAL aes_ctx_size()
+ *         （TinyCrypt 密钥调度 176 字节 + 计数器 16 字节）；
+ *         开启 SMOTA_RELIABILITY_TRANSMISSION 时每个会话从 HEADER_INFO 到传输结束持有一个，
+ *         默认按实例数分配
+ */
+#ifndef SMOTA_AES_CTX_SIZE
+#define SMOTA_AES_CTX_SIZE 256 // 字节
+#endif
+
+#ifndef SMOTA_AES_CTX_NUM
+#define SMOTA_AES_CTX_NUM SMOTA_INSTANCE_MAX
+#endif
+
+/**
+ * @brief 上下文池用完时改用堆分配
+ * @note   HAL 提供 *_init_at 时上下文只取自上面的静态池：池用完时 smota_sha256_start()/smota_aes_start()
+ *         返回 -4，对应的校验或解密失败（HEADER_INFO 应答 SMOTA_ERR_DATA_AES 等），升级过程不使用堆；
+ *         1=池用完时改调 sha256_init/aes_init 由驱动分配（须有堆），0=不回退。
+ *         HAL 未提供 *_init_at 时始终使用 sha256_init/aes_init，与此开关无关
+ */
+#ifndef SMOTA_CRYPTO_HEAP_FALLBACK
+#define SMOTA_CRYPTO_HEAP_FALLBACK 0
+#endif
+
+/**
+ * @brief CTR 密钥流预取窗口大小
+ * @note   开启 SMOTA_RELIABILITY_TRANSMISSION 时，smota_poll() 在等待下一帧的空闲周期
+ *         预先生成期望偏移之后的密钥流，数据块到达时只需异或；须为 16 的整数倍，
+ *         建议不小于一个数据块；0=关闭预取，数据块到达时当场生成
+ */
+#ifndef SMOTA_CTR_PREFETCH_SIZE
+#define SMOTA_CTR_PREFETCH_SIZE 512 // 字节
+#endif
+
+/**
+ * @brief 分片哈希表容量
+ * @note   开启 SMOTA_CHUNK_MANIFEST 时占用 32 字节 x 此值的 RAM；
+ *         上位机按 固件大小 / 此值 向上取整到擦除单元 选择分片大小
+ */
+#ifndef SMOTA_CHUNK_MAX
+#define SMOTA_CHUNK_MAX 64
+#endif
+
+/**
+ * @brief 中断推送接收队列大小
+ * @note   非 0 时由 DMA 完成/串口空闲中断调用 smota_feed() 推送数据，smota_poll() 从队列取数据，
+ *         不再调用 comm->receive；须为 2 的幂，建议不小于一个完整数据帧；0=关闭
+ */
+#ifndef SMOTA_FEED_BUF_SIZE
+#define SMOTA_FEED_BUF_SIZE 0 // 字节
+#endif
+
+/**
+ * @brief 实例数量上限
+ * @note   网关同时向多个节点升级时增大（smota_instance.h）；各模块按此值保存每个实例的会话状态
+ *         （分区表、元数据、擦除计数、分片表、密钥流窗口等），实例句柄本身（含接收缓冲区）
+ *         由调用者分配；1=只有默认实例
+ */
+#ifndef SMOTA_INSTANCE_MAX
+#define SMOTA_INSTANCE_MAX 1
+#endif
+
+/**
+ * @brief 当前实例按线程保存
+ * @note   smota_instance_*() 进入时切换当前实例，各模块据此查找自己的槽位。
+ *         0=当前实例为全局指针，所有 smota 接口须在同一线程中调用（smota_instance_feed()/smota_task_feed() 除外），
+ *           实例数大于 1 时 smota_task_start() 拒绝启动；
+ *         1=当前实例为线程局部变量（C11 _Thread_local，MSVC __declspec(thread)），每个线程驱动各自的实例，
+ *           SHA-256/AES 上下文池按实例平分（每个实例 NUM / SMOTA_INSTANCE_MAX 个），取还不需要加锁；
+ *           实例的 init/deinit 仍须串行调用
+ */
+#ifndef SMOTA_INSTANCE_THREAD_LOCAL
+#define SMOTA_INSTANCE_THREAD_LOCAL 0
+#endif
+
+/**
+ * @brief OTA 任务栈大小
+ * @note   使用 RTOS 参考任务（smota_task.h）时传给 os->task_create()；单位由移植层解释
+ *         （FreeRTOS 为字，Zephyr/POSIX 为字节），需容纳 smota_poll() 栈上的帧、应答缓冲和哈希/AES 上下文
+ */
+#ifndef SMOTA_TASK_STACK_SIZE
+#define SMOTA_TASK_STACK_SIZE 4096
+#endif
+
+/**
+ * @brief OTA 任务优先级
+ * @note   原样传给 os->task_create()，数值含义由 RTOS 决定（FreeRTOS 越大越高，Zephyr 越小越高）；
+ *         一般低于控制任务、高于空闲任务
+ */
+#ifndef SMOTA_TASK_PRIORITY
+#define SMOTA_TASK_PRIORITY 2
+#endif
+
 /*==============================================================================
  * 7. 加密算法配置
  *============================================================================*/
@@ -222,6 +504,16 @@ extern "C" {
 #define SMOTA_DEBUG_PRINTF(...)
 #endif
 
+/**
+ * @brief 启用 Flash 操作统计
+ * @note   按分区统计读/写/擦除/解锁/上锁的次数、字节数和耗时（smota_stats.h），
+ *         用于检查一次升级的实际擦写量是否超出固件所需；
+ *         占用 RAM 约 SMOTA_PART_MAX x 80 字节，每次 Flash 操作额外读取两次时钟
+ */
+#ifndef SMOTA_FLASH_STATS
+#define SMOTA_FLASH_STATS 0
+#endif
+
 /*==============================================================================
  * 9. 超时配置
  *============================================================================*/
@@ -242,6 +534,33 @@ extern "C" {
 #define SMOTA_VERIFY_TIMEOUT_MS 30000
 #endif
 
+/**
+ * @brief 外部 NOR Flash 忙等待超时时间
+ * @note   单位：毫秒；需大于块擦除最大时间（典型 64KB 块擦除最大 2s）
+ */
+#ifndef SMOTA_NOR_TIMEOUT_MS
+#define SMOTA_NOR_TIMEOUT_MS 3000
+#endif
+
+/**
+ * @brief 外部 NOR Flash 忙等待最大读状态次数
+ * @note   HAL 未提供 get_tick_ms 时无法按 SMOTA_NOR_TIMEOUT_MS 计时，改为限制读状态次数，
+ *         芯片一直忙时返回失败而不是永久阻塞；按总线速度取约 SMOTA_NOR_TIMEOUT_MS 对应的次数
+ *         （一次读状态约 2 字节传输，10MHz SPI 下约 2us）
+ */
+#ifndef SMOTA_NOR_POLL_MAX
+#define SMOTA_NOR_POLL_MAX 2000000UL
+#endif
+
+/**
+ * @brief OTA 任务最长阻塞时间
+ * @note   单位：毫秒；OTA 任务按 smota_poll_deadline() 给出的期限阻塞等待，
+ *         非 0 时等待时间不超过此值（用于喂看门狗等需要任务定期运行的场合）；0=不限制
+ */
+#ifndef SMOTA_TASK_IDLE_MS
+#define SMOTA_TASK_IDLE_MS 0
+#endif
+
 /*==============================================================================
  * 10. 编译时校验
  *============================================================================*/
@@ -265,10 +584,48 @@ extern "C" {
 #endif
 
 // 解密缓冲区不能超过工作缓冲区
+#if SMOTA_FLASH_WRITE_BUF_SIZE < SMOTA_FLASH_WRITE_SIZE
+#error "Error: SMOTA_FLASH_WRITE_BUF_SIZE must hold at least one SMOTA_FLASH_WRITE_SIZE unit!"
+#endif
+
 #if SMOTA_DECRYPT_BUF_SIZE > SMOTA_WORK_BUF_SIZE
 #error "Error: Decrypt buffer cannot exceed work buffer size!"
 #endif
 
+// 实例槽位号为 uint8_t，槽位 0 固定给默认实例
+#if (SMOTA_INSTANCE_MAX < 1) || (SMOTA_INSTANCE_MAX > 255)
+#error "Error: SMOTA_INSTANCE_MAX must be in the range 1-255!"
+#endif
+
+/* 共享上下文池：每个实例的会话在传输期间各持有一个整包哈希上下文（及 AES 上下文） */
+#if SMOTA_SHA256_CTX_NUM < SMOTA_INSTANCE_MAX
+#error "Error: SMOTA_SHA256_CTX_NUM must be at least SMOTA_INSTANCE_MAX!"
+#endif
+
+#if SMOTA_RELIABILITY_TRANSMISSION && (SMOTA_AES_CTX_NUM < SMOTA_INSTANCE_MAX)
+#error "Error: SMOTA_AES_CTX_NUM must be at least SMOTA_INSTANCE_MAX when SMOTA_RELIABILITY_TRANSMISSION is enabled!"
+#endif
+
+/* 当前实例按线程保存时上下文池按实例平分，每个实例至少一个 */
+#if SMOTA_INSTANCE_THREAD_LOCAL && (SMOTA_AES_CTX_NUM < SMOTA_INSTANCE_MAX)
+#error "Error: SMOTA_AES_CTX_NUM must be at least SMOTA_INSTANCE_MAX when SMOTA_INSTANCE_THREAD_LOCAL is enabled!"
+#endif
+
+// 接收队列按掩码取下标
+#if (SMOTA_FEED_BUF_SIZE & (SMOTA_FEED_BUF_SIZE - 1)) != 0
+#error "Error: SMOTA_FEED_BUF_SIZE must be 0 or a power of two!"
+#endif
+
+// 传输加密只能选择一种
+#if SMOTA_RELIABILITY_TRANSMISSION && SMOTA_CHACHA20_POLY1305
+#error "Error: SMOTA_RELIABILITY_TRANSMISSION and SMOTA_CHACHA20_POLY1305 cannot be enabled together!"
+#endif
+
+// 延迟解密依赖 CTR 传输加密和安装拷贝
+#if SMOTA_CTR_DEFERRED && (!SMOTA_RELIABILITY_TRANSMISSION || SMOTA_MODE != 1 || SMOTA_CHUNK_MANIFEST)
+#error "Error: SMOTA_CTR_DEFERRED requires SMOTA_RELIABILITY_TRANSMISSION and SMOTA_MODE 1, without SMOTA_CHUNK_MANIFEST!"
+#endif
+
 /* --- Flash 容量配置校验 --- */
 
 // 单分区模式：App 区结束地址不能超过 Flash 容量
@@ -292,10 +649,62 @@ extern "C" {
 #endif
 #endif
 
+/* --- 外部 NOR Flash 配置校验 --- */
+
+#if (SMOTA_NOR_BLOCK_SIZE % SMOTA_NOR_SECTOR_SIZE) != 0 || (SMOTA_NOR_SECTOR_SIZE % SMOTA_NOR_PAGE_SIZE) != 0
+#error "Error: SMOTA_NOR_BLOCK_SIZE/SECTOR_SIZE/PAGE_SIZE must be multiples of each other!"
+#endif
+
+/* --- 擦除计数配置校验 --- */
+
+// 计数器占用标签 SMOTA_META_TAG_WEAR (0x08) ~ 0x0F，每条记录保存 SMOTA_META_VALUE_MAX / 2 个计数器
+#if SMOTA_WEAR_COUNTER_NUM > (SMOTA_META_VALUE_MAX / 2) * 8
+#error "Error: SMOTA_WEAR_COUNTER_NUM exceeds the metadata tags reserved for erase counters!"
+#endif
+
+#if SMOTA_WEAR_COUNTER_NUM > 0 && SMOTA_META_TAG_MAX <= 0x0F
+#error "Error: SMOTA_META_TAG_MAX must be greater than 0x0F when erase counters are enabled!"
+#endif
+
+/* --- 元数据区配置校验 --- */
+
+#if SMOTA_META_SECTOR_NUM < 2
+#error "Error: SMOTA_META_SECTOR_NUM must be at least 2 for power-safe compaction!"
+#endif
+
+#if (SMOTA_META_ALIGN & (SMOTA_META_ALIGN - 1)) != 0 || SMOTA_META_ALIGN < 4
+#error "Error: SMOTA_META_ALIGN must be a power of two and at least 4!"
+#endif
+
+#if SMOTA_META_VALUE_MAX > 255
+#error "Error: SMOTA_META_VALUE_MAX cannot exceed 255 bytes!"
+#endif
+
+#if (SMOTA_META_ADDR + SMOTA_META_SECTOR_SIZE * SMOTA_META_SECTOR_NUM) > (SMOTA_FLASH_BASE_ADDR + SMOTA_FLASH_SIZE)
+#error "Error: Metadata region exceeds Flash size! Please check SMOTA_META_ADDR."
+#endif
+
+// 元数据区不能与 App 区/备份区重叠
+#if SMOTA_MODE == 2
+#if (SMOTA_FLASH_BASE_ADDR + SMOTA_BOOTLOADER_SIZE + SMOTA_APP_SIZE) > SMOTA_META_ADDR
+#error "Error: Metadata region overlaps the application region! Please reduce SMOTA_APP_SIZE."
+#endif
+#else
+#if (SMOTA_FLASH_BASE_ADDR + SMOTA_BOOTLOADER_SIZE + SMOTA_APP_SIZE * 2) > SMOTA_META_ADDR
+#error "Error: Metadata region overlaps the backup region! Please reduce SMOTA_APP_SIZE."
+#endif
+#endif
+
 /*==============================================================================
  * 11. 辅助宏定义
  *============================================================================*/
 
+/**
+ * @brief 无限等待
+ * @note  smota_poll_deadline() 在除新数据到达外没有需要定时处理的事务时返回此值
+ */
+#define SMOTA_WAIT_FOREVER 0xFFFFFFFFU
+
 /**
  * @brief 字节数对齐宏
  */
@@ -304,16 +713,11 @@ extern "C" {
 
 /**
  * @brief 获取各模式的地址偏移; App 和备份区地址计算
+ * @note  仅用于生成默认分区表（smota_partition_table_default），
+ *        运行时所有地址均通过分区表解析
  */
-#if SMOTA_MODE == 0
-// 双 Bank 模式：App 固定在基地址，硬件自动映射
-#define SMOTA_APP_OFFSET    0
-#define SMOTA_BACKUP_OFFSET SMOTA_BOOTLOADER_SIZE
-#define SMOTA_APP_ADDR      (SMOTA_FLASH_BASE_ADDR + SMOTA_APP_OFFSET)
-#define SMOTA_BACKUP_ADDR   (SMOTA_FLASH_BASE_ADDR + SMOTA_BACKUP_OFFSET)
-
-#elif SMOTA_MODE == 1
-// 双槽位模式：需要偏移 Bootloader 空间
+#if SMOTA_MODE == 0 || SMOTA_MODE == 1
+// 双 Bank / 双槽位模式：Bootloader 之后依次为 App 区和备份区
 #define SMOTA_APP_OFFSET    SMOTA_BOOTLOADER_SIZE
 #define SMOTA_BACKUP_OFFSET (SMOTA_BOOTLOADER_SIZE + SMOTA_APP_SIZE)
 #define SMOTA_APP_ADDR      (SMOTA_FLASH_BASE_ADDR + SMOTA_APP_OFFSET)
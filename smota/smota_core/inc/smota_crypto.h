@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_crypto.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 22:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 22:00:00
+ * @Brief        : smOTA 固件来源校验（ECDSA 签名）
+ * @details      签名在 HEADER_INFO 阶段、擦除 Flash 之前校验。签名不直接覆盖整包哈希，
+ *              而是覆盖头部摘要，把握手中声明的大小和版本一并绑定：
+ *
+ *              - 摘要 = H(sha256_hash || firmware_size(LE32) || major || minor || patch || 附加信息)
+ *              - 附加信息为 HEADER_INFO 中跟在签名之后的原始字节（分片信息、哈希算法），
+ *                未开启对应能力时为空
+ *              - H 为本次会话协商的内容哈希（SHA-256 或 BLAKE2s-256）
+ *
+ *              未签名或非本项目私钥签发的固件在一个往返内被拒绝；签名通过后，
+ *              传输完成时只需比较流式计算的整包哈希与已签名的 sha256_hash。
+ *              公钥由用户实现的 smota_get_key() 提供。
+ */
+
+#ifndef SMOTA_CRYPTO_H
+#define SMOTA_CRYPTO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* 密钥 ID（smota_get_key） */
+#define SMOTA_KEY_AES_MASTER 0 /* AES-128 主密钥，16 字节 */
+#define SMOTA_KEY_ECDSA_PUB  1 /* ECDSA-P256 公钥，64 字节 x || y */
+#define SMOTA_KEY_AES_DEVICE 2 /* AES-128 设备传输密钥，16 字节（由主密钥和 UID 派生） */
+
+/* ECDSA-P256 公钥长度 */
+#define SMOTA_ECDSA_PUB_KEY_SIZE 64
+
+/*---------- type define ----------*/
+
+struct smota_header_info_req;
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief       获取密钥（用户实现）
+ * @param[in]   key_id: 密钥 ID SMOTA_KEY_*
+ * @param[out]  out_key: 输出缓冲区
+ * @param[in]   len: 缓冲区长度
+ * @note        可由 scripts/keygen.py --c-file 生成，见 doc/3.key-management.md
+ */
+void smota_get_key(uint8_t key_id, uint8_t *out_key, uint32_t len);
+
+/**
+ * @brief       计算头部签名摘要
+ * @param[in]   image_hash: 整包 SHA-256（HEADER_INFO 的 sha256_hash）
+ * @param[in]   image_size: 固件大小（握手声明）
+ * @param[in]   version: 固件版本 major/minor/patch（握手声明）
+ * @param[in]   trailer: HEADER_INFO 附加信息，trailer_len=0 时可为 NULL
+ * @param[in]   trailer_len: 附加信息长度
+ * @param[out]  digest: 输出摘要（32字节）
+ * @return      0=成功, <0=失败
+ * @note        按 smota_hash_current() 的算法计算
+ */
+int smota_crypto_header_digest(const uint8_t image_hash[32], uint32_t image_size, const uint8_t version[3],
+                               const uint8_t *trailer, uint32_t trailer_len, uint8_t digest[32]);
+
+/**
+ * @brief       校验头部签名
+ * @param[in]   req: 头部信息请求（sha256_hash、signature_r、signature_s，其后紧跟附加信息）
+ * @param[in]   image_size: 固件大小（握手声明）
+ * @param[in]   version: 固件版本 major/minor/patch（握手声明）
+ * @param[in]   trailer_len: 附加信息长度（SMOTA_HEADER_TRAILER_LEN）
+ * @return      0=签名有效, -1=未开启 SMOTA_RELIABILITY_SOURCE 或 HAL 未提供 ecdsa_verify,
+ *              -2=摘要计算失败, -3=签名无效
+ * @note        在擦除下载分区之前、选定哈希算法之后调用
+ */
+int smota_crypto_verify_header(const struct smota_header_info_req *req, uint32_t image_size,
+                               const uint8_t version[3], uint32_t trailer_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_CRYPTO_H
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_ctr.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 23:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 23:00:00
+ * @Brief        : smOTA 传输解密（AES-128-CTR 密钥流预取）
+ * @details      开启 SMOTA_RELIABILITY_TRANSMISSION 时整个固件按一条 CTR 密钥流加密：
+ *
+ *              - 计数块 = sha256_hash[0..11] || 块号(BE32)，块号 = offset / 16
+ *              - 密钥   = smota_get_key(SMOTA_KEY_AES_DEVICE)，一机一密
+ *
+ *              密钥流只取决于计数器，与密文无关。本模块维护一个密钥流窗口，
+ *              smota_poll() 在等待下一帧的空闲周期调用 smota_ctr_prefetch()，
+ *              从期望偏移开始把窗口填满；数据块到达时解密只剩按字异或，
+ *              不再在应答之前做 AES 运算。窗口未覆盖的偏移（重传、续传）当场生成。
+ *              需开启 SMOTA_RELIABILITY_TRANSMISSION，否则会话接口返回失败且不占用 RAM。
+ */
+
+#ifndef SMOTA_CTR_H
+#define SMOTA_CTR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* CTR 计数块中取自整包哈希的前缀长度 */
+#define SMOTA_CTR_NONCE_SIZE 12
+
+/*---------- type define ----------*/
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief       开始新的解密会话
+ * @param[in]   nonce: 计数块前缀（整包哈希前 12 字节）
+ * @return      0=成功, -1=参数无效, -2=AES 上下文初始化失败, -3=未开启 SMOTA_RELIABILITY_TRANSMISSION
+ * @note        放弃上一次会话未结束的密钥流；密钥用后即清零，只保留在 AES 上下文中
+ */
+int smota_ctr_begin(const uint8_t nonce[SMOTA_CTR_NONCE_SIZE]);
+
+/**
+ * @brief       在空闲时预取密钥流
+ * @param[in]   offset: 下一个数据块的期望偏移
+ * @return      从 offset 起已就绪的密钥流字节数, <0=会话未开始或生成失败
+ * @note        窗口已从 offset 起填满时直接返回；否则丢弃 offset 之前的部分并补满，
+ *              一次最多生成 SMOTA_CTR_PREFETCH_SIZE 字节
+ */
+int smota_ctr_prefetch(uint32_t offset);
+
+/**
+ * @brief       获取从 offset 起已就绪的密钥流字节数
+ * @param[in]   offset: 固件内偏移
+ * @return      字节数，0=未预取或会话未开始
+ */
+uint32_t smota_ctr_ready(uint32_t offset);
+
+/**
+ * @brief       解密（或加密）固件数据
+ * @param[in]   offset: 数据在固件中的偏移（任意对齐）
+ * @param[in]   input: 输入数据
+ * @param[out]  output: 输出数据（可与 input 相同）
+ * @param[in]   size: 长度
+ * @return      0=成功, -1=会话未开始或参数无效, -2=密钥流生成失败
+ * @note        优先使用窗口中的密钥流，未覆盖的部分当场生成
+ */
+int smota_ctr_crypt(uint32_t offset, const uint8_t *input, uint8_t *output, uint32_t size);
+
+/**
+ * @brief       结束解密会话，清零密钥流并归还 AES 上下文
+ */
+void smota_ctr_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_CTR_H
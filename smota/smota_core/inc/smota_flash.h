@@ -33,10 +33,25 @@ extern "C" {
  * @param[in]   src: 源数据指针
  * @param[in]   size: 写入大小
  * @return      实际写入字节数, <0=失败
- * @note        自动处理跨页写入
+ * @note        自动处理跨页写入；按分区编程单元合并写入，不足一个单元的尾部暂存在 RAM 中
  */
 int smota_flash_write_backup(const uint8_t *src, uint32_t size);
 
+/**
+ * @brief       将写合并缓冲区中的剩余数据写入备份区
+ * @return      0=成功, <0=失败
+ * @note        最后一个数据块写入后调用，之后才能从 Flash 读回完整固件
+ */
+int smota_flash_flush_backup(void);
+
+/**
+ * @brief       回退备份区写入位置
+ * @param[in]   offset: 新的写入位置（须对齐到擦除单元且不超过当前写入位置）
+ * @return      0=成功, <0=失败
+ * @note        用于分片校验失败后从分片起始重写，回退范围在重新写入时重新擦除
+ */
+int smota_flash_rewind_backup(uint32_t offset);
+
 /**
  * @brief       擦除备份区
  * @param[in]   size: 擦除大小
@@ -47,11 +62,11 @@ int smota_flash_erase_backup(uint32_t size);
 
 /**
  * @brief       固件拷贝（双槽位模式）
- * @param[in]   src_addr: 源地址（备份区）
+ * @param[in]   src_addr: 源地址（备份区，所在设备的地址）
  * @param[in]   dst_addr: 目标地址（应用区）
  * @param[in]   size: 拷贝大小
- * @return      0=成功, <0=失败
- * @note        边拷贝边校验
+ * @return      0=成功, <0=失败（-4=延迟解密记录无效或解密失败, -5=解密后的明文哈希不符）
+ * @note        边拷贝边校验；开启 SMOTA_CTR_DEFERRED 时备份区为密文，拷贝时解密并校验明文哈希
  */
 int smota_flash_copy_firmware(uint32_t src_addr, uint32_t dst_addr, uint32_t size);
 
@@ -71,7 +86,7 @@ int smota_flash_write_version(const uint8_t version[3]);
 
 /**
  * @brief       检查 Flash 是否为空（全部为 0xFF）
- * @param[in]   addr: 起始地址
+ * @param[in]   addr: 起始地址（片内 Flash）
  * @param[in]   size: 检查大小
  * @return      true=空, false=非空
  */
@@ -79,7 +94,7 @@ bool smota_flash_is_erased(uint32_t addr, uint32_t size);
 
 /**
  * @brief       获取备份区起始地址
- * @return      备份区起始地址
+ * @return      备份区起始地址（备份区所在设备的地址）
  */
 uint32_t smota_flash_backup_addr(void);
 
@@ -95,6 +110,12 @@ uint32_t smota_flash_app_addr(void);
  */
 uint32_t smota_flash_backup_size(void);
 
+/**
+ * @brief       获取备份区擦除单元大小
+ * @return      擦除单元大小
+ */
+uint32_t smota_flash_backup_erase_size(void);
+
 /**
  * @brief       获取应用区大小
  * @return      应用区大小
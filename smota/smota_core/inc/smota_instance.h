@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_instance.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 23:30:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 23:30:00
+ * @Brief        : smOTA 多实例
+ * @details      网关同时向多个下游节点升级时，每个节点对应一个 struct smota_instance：
+ *
+ *              - 实例句柄本身持有 HAL 绑定、升级上下文、错误码、接收缓冲区和中断推送队列，
+ *                由调用者分配（静态数组或堆）
+ *              - 其余模块的会话状态（分区表、元数据、擦除计数、Flash 写入上下文、整包哈希、
+ *                分片表、CTR 密钥流、内容哈希算法、统计）按实例槽位保存在各模块的静态数组中，
+ *                槽位数为 SMOTA_INSTANCE_MAX，槽位 0 固定给默认实例
+ *
+ *              smota_instance_*() 接口进入时把实例设为当前实例，返回前恢复；模块内部通过
+ *              smota_instance_current() 和 SMOTA_INSTANCE_SLOT() 找到自己的状态，接口不变。
+ *              smota_init()/smota_poll() 等原有接口操作默认实例。
+ *
+ *              默认（SMOTA_INSTANCE_THREAD_LOCAL=0）当前实例是一个全局指针：任何线程调用任何 smota 接口
+ *              都会切换它，所以所有接口须在同一线程中调用（或由调用者加锁串行），一个事件循环即可轮流
+ *              驱动所有会话；此时实例数大于 1 的工程不能使用 smota_task（smota_task_start() 返回 -5）。
+ *              SMOTA_INSTANCE_THREAD_LOCAL=1 时当前实例按线程保存，每个线程（如每个实例一个 smota_task）
+ *              驱动各自的实例，上下文池按实例平分；实例的 init/deinit 仍须串行。
+ *              smota_instance_feed() 不切换当前实例，可在中断中调用。
+ *              SHA-256/AES 上下文池见 SMOTA_SHA256_CTX_NUM。
+ */
+
+#ifndef SMOTA_INSTANCE_H
+#define SMOTA_INSTANCE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "smota_types.h"
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* 接收缓冲区大小 */
+#define SMOTA_RECV_BUFFER_SIZE 1024
+
+/* 当前实例的模块状态槽位；只有一个实例时为常量 0，不增加开销 */
+#if SMOTA_INSTANCE_MAX > 1
+#define SMOTA_INSTANCE_SLOT() (smota_instance_current()->slot)
+#else
+#define SMOTA_INSTANCE_SLOT() 0
+#endif
+
+/*---------- type define ----------*/
+
+struct smota_hal;
+
+#if SMOTA_FEED_BUF_SIZE > 0
+/**
+ * @brief  中断推送接收队列（单生产者单消费者，无锁）
+ * @note   head 只由 smota_feed() 写，tail 只由 smota_poll() 写；下标自由递增，按掩码取模
+ */
+struct smota_feed_queue {
+    uint8_t buf[SMOTA_FEED_BUF_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+};
+#endif
+
+/**
+ * @brief  OTA 实例
+ * @note   字段由核心维护，调用者只负责分配并清零；初始化后不得移动（模块槽位按地址登记）
+ */
+struct smota_instance {
+    const struct smota_hal *hal;                 /* HAL 绑定 */
+    struct smota_ctx ctx;                        /* 升级上下文 */
+    smota_err_t last_error;                      /* 最近一次错误码 */
+    bool initialized;                            /* 已初始化 */
+    uint8_t slot;                                /* 模块状态槽位 */
+    uint8_t recv_buffer[SMOTA_RECV_BUFFER_SIZE]; /* 接收缓冲区 */
+#if SMOTA_FEED_BUF_SIZE > 0
+    struct smota_feed_queue feed;                /* 中断推送队列 */
+#endif
+};
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief       获取默认实例（原有单实例接口使用）
+ * @return      默认实例
+ */
+struct smota_instance *smota_instance_default(void);
+
+/**
+ * @brief       获取当前实例
+ * @return      当前实例，未进入任何实例时为默认实例
+ * @note        SMOTA_INSTANCE_THREAD_LOCAL=1 时为调用线程的当前实例
+ */
+struct smota_instance *smota_instance_current(void);
+
+/**
+ * @brief       为实例分配模块状态槽位
+ * @param[in]   inst: 实例
+ * @return      槽位号, -1=参数无效, -2=槽位已用完（增大 SMOTA_INSTANCE_MAX）
+ * @note        已分配时返回原槽位；默认实例固定为槽位 0
+ */
+int smota_instance_attach(struct smota_instance *inst);
+
+/**
+ * @brief       释放实例的模块状态槽位
+ * @param[in]   inst: 实例
+ * @note        默认实例的槽位不释放
+ */
+void smota_instance_detach(struct smota_instance *inst);
+
+/**
+ * @brief       进入实例：设为当前实例
+ * @param[in]   inst: 实例
+ * @return      进入前的当前实例，离开时传给 smota_instance_leave()
+ */
+struct smota_instance *smota_instance_enter(struct smota_instance *inst);
+
+/**
+ * @brief       离开实例：恢复进入前的当前实例
+ * @param[in]   prev: smota_instance_enter() 的返回值
+ */
+void smota_instance_leave(struct smota_instance *prev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_INSTANCE_H
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_meta.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 09:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 09:00:00
+ * @Brief        : smOTA 元数据存储（追加写日志结构）
+ * @details      在独立扇区中以 TLV 记录追加写入版本号、启动标志、暂存位置、擦除计数和用户记录，
+ *              每条记录带序号和 CRC16，更新时无需擦除整页。
+ *              初始化时扫描扇区建立 RAM 索引，读取为 O(1)。
+ *
+ *              扇区布局（元数据分区按 SMOTA_META_SECTOR_SIZE 划分扇区，轮流使用）：
+ *              +----------------------+ offset 0
+ *              | 扇区头 magic + 代数   |
+ *              +----------------------+ SMOTA_META_ALIGN
+ *              | 记录 0               |
+ *              | 记录 1               |
+ *              | ...                  |
+ *              | 0xFF (未写入)         |
+ *              +----------------------+ SMOTA_META_SECTOR_SIZE
+ *
+ *              当前扇区写满后，将每个标签的最新记录搬移到下一个扇区（整理），
+ *              最后写入新扇区头，掉电时旧扇区仍然有效。
+ */
+
+#ifndef SMOTA_META_H
+#define SMOTA_META_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "smota_types.h"
+
+/*---------- macro ----------*/
+
+/* 扇区头魔数 "sMDT" */
+#define SMOTA_META_MAGIC              0x54444D73U
+
+/* 记录标签定义（0x00 与 0xFF 保留） */
+#define SMOTA_META_TAG_VERSION        0x01 /* 当前固件版本 [major, minor, patch] */
+#define SMOTA_META_TAG_BOOT_FLAGS     0x02 /* 启动确认标志 (uint32_t) */
+/* 0x03 ~ 0x05 保留 */
+#define SMOTA_META_TAG_STAGE          0x06 /* 下载区暂存位置 (struct smota_meta_stage) */
+#define SMOTA_META_TAG_IMAGE          0x07 /* 暂存固件的明文哈希 (struct smota_meta_image) */
+#define SMOTA_META_TAG_WEAR           0x08 /* 下载区擦除计数起始标签，占用 0x08 ~ 0x0F (uint16_t[]) */
+#define SMOTA_META_TAG_USER           0x10 /* 用户自定义标签起始值 */
+
+/* 启动确认标志位 */
+#define SMOTA_BOOT_FLAG_INSTALL_PENDING (1U << 0) /* bit0: 新固件待 Bootloader 安装 */
+
+/*---------- type define ----------*/
+
+/**
+ * @brief  下载区暂存位置
+ * @note   开启 SMOTA_WEAR_ROTATE 时每次升级的暂存起始偏移不同，
+ *         Bootloader 通过该记录找到待安装的固件
+ */
+struct smota_meta_stage {
+    uint32_t offset; /* 暂存起始偏移（相对下载分区） */
+    uint32_t size;   /* 暂存占用大小（按擦除单元对齐） */
+};
+
+/**
+ * @brief  暂存固件的明文哈希
+ * @note   开启 SMOTA_CTR_DEFERRED 时暂存区保存密文，传输完成时记录，
+ *         安装拷贝据此生成 CTR 密钥流并校验解密后的明文
+ */
+struct smota_meta_image {
+    uint8_t hash[32];  /* 整包明文哈希（HEADER_INFO 的 sha256_hash，已签名） */
+    uint8_t hash_alg;  /* 内容哈希算法 SMOTA_HASH_ALG_* */
+    uint8_t reserved[3];
+    uint32_t size;     /* 固件大小 */
+};
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief       初始化元数据存储
+ * @return      0=成功, <0=失败
+ * @note        扫描元数据扇区建立 RAM 索引；若没有有效扇区则自动格式化
+ */
+int smota_meta_init(void);
+
+/**
+ * @brief       格式化元数据存储（擦除所有扇区并写入新扇区头）
+ * @return      0=成功, <0=失败
+ */
+int smota_meta_format(void);
+
+/**
+ * @brief       读取标签对应的最新记录
+ * @param[in]   tag: 记录标签
+ * @param[out]  buf: 输出缓冲区
+ * @param[in]   size: 缓冲区大小
+ * @return      实际记录长度, <0=失败（-3 表示记录不存在）
+ * @note        通过 RAM 索引直接定位记录地址，无需扫描
+ */
+int smota_meta_read(uint8_t tag, void *buf, uint8_t size);
+
+/**
+ * @brief       追加写入标签记录
+ * @param[in]   tag: 记录标签
+ * @param[in]   value: 记录内容
+ * @param[in]   len: 记录长度（不超过 SMOTA_META_VALUE_MAX）
+ * @return      0=成功, <0=失败
+ * @note        与最新记录内容相同时不会重复写入；扇区写满时自动整理
+ */
+int smota_meta_write(uint8_t tag, const void *value, uint8_t len);
+
+/**
+ * @brief       检查标签是否存在有效记录
+ * @param[in]   tag: 记录标签
+ * @return      true=存在, false=不存在
+ */
+bool smota_meta_exists(uint8_t tag);
+
+/**
+ * @brief       计数器加一
+ * @param[in]   tag: 计数器标签（记录内容为 uint32_t）
+ * @param[out]  value: 输出加一后的值，可为 NULL
+ * @return      0=成功, <0=失败
+ */
+int smota_meta_counter_inc(uint8_t tag, uint32_t *value);
+
+/**
+ * @brief       设置启动标志位
+ * @param[in]   set_mask: 需要置位的标志
+ * @param[in]   clear_mask: 需要清除的标志
+ * @return      0=成功, <0=失败
+ */
+int smota_meta_boot_flags_update(uint32_t set_mask, uint32_t clear_mask);
+
+/**
+ * @brief       获取启动标志
+ * @return      启动标志，无记录时返回 0
+ */
+uint32_t smota_meta_boot_flags_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_META_H
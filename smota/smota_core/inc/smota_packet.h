@@ -19,6 +19,7 @@ extern "C" {
 #include <stdint.h>
 #include <stddef.h>
 #include "smota_types.h"
+#include "smota_config.h"
 
 /*---------- macro ----------*/
 /* smFrame 帏起始符 */
@@ -35,6 +36,8 @@ extern "C" {
 #define SMOTA_CMD_DATA_COMPLETE        0x04 /* 数据包传输完毕 */
 #define SMOTA_CMD_INSTALL              0x05 /* 触发安装请求 */
 #define SMOTA_CMD_ACTIVATE_CHECK       0x06 /* 状态确认请求 */
+#define SMOTA_CMD_DIAG_QUERY           0x07 /* 诊断查询（任意状态可用） */
+#define SMOTA_CMD_CHUNK_MANIFEST       0x08 /* 下发分片哈希清单 */
 
 /* 应答标志位 (D7置位) */
 #define SMOTA_CMD_RESPONSE_FLAG        0x80
@@ -46,6 +49,8 @@ extern "C" {
 #define SMOTA_CMD_DATA_COMPLETE_RESP   (SMOTA_CMD_DATA_COMPLETE | SMOTA_CMD_RESPONSE_FLAG)
 #define SMOTA_CMD_INSTALL_RESP         (SMOTA_CMD_INSTALL | SMOTA_CMD_RESPONSE_FLAG)
 #define SMOTA_CMD_ACTIVATE_CHECK_RESP  (SMOTA_CMD_ACTIVATE_CHECK | SMOTA_CMD_RESPONSE_FLAG)
+#define SMOTA_CMD_DIAG_QUERY_RESP      (SMOTA_CMD_DIAG_QUERY | SMOTA_CMD_RESPONSE_FLAG)
+#define SMOTA_CMD_CHUNK_MANIFEST_RESP  (SMOTA_CMD_CHUNK_MANIFEST | SMOTA_CMD_RESPONSE_FLAG)
 
 /* 通用错误码定义 (uint32_t bit位) */
 #define SMOTA_ERR_PROTOCOL_MISMATCH    (1U << 0)  /* bit0: 协议版本不匹配 */
@@ -54,23 +59,50 @@ extern "C" {
 #define SMOTA_ERR_FLASH_INSUFFICIENT   (1U << 3)  /* bit3: Flash空间不足 */
 #define SMOTA_ERR_DATA_AES             (1U << 8)  /* bit8: AES解密错误 */
 #define SMOTA_ERR_FLASH_WRITE          (1U << 9)  /* bit9: FLASH写入错误 */
+#define SMOTA_ERR_DATA_BLOCK           (1U << 10) /* bit10: 数据块损坏（长度不符或认证标签错误），需重发 */
+#define SMOTA_ERR_CHUNK_MANIFEST       (1U << 11) /* bit11: 分片清单无效或与 Merkle 根不符 */
+#define SMOTA_ERR_CHUNK_HASH           (1U << 12) /* bit12: 分片哈希不符，从 received_offset 重发该分片 */
 #define SMOTA_ERR_VERIFY_SHA256_FAILED (1U << 17) /* bit17: SHA256校验不匹配 */
 #define SMOTA_ERR_VERIFY_SIGN_FAILED   (1U << 18) /* bit18: ECDSA签名验证未通过 */
 #define SMOTA_ERR_INSTALL_FLASH_READ   (1U << 19) /* bit19: 从下载区读取数据失败 */
 #define SMOTA_ERR_INSTALL_LOW_BATTERY  (1U << 20) /* bit20: 电池电量过低 */
 #define SMOTA_ERR_INSTALL_BUSY         (1U << 21) /* bit21: 设备处于关键业务状态 */
 #define SMOTA_ERR_INSTALL_VERSION_OLD  (1U << 22) /* bit22: 安装后版本号未更新 */
+#define SMOTA_ERR_DIAG_UNSUPPORTED     (1U << 23) /* bit23: 诊断项不支持 */
 
 /* 设备能力标志位 */
 #define SMOTA_CAP_SIGNATURE            (1U << 0) /* bit0: 支持ECDSA签名验证 */
 #define SMOTA_CAP_ENCRYPT              (1U << 1) /* bit1: 支持AES解密 */
 #define SMOTA_CAP_ANTI_ROLLBACK        (1U << 2) /* bit2: 支持防回滚 */
+#define SMOTA_CAP_BLOCK_AUTH           (1U << 3) /* bit3: 数据块携带认证标签 */
+#define SMOTA_CAP_CHUNK_MANIFEST       (1U << 4) /* bit4: 按分片清单逐片校验 */
+#define SMOTA_CAP_HASH_BLAKE2S         (1U << 5) /* bit5: 内容哈希可选 BLAKE2s-256 */
+#define SMOTA_CAP_CHACHA20_POLY1305    (1U << 6) /* bit6: 数据块 ChaCha20-Poly1305 加密 */
+#define SMOTA_CAP_DEFERRED_DECRYPT     (1U << 7) /* bit7: 密文暂存，安装拷贝时解密 */
 
 /* 分片控制字段定义 */
 #define SMOTA_FRAG_EN_MASK             0x80 /* bit7: 分片使能标志 */
 #define SMOTA_FRAG_MORE_MASK           0x40 /* bit6: 后续分片标志 */
 #define SMOTA_FRAG_TOTAL_MASK          0x3F /* bit5-0: 分片总数 */
 
+/* 数据块认证标签长度（SMOTA_CAP_BLOCK_AUTH / SMOTA_CAP_CHACHA20_POLY1305） */
+#define SMOTA_BLOCK_TAG_SIZE           16
+
+/* 数据块 AEAD 随机数中取自整包哈希的前缀长度（SMOTA_CAP_CHACHA20_POLY1305） */
+#define SMOTA_AEAD_NONCE_PREFIX_SIZE   8
+
+/* 分片哈希长度（SMOTA_CAP_CHUNK_MANIFEST） */
+#define SMOTA_CHUNK_HASH_SIZE          32
+
+/* 诊断查询项 */
+#define SMOTA_DIAG_WEAR                0x01 /* 下载区擦除计数 (struct smota_diag_wear) */
+
+/* 诊断应答数据区最大长度 */
+#define SMOTA_DIAG_DATA_MAX            128
+
+/* 单次诊断应答携带的擦除计数器数量 */
+#define SMOTA_DIAG_WEAR_COUNTS         32
+
 /*---------- type define ----------*/
 
 #pragma pack(push, 1)
@@ -135,6 +167,25 @@ struct smota_header_info_req {
     uint8_t signature_s[32]; /* ECDSA签名s分量 */
 };
 
+/**
+ * @brief  分片信息 (SMOTA_CAP_CHUNK_MANIFEST)
+ * @note   设备声明 SMOTA_CAP_CHUNK_MANIFEST 时紧跟在 struct smota_header_info_req 之后；
+ *         签名的头部摘要在末尾追加 chunk_size(LE32) || chunk_root，见 smota_crypto_header_digest()
+ */
+struct smota_header_chunk_info {
+    uint32_t chunk_size;     /* 分片大小，须为下载分区擦除单元的整数倍 */
+    uint8_t chunk_root[32];  /* 分片哈希的 Merkle 根 */
+};
+
+/**
+ * @brief  内容哈希算法 (SMOTA_CAP_HASH_BLAKE2S)
+ * @note   设备声明 SMOTA_CAP_HASH_BLAKE2S 时放在 HEADER_INFO 末尾（分片信息之后）；
+ *         sha256_hash、分片哈希和签名摘要均按所选算法计算，签名同时覆盖本字段
+ */
+struct smota_header_hash_info {
+    uint8_t hash_alg;        /* SMOTA_HASH_ALG_SHA256 / SMOTA_HASH_ALG_BLAKE2S */
+};
+
 /**
  * @brief  固件头部信息应答 (Device -> Server, 0x82)
  */
@@ -144,6 +195,10 @@ struct smota_header_info_resp {
 
 /**
  * @brief  数据块传输请求 (Server -> Device, 0x03)
+ * @note   设备声明 SMOTA_CAP_BLOCK_AUTH 时，data 之后紧跟 SMOTA_BLOCK_TAG_SIZE 字节认证标签：
+ *         tag = MAC(offset || length || data)，offset/length 按本结构的小端字节序参与计算。
+ *         设备声明 SMOTA_CAP_CHACHA20_POLY1305 时 data 为密文，标签改为 Poly1305 标签：
+ *         nonce = sha256_hash[0..7] || offset，AAD = offset || length（见 smota_aead_decrypt_block()）
  */
 struct smota_data_block_req {
     uint32_t offset; /* 在固件中的字节偏移 */
@@ -166,6 +221,15 @@ struct smota_transfer_complete_req {
     uint32_t total_size; /* 再次确认总大小，防止漏包 */
 };
 
+/**
+ * @brief  密文整包哈希 (SMOTA_CAP_DEFERRED_DECRYPT)
+ * @note   紧跟在 struct smota_transfer_complete_req 之后；暂存区保存密文，
+ *         传输完成时按协商的内容哈希算法与流式计算的密文哈希比较，明文哈希在安装拷贝时校验
+ */
+struct smota_complete_cipher_info {
+    uint8_t cipher_hash[32]; /* 上位机发送的密文的整包哈希 */
+};
+
 /**
  * @brief  传输完成应答 (Device -> Server, 0x84)
  */
@@ -206,8 +270,86 @@ struct smota_activate_check_resp {
     uint8_t fw_version_patch; /* 当前运行的补丁版本号 */
 };
 
+/**
+ * @brief  诊断查询请求 (Server -> Device, 0x07)
+ */
+struct smota_diag_req {
+    uint8_t item;   /* 诊断项 SMOTA_DIAG_xxx */
+    uint16_t index; /* 分页起始编号（擦除计数为计数器编号） */
+};
+
+/**
+ * @brief  诊断查询应答 (Device -> Server, 0x87)
+ * @note   只发送 data 中前 length 字节
+ */
+struct smota_diag_resp {
+    uint32_t error_code;                /* 0=成功, bit23=诊断项不支持 */
+    uint8_t item;                       /* 诊断项 */
+    uint16_t index;                     /* 分页起始编号 */
+    uint16_t length;                    /* data 有效长度 */
+    uint8_t data[SMOTA_DIAG_DATA_MAX];  /* 诊断数据 */
+};
+
+/**
+ * @brief  分片哈希清单请求 (Server -> Device, 0x08)
+ * @note   hash 为 count 个 SMOTA_CHUNK_HASH_SIZE 字节的分片哈希，按分片编号顺序分页发送；
+ *         index 须等于设备已收到的分片哈希数
+ */
+struct smota_chunk_manifest_req {
+    uint16_t index;  /* 本页第一个分片编号 */
+    uint8_t count;   /* 本页分片哈希数量 */
+    uint8_t hash[0]; /* 分片哈希 */
+};
+
+/**
+ * @brief  分片哈希清单应答 (Device -> Server, 0x88)
+ */
+struct smota_chunk_manifest_resp {
+    uint32_t error_code; /* 0=成功, bit11=清单无效或与 Merkle 根不符（已清空，从 0 重发） */
+    uint16_t received;   /* 设备已收到的分片哈希数，即下一页的 index */
+    uint16_t total;      /* 分片总数 */
+};
+
+/**
+ * @brief  下载区擦除计数诊断数据 (SMOTA_DIAG_WEAR)
+ * @note   counts 只发送前 count 个；counter_num 超过 SMOTA_DIAG_WEAR_COUNTS 时
+ *         上位机按 index 分页查询
+ */
+struct smota_diag_wear {
+    uint32_t erase_size;                       /* 下载分区擦除单元大小 */
+    uint16_t unit_num;                         /* 擦除单元数量 */
+    uint16_t unit_per_counter;                 /* 每个计数器覆盖的擦除单元数 */
+    uint16_t counter_num;                      /* 计数器总数 */
+    uint16_t min_count;                        /* 最小擦除次数 */
+    uint16_t max_count;                        /* 最大擦除次数 */
+    uint16_t count;                            /* 本页计数器数量 */
+    uint32_t stage_offset;                     /* 当前暂存起始偏移 */
+    uint32_t stage_size;                       /* 当前暂存占用大小 */
+    uint16_t counts[SMOTA_DIAG_WEAR_COUNTS];   /* 擦除计数，从 index 开始 */
+};
+
 #pragma pack(pop)
 
+/* HEADER_INFO 附加信息长度：按能力位依次跟在 struct smota_header_info_req 之后，由签名覆盖 */
+#if SMOTA_CHUNK_MANIFEST
+#define SMOTA_HEADER_CHUNK_INFO_LEN    sizeof(struct smota_header_chunk_info)
+#else
+#define SMOTA_HEADER_CHUNK_INFO_LEN    0U
+#endif
+#if SMOTA_HASH_BLAKE2S
+#define SMOTA_HEADER_HASH_INFO_LEN     sizeof(struct smota_header_hash_info)
+#else
+#define SMOTA_HEADER_HASH_INFO_LEN     0U
+#endif
+#define SMOTA_HEADER_TRAILER_LEN       (SMOTA_HEADER_CHUNK_INFO_LEN + SMOTA_HEADER_HASH_INFO_LEN)
+
+/* DATA_COMPLETE 附加信息长度：跟在 struct smota_transfer_complete_req 之后 */
+#if SMOTA_CTR_DEFERRED
+#define SMOTA_COMPLETE_TRAILER_LEN     sizeof(struct smota_complete_cipher_info)
+#else
+#define SMOTA_COMPLETE_TRAILER_LEN     0U
+#endif
+
 /*---------- variable prototype ----------*/
 
 /*---------- function prototype ----------*/
@@ -270,6 +412,7 @@ smota_err_t smota_handle_handshake_req(const struct smota_handshake_req *req,
  * @param[in]   req: 头部信息请求结构体
  * @param[out]  resp: 头部信息响应结构体
  * @return      smota_err_t 错误码
+ * @note        req 后紧跟 SMOTA_HEADER_TRAILER_LEN 字节附加信息（分片信息、哈希算法），由调用者保证负载长度足够
  */
 smota_err_t smota_handle_header_info_req(const struct smota_header_info_req *req,
                                           struct smota_header_info_resp *resp);
@@ -312,6 +455,25 @@ smota_err_t smota_handle_install_req(const struct smota_install_req *req,
 smota_err_t smota_handle_activate_check_req(const struct smota_activate_check_req *req,
                                              struct smota_activate_check_resp *resp);
 
+/**
+ * @brief  处理诊断查询请求 (0x07)
+ * @param[in]   req: 诊断查询请求结构体
+ * @param[out]  resp: 诊断查询响应结构体
+ * @return      smota_err_t 错误码
+ * @note        不改变状态机，任意状态下可用
+ */
+smota_err_t smota_handle_diag_query_req(const struct smota_diag_req *req,
+                                         struct smota_diag_resp *resp);
+
+/**
+ * @brief  处理分片哈希清单请求 (0x08)
+ * @param[in]   req: 清单请求结构体（hash 中有 count 个分片哈希，由调用者保证负载长度足够）
+ * @param[out]  resp: 清单响应结构体
+ * @return      smota_err_t 错误码，SMOTA_ERR_CRC=清单与 Merkle 根不符（应答 NACK）
+ */
+smota_err_t smota_handle_chunk_manifest_req(const struct smota_chunk_manifest_req *req,
+                                             struct smota_chunk_manifest_resp *resp);
+
 /*---------- end of file ----------*/
 
 #ifdef __cplusplus
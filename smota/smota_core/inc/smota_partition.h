@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_partition.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 10:30:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 10:30:00
+ * @Brief        : smOTA 运行时分区表
+ * @details      以命名分区描述 Bootloader/App/备份区/元数据区的位置、所在存储设备、
+ *              大小和擦写粒度。分区表在 smota_init() 时读取并校验：
+ *              - HAL 注册了分区表（struct smota_hal::partitions）时使用该表，
+ *                可由移植层根据实际 Flash 容量在运行时生成，或指向 Flash 中的常量表
+ *              - 未注册时根据 smota_config.h 中的布局宏生成默认分区表
+ *              所有 Flash 操作都通过分区解析地址，同一 Bootloader 可适配不同容量的板卡。
+ */
+
+#ifndef SMOTA_PARTITION_H
+#define SMOTA_PARTITION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "smota_types.h"
+
+/*---------- macro ----------*/
+
+/* 分区表魔数 "sPTB" */
+#define SMOTA_PART_TABLE_MAGIC   0x42545073U
+
+/* 分区表格式版本 */
+#define SMOTA_PART_TABLE_VER     0x01
+
+/* 分区表最大分区数 */
+#define SMOTA_PART_MAX           8
+
+/* 分区名最大长度（含结束符） */
+#define SMOTA_PART_NAME_MAX      8
+
+/* 分区 ID 定义 */
+#define SMOTA_PART_ID_BOOTLOADER 0x00 /* Bootloader */
+#define SMOTA_PART_ID_APP        0x01 /* 应用程序区（运行区） */
+#define SMOTA_PART_ID_BACKUP     0x02 /* 备份区（下载区） */
+#define SMOTA_PART_ID_META       0x03 /* 元数据区 */
+#define SMOTA_PART_ID_USER       0x10 /* 用户自定义分区起始值 */
+
+/* 分区属性标志位 */
+#define SMOTA_PART_FLAG_READONLY (1U << 0) /* bit0: 只读分区（OTA 不会擦写） */
+
+/*---------- type define ----------*/
+
+struct smota_flash_driver;
+
+#pragma pack(push, 1)
+
+/**
+ * @brief  分区描述
+ */
+struct smota_partition {
+    char name[SMOTA_PART_NAME_MAX]; /* 分区名，如 "app" */
+    uint8_t id;                     /* 分区 ID (SMOTA_PART_ID_*) */
+    uint8_t dev;                    /* 所在存储设备编号，0=片内 Flash，1~n=外部设备 */
+    uint16_t flags;                 /* 分区属性 (SMOTA_PART_FLAG_*) */
+    uint32_t addr;                  /* 分区在设备上的起始地址 */
+    uint32_t size;                  /* 分区大小（字节） */
+    uint32_t erase_size;            /* 最小擦除单元（页/扇区/块） */
+    uint32_t write_size;            /* 最小编程单元 */
+};
+
+/**
+ * @brief  分区表
+ * @note   可直接存放在 Flash 中，通过魔数和 CRC16 校验有效性
+ */
+struct smota_partition_table {
+    uint32_t magic;                                 /* SMOTA_PART_TABLE_MAGIC */
+    uint8_t version;                                /* SMOTA_PART_TABLE_VER */
+    uint8_t count;                                  /* 有效分区数 */
+    uint16_t crc;                                   /* entries[0..count) 的 CRC16 */
+    struct smota_partition entries[SMOTA_PART_MAX]; /* 分区列表 */
+};
+
+#pragma pack(pop)
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief       读取并校验分区表
+ * @param[in]   table: 分区表，NULL=使用配置宏生成的默认分区表
+ * @return      0=成功, <0=失败
+ * @note        由 smota_init() 调用；校验魔数、CRC、对齐以及同设备分区重叠
+ */
+int smota_partition_init(const struct smota_partition_table *table);
+
+/**
+ * @brief       填充分区表魔数、版本和 CRC
+ * @param[in,out] table: 分区表（需已填好 count 和 entries）
+ * @note        移植层在运行时生成分区表后调用
+ */
+void smota_partition_table_seal(struct smota_partition_table *table);
+
+/**
+ * @brief       获取默认分区表（由 smota_config.h 布局宏生成）
+ * @param[out]  table: 输出分区表
+ */
+void smota_partition_table_default(struct smota_partition_table *table);
+
+/**
+ * @brief       获取分区数量
+ * @return      分区数量，未初始化时返回 0
+ */
+uint8_t smota_partition_count(void);
+
+/**
+ * @brief       按索引获取分区
+ * @param[in]   index: 分区索引
+ * @return      分区指针，NULL=越界
+ */
+const struct smota_partition *smota_partition_get(uint8_t index);
+
+/**
+ * @brief       获取分区在分区表中的索引
+ * @param[in]   part: 分区（须为 smota_partition_get/find 返回的指针）
+ * @return      分区索引, <0=不在当前分区表中
+ */
+int smota_partition_index(const struct smota_partition *part);
+
+/**
+ * @brief       按 ID 查找分区
+ * @param[in]   id: 分区 ID
+ * @return      分区指针，NULL=不存在
+ */
+const struct smota_partition *smota_partition_find(uint8_t id);
+
+/**
+ * @brief       按名称查找分区
+ * @param[in]   name: 分区名
+ * @return      分区指针，NULL=不存在
+ */
+const struct smota_partition *smota_partition_find_by_name(const char *name);
+
+/**
+ * @brief       按设备地址查找分区
+ * @param[in]   dev: 存储设备编号
+ * @param[in]   addr: 设备地址
+ * @return      包含该地址的分区指针，NULL=不存在
+ */
+const struct smota_partition *smota_partition_find_by_addr(uint8_t dev, uint32_t addr);
+
+/**
+ * @brief       获取存储设备驱动
+ * @param[in]   dev: 设备编号，0=片内 Flash（hal->flash），1~n=外部存储设备（hal->ext_flash[dev-1]）
+ * @return      Flash 驱动指针，NULL=设备未注册
+ */
+const struct smota_flash_driver *smota_partition_device(uint8_t dev);
+
+/**
+ * @brief       读取分区数据
+ * @param[in]   part: 分区
+ * @param[in]   offset: 分区内偏移
+ * @param[out]  data: 数据缓冲区
+ * @param[in]   size: 读取字节数
+ * @return      实际读取字节数, <0=失败
+ */
+int smota_partition_read(const struct smota_partition *part, uint32_t offset, uint8_t *data, uint32_t size);
+
+/**
+ * @brief       写入分区数据
+ * @param[in]   part: 分区
+ * @param[in]   offset: 分区内偏移
+ * @param[in]   data: 数据缓冲区
+ * @param[in]   size: 写入字节数
+ * @return      实际写入字节数, <0=失败
+ * @note        写入前需确保目标区域已擦除，调用者负责解锁/上锁
+ */
+int smota_partition_write(const struct smota_partition *part, uint32_t offset, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief       擦除分区区域
+ * @param[in]   part: 分区
+ * @param[in]   offset: 分区内偏移（需对齐到 erase_size）
+ * @param[in]   size: 擦除字节数（需对齐到 erase_size）
+ * @return      0=成功, <0=失败
+ * @note        调用者负责解锁/上锁
+ */
+int smota_partition_erase(const struct smota_partition *part, uint32_t offset, uint32_t size);
+
+/**
+ * @brief       解锁分区所在设备的写保护
+ * @param[in]   part: 分区
+ * @return      0=成功, <0=失败
+ */
+int smota_partition_unlock(const struct smota_partition *part);
+
+/**
+ * @brief       上锁分区所在设备的写保护
+ * @param[in]   part: 分区
+ * @return      0=成功, <0=失败
+ */
+int smota_partition_lock(const struct smota_partition *part);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_PARTITION_H
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_stats.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 18:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 18:00:00
+ * @Brief        : smOTA Flash 操作统计
+ * @details      所有 struct smota_flash_driver 调用都经过 smota_partition_* 转发，
+ *              在此按分区（区域）和操作类型累计调用次数、失败次数、字节数和耗时。
+ *              一次升级会话从握手开始（smota_stats_begin），会话摘要给出下载分区的
+ *              擦除/写入量与固件大小之比，用于发现多余的擦除或重复写入。
+ *              需开启 SMOTA_FLASH_STATS，否则统计接口返回失败且不占用 RAM。
+ */
+
+#ifndef SMOTA_STATS_H
+#define SMOTA_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* Flash 操作类型 */
+#define SMOTA_FLASH_OP_READ   0 /* 读取 */
+#define SMOTA_FLASH_OP_WRITE  1 /* 编程 */
+#define SMOTA_FLASH_OP_ERASE  2 /* 擦除 */
+#define SMOTA_FLASH_OP_UNLOCK 3 /* 解锁 */
+#define SMOTA_FLASH_OP_LOCK   4 /* 上锁 */
+#define SMOTA_FLASH_OP_NUM    5
+
+/**
+ * @brief  Flash 操作计时（供 smota_partition.c 使用）
+ * @note   关闭 SMOTA_FLASH_STATS 时不读取时钟
+ */
+#if SMOTA_FLASH_STATS
+#define SMOTA_STATS_START(t)                    ((t) = smota_stats_now_us())
+#define SMOTA_STATS_STOP(part, op, size, t, ret) smota_stats_record((part), (op), (size), (t), (ret))
+#else
+#define SMOTA_STATS_START(t)                    ((t) = 0)
+#define SMOTA_STATS_STOP(part, op, size, t, ret) ((void)(t))
+#endif
+
+/*---------- type define ----------*/
+
+struct smota_partition;
+
+/**
+ * @brief  单类操作统计
+ */
+struct smota_flash_op_stats {
+    uint32_t count;   /* 调用次数 */
+    uint32_t errors;  /* 失败次数 */
+    uint32_t bytes;   /* 成功处理的字节数（解锁/上锁为 0） */
+    uint32_t time_us; /* 累计耗时（微秒） */
+};
+
+/**
+ * @brief  单个分区的统计
+ */
+struct smota_flash_region_stats {
+    struct smota_flash_op_stats op[SMOTA_FLASH_OP_NUM]; /* 按 SMOTA_FLASH_OP_* 索引 */
+};
+
+/**
+ * @brief  升级会话摘要
+ */
+struct smota_flash_summary {
+    uint32_t image_size;                                   /* 固件大小（会话开始时传入） */
+    uint32_t elapsed_ms;                                   /* 会话已持续时间 */
+    struct smota_flash_op_stats total[SMOTA_FLASH_OP_NUM]; /* 所有分区合计 */
+    uint32_t stage_erase_count;                            /* 下载分区擦除次数 */
+    uint32_t stage_erase_bytes;                            /* 下载分区擦除字节数 */
+    uint32_t stage_write_count;                            /* 下载分区编程次数 */
+    uint32_t stage_write_bytes;                            /* 下载分区写入字节数 */
+    uint16_t erase_amp_x100;                               /* 下载分区擦除量 / 固件大小 x 100 */
+    uint16_t write_amp_x100;                               /* 下载分区写入量 / 固件大小 x 100 */
+};
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief       开始新的统计会话（清零所有统计）
+ * @param[in]   image_size: 本次升级的固件大小，用于计算写放大
+ * @note        smota_init() 和握手时自动调用
+ */
+void smota_stats_begin(uint32_t image_size);
+
+/**
+ * @brief       获取微秒时间戳
+ * @return      微秒时间戳，HAL 未提供 get_tick_us 时由 get_tick_ms 换算
+ */
+uint64_t smota_stats_now_us(void);
+
+/**
+ * @brief       记录一次 Flash 操作
+ * @param[in]   part: 分区
+ * @param[in]   op: 操作类型 SMOTA_FLASH_OP_*
+ * @param[in]   size: 请求的字节数
+ * @param[in]   start_us: 操作开始时间
+ * @param[in]   ret: 驱动返回值，<0 计为失败
+ */
+void smota_stats_record(const struct smota_partition *part, uint8_t op, uint32_t size, uint64_t start_us, int ret);
+
+/**
+ * @brief       获取分区统计
+ * @param[in]   index: 分区索引（0 ~ smota_partition_count()-1）
+ * @param[out]  stats: 输出
+ * @return      0=成功, <0=失败（未开启 SMOTA_FLASH_STATS 时返回 -1）
+ */
+int smota_stats_region_get(uint8_t index, struct smota_flash_region_stats *stats);
+
+/**
+ * @brief       获取会话摘要
+ * @param[out]  summary: 输出
+ * @return      0=成功, <0=失败（未开启 SMOTA_FLASH_STATS 时返回 -1）
+ */
+int smota_stats_summary_get(struct smota_flash_summary *summary);
+
+/**
+ * @brief       获取操作类型名称
+ * @param[in]   op: 操作类型 SMOTA_FLASH_OP_*
+ * @return      名称字符串
+ */
+const char *smota_stats_op_name(uint8_t op);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_STATS_H
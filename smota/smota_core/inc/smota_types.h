@@ -65,11 +65,14 @@ struct smota_ctx {
     uint32_t firmware_size;                  /*!< 固件总大小（字节） */
     uint32_t received_size;                  /*!< 已接收数据大小（字节） */
     uint8_t firmware_version[4];             /*!< 固件版本号 */
+    uint8_t image_hash[32];                  /*!< 整包 SHA-256（HEADER_INFO 声明） */
     uint32_t flash_addr;                     /*!< 目标 Flash 起始地址 */
     uint32_t timeout_ms;                     /*!< 通信超时时间（毫秒） */
     uint8_t *recv_buffer;                    /*!< 接收缓冲区指针 */
     uint32_t recv_len;                       /*!< 已接收数据长度 */
     uint32_t last_packet_time;               /*!< 最后接收数据包的时间戳 */
+    uint32_t total_timeout_ms;               /*!< 会话总超时时间（毫秒），0=不限 */
+    uint32_t session_start_time;             /*!< 会话开始（握手）的时间戳 */
     uint8_t retry_count;                     /*!< 重试计数 */
 };
 
@@ -22,6 +22,10 @@ extern "C" {
 
 /*---------- macro ----------*/
 
+/* 内容哈希算法（HEADER_INFO 的 hash_alg） */
+#define SMOTA_HASH_ALG_SHA256  0 /* SHA-256（默认） */
+#define SMOTA_HASH_ALG_BLAKE2S 1 /* BLAKE2s-256 */
+
 /*---------- type define ----------*/
 
 /**
@@ -31,6 +35,25 @@ extern "C" {
 struct smota_sha256_ctx {
     void *hal_ctx;   /* HAL 上下文指针 */
     uint32_t total_size;  /* 已处理数据总大小 */
+    int8_t slot;     /* 上下文池槽位，-1=由驱动分配 */
+};
+
+/**
+ * @brief  AES-128-CTR 上下文结构体（HAL 抽象）
+ * @note   HAL 提供 aes_init_at 时存储取自静态上下文池
+ */
+struct smota_aes_ctx {
+    void *hal_ctx;   /* HAL 上下文指针 */
+    int8_t slot;     /* 上下文池槽位，-1=由驱动分配 */
+};
+
+/**
+ * @brief  内容哈希上下文（按会话协商的算法计算）
+ * @note   SHA-256 时直接使用 base；BLAKE2s 时 base 的 hal_ctx/slot 指向上下文池
+ */
+struct smota_hash_ctx {
+    struct smota_sha256_ctx base; /* HAL 上下文 */
+    uint8_t alg;                  /* 开始时的算法 SMOTA_HASH_ALG_* */
 };
 
 /*---------- variable prototype ----------*/
@@ -40,7 +63,9 @@ struct smota_sha256_ctx {
 /**
  * @brief       开始 SHA-256 计算
  * @param[out]  ctx: SHA-256 上下文指针
- * @return      0=成功, <0=失败
+ * @return      0=成功, <0=失败（-4=上下文池已用完）
+ * @note        HAL 提供 sha256_init_at 时在静态上下文池中初始化，否则调用 sha256_init；
+ *              池用完时只有开启 SMOTA_CRYPTO_HEAP_FALLBACK 才改用 sha256_init
  */
 int smota_sha256_start(struct smota_sha256_ctx *ctx);
 
@@ -58,9 +83,94 @@ int smota_sha256_update(struct smota_sha256_ctx *ctx, const uint8_t *data, uint3
  * @param[in]   ctx: SHA-256 上下文指针
  * @param[out]  hash: 输出哈希值（32字节）
  * @return      0=成功, <0=失败
+ * @note        每次成功的 smota_sha256_start() 都须以此结束（中途放弃也一样），以归还上下文
  */
 int smota_sha256_final(struct smota_sha256_ctx *ctx, uint8_t hash[32]);
 
+/**
+ * @brief       HAL 是否支持指定的内容哈希算法
+ * @param[in]   alg: 算法 SMOTA_HASH_ALG_*
+ * @return      true=支持
+ */
+bool smota_hash_supported(uint8_t alg);
+
+/**
+ * @brief       选择本次会话的内容哈希算法
+ * @param[in]   alg: 算法 SMOTA_HASH_ALG_*
+ * @return      0=成功, -1=不支持
+ * @note        握手时恢复为 SHA-256，HEADER_INFO 时按上位机的选择切换；
+ *              只影响之后开始的 smota_hash_start()
+ */
+int smota_hash_select(uint8_t alg);
+
+/**
+ * @brief       获取本次会话的内容哈希算法
+ * @return      SMOTA_HASH_ALG_*
+ */
+uint8_t smota_hash_current(void);
+
+/**
+ * @brief       开始内容哈希计算（整包哈希、分片哈希、签名摘要）
+ * @param[out]  ctx: 上下文
+ * @return      0=成功, <0=失败
+ */
+int smota_hash_start(struct smota_hash_ctx *ctx);
+
+/**
+ * @brief       更新内容哈希计算
+ * @param[in]   ctx: 上下文
+ * @param[in]   data: 待计算数据
+ * @param[in]   size: 数据长度
+ * @return      0=成功, <0=失败
+ */
+int smota_hash_update(struct smota_hash_ctx *ctx, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief       完成内容哈希计算
+ * @param[in]   ctx: 上下文
+ * @param[out]  hash: 输出摘要（32字节）
+ * @return      0=成功, <0=失败
+ * @note        与 smota_sha256_final() 相同，每次成功的 start 都须以此结束
+ */
+int smota_hash_final(struct smota_hash_ctx *ctx, uint8_t hash[32]);
+
+/**
+ * @brief       开始 AES-128-CTR 加解密
+ * @param[out]  ctx: AES 上下文指针
+ * @param[in]   key: 密钥（16字节）
+ * @param[in]   iv: 初始计数器（16字节）
+ * @return      0=成功, <0=失败（-4=上下文池已用完）
+ * @note        HAL 提供 aes_init_at 时在静态上下文池中初始化，否则调用 aes_init；
+ *              池用完时只有开启 SMOTA_CRYPTO_HEAP_FALLBACK 才改用 aes_init
+ */
+int smota_aes_start(struct smota_aes_ctx *ctx, const uint8_t key[16], const uint8_t iv[16]);
+
+/**
+ * @brief       重新设置 AES-128-CTR 的密钥和计数器
+ * @param[in]   ctx: AES 上下文指针（未开始时等同 smota_aes_start()）
+ * @param[in]   key: 密钥（16字节）
+ * @param[in]   iv: 初始计数器（16字节）
+ * @return      0=成功, <0=失败（失败时上下文已结束）
+ * @note        上下文在静态池中时用 aes_init_at 原地重新初始化，不归还也不重新申请
+ */
+int smota_aes_rekey(struct smota_aes_ctx *ctx, const uint8_t key[16], const uint8_t iv[16]);
+
+/**
+ * @brief       AES-128-CTR 加解密
+ * @param[in]   ctx: AES 上下文指针
+ * @param[in]   input: 输入数据
+ * @param[out]  output: 输出数据（可与 input 相同）
+ * @param[in]   size: 数据长度
+ * @return      0=成功, <0=失败
+ */
+int smota_aes_crypt(struct smota_aes_ctx *ctx, const uint8_t *input, uint8_t *output, uint32_t size);
+
+/**
+ * @brief       结束 AES-128-CTR 加解密，归还上下文
+ * @param[in]   ctx: AES 上下文指针
+ */
+void smota_aes_end(struct smota_aes_ctx *ctx);
+
 /**
  * @brief       快速计算数据的 SHA-256 哈希
  * @param[in]   data: 待计算数据
@@ -70,6 +180,17 @@ int smota_sha256_final(struct smota_sha256_ctx *ctx, uint8_t hash[32]);
  */
 int smota_sha256_compute(const uint8_t *data, uint32_t size, uint8_t hash[32]);
 
+/**
+ * @brief       批量计算多段独立数据的 SHA-256 哈希
+ * @param[in]   data: 数据指针数组
+ * @param[in]   size: 数据长度数组
+ * @param[out]  hash: 输出哈希值数组（count 个 32 字节）
+ * @param[in]   count: 数据段数量
+ * @return      0=成功, <0=失败
+ * @note        HAL 提供 sha256_batch 时交给它并行计算，否则逐段调用 smota_sha256_compute()
+ */
+int smota_sha256_compute_batch(const uint8_t *const *data, const uint32_t *size, uint8_t (*hash)[32], uint32_t count);
+
 /**
  * @brief       验证版本号（防回滚）
  * @param[in]   current_version: 当前版本号[major, minor, patch]
@@ -86,6 +207,32 @@ bool smota_verify_version(const uint8_t current_version[3], const uint8_t new_ve
  */
 bool smota_verify_hash_equal(const uint8_t hash1[32], const uint8_t hash2[32]);
 
+/**
+ * @brief       校验数据块认证标签
+ * @param[in]   offset: 数据块在固件中的偏移
+ * @param[in]   data: 数据块
+ * @param[in]   size: 数据长度
+ * @param[in]   tag: 收到的标签（16字节）
+ * @return      0=校验通过, -1=HAL 未提供 block_mac, -2=计算失败, -3=标签不符
+ * @note        标签由 HAL crypto->block_mac 计算，按常数时间比较
+ */
+int smota_verify_block_tag(uint32_t offset, const uint8_t *data, uint16_t size, const uint8_t tag[16]);
+
+/**
+ * @brief       认证并解密数据块（ChaCha20-Poly1305）
+ * @param[in]   nonce_prefix: 随机数前缀（整包哈希前 8 字节）
+ * @param[in]   offset: 数据块在固件中的偏移
+ * @param[in]   input: 密文
+ * @param[out]  output: 明文（可与 input 相同）
+ * @param[in]   size: 数据长度
+ * @param[in]   tag: 收到的标签（16字节）
+ * @return      0=标签正确并已解密, -1=HAL 未提供 aead_decrypt, -2=参数错误, -3=标签不符或解密失败
+ * @note        nonce = nonce_prefix || offset(LE32)，AAD = offset(LE32) || length(LE16)；
+ *              同一设备密钥下不同固件的随机数前缀不同，同一固件重发的数据块密文相同
+ */
+int smota_aead_decrypt_block(const uint8_t nonce_prefix[8], uint32_t offset, const uint8_t *input,
+                             uint8_t *output, uint16_t size, const uint8_t tag[16]);
+
 /*---------- end of file ----------*/
 
 #ifdef __cplusplus
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_wear.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 16:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 16:00:00
+ * @Brief        : smOTA 下载区擦除计数与暂存位置轮换
+ * @details      每次升级都会擦除并重写下载分区，频繁升级的设备上这些页最先达到擦写寿命。
+ *              本模块为下载分区的每个擦除单元维护擦除计数（保存在元数据区），
+ *              并可选地在下载分区大于固件时轮换暂存起始位置，把磨损分散到整个分区。
+ *
+ *              - 擦除单元数不超过 SMOTA_WEAR_COUNTER_NUM 时一个单元一个计数器，
+ *                否则相邻单元合用一个计数器（记录该组单元的擦除遍数）
+ *              - 一次升级中同一计数器最多加一，升级过程中先在 RAM 中标记，
+ *                擦除完成和最后一包写入后各提交一次，减少元数据写入
+ *              - 开启 SMOTA_WEAR_ROTATE 时选择计数之和最小的窗口作为暂存位置，
+ *                计数相同时从上次暂存区域之后开始，依次轮换
+ */
+
+#ifndef SMOTA_WEAR_H
+#define SMOTA_WEAR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+
+/*---------- macro ----------*/
+
+/* 计数器饱和值 */
+#define SMOTA_WEAR_COUNT_MAX 0xFFFFU
+
+/*---------- type define ----------*/
+
+/**
+ * @brief  下载区磨损概况
+ */
+struct smota_wear_info {
+    uint32_t erase_size;       /* 下载分区擦除单元大小 */
+    uint16_t unit_num;         /* 下载分区擦除单元数量 */
+    uint16_t unit_per_counter; /* 每个计数器覆盖的擦除单元数 */
+    uint16_t counter_num;      /* 计数器数量 */
+    uint16_t min_count;        /* 最小擦除次数 */
+    uint16_t max_count;        /* 最大擦除次数 */
+    uint32_t stage_offset;     /* 当前暂存起始偏移（相对下载分区） */
+    uint32_t stage_size;       /* 当前暂存占用大小 */
+};
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief       初始化擦除计数（从元数据区加载计数器和暂存位置）
+ * @return      0=成功, <0=失败
+ * @note        须在 smota_meta_init() 之后调用；SMOTA_WEAR_COUNTER_NUM 为 0 时只加载暂存位置
+ */
+int smota_wear_init(void);
+
+/**
+ * @brief       标记下载分区中被擦除的范围
+ * @param[in]   offset: 分区内偏移
+ * @param[in]   size: 擦除大小
+ * @note        只修改 RAM，由 smota_wear_commit() 写入元数据区
+ */
+void smota_wear_mark(uint32_t offset, uint32_t size);
+
+/**
+ * @brief       提交本次升级中标记的擦除
+ * @return      0=成功, <0=失败
+ * @note        同一计数器在一次升级中最多加一；没有新标记时不写入
+ */
+int smota_wear_commit(void);
+
+/**
+ * @brief       开始新一次升级，选择暂存起始位置
+ * @param[in]   size: 固件大小
+ * @return      暂存起始偏移（相对下载分区，已对齐到擦除单元），<0=失败
+ * @note        未初始化、未开启 SMOTA_WEAR_ROTATE 或固件占满下载分区时固定为 0；
+ *              选中的位置写入元数据区，供 Bootloader 安装时定位
+ */
+int32_t smota_wear_stage_select(uint32_t size);
+
+/**
+ * @brief       获取当前暂存起始偏移
+ * @return      暂存起始偏移（相对下载分区）
+ */
+uint32_t smota_wear_stage_offset(void);
+
+/**
+ * @brief       获取磨损概况
+ * @param[out]  info: 输出
+ * @return      0=成功, <0=失败
+ */
+int smota_wear_info_get(struct smota_wear_info *info);
+
+/**
+ * @brief       读取擦除计数器
+ * @param[in]   first: 起始计数器编号
+ * @param[out]  counts: 输出缓冲区
+ * @param[in]   num: 最多读取的数量
+ * @return      实际读取的数量, <0=失败
+ */
+int smota_wear_counts_get(uint16_t first, uint16_t *counts, uint16_t num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_WEAR_H
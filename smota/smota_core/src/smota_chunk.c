@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_chunk.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 20:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 20:00:00
+ * @Brief        : smOTA 分片清单（Merkle 树）校验实现
+ */
+
+/*---------- includes ----------*/
+#include <stddef.h>
+#include <string.h>
+#include "smota_chunk.h"
+#include "smota_verify.h"
+#include "smota_flash.h"
+#include "smota_instance.h"
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* 当前实例的分片会话上下文 */
+#define CHUNK_CTX (g_chunk_ctx[SMOTA_INSTANCE_SLOT()])
+
+/* 叶子与内部节点的域分隔前缀 */
+#define CHUNK_LEAF_PREFIX 0x00
+#define CHUNK_NODE_PREFIX 0x01
+
+/*---------- type define ----------*/
+
+#if SMOTA_CHUNK_MANIFEST
+/**
+ * @brief  分片会话上下文
+ */
+struct chunk_ctx {
+    uint32_t image_size;                /* 固件大小 */
+    uint32_t chunk_size;                /* 分片大小 */
+    uint32_t committed;                 /* 已校验提交的字节数 */
+    uint32_t pos;                       /* 已计算哈希的字节数 */
+    uint16_t total;                     /* 分片总数 */
+    uint16_t received;                  /* 已收到的分片哈希数 */
+    bool ready;                         /* 清单已通过 Merkle 根校验 */
+    bool hashing;                       /* 当前分片的哈希计算进行中 */
+    struct smota_hash_ctx sha;        /* 当前分片的哈希上下文 */
+    uint8_t root[32];                   /* Merkle 根 */
+    uint8_t hash[SMOTA_CHUNK_MAX][32];  /* 分片哈希清单 */
+};
+#endif
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+#if SMOTA_CHUNK_MANIFEST
+/**
+ * @brief  分片会话上下文（每个实例一份）
+ */
+static struct chunk_ctx g_chunk_ctx[SMOTA_INSTANCE_MAX];
+#endif
+
+/*---------- function ----------*/
+
+/**
+ * @brief       计算内部节点哈希
+ * @param[in]   left: 左子节点
+ * @param[in]   right: 右子节点
+ * @param[out]  out: 输出节点哈希（可与 left 或 right 重叠）
+ * @return      0=成功, <0=失败
+ */
+static int chunk_node_hash(const uint8_t left[32], const uint8_t right[32], uint8_t out[32])
+{
+    struct smota_hash_ctx sha;
+    const uint8_t prefix = CHUNK_NODE_PREFIX;
+
+    if (smota_hash_start(&sha) < 0) {
+        return -1;
+    }
+
+    if (smota_hash_update(&sha, &prefix, 1) < 0 ||
+        smota_hash_update(&sha, left, 32) < 0 ||
+        smota_hash_update(&sha, right, 32) < 0) {
+        (void)smota_hash_final(&sha, out);
+        return -1;
+    }
+
+    return smota_hash_final(&sha, out);
+}
+
+/**
+ * @brief       计算分片叶子哈希
+ * @param[in]   data: 分片数据
+ * @param[in]   size: 分片长度
+ * @param[out]  hash: 输出叶子哈希
+ * @return      0=成功, <0=失败
+ */
+int smota_chunk_leaf_hash(const uint8_t *data, uint32_t size, uint8_t hash[32])
+{
+    struct smota_hash_ctx sha;
+    const uint8_t prefix = CHUNK_LEAF_PREFIX;
+
+    if ((data == NULL && size > 0) || hash == NULL) {
+        return -1;
+    }
+
+    if (smota_hash_start(&sha) < 0) {
+        return -2;
+    }
+
+    if (smota_hash_update(&sha, &prefix, 1) < 0 ||
+        (size > 0 && smota_hash_update(&sha, data, size) < 0)) {
+        (void)smota_hash_final(&sha, hash);
+        return -2;
+    }
+
+    return (smota_hash_final(&sha, hash) < 0) ? -2 : 0;
+}
+
+/**
+ * @brief       由叶子哈希计算 Merkle 根
+ * @param[in]   leaf: 叶子哈希数组
+ * @param[in]   count: 叶子数量
+ * @param[out]  root: 输出根
+ * @return      0=成功, <0=失败
+ * @note        栈中保存各层尚未配对的子树根；同层的两个子树立即合并，
+ *              最后自顶向下合并剩余子树，结果与逐层两两合并（奇数个时末尾上移）相同
+ */
+int smota_chunk_merkle_root(const uint8_t (*leaf)[32], uint16_t count, uint8_t root[32])
+{
+    uint8_t stack[SMOTA_CHUNK_TREE_DEPTH][32];
+    uint8_t level[SMOTA_CHUNK_TREE_DEPTH];
+    uint8_t top = 0;
+    uint16_t i;
+
+    if (leaf == NULL || root == NULL || count == 0) {
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        memcpy(stack[top], leaf[i], 32);
+        level[top] = 0;
+        top++;
+
+        while (top >= 2 && level[top - 1] == level[top - 2]) {
+            if (chunk_node_hash(stack[top - 2], stack[top - 1], stack[top - 2]) < 0) {
+                return -2;
+            }
+            level[top - 2]++;
+            top--;
+        }
+    }
+
+    while (top >= 2) {
+        if (chunk_node_hash(stack[top - 2], stack[top - 1], stack[top - 2]) < 0) {
+            return -2;
+        }
+        top--;
+    }
+
+    memcpy(root, stack[0], 32);
+    return 0;
+}
+
+#if SMOTA_CHUNK_MANIFEST
+/**
+ * @brief       放弃进行中的分片哈希计算（释放 HAL 上下文）
+ */
+static void chunk_hash_abort(void)
+{
+    uint8_t discard[32];
+
+    if (CHUNK_CTX.hashing) {
+        (void)smota_hash_final(&CHUNK_CTX.sha, discard);
+        CHUNK_CTX.hashing = false;
+    }
+}
+#endif
+
+/**
+ * @brief       开始新的分片会话
+ * @param[in]   image_size: 固件大小
+ * @param[in]   chunk_size: 分片大小
+ * @param[in]   root: Merkle 根
+ * @return      0=成功, <0=失败
+ */
+int smota_chunk_begin(uint32_t image_size, uint32_t chunk_size, const uint8_t root[32])
+{
+#if SMOTA_CHUNK_MANIFEST
+    uint32_t erase_size = smota_flash_backup_erase_size();
+    uint32_t total;
+
+    chunk_hash_abort();
+    CHUNK_CTX.image_size = 0;
+    CHUNK_CTX.chunk_size = 0;
+    CHUNK_CTX.committed = 0;
+    CHUNK_CTX.pos = 0;
+    CHUNK_CTX.total = 0;
+    CHUNK_CTX.received = 0;
+    CHUNK_CTX.ready = false;
+
+    if (root == NULL || image_size == 0 || chunk_size == 0 ||
+        erase_size == 0 || chunk_size % erase_size != 0) {
+        return -1;
+    }
+
+    total = (image_size + chunk_size - 1) / chunk_size;
+    if (total > SMOTA_CHUNK_MAX) {
+        return -2;
+    }
+
+    CHUNK_CTX.image_size = image_size;
+    CHUNK_CTX.chunk_size = chunk_size;
+    CHUNK_CTX.total = (uint16_t)total;
+    memcpy(CHUNK_CTX.root, root, 32);
+
+    return 0;
+#else
+    (void)image_size;
+    (void)chunk_size;
+    (void)root;
+    return -3;
+#endif
+}
+
+/**
+ * @brief       写入一页分片哈希
+ * @param[in]   index: 第一个分片编号
+ * @param[in]   hash: count 个分片哈希
+ * @param[in]   count: 数量
+ * @return      已收到的分片哈希数, <0=失败
+ */
+int smota_chunk_manifest_put(uint16_t index, const uint8_t *hash, uint16_t count)
+{
+#if SMOTA_CHUNK_MANIFEST
+    uint8_t root[32];
+
+    if (hash == NULL || CHUNK_CTX.total == 0 || CHUNK_CTX.ready ||
+        index != CHUNK_CTX.received || count > CHUNK_CTX.total - CHUNK_CTX.received) {
+        return -1;
+    }
+
+    memcpy(CHUNK_CTX.hash[index], hash, (size_t)count * 32U);
+    CHUNK_CTX.received += count;
+
+    if (CHUNK_CTX.received < CHUNK_CTX.total) {
+        return CHUNK_CTX.received;
+    }
+
+    /* 收齐：重新计算根，不符时清空清单 */
+    if (smota_chunk_merkle_root((const uint8_t (*)[32])CHUNK_CTX.hash, CHUNK_CTX.total, root) < 0) {
+        CHUNK_CTX.received = 0;
+        return -2;
+    }
+
+    if (!smota_verify_hash_equal(root, CHUNK_CTX.root)) {
+        CHUNK_CTX.received = 0;
+        return -3;
+    }
+
+    CHUNK_CTX.ready = true;
+    return CHUNK_CTX.received;
+#else
+    (void)index;
+    (void)hash;
+    (void)count;
+    return -1;
+#endif
+}
+
+/**
+ * @brief       清单是否已就绪
+ * @return      true=已就绪
+ */
+bool smota_chunk_manifest_ready(void)
+{
+#if SMOTA_CHUNK_MANIFEST
+    return CHUNK_CTX.ready;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief       获取已收到的分片哈希数
+ * @return      数量
+ */
+uint16_t smota_chunk_manifest_received(void)
+{
+#if SMOTA_CHUNK_MANIFEST
+    return CHUNK_CTX.received;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief       获取分片总数
+ * @return      数量
+ */
+uint16_t smota_chunk_total(void)
+{
+#if SMOTA_CHUNK_MANIFEST
+    return CHUNK_CTX.total;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief       流式校验数据
+ * @param[in]   offset: 数据在固件中的偏移
+ * @param[in]   data: 数据
+ * @param[in]   size: 长度
+ * @return      0=通过, <0=失败
+ * @note        一个数据块可能跨越分片边界：边界前的部分收尾当前分片，其余部分开始下一分片。
+ *              调用者在失败时整块丢弃，因此回退到本次调用开始时所在分片的起始，
+ *              即使本次调用中已有分片通过
+ */
+int smota_chunk_update(uint32_t offset, const uint8_t *data, uint32_t size)
+{
+#if SMOTA_CHUNK_MANIFEST
+    const uint8_t prefix = CHUNK_LEAF_PREFIX;
+    uint32_t start = CHUNK_CTX.committed;
+    uint8_t hash[32];
+    int ret = 0;
+
+    if (!CHUNK_CTX.ready || data == NULL || offset != CHUNK_CTX.pos ||
+        size > CHUNK_CTX.image_size - CHUNK_CTX.pos) {
+        return -1;
+    }
+
+    while (size > 0) {
+        uint32_t end = CHUNK_CTX.committed + CHUNK_CTX.chunk_size;
+        uint32_t n;
+
+        if (end > CHUNK_CTX.image_size) {
+            end = CHUNK_CTX.image_size;
+        }
+
+        n = end - CHUNK_CTX.pos;
+        if (n > size) {
+            n = size;
+        }
+
+        /* 分片的第一个字节到达时开始计算 */
+        if (!CHUNK_CTX.hashing) {
+            if (smota_hash_start(&CHUNK_CTX.sha) < 0) {
+                ret = -2;
+                break;
+            }
+            CHUNK_CTX.hashing = true;
+
+            if (smota_hash_update(&CHUNK_CTX.sha, &prefix, 1) < 0) {
+                ret = -2;
+                break;
+            }
+        }
+
+        if (smota_hash_update(&CHUNK_CTX.sha, data, n) < 0) {
+            ret = -2;
+            break;
+        }
+
+        CHUNK_CTX.pos += n;
+        data += n;
+        size -= n;
+
+        if (CHUNK_CTX.pos < end) {
+            continue;
+        }
+
+        /* 分片收齐：与清单比较，通过则提交 */
+        CHUNK_CTX.hashing = false;
+        if (smota_hash_final(&CHUNK_CTX.sha, hash) < 0) {
+            ret = -2;
+            break;
+        }
+
+        if (!smota_verify_hash_equal(hash, CHUNK_CTX.hash[CHUNK_CTX.committed / CHUNK_CTX.chunk_size])) {
+            ret = -3;
+            break;
+        }
+
+        CHUNK_CTX.committed = end;
+    }
+
+    if (ret < 0) {
+        chunk_hash_abort();
+        CHUNK_CTX.committed = start;
+        CHUNK_CTX.pos = start;
+    }
+
+    return ret;
+#else
+    (void)offset;
+    (void)data;
+    (void)size;
+    return -1;
+#endif
+}
+
+/**
+ * @brief       获取已校验提交的字节数
+ * @return      字节数
+ */
+uint32_t smota_chunk_committed(void)
+{
+#if SMOTA_CHUNK_MANIFEST
+    return CHUNK_CTX.committed;
+#else
+    return 0;
+#endif
+}
+
+/*---------- end of file ----------*/
@@ -15,12 +15,42 @@
 #include <string.h>
 #include "smota_packet.h"
 #include "smota_state.h"
+#include "smota_meta.h"
+#include "smota_partition.h"
+#include "smota_wear.h"
+#include "smota_stats.h"
+#include "smota_ctr.h"
+#include "smota_instance.h"
 #include "smota_types.h"
 #include "smota_config.h"
 #include "../smota_hal/smota_hal.h"
 
 /*---------- macro ----------*/
-#define SMOTA_RECV_BUFFER_SIZE    1024    /* 接收缓冲区大小 */
+
+/* 数据块负载中认证标签的长度（block_mac 或 Poly1305 标签） */
+#if SMOTA_BLOCK_AUTH || SMOTA_CHACHA20_POLY1305
+#define SMOTA_DATA_TAG_LEN        SMOTA_BLOCK_TAG_SIZE
+#else
+#define SMOTA_DATA_TAG_LEN        0
+#endif
+
+/* 头部信息负载长度（附带分片信息、哈希算法等附加信息） */
+#define SMOTA_HEADER_INFO_LEN     (sizeof(struct smota_header_info_req) + SMOTA_HEADER_TRAILER_LEN)
+
+/* 接收队列内存屏障：数据读写与 head/tail 更新之间不得重排（编译器和 CPU 都不得重排），
+ * 其他编译器须在用户配置中定义 */
+#if SMOTA_FEED_BUF_SIZE > 0 && !defined(SMOTA_FEED_BARRIER)
+#if defined(__GNUC__) || defined(__clang__)
+#define SMOTA_FEED_BARRIER()      __sync_synchronize()
+#elif defined(__ICCARM__)
+#include <intrinsics.h>
+#define SMOTA_FEED_BARRIER()      __DMB()
+#elif defined(__CC_ARM)
+#define SMOTA_FEED_BARRIER()      __dmb(0xF)
+#else
+#error "define SMOTA_FEED_BARRIER() for this compiler (full memory barrier, e.g. DMB on Cortex-M)"
+#endif
+#endif
 
 /*---------- type define ----------*/
 
@@ -29,46 +59,283 @@
 /*---------- function prototype ----------*/
 
 /*---------- variable ----------*/
+
+/*---------- function ----------*/
+
 /**
- * @brief  HAL 实例
+ * @brief       非阻塞地取出已收到的数据
+ * @param[in]   inst: 实例
+ * @param[out]  data: 接收缓冲区
+ * @param[in]   size: 缓冲区剩余空间
+ * @return      取出的字节数, <0=失败
+ * @note        开启 SMOTA_FEED_BUF_SIZE 时从中断推送队列取，否则调用 comm->receive
  */
-static const struct smota_hal *g_hal = NULL;
+static int poll_receive(struct smota_instance *inst, uint8_t *data, uint32_t size)
+{
+#if SMOTA_FEED_BUF_SIZE > 0
+    struct smota_feed_queue *q = &inst->feed;
+    uint32_t tail = q->tail;
+    uint32_t avail = q->head - tail;
+    uint32_t first;
+
+    /* 先读 head 再读数据 */
+    SMOTA_FEED_BARRIER();
+
+    if (avail > size) {
+        avail = size;
+    }
+
+    first = SMOTA_FEED_BUF_SIZE - (tail & (SMOTA_FEED_BUF_SIZE - 1));
+    if (first > avail) {
+        first = avail;
+    }
+
+    memcpy(data, &q->buf[tail & (SMOTA_FEED_BUF_SIZE - 1)], first);
+    memcpy(data + first, q->buf, avail - first);
+
+    /* 数据取完再归还空间 */
+    SMOTA_FEED_BARRIER();
+    q->tail = tail + avail;
+
+    return (int)avail;
+#else
+    if (inst->hal->comm->receive == NULL) {
+        return 0;
+    }
+
+    return inst->hal->comm->receive(data, size, 0);  /* 非阻塞 */
+#endif
+}
 
 /**
- * @brief  OTA 状态码
+ * @brief       检查接收缓冲区中是否有待解析的帧
+ * @param[in]   inst: 实例
+ * @param[in]   len: 缓冲区中的字节数
+ * @return      true=帧已完整，或帧头无效、缓冲区已满（交给 smota_frame_parse 丢弃）
  */
-static smota_err_t g_last_error = SMOTA_ERR_OK;
+static bool poll_frame_ready(const struct smota_instance *inst, uint32_t len)
+{
+    const struct smota_frame_header *header = (const struct smota_frame_header *)inst->recv_buffer;
+    uint32_t need = sizeof(struct smota_frame_header) + sizeof(uint16_t);
+
+    if (len < need) {
+        return false;
+    }
+
+    if (memcmp(header->sof, SMOTA_SOF, SMOTA_SOF_SIZE) != 0 || len >= SMOTA_RECV_BUFFER_SIZE) {
+        return true;
+    }
+
+    return len >= need + header->length;
+}
 
 /**
- * @brief  接收缓冲区
+ * @brief       推送收到的数据（可在中断中调用）
+ * @param[in]   inst: 实例
+ * @param[in]   data: 数据
+ * @param[in]   len: 长度
+ * @return      写入队列的字节数，队列满时小于 len，多出的部分丢弃
+ * @note        只访问实例自己的队列，不切换当前实例
  */
-static uint8_t g_recv_buffer[SMOTA_RECV_BUFFER_SIZE];
+size_t smota_instance_feed(struct smota_instance *inst, const uint8_t *data, size_t len)
+{
+#if SMOTA_FEED_BUF_SIZE > 0
+    struct smota_feed_queue *q;
+    uint32_t head;
+    uint32_t space;
+    uint32_t first;
+    uint32_t n;
+
+    if (inst == NULL || data == NULL) {
+        return 0;
+    }
+
+    q = &inst->feed;
+    head = q->head;
+    space = SMOTA_FEED_BUF_SIZE - (head - q->tail);
+
+    n = (len < space) ? (uint32_t)len : space;
+
+    first = SMOTA_FEED_BUF_SIZE - (head & (SMOTA_FEED_BUF_SIZE - 1));
+    if (first > n) {
+        first = n;
+    }
+
+    memcpy(&q->buf[head & (SMOTA_FEED_BUF_SIZE - 1)], data, first);
+    memcpy(q->buf, data + first, n - first);
+
+    /* 数据写完再发布 head */
+    SMOTA_FEED_BARRIER();
+    q->head = head + n;
+
+    return n;
+#else
+    (void)inst;
+    (void)data;
+    (void)len;
+    return 0;
+#endif
+}
 
 /**
- * @brief  OTA 是否已初始化
+ * @brief       检查实例是否有待处理的接收数据
+ * @param[in]   inst: 实例
+ * @return      true=推送队列非空或接收缓冲区中有完整帧
+ * @note        不切换当前实例；OTA 任务据此决定继续轮询还是阻塞等待
  */
-static bool g_initialized = false;
+bool smota_instance_pending(const struct smota_instance *inst)
+{
+    if (inst == NULL || !inst->initialized) {
+        return false;
+    }
 
-/*---------- function ----------*/
+#if SMOTA_FEED_BUF_SIZE > 0
+    if (inst->feed.head != inst->feed.tail) {
+        return true;
+    }
+#endif
+
+    return poll_frame_ready(inst, inst->ctx.recv_len);
+}
 
 /**
- * @brief       初始化 OTA 模块
+ * @brief       读取实例的毫秒时钟
+ * @param[in]   inst: 实例
+ * @return      毫秒时间戳，HAL 未提供时钟时为 0
+ */
+static uint64_t core_tick_ms(const struct smota_instance *inst)
+{
+    const struct smota_system_driver *system = (inst->hal != NULL) ? inst->hal->system : NULL;
+
+    if (system != NULL && system->get_tick_ms != NULL) {
+        return system->get_tick_ms();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       检查会话是否处于总超时的计时范围（握手到传输完成）
+ * @param[in]   ctx: 上下文
+ * @return      true=计时中
+ */
+static bool core_session_active(const struct smota_ctx *ctx)
+{
+    return ctx->state == SMOTA_STATE_HANDSHAKE || ctx->state == SMOTA_STATE_HEADER_INFO ||
+           ctx->state == SMOTA_STATE_TRANSFER;
+}
+
+/**
+ * @brief       计算距超时到期的毫秒数
+ * @param[in]   start: 计时起点（32 位时间戳）
+ * @param[in]   timeout: 超时时间
+ * @param[in]   now: 当前时间（32 位时间戳）
+ * @return      毫秒数，0=已到期
+ * @note        超时判断为 (now - start) > timeout，到期时刻是 start + timeout + 1
+ */
+static uint32_t core_remain_ms(uint32_t start, uint32_t timeout, uint32_t now)
+{
+    uint32_t elapsed = now - start;
+
+    if (elapsed > timeout) {
+        return 0;
+    }
+
+    return (timeout - elapsed < SMOTA_WAIT_FOREVER - 1) ? (timeout - elapsed + 1) : (SMOTA_WAIT_FOREVER - 1);
+}
+
+/**
+ * @brief       计算当前实例下次需要轮询的时间
+ * @param[in]   inst: 当前实例
+ * @return      距下次轮询的毫秒数，0=立即，SMOTA_WAIT_FOREVER=只在新数据到达时
+ */
+static uint32_t core_deadline(struct smota_instance *inst)
+{
+    struct smota_ctx *ctx = smota_ctx_get();
+    uint32_t now;
+    uint32_t wait = SMOTA_WAIT_FOREVER;
+    uint32_t remain;
+
+    if (!inst->initialized) {
+        return SMOTA_WAIT_FOREVER;
+    }
+
+    /* 还有未处理的数据（一次收到多帧） */
+    if (smota_instance_pending(inst)) {
+        return 0;
+    }
+
+    now = (uint32_t)core_tick_ms(inst);
+
+    /* 数据包超时 */
+    if (ctx->last_packet_time > 0 && ctx->timeout_ms > 0) {
+        wait = core_remain_ms(ctx->last_packet_time, ctx->timeout_ms, now);
+    }
+
+    /* 会话总超时 */
+    if (ctx->total_timeout_ms > 0 && core_session_active(ctx)) {
+        remain = core_remain_ms(ctx->session_start_time, ctx->total_timeout_ms, now);
+        if (remain < wait) {
+            wait = remain;
+        }
+    }
+
+    return wait;
+}
+
+/**
+ * @brief       初始化当前实例
+ * @param[in]   inst: 当前实例
  * @return      smota_err_t 错误码
  */
-smota_err_t smota_init(void)
+static smota_err_t core_init(struct smota_instance *inst)
 {
     struct smota_ctx *ctx;
 
     /* 防止重复初始化 */
-    if (g_initialized) {
+    if (inst->initialized) {
         return SMOTA_ERR_OK;
     }
 
     /* 检查 HAL 是否已注册 */
-    g_hal = smota_hal_get();
-    if (g_hal == NULL) {
-        g_last_error = SMOTA_ERR_INVALID_STATE;
-        return g_last_error;
+    if (inst->hal == NULL) {
+        inst->last_error = SMOTA_ERR_INVALID_STATE;
+        return inst->last_error;
+    }
+
+    /* Flash 操作统计从初始化开始，握手时重新开始 */
+    smota_stats_begin(0);
+
+    /* 初始化 Flash 驱动 */
+    if (inst->hal->flash->init != NULL && inst->hal->flash->init() < 0) {
+        inst->last_error = SMOTA_ERR_FLASH;
+        return inst->last_error;
+    }
+
+    /* 初始化外部存储设备 */
+    for (uint8_t i = 0; i < inst->hal->ext_flash_num; i++) {
+        if (inst->hal->ext_flash[i]->init != NULL && inst->hal->ext_flash[i]->init() < 0) {
+            inst->last_error = SMOTA_ERR_FLASH;
+            return inst->last_error;
+        }
+    }
+
+    /* 加载分区表 */
+    if (smota_partition_init(inst->hal->partitions) < 0) {
+        inst->last_error = SMOTA_ERR_FLASH;
+        return inst->last_error;
+    }
+
+    /* 加载元数据（版本号、启动标志等） */
+    if (smota_meta_init() < 0) {
+        inst->last_error = SMOTA_ERR_FLASH;
+        return inst->last_error;
+    }
+
+    /* 加载下载区擦除计数和暂存位置 */
+    if (smota_wear_init() < 0) {
+        inst->last_error = SMOTA_ERR_FLASH;
+        return inst->last_error;
     }
 
     /* 初始化上下文 */
@@ -78,27 +345,30 @@ smota_err_t smota_init(void)
     ctx->received_size = 0;
     ctx->flash_addr = 0;
     ctx->timeout_ms = 5000;  /* 默认 5 秒超时 */
-    ctx->recv_buffer = g_recv_buffer;
+    ctx->recv_buffer = inst->recv_buffer;
     ctx->recv_len = 0;
     ctx->last_packet_time = 0;
+    ctx->total_timeout_ms = 0;
+    ctx->session_start_time = 0;
     ctx->retry_count = 0;
 
     /* 重置状态机 */
     smota_state_reset();
 
-    g_initialized = true;
-    g_last_error = SMOTA_ERR_OK;
+    inst->initialized = true;
+    inst->last_error = SMOTA_ERR_OK;
 
     return SMOTA_ERR_OK;
 }
 
 /**
- * @brief       去初始化 OTA 模块
+ * @brief       去初始化当前实例
+ * @param[in]   inst: 当前实例
  * @return      smota_err_t 错误码
  */
-smota_err_t smota_deinit(void)
+static smota_err_t core_deinit(struct smota_instance *inst)
 {
-    if (!g_initialized) {
+    if (!inst->initialized) {
         return SMOTA_ERR_OK;
     }
 
@@ -106,23 +376,23 @@ smota_err_t smota_deinit(void)
     smota_state_reset();
 
     /* 清除缓冲区 */
-    memset(g_recv_buffer, 0, sizeof(g_recv_buffer));
+    memset(inst->recv_buffer, 0, sizeof(inst->recv_buffer));
+    smota_ctr_end();
 
-    g_initialized = false;
-    g_last_error = SMOTA_ERR_OK;
+    inst->initialized = false;
+    inst->last_error = SMOTA_ERR_OK;
 
     return SMOTA_ERR_OK;
 }
 
 /**
- * @brief       主轮询函数
+ * @brief       轮询当前实例
+ * @param[in]   inst: 当前实例
  * @return      smota_err_t 错误码
- * @note        需在主循环中每 1-10ms 调用一次
  */
-smota_err_t smota_poll(void)
+static smota_err_t core_poll(struct smota_instance *inst)
 {
     struct smota_ctx *ctx;
-    const struct smota_system_driver *system;
     struct smota_frame frame;
     struct smota_handshake_resp handshake_resp;
     struct smota_header_info_resp header_resp;
@@ -130,6 +400,8 @@ smota_err_t smota_poll(void)
     struct smota_transfer_complete_resp complete_resp;
     struct smota_install_resp install_resp;
     struct smota_activate_check_resp activate_resp;
+    struct smota_diag_resp diag_resp;
+    struct smota_chunk_manifest_resp manifest_resp;
     uint8_t resp_buffer[256];
     int resp_len;
     int recv_len;
@@ -137,42 +409,47 @@ smota_err_t smota_poll(void)
     uint64_t current_time;
 
     /* 检查初始化状态 */
-    if (!g_initialized) {
+    if (!inst->initialized) {
         return SMOTA_ERR_INVALID_STATE;
     }
 
     ctx = smota_ctx_get();
-    system = (g_hal != NULL) ? g_hal->system : NULL;
 
     /* 获取当前时间 */
-    if (system != NULL && system->get_tick_ms != NULL) {
-        current_time = system->get_tick_ms();
-    } else {
-        current_time = 0;
-    }
+    current_time = core_tick_ms(inst);
 
-    /* 检查超时 */
+    /* 检查超时（时间戳按 32 位保存，差值按 32 位回绕计算）；超时只报告一次，之后等待新数据 */
     if (ctx->last_packet_time > 0 && ctx->timeout_ms > 0) {
-        if ((current_time - ctx->last_packet_time) > ctx->timeout_ms) {
-            g_last_error = SMOTA_ERR_TIMEOUT;
+        if ((uint32_t)((uint32_t)current_time - ctx->last_packet_time) > ctx->timeout_ms) {
+            ctx->last_packet_time = 0;
+            inst->last_error = SMOTA_ERR_TIMEOUT;
+            smota_state_set(SMOTA_STATE_ERROR);
+            return SMOTA_ERR_TIMEOUT;
+        }
+    }
+
+    if (ctx->total_timeout_ms > 0 && core_session_active(ctx)) {
+        if ((uint32_t)((uint32_t)current_time - ctx->session_start_time) > ctx->total_timeout_ms) {
+            ctx->total_timeout_ms = 0;
+            inst->last_error = SMOTA_ERR_TIMEOUT;
             smota_state_set(SMOTA_STATE_ERROR);
             return SMOTA_ERR_TIMEOUT;
         }
     }
 
     /* 尝试接收数据 */
-    if (g_hal != NULL && g_hal->comm != NULL && g_hal->comm->receive != NULL) {
-        recv_len = g_hal->comm->receive(g_recv_buffer + ctx->recv_len,
-                                         SMOTA_RECV_BUFFER_SIZE - ctx->recv_len,
-                                         0);  /* 非阻塞 */
+    if (inst->hal != NULL && inst->hal->comm != NULL) {
+        recv_len = poll_receive(inst, inst->recv_buffer + ctx->recv_len, SMOTA_RECV_BUFFER_SIZE - ctx->recv_len);
         if (recv_len > 0) {
             ctx->recv_len += recv_len;
-            ctx->last_packet_time = current_time;
+            ctx->last_packet_time = (uint32_t)current_time;
+        }
 
-            /* 检查是否收到完整帧 (最小帧长度) */
-            if (ctx->recv_len >= 12) {  /* header(10) + length(2) */
+        if (ctx->recv_len > 0) {
+            /* 缓冲区中有完整帧才解析（一次收到多帧时，余下的帧在之后的轮询中处理） */
+            if (poll_frame_ready(inst, ctx->recv_len)) {
                 /* 解析帧 */
-                ret = smota_frame_parse(g_recv_buffer, ctx->recv_len, &frame);
+                ret = smota_frame_parse(inst->recv_buffer, ctx->recv_len, &frame);
                 if (ret == 0) {
                     /* 处理命令 */
                     switch (frame.header.cmd) {
@@ -181,51 +458,75 @@ smota_err_t smota_poll(void)
                             (struct smota_handshake_req *)frame.payload,
                             &handshake_resp);
                         if (ret == SMOTA_ERR_OK) {
+                            /* 会话总超时从握手开始计时 */
+                            ctx->session_start_time = (uint32_t)current_time;
                             resp_len = smota_frame_build(
                                 SMOTA_CMD_HANDSHAKE_RESP,
                                 (uint8_t *)&handshake_resp,
                                 sizeof(handshake_resp),
                                 resp_buffer, sizeof(resp_buffer));
-                            if (resp_len > 0 && g_hal->comm->send != NULL) {
-                                g_hal->comm->send(resp_buffer, resp_len);
+                            if (resp_len > 0 && inst->hal->comm->send != NULL) {
+                                inst->hal->comm->send(resp_buffer, resp_len);
                             }
                         }
                         break;
 
                     case SMOTA_CMD_HEADER_INFO:
+                        if (frame.header.length < SMOTA_HEADER_INFO_LEN) {
+                            /* 负载不完整（或缺少附加信息），不处理 */
+                            ret = SMOTA_ERR_INVALID_PARAM;
+                            break;
+                        }
                         ret = smota_handle_header_info_req(
                             (struct smota_header_info_req *)frame.payload,
                             &header_resp);
-                        if (ret == SMOTA_ERR_OK) {
+                        /* 签名无效、哈希算法不支持同样应答，上位机在擦除和传输之前得知拒绝原因 */
+                        if (ret == SMOTA_ERR_OK || ret == SMOTA_ERR_SIGNATURE || ret == SMOTA_ERR_NOT_SUPPORTED) {
                             resp_len = smota_frame_build(
                                 SMOTA_CMD_HEADER_INFO_RESP,
                                 (uint8_t *)&header_resp,
                                 sizeof(header_resp),
                                 resp_buffer, sizeof(resp_buffer));
-                            if (resp_len > 0 && g_hal->comm->send != NULL) {
-                                g_hal->comm->send(resp_buffer, resp_len);
+                            if (resp_len > 0 && inst->hal->comm->send != NULL) {
+                                inst->hal->comm->send(resp_buffer, resp_len);
                             }
                         }
                         break;
 
                     case SMOTA_CMD_DATA_BLOCK:
-                        ret = smota_handle_data_block_req(
-                            (struct smota_data_block_req *)frame.payload,
-                            frame.payload + sizeof(struct smota_data_block_req),
-                            &data_resp);
-                        if (ret == SMOTA_ERR_OK) {
+                        if (frame.header.length < sizeof(struct smota_data_block_req) ||
+                            frame.header.length < sizeof(struct smota_data_block_req) +
+                                ((struct smota_data_block_req *)frame.payload)->length + SMOTA_DATA_TAG_LEN) {
+                            /* 负载短于 length 字段（或缺少认证标签），按损坏的数据块处理 */
+                            data_resp.error_code = SMOTA_ERR_DATA_BLOCK;
+                            data_resp.received_offset = ctx->received_size;
+                            ret = SMOTA_ERR_CRC;
+                        } else {
+                            ret = smota_handle_data_block_req(
+                                (struct smota_data_block_req *)frame.payload,
+                                frame.payload + sizeof(struct smota_data_block_req),
+                                &data_resp);
+                        }
+                        /* 损坏的数据块也应答（NACK），上位机立即重发该块 */
+                        if (ret == SMOTA_ERR_OK || ret == SMOTA_ERR_CRC) {
                             resp_len = smota_frame_build(
                                 SMOTA_CMD_DATA_BLOCK_RESP,
                                 (uint8_t *)&data_resp,
                                 sizeof(data_resp),
                                 resp_buffer, sizeof(resp_buffer));
-                            if (resp_len > 0 && g_hal->comm->send != NULL) {
-                                g_hal->comm->send(resp_buffer, resp_len);
+                            if (resp_len > 0 && inst->hal->comm->send != NULL) {
+                                inst->hal->comm->send(resp_buffer, resp_len);
                             }
                         }
                         break;
 
                     case SMOTA_CMD_DATA_COMPLETE:
+                        if (frame.header.length < sizeof(struct smota_transfer_complete_req) +
+                                                      SMOTA_COMPLETE_TRAILER_LEN) {
+                            /* 负载不完整（或缺少密文哈希），不处理 */
+                            ret = SMOTA_ERR_INVALID_PARAM;
+                            break;
+                        }
                         ret = smota_handle_transfer_complete_req(
                             (struct smota_transfer_complete_req *)frame.payload,
                             &complete_resp);
@@ -235,8 +536,8 @@ smota_err_t smota_poll(void)
                                 (uint8_t *)&complete_resp,
                                 sizeof(complete_resp),
                                 resp_buffer, sizeof(resp_buffer));
-                            if (resp_len > 0 && g_hal->comm->send != NULL) {
-                                g_hal->comm->send(resp_buffer, resp_len);
+                            if (resp_len > 0 && inst->hal->comm->send != NULL) {
+                                inst->hal->comm->send(resp_buffer, resp_len);
                             }
                         }
                         break;
@@ -251,8 +552,8 @@ smota_err_t smota_poll(void)
                                 (uint8_t *)&install_resp,
                                 sizeof(install_resp),
                                 resp_buffer, sizeof(resp_buffer));
-                            if (resp_len > 0 && g_hal->comm->send != NULL) {
-                                g_hal->comm->send(resp_buffer, resp_len);
+                            if (resp_len > 0 && inst->hal->comm->send != NULL) {
+                                inst->hal->comm->send(resp_buffer, resp_len);
                             }
                         }
                         break;
@@ -267,8 +568,48 @@ smota_err_t smota_poll(void)
                                 (uint8_t *)&activate_resp,
                                 sizeof(activate_resp),
                                 resp_buffer, sizeof(resp_buffer));
-                            if (resp_len > 0 && g_hal->comm->send != NULL) {
-                                g_hal->comm->send(resp_buffer, resp_len);
+                            if (resp_len > 0 && inst->hal->comm->send != NULL) {
+                                inst->hal->comm->send(resp_buffer, resp_len);
+                            }
+                        }
+                        break;
+
+                    case SMOTA_CMD_DIAG_QUERY:
+                        ret = smota_handle_diag_query_req(
+                            (struct smota_diag_req *)frame.payload,
+                            &diag_resp);
+                        if (ret == SMOTA_ERR_OK) {
+                            resp_len = smota_frame_build(
+                                SMOTA_CMD_DIAG_QUERY_RESP,
+                                (uint8_t *)&diag_resp,
+                                (uint16_t)(offsetof(struct smota_diag_resp, data) + diag_resp.length),
+                                resp_buffer, sizeof(resp_buffer));
+                            if (resp_len > 0 && inst->hal->comm->send != NULL) {
+                                inst->hal->comm->send(resp_buffer, resp_len);
+                            }
+                        }
+                        break;
+
+                    case SMOTA_CMD_CHUNK_MANIFEST:
+                        if (frame.header.length < sizeof(struct smota_chunk_manifest_req) ||
+                            frame.header.length < sizeof(struct smota_chunk_manifest_req) +
+                                (uint32_t)((struct smota_chunk_manifest_req *)frame.payload)->count * SMOTA_CHUNK_HASH_SIZE) {
+                            /* 负载短于 count 个分片哈希，不处理 */
+                            ret = SMOTA_ERR_INVALID_PARAM;
+                            break;
+                        }
+                        ret = smota_handle_chunk_manifest_req(
+                            (struct smota_chunk_manifest_req *)frame.payload,
+                            &manifest_resp);
+                        /* 编号不连续或与根不符也应答（NACK），上位机按 received 续发 */
+                        if (ret == SMOTA_ERR_OK || ret == SMOTA_ERR_CRC) {
+                            resp_len = smota_frame_build(
+                                SMOTA_CMD_CHUNK_MANIFEST_RESP,
+                                (uint8_t *)&manifest_resp,
+                                sizeof(manifest_resp),
+                                resp_buffer, sizeof(resp_buffer));
+                            if (resp_len > 0 && inst->hal->comm->send != NULL) {
+                                inst->hal->comm->send(resp_buffer, resp_len);
                             }
                         }
                         break;
@@ -280,18 +621,21 @@ smota_err_t smota_poll(void)
 
                     /* 更新最后错误码 */
                     if (ret != SMOTA_ERR_OK) {
-                        g_last_error = ret;
+                        inst->last_error = ret;
                     }
 
                     /* 移动缓冲区 */
                     ctx->recv_len -= (frame.header.length + sizeof(struct smota_frame_header) + sizeof(uint16_t));
                     if (ctx->recv_len > 0) {
-                        memmove(g_recv_buffer,
-                                g_recv_buffer + frame.header.length + sizeof(struct smota_frame_header) + sizeof(uint16_t),
+                        memmove(inst->recv_buffer,
+                                inst->recv_buffer + frame.header.length + sizeof(struct smota_frame_header) + sizeof(uint16_t),
                                 ctx->recv_len);
                     }
                 } else if (ret == -5) {
-                    /* 帧不完整，继续接收 */
+                    /* 帧不完整，继续接收；缓冲区已满仍不完整说明帧长超出缓冲区，丢弃 */
+                    if (ctx->recv_len >= SMOTA_RECV_BUFFER_SIZE) {
+                        ctx->recv_len = 0;
+                    }
                 } else {
                     /* 帧解析错误，丢弃缓冲区 */
                     ctx->recv_len = 0;
@@ -300,16 +644,24 @@ smota_err_t smota_poll(void)
         }
     }
 
+#if SMOTA_RELIABILITY_TRANSMISSION && !SMOTA_CTR_DEFERRED
+    /* 没有待处理的数据（应答已发出）：为下一个数据块预取密钥流，到达时只需异或 */
+    if (ctx->recv_len == 0) {
+        (void)smota_ctr_prefetch(ctx->received_size);
+    }
+#endif
+
     return SMOTA_ERR_OK;
 }
 
 /**
- * @brief       启动 OTA（主动触发）
+ * @brief       启动当前实例的 OTA（主动触发）
+ * @param[in]   inst: 当前实例
  * @return      smota_err_t 错误码
  */
-smota_err_t smota_start(void)
+static smota_err_t core_start(struct smota_instance *inst)
 {
-    if (!g_initialized) {
+    if (!inst->initialized) {
         return SMOTA_ERR_INVALID_STATE;
     }
 
@@ -320,37 +672,294 @@ smota_err_t smota_start(void)
 }
 
 /**
- * @brief       中止 OTA
+ * @brief       中止当前实例的 OTA
+ * @param[in]   inst: 当前实例
  * @return      smota_err_t 错误码
  */
-smota_err_t smota_abort(void)
+static smota_err_t core_abort(struct smota_instance *inst)
 {
-    if (!g_initialized) {
+    if (!inst->initialized) {
         return SMOTA_ERR_INVALID_STATE;
     }
 
     /* 重置状态机 */
     smota_state_reset();
 
+    /* 丢弃未用完的密钥流 */
+    smota_ctr_end();
+
     /* 清除错误码 */
-    g_last_error = SMOTA_ERR_OK;
+    inst->last_error = SMOTA_ERR_OK;
 
     return SMOTA_ERR_OK;
 }
 
 /**
- * @brief       获取 OTA 进度
- * @return      uint8_t 进度百分比 (0-100)
+ * @brief       初始化实例
+ * @param[in]   inst: 实例（调用者分配并清零）
+ * @param[in]   hal: 绑定的 HAL，NULL=使用已在该实例上注册的 HAL
+ * @return      smota_err_t 错误码
  */
-uint8_t smota_get_progress(void)
+smota_err_t smota_instance_init(struct smota_instance *inst, const struct smota_hal *hal)
 {
-    struct smota_ctx *ctx = smota_ctx_get();
+    struct smota_instance *prev;
+    smota_err_t ret;
+
+    if (inst == NULL) {
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+
+    /* 分配模块状态槽位 */
+    if (smota_instance_attach(inst) < 0) {
+        return SMOTA_ERR_BUSY;
+    }
+
+    prev = smota_instance_enter(inst);
 
-    if (ctx->firmware_size == 0) {
+    if (hal != NULL && smota_hal_register(hal) < 0) {
+        ret = SMOTA_ERR_INVALID_PARAM;
+    } else {
+        ret = core_init(inst);
+    }
+
+    smota_instance_leave(prev);
+
+    if (ret != SMOTA_ERR_OK) {
+        smota_instance_detach(inst);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief       去初始化实例并释放槽位
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_deinit(struct smota_instance *inst)
+{
+    struct smota_instance *prev;
+    smota_err_t ret;
+
+    if (inst == NULL) {
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+
+    prev = smota_instance_enter(inst);
+    ret = core_deinit(inst);
+    smota_instance_leave(prev);
+
+    smota_instance_detach(inst);
+
+    return ret;
+}
+
+/**
+ * @brief       轮询实例
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_poll(struct smota_instance *inst)
+{
+    struct smota_instance *prev;
+    smota_err_t ret;
+
+    if (inst == NULL) {
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+
+    prev = smota_instance_enter(inst);
+    ret = core_poll(inst);
+    smota_instance_leave(prev);
+
+    return ret;
+}
+
+/**
+ * @brief       轮询实例并给出下次需要轮询的时间
+ * @param[in]   inst: 实例
+ * @param[out]  wait_ms: 距下次需要轮询的毫秒数
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_poll_deadline(struct smota_instance *inst, uint32_t *wait_ms)
+{
+    struct smota_instance *prev;
+    smota_err_t ret;
+
+    if (inst == NULL || wait_ms == NULL) {
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+
+    prev = smota_instance_enter(inst);
+    ret = core_poll(inst);
+    *wait_ms = core_deadline(inst);
+    smota_instance_leave(prev);
+
+    return ret;
+}
+
+/**
+ * @brief       启动实例的 OTA（主动触发）
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_start(struct smota_instance *inst)
+{
+    struct smota_instance *prev;
+    smota_err_t ret;
+
+    if (inst == NULL) {
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+
+    prev = smota_instance_enter(inst);
+    ret = core_start(inst);
+    smota_instance_leave(prev);
+
+    return ret;
+}
+
+/**
+ * @brief       中止实例的 OTA
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_instance_abort(struct smota_instance *inst)
+{
+    struct smota_instance *prev;
+    smota_err_t ret;
+
+    if (inst == NULL) {
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+
+    prev = smota_instance_enter(inst);
+    ret = core_abort(inst);
+    smota_instance_leave(prev);
+
+    return ret;
+}
+
+/**
+ * @brief       获取实例的 OTA 进度
+ * @param[in]   inst: 实例
+ * @return      uint8_t 进度百分比 (0-100)
+ */
+uint8_t smota_instance_get_progress(const struct smota_instance *inst)
+{
+    if (inst == NULL || inst->ctx.firmware_size == 0) {
         return 0;
     }
 
-    return (uint8_t)((ctx->received_size * 100) / ctx->firmware_size);
+    return (uint8_t)((inst->ctx.received_size * 100) / inst->ctx.firmware_size);
+}
+
+/**
+ * @brief       获取实例的当前状态
+ * @param[in]   inst: 实例
+ * @return      smota_state_t 当前状态
+ */
+smota_state_t smota_instance_get_state(const struct smota_instance *inst)
+{
+    return (inst != NULL) ? inst->ctx.state : SMOTA_STATE_ERROR;
+}
+
+/**
+ * @brief       获取实例的最后错误码
+ * @param[in]   inst: 实例
+ * @return      smota_err_t 最后错误码
+ */
+smota_err_t smota_instance_get_error(const struct smota_instance *inst)
+{
+    return (inst != NULL) ? inst->last_error : SMOTA_ERR_INVALID_PARAM;
+}
+
+/**
+ * @brief       检查实例的 OTA 是否正在运行
+ * @param[in]   inst: 实例
+ * @return      bool true=运行中, false=空闲
+ */
+bool smota_instance_is_running(const struct smota_instance *inst)
+{
+    smota_state_t state = smota_instance_get_state(inst);
+    return (state != SMOTA_STATE_IDLE && state != SMOTA_STATE_ERROR);
+}
+
+/**
+ * @brief       初始化 OTA 模块
+ * @return      smota_err_t 错误码
+ * @note        以下接口操作默认实例
+ */
+smota_err_t smota_init(void)
+{
+    return smota_instance_init(smota_instance_default(), NULL);
+}
+
+/**
+ * @brief       去初始化 OTA 模块
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_deinit(void)
+{
+    return smota_instance_deinit(smota_instance_default());
+}
+
+/**
+ * @brief       主轮询函数
+ * @return      smota_err_t 错误码
+ * @note        需在主循环中每 1-10ms 调用一次
+ */
+smota_err_t smota_poll(void)
+{
+    return smota_instance_poll(smota_instance_default());
+}
+
+/**
+ * @brief       轮询并给出下次需要轮询的时间
+ * @param[out]  wait_ms: 距下次需要轮询的毫秒数
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_poll_deadline(uint32_t *wait_ms)
+{
+    return smota_instance_poll_deadline(smota_instance_default(), wait_ms);
+}
+
+/**
+ * @brief       推送收到的数据（可在中断中调用）
+ * @param[in]   data: 数据
+ * @param[in]   len: 长度
+ * @return      写入队列的字节数，队列满时小于 len，多出的部分丢弃
+ */
+size_t smota_feed(const uint8_t *data, size_t len)
+{
+    return smota_instance_feed(smota_instance_default(), data, len);
+}
+
+/**
+ * @brief       启动 OTA（主动触发）
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_start(void)
+{
+    return smota_instance_start(smota_instance_default());
+}
+
+/**
+ * @brief       中止 OTA
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_abort(void)
+{
+    return smota_instance_abort(smota_instance_default());
+}
+
+/**
+ * @brief       获取 OTA 进度
+ * @return      uint8_t 进度百分比 (0-100)
+ */
+uint8_t smota_get_progress(void)
+{
+    return smota_instance_get_progress(smota_instance_default());
 }
 
 /**
@@ -359,7 +968,7 @@ uint8_t smota_get_progress(void)
  */
 smota_state_t smota_get_state(void)
 {
-    return smota_state_get();
+    return smota_instance_get_state(smota_instance_default());
 }
 
 /**
@@ -368,7 +977,7 @@ smota_state_t smota_get_state(void)
  */
 smota_err_t smota_get_error(void)
 {
-    return g_last_error;
+    return smota_instance_get_error(smota_instance_default());
 }
 
 /**
@@ -377,7 +986,7 @@ smota_err_t smota_get_error(void)
  */
 const char *smota_get_error_string(void)
 {
-    return smota_err_to_string(g_last_error);
+    return smota_err_to_string(smota_instance_get_error(smota_instance_default()));
 }
 
 /**
@@ -386,8 +995,7 @@ const char *smota_get_error_string(void)
  */
 bool smota_is_running(void)
 {
-    smota_state_t state = smota_state_get();
-    return (state != SMOTA_STATE_IDLE && state != SMOTA_STATE_ERROR);
+    return smota_instance_is_running(smota_instance_default());
 }
 
 /*---------- end of file ----------*/
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_crypto.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 22:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 22:00:00
+ * @Brief        : smOTA 固件来源校验（ECDSA 签名）实现
+ */
+
+/*---------- includes ----------*/
+#include <stddef.h>
+#include <string.h>
+#include "smota_crypto.h"
+#include "smota_packet.h"
+#include "smota_verify.h"
+#include "smota_config.h"
+#include "../smota_hal/smota_hal.h"
+
+/*---------- macro ----------*/
+
+/*---------- type define ----------*/
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+
+/*---------- function ----------*/
+
+/**
+ * @brief       按小端写入 32 位整数
+ * @param[out]  out: 输出（4字节）
+ * @param[in]   value: 数值
+ */
+static void crypto_put_le32(uint8_t out[4], uint32_t value)
+{
+    out[0] = (uint8_t)(value);
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief       计算头部签名摘要
+ * @param[in]   image_hash: 整包 SHA-256
+ * @param[in]   image_size: 固件大小
+ * @param[in]   version: 固件版本
+ * @param[in]   trailer: 附加信息
+ * @param[in]   trailer_len: 附加信息长度
+ * @param[out]  digest: 输出摘要
+ * @return      0=成功, <0=失败
+ */
+int smota_crypto_header_digest(const uint8_t image_hash[32], uint32_t image_size, const uint8_t version[3],
+                               const uint8_t *trailer, uint32_t trailer_len, uint8_t digest[32])
+{
+    struct smota_hash_ctx hash;
+    uint8_t meta[7];
+    int ret;
+
+    if (image_hash == NULL || version == NULL || digest == NULL || (trailer == NULL && trailer_len > 0)) {
+        return -1;
+    }
+
+    crypto_put_le32(meta, image_size);
+    memcpy(&meta[4], version, 3);
+
+    if (smota_hash_start(&hash) < 0) {
+        return -2;
+    }
+
+    ret = smota_hash_update(&hash, image_hash, 32);
+    if (ret >= 0) {
+        ret = smota_hash_update(&hash, meta, sizeof(meta));
+    }
+    if (ret >= 0) {
+        ret = smota_hash_update(&hash, trailer, trailer_len);
+    }
+
+    if (ret < 0) {
+        (void)smota_hash_final(&hash, digest);
+        return -2;
+    }
+
+    return (smota_hash_final(&hash, digest) < 0) ? -2 : 0;
+}
+
+/**
+ * @brief       校验头部签名
+ * @param[in]   req: 头部信息请求
+ * @param[in]   image_size: 固件大小
+ * @param[in]   version: 固件版本
+ * @param[in]   trailer_len: 附加信息长度
+ * @return      0=签名有效, <0=失败
+ */
+int smota_crypto_verify_header(const struct smota_header_info_req *req, uint32_t image_size,
+                               const uint8_t version[3], uint32_t trailer_len)
+{
+#if SMOTA_RELIABILITY_SOURCE
+    const struct smota_hal *hal = smota_hal_get();
+    uint8_t digest[32];
+    uint8_t pub_key[SMOTA_ECDSA_PUB_KEY_SIZE];
+
+    if (req == NULL || version == NULL) {
+        return -1;
+    }
+
+    if (hal == NULL || hal->crypto == NULL ||
+        (hal->crypto->ecdsa_verify == NULL && hal->crypto->ecdsa_verify_fixed == NULL)) {
+        return -1;
+    }
+
+    if (smota_crypto_header_digest(req->sha256_hash, image_size, version, (const uint8_t *)(req + 1), trailer_len,
+                                   digest) < 0) {
+        return -2;
+    }
+
+    /* 公钥固化时驱动直接使用预计算表，不再逐次取公钥 */
+    if (hal->crypto->ecdsa_verify_fixed != NULL) {
+        return (hal->crypto->ecdsa_verify_fixed(digest, req->signature_r, req->signature_s) != 0) ? -3 : 0;
+    }
+
+    smota_get_key(SMOTA_KEY_ECDSA_PUB, pub_key, sizeof(pub_key));
+
+    if (hal->crypto->ecdsa_verify(digest, req->signature_r, req->signature_s, pub_key) != 0) {
+        return -3;
+    }
+
+    return 0;
+#else
+    (void)req;
+    (void)image_size;
+    (void)version;
+    (void)trailer_len;
+    return -1;
+#endif
+}
+
+/*---------- end of file ----------*/
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_ctr.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 23:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 23:00:00
+ * @Brief        : smOTA 传输解密（AES-128-CTR 密钥流预取）实现
+ */
+
+/*---------- includes ----------*/
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include "smota_ctr.h"
+#include "smota_crypto.h"
+#include "smota_verify.h"
+#include "smota_instance.h"
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* 当前实例的解密会话上下文 */
+#define CTR_CTX (g_ctr_ctx[SMOTA_INSTANCE_SLOT()])
+
+/* AES 分组长度，CTR 每个计数块生成 16 字节密钥流 */
+#define CTR_BLOCK_SIZE 16
+
+/* 密钥流窗口大小：关闭预取时只保留当场生成所需的最小窗口 */
+#if SMOTA_CTR_PREFETCH_SIZE > 0
+#define CTR_WINDOW_SIZE SMOTA_CTR_PREFETCH_SIZE
+#else
+#define CTR_WINDOW_SIZE 64
+#endif
+
+#if (CTR_WINDOW_SIZE % CTR_BLOCK_SIZE) != 0
+#error "SMOTA_CTR_PREFETCH_SIZE must be a multiple of 16"
+#endif
+
+/* AES 上下文状态未知，下次生成前须重新定位 */
+#define CTR_BLOCK_INVALID 0xFFFFFFFFU
+
+/*---------- type define ----------*/
+
+#if SMOTA_RELIABILITY_TRANSMISSION
+/**
+ * @brief  解密会话上下文
+ * @note   窗口覆盖 [start, start + len)，且始终满足 start + len == next_block * 16
+ */
+struct ctr_ctx {
+    bool active;                          /* 会话进行中 */
+    struct smota_aes_ctx aes;             /* AES 上下文，位于 next_block */
+    uint8_t nonce[SMOTA_CTR_NONCE_SIZE];  /* 计数块前缀 */
+    uint32_t next_block;                  /* AES 上下文下一个生成的块号 */
+    uint32_t start;                       /* 窗口首字节在固件中的偏移（16 字节对齐） */
+    uint32_t len;                         /* 窗口中的密钥流长度 */
+    uint32_t ks[CTR_WINDOW_SIZE / 4];     /* 密钥流窗口（按字对齐，便于按字异或） */
+};
+#endif
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+#if SMOTA_RELIABILITY_TRANSMISSION
+/**
+ * @brief  解密会话上下文（每个实例一份）
+ */
+static struct ctr_ctx g_ctr_ctx[SMOTA_INSTANCE_MAX];
+#endif
+
+/*---------- function ----------*/
+
+#if SMOTA_RELIABILITY_TRANSMISSION
+/**
+ * @brief       把 AES 上下文重新定位到指定块号
+ * @param[in]   block: 块号
+ * @return      0=成功, <0=失败
+ * @note        已持有上下文时原地重新设置计数器，不归还也不重新申请
+ */
+static int ctr_seek(uint32_t block)
+{
+    struct ctr_ctx *c = &CTR_CTX;
+    uint8_t key[16];
+    uint8_t iv[16];
+    int ret;
+
+    c->next_block = CTR_BLOCK_INVALID;
+
+    memcpy(iv, c->nonce, SMOTA_CTR_NONCE_SIZE);
+    iv[12] = (uint8_t)(block >> 24);
+    iv[13] = (uint8_t)(block >> 16);
+    iv[14] = (uint8_t)(block >> 8);
+    iv[15] = (uint8_t)(block);
+
+    smota_get_key(SMOTA_KEY_AES_DEVICE, key, sizeof(key));
+    ret = smota_aes_rekey(&c->aes, key, iv);
+    memset(key, 0, sizeof(key));
+
+    if (ret < 0) {
+        return -1;
+    }
+
+    c->next_block = block;
+    return 0;
+}
+
+/**
+ * @brief       从 offset 所在的块起把窗口补满
+ * @param[in]   offset: 固件内偏移
+ * @return      0=成功, <0=失败
+ * @note        窗口已覆盖 offset 时保留其后的密钥流，只生成缺少的部分；
+ *              否则从 offset 所在的块重新开始，必要时重新定位 AES 上下文
+ */
+static int ctr_fill(uint32_t offset)
+{
+    struct ctr_ctx *c = &CTR_CTX;
+    uint8_t *ks = (uint8_t *)c->ks;
+    uint32_t base = offset & ~(uint32_t)(CTR_BLOCK_SIZE - 1);
+    uint32_t n;
+
+    if (base >= c->start && base < c->start + c->len) {
+        n = base - c->start;
+        memmove(ks, ks + n, c->len - n);
+        c->start = base;
+        c->len -= n;
+    } else {
+        c->start = base;
+        c->len = 0;
+        if (c->next_block != base / CTR_BLOCK_SIZE && ctr_seek(base / CTR_BLOCK_SIZE) < 0) {
+            return -1;
+        }
+    }
+
+    n = sizeof(c->ks) - c->len;
+    if (n == 0) {
+        return 0;
+    }
+
+    /* CTR 模式下加密全零即得到密钥流；始终按整块生成，AES 上下文的计数器保持对齐 */
+    memset(ks + c->len, 0, n);
+    if (smota_aes_crypt(&c->aes, ks + c->len, ks + c->len, n) < 0) {
+        c->len = 0;
+        c->next_block = CTR_BLOCK_INVALID;
+        return -2;
+    }
+
+    c->len += n;
+    c->next_block += n / CTR_BLOCK_SIZE;
+    return 0;
+}
+
+/**
+ * @brief       数据与密钥流异或
+ * @param[out]  out: 输出（可与 in 相同）
+ * @param[in]   in: 输入
+ * @param[in]   ks: 密钥流
+ * @param[in]   size: 长度
+ * @note        按 32 位字处理，memcpy 由编译器展开为非对齐加载，不要求 in/out 对齐
+ */
+static void ctr_xor(uint8_t *out, const uint8_t *in, const uint8_t *ks, uint32_t size)
+{
+    uint32_t i = 0;
+    uint32_t a;
+    uint32_t b;
+
+    for (; i + 4 <= size; i += 4) {
+        memcpy(&a, in + i, 4);
+        memcpy(&b, ks + i, 4);
+        a ^= b;
+        memcpy(out + i, &a, 4);
+    }
+
+    for (; i < size; i++) {
+        out[i] = in[i] ^ ks[i];
+    }
+}
+#endif
+
+/**
+ * @brief       开始新的解密会话
+ * @param[in]   nonce: 计数块前缀（整包哈希前 12 字节）
+ * @return      0=成功, <0=失败
+ */
+int smota_ctr_begin(const uint8_t nonce[SMOTA_CTR_NONCE_SIZE])
+{
+#if SMOTA_RELIABILITY_TRANSMISSION
+    struct ctr_ctx *c = &CTR_CTX;
+
+    if (nonce == NULL) {
+        return -1;
+    }
+
+    smota_ctr_end();
+
+    memcpy(c->nonce, nonce, SMOTA_CTR_NONCE_SIZE);
+    c->aes.hal_ctx = NULL;
+    c->aes.slot = -1;
+    c->start = 0;
+    c->len = 0;
+
+    if (ctr_seek(0) < 0) {
+        return -2;
+    }
+
+    c->active = true;
+    return 0;
+#else
+    (void)nonce;
+    return -3;
+#endif
+}
+
+/**
+ * @brief       在空闲时预取密钥流
+ * @param[in]   offset: 下一个数据块的期望偏移
+ * @return      从 offset 起已就绪的密钥流字节数, <0=失败
+ */
+int smota_ctr_prefetch(uint32_t offset)
+{
+#if SMOTA_RELIABILITY_TRANSMISSION
+    struct ctr_ctx *c = &CTR_CTX;
+
+    if (!c->active) {
+        return -1;
+    }
+
+#if SMOTA_CTR_PREFETCH_SIZE > 0
+    if (c->start != (offset & ~(uint32_t)(CTR_BLOCK_SIZE - 1)) || c->len < sizeof(c->ks)) {
+        if (ctr_fill(offset) < 0) {
+            return -2;
+        }
+    }
+#endif
+
+    return (int)smota_ctr_ready(offset);
+#else
+    (void)offset;
+    return -1;
+#endif
+}
+
+/**
+ * @brief       获取从 offset 起已就绪的密钥流字节数
+ * @param[in]   offset: 固件内偏移
+ * @return      字节数
+ */
+uint32_t smota_ctr_ready(uint32_t offset)
+{
+#if SMOTA_RELIABILITY_TRANSMISSION
+    struct ctr_ctx *c = &CTR_CTX;
+
+    if (!c->active || offset < c->start || offset >= c->start + c->len) {
+        return 0;
+    }
+
+    return c->start + c->len - offset;
+#else
+    (void)offset;
+    return 0;
+#endif
+}
+
+/**
+ * @brief       解密（或加密）固件数据
+ * @param[in]   offset: 数据在固件中的偏移
+ * @param[in]   input: 输入数据
+ * @param[out]  output: 输出数据（可与 input 相同）
+ * @param[in]   size: 长度
+ * @return      0=成功, <0=失败
+ */
+int smota_ctr_crypt(uint32_t offset, const uint8_t *input, uint8_t *output, uint32_t size)
+{
+#if SMOTA_RELIABILITY_TRANSMISSION
+    struct ctr_ctx *c = &CTR_CTX;
+    uint32_t avail;
+    uint32_t n;
+
+    if (!c->active || ((input == NULL || output == NULL) && size > 0)) {
+        return -1;
+    }
+
+    while (size > 0) {
+        avail = smota_ctr_ready(offset);
+        if (avail == 0) {
+            /* 窗口未覆盖（未预取、重传或续传），当场生成 */
+            if (ctr_fill(offset) < 0) {
+                return -2;
+            }
+            avail = smota_ctr_ready(offset);
+        }
+
+        n = (size < avail) ? size : avail;
+        ctr_xor(output, input, (const uint8_t *)c->ks + (offset - c->start), n);
+
+        offset += n;
+        input += n;
+        output += n;
+        size -= n;
+    }
+
+    return 0;
+#else
+    (void)offset;
+    (void)input;
+    (void)output;
+    (void)size;
+    return -1;
+#endif
+}
+
+/**
+ * @brief       结束解密会话，清零密钥流并归还 AES 上下文
+ */
+void smota_ctr_end(void)
+{
+#if SMOTA_RELIABILITY_TRANSMISSION
+    smota_aes_end(&CTR_CTX.aes);
+    memset(&CTR_CTX, 0, sizeof(CTR_CTX));
+    CTR_CTX.aes.slot = -1;
+#endif
+}
+
+/*---------- end of file ----------*/
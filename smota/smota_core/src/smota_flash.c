@@ -11,20 +11,32 @@
 /*---------- includes ----------*/
 #include <string.h>
 #include "smota_flash.h"
+#include "smota_meta.h"
+#include "smota_partition.h"
+#include "smota_wear.h"
+#include "smota_verify.h"
+#include "smota_ctr.h"
+#include "smota_instance.h"
 #include "smota_config.h"
 #include "../smota_hal/smota_hal.h"
 
 /*---------- macro ----------*/
 
+/* 当前实例的Flash 操作上下文 */
+#define FLASH_CTX (g_flash_ctx[SMOTA_INSTANCE_SLOT()])
+
 /*---------- type define ----------*/
 
 /**
  * @brief  Flash 操作上下文
  */
 struct smota_flash_ctx {
-    uint32_t write_addr;     /* 当前写入地址 */
-    uint32_t erase_addr;     /* 当前擦除地址 */
+    uint32_t base;           /* 暂存起始偏移（擦除计数轮换） */
+    uint32_t write_addr;     /* 当前写入地址（相对暂存起始偏移） */
+    uint32_t erase_addr;     /* 已擦除范围的结束偏移 */
     uint32_t progress;       /* 进度 */
+    uint32_t pend_len;       /* 写合并缓冲区中待写入的字节数 */
+    uint8_t pend[SMOTA_FLASH_WRITE_BUF_SIZE]; /* 写合并缓冲区 */
 };
 
 /*---------- variable prototype ----------*/
@@ -33,74 +45,95 @@ struct smota_flash_ctx {
 
 /*---------- variable ----------*/
 /**
- * @brief  Flash 操作上下文（单例）
+ * @brief  Flash 操作上下文（每个实例一份）
  */
-static struct smota_flash_ctx g_flash_ctx = {
-    .write_addr = 0,
-    .erase_addr = 0,
-    .progress = 0,
-};
+static struct smota_flash_ctx g_flash_ctx[SMOTA_INSTANCE_MAX];
 
-/**
- * @brief  备份区起始地址缓存
- */
-static uint32_t g_backup_addr = 0;
+/*---------- function ----------*/
 
 /**
- * @brief  应用区起始地址缓存
+ * @brief       初始化 Flash 操作模块
+ * @return      0=成功, <0=失败
  */
-static uint32_t g_app_addr = 0;
+static int flash_init(void)
+{
+    const struct smota_hal *hal;
+    const struct smota_flash_driver *flash;
 
-/*---------- function ----------*/
+    hal = smota_hal_get();
+    if (hal == NULL || hal->flash == NULL) {
+        return -1;
+    }
+
+    flash = hal->flash;
+
+    if (flash->init != NULL) {
+        return flash->init();
+    }
+
+    return 0;
+}
 
 /**
- * @brief       计算备份区起始地址
- * @return      备份区起始地址
+ * @brief       获取下载分区
+ * @return      分区指针，NULL=分区表中不存在
+ * @note        有备份区时下载到备份区，单分区模式直接下载到 App 区
  */
-static uint32_t calc_backup_addr(void)
+static const struct smota_partition *flash_download_part(void)
 {
-    if (g_backup_addr == 0) {
-        g_backup_addr = SMOTA_FLASH_BASE_ADDR + SMOTA_BOOTLOADER_SIZE;
-    }
-    return g_backup_addr;
+    const struct smota_partition *part = smota_partition_find(SMOTA_PART_ID_BACKUP);
+
+    return (part != NULL) ? part : smota_partition_find(SMOTA_PART_ID_APP);
 }
 
 /**
- * @brief       计算应用区起始地址
- * @return      应用区起始地址
+ * @brief       获取下载分区的写合并单元
+ * @return      写合并单元，1=不合并
  */
-static uint32_t calc_app_addr(void)
+static uint32_t flash_combine_unit(const struct smota_partition *part)
 {
-    if (g_app_addr == 0) {
-#if SMOTA_MODE == 0  /* 双 Bank 模式 */
-        g_app_addr = SMOTA_FLASH_BASE_ADDR;
-#elif SMOTA_MODE == 1  /* 双槽位模式 */
-        g_app_addr = SMOTA_FLASH_BASE_ADDR + SMOTA_BOOTLOADER_SIZE + SMOTA_APP_SIZE;
-#else  /* 单分区模式 */
-        g_app_addr = SMOTA_FLASH_BASE_ADDR + SMOTA_BOOTLOADER_SIZE;
-#endif
-    }
-    return g_app_addr;
+    return (part->write_size <= SMOTA_FLASH_WRITE_BUF_SIZE) ? part->write_size : 1;
 }
 
 /**
- * @brief       初始化 Flash 操作模块
+ * @brief       编程下载分区（进入尚未擦除的页时先擦除）
+ * @param[in]   part: 下载分区
+ * @param[in]   offset: 分区内偏移
+ * @param[in]   data: 数据
+ * @param[in]   size: 大小
  * @return      0=成功, <0=失败
+ * @note        调用者负责解锁/上锁；smota_flash_erase_backup 已擦除的范围不会重复擦除
  */
-static int flash_init(void)
+static int flash_program(const struct smota_partition *part, uint32_t offset, const uint8_t *data, uint32_t size)
 {
-    const struct smota_hal *hal;
-    const struct smota_flash_driver *flash;
+    uint32_t page_size = part->erase_size;
+    int ret;
 
-    hal = smota_hal_get();
-    if (hal == NULL || hal->flash == NULL) {
-        return -1;
-    }
+    while (size > 0) {
+        uint32_t page_offset = offset % page_size;
+        uint32_t chunk = page_size - page_offset;
 
-    flash = hal->flash;
+        if (page_offset == 0 && offset >= FLASH_CTX.erase_addr) {
+            ret = smota_partition_erase(part, offset, page_size);
+            if (ret < 0) {
+                return ret;
+            }
+            smota_wear_mark(offset, page_size);
+            FLASH_CTX.erase_addr = offset + page_size;
+        }
 
-    if (flash->init != NULL) {
-        return flash->init();
+        if (chunk > size) {
+            chunk = size;
+        }
+
+        ret = smota_partition_write(part, offset, data, chunk);
+        if (ret != (int)chunk) {
+            return -3;
+        }
+
+        offset += chunk;
+        data += chunk;
+        size -= chunk;
     }
 
     return 0;
@@ -111,137 +144,274 @@ static int flash_init(void)
  * @param[in]   src: 源数据指针
  * @param[in]   size: 写入大小
  * @return      实际写入字节数, <0=失败
+ * @note        按分区编程单元合并写入，不足一个单元的尾部暂存在 RAM 中，
+ *              由后续写入或 smota_flash_flush_backup() 写入 Flash
  */
 int smota_flash_write_backup(const uint8_t *src, uint32_t size)
 {
-    const struct smota_hal *hal;
-    const struct smota_flash_driver *flash;
-    uint32_t addr;
-    uint32_t page_size;
-    uint32_t page_offset;
-    uint32_t page_remain;
-    uint32_t written = 0;
-    int ret;
+    const struct smota_partition *part;
+    uint32_t unit;
+    uint32_t accepted = 0;
+    int ret = 0;
 
     if (src == NULL || size == 0) {
         return -1;
     }
 
-    hal = smota_hal_get();
-    if (hal == NULL || hal->flash == NULL) {
+    part = flash_download_part();
+    if (part == NULL) {
         return -2;
     }
 
-    flash = hal->flash;
-    addr = calc_backup_addr() + g_flash_ctx.write_addr;
-    page_size = SMOTA_FLASH_PAGE_SIZE;
+    unit = flash_combine_unit(part);
 
     /* 解锁 Flash */
-    if (flash->flash_unlock != NULL) {
-        flash->flash_unlock();
-    }
+    smota_partition_unlock(part);
 
-    while (written < size) {
-        page_offset = addr % page_size;
-        page_remain = page_size - page_offset;
+    while (accepted < size) {
+        uint32_t prog_off = FLASH_CTX.base + FLASH_CTX.write_addr - FLASH_CTX.pend_len;
+        uint32_t n;
 
-        /* 需要擦除当前页 */
-        if (page_offset == 0) {
-            ret = flash->erase(addr, page_size);
+        if (FLASH_CTX.pend_len > 0 || size - accepted < unit) {
+            /* 凑满一个编程单元 */
+            n = unit - FLASH_CTX.pend_len;
+            if (n > size - accepted) {
+                n = size - accepted;
+            }
+            memcpy(FLASH_CTX.pend + FLASH_CTX.pend_len, src + accepted, n);
+            FLASH_CTX.pend_len += n;
+
+            if (FLASH_CTX.pend_len == unit) {
+                ret = flash_program(part, prog_off, FLASH_CTX.pend, unit);
+                if (ret < 0) {
+                    FLASH_CTX.pend_len -= n;
+                    break;
+                }
+                FLASH_CTX.pend_len = 0;
+            }
+        } else {
+            /* 整单元部分直接写入 */
+            n = (size - accepted) / unit * unit;
+            ret = flash_program(part, prog_off, src + accepted, n);
             if (ret < 0) {
-                goto cleanup;
+                break;
             }
         }
 
-        /* 计算本次写入大小 */
-        uint32_t chunk = (size - written < page_remain) ? (size - written) : page_remain;
+        accepted += n;
+        FLASH_CTX.write_addr += n;
+    }
 
-        /* 执行写入 */
-        ret = flash->write(addr, src + written, chunk);
-        if (ret != (int)chunk) {
-            goto cleanup;
-        }
+    /* 上锁 Flash */
+    smota_partition_lock(part);
+
+    return (accepted > 0) ? (int)accepted : ret;
+}
+
+/**
+ * @brief       将写合并缓冲区中的剩余数据写入备份区
+ * @return      0=成功, <0=失败
+ * @note        不足一个编程单元的部分以 0xFF 填充；完成后提交本次升级的擦除计数
+ */
+int smota_flash_flush_backup(void)
+{
+    const struct smota_partition *part;
+    uint32_t unit;
+    uint32_t size;
+    int ret;
 
-        addr += chunk;
-        written += chunk;
-        g_flash_ctx.write_addr += chunk;
+    if (FLASH_CTX.pend_len == 0) {
+        smota_wear_commit();
+        return 0;
     }
 
-cleanup:
-    /* 上锁 Flash */
-    if (flash->flash_lock != NULL) {
-        flash->flash_lock();
+    part = flash_download_part();
+    if (part == NULL) {
+        return -1;
+    }
+
+    unit = flash_combine_unit(part);
+    size = (FLASH_CTX.pend_len + unit - 1) / unit * unit;
+    memset(FLASH_CTX.pend + FLASH_CTX.pend_len, 0xFF, size - FLASH_CTX.pend_len);
+
+    smota_partition_unlock(part);
+    ret = flash_program(part, FLASH_CTX.base + FLASH_CTX.write_addr - FLASH_CTX.pend_len,
+                        FLASH_CTX.pend, size);
+    smota_partition_lock(part);
+
+    if (ret < 0) {
+        return ret;
+    }
+
+    FLASH_CTX.pend_len = 0;
+    smota_wear_commit();
+    return 0;
+}
+
+/**
+ * @brief       回退备份区写入位置
+ * @param[in]   offset: 新的写入位置（相对暂存起始，须对齐到擦除单元且不超过当前写入位置）
+ * @return      0=成功, <0=失败
+ * @note        丢弃写合并缓冲区；回退范围内的页在重新写入时由 flash_program 重新擦除
+ */
+int smota_flash_rewind_backup(uint32_t offset)
+{
+    const struct smota_partition *part;
+
+    part = flash_download_part();
+    if (part == NULL) {
+        return -1;
+    }
+
+    if (offset % part->erase_size != 0 || offset > FLASH_CTX.write_addr) {
+        return -2;
+    }
+
+    FLASH_CTX.write_addr = offset;
+    FLASH_CTX.pend_len = 0;
+    if (FLASH_CTX.erase_addr > FLASH_CTX.base + offset) {
+        FLASH_CTX.erase_addr = FLASH_CTX.base + offset;
     }
 
-    return (written > 0) ? (int)written : ret;
+    return 0;
 }
 
 /**
  * @brief       擦除备份区
  * @param[in]   size: 擦除大小
  * @return      0=成功, <0=失败
+ * @note        暂存起始位置由 smota_wear_stage_select() 决定（未开启轮换时为分区起始），
+ *              擦除完成后提交擦除计数
  */
 int smota_flash_erase_backup(uint32_t size)
 {
-    const struct smota_hal *hal;
-    const struct smota_flash_driver *flash;
-    uint32_t addr;
+    const struct smota_partition *part;
     uint32_t page_size;
     uint32_t erase_size;
     uint32_t erased = 0;
-    int ret;
+    int32_t stage;
+    int ret = -3;
 
-    hal = smota_hal_get();
-    if (hal == NULL || hal->flash == NULL) {
+    part = flash_download_part();
+    if (part == NULL) {
         return -1;
     }
 
-    flash = hal->flash;
-    addr = calc_backup_addr();
-    page_size = SMOTA_FLASH_PAGE_SIZE;
+    if (size > part->size) {
+        return -2;
+    }
 
     /* 计算需要擦除的大小（按页对齐） */
+    page_size = part->erase_size;
     erase_size = (size + page_size - 1) / page_size * page_size;
 
-    /* 解锁 Flash */
-    if (flash->flash_unlock != NULL) {
-        flash->flash_unlock();
+    /* 新一次传输从暂存起始位置写入 */
+    stage = smota_wear_stage_select(size);
+    if (stage < 0) {
+        return -3;
     }
 
+    FLASH_CTX.base = (uint32_t)stage;
+    FLASH_CTX.write_addr = 0;
+    FLASH_CTX.erase_addr = FLASH_CTX.base;
+    FLASH_CTX.pend_len = 0;
+
+    /* 解锁 Flash */
+    smota_partition_unlock(part);
+
     while (erased < erase_size) {
-        ret = flash->erase(addr, page_size);
+        ret = smota_partition_erase(part, FLASH_CTX.base + erased, page_size);
         if (ret < 0) {
             goto cleanup;
         }
 
-        addr += page_size;
         erased += page_size;
-        g_flash_ctx.erase_addr = addr - calc_backup_addr();
+        FLASH_CTX.erase_addr = FLASH_CTX.base + erased;
     }
 
 cleanup:
     /* 上锁 Flash */
-    if (flash->flash_lock != NULL) {
-        flash->flash_lock();
-    }
+    smota_partition_lock(part);
+
+    smota_wear_mark(FLASH_CTX.base, erased);
+    smota_wear_commit();
 
     return (erased > 0) ? 0 : ret;
 }
 
+#if SMOTA_CTR_DEFERRED
+/**
+ * @brief       安装前校验暂存区密文
+ * @param[in]   src: 备份区分区
+ * @param[in]   src_off: 分区内偏移
+ * @param[in]   size: 固件大小
+ * @param[in]   image: 已签名的镜像记录
+ * @param[out]  buffer: 工作缓冲区（SMOTA_WORK_BUF_SIZE）
+ * @return      0=明文哈希与签名哈希一致, -4=读取或解密失败, -5=明文哈希不符
+ * @note        整包读出、解密并计算明文哈希，不写任何 Flash；
+ *              通过后才擦除应用区，损坏或被篡改的密文不会覆盖现有 App
+ */
+static int flash_deferred_verify(const struct smota_partition *src, uint32_t src_off, uint32_t size,
+                                 const struct smota_meta_image *image, uint8_t *buffer)
+{
+    struct smota_hash_ctx hash;
+    uint8_t digest[32];
+    uint32_t offset = 0;
+    int ret = 0;
+
+    if (smota_hash_start(&hash) < 0) {
+        return -4;
+    }
+
+    while (offset < size) {
+        uint32_t chunk = (size - offset < SMOTA_WORK_BUF_SIZE) ? (size - offset) : SMOTA_WORK_BUF_SIZE;
+
+        if (smota_partition_read(src, src_off + offset, buffer, chunk) != (int)chunk ||
+            smota_ctr_crypt(offset, buffer, buffer, chunk) < 0 || smota_hash_update(&hash, buffer, chunk) < 0) {
+            ret = -4;
+            break;
+        }
+        offset += chunk;
+    }
+
+    if (smota_hash_final(&hash, digest) < 0 && ret == 0) {
+        ret = -4;
+    }
+    if (ret == 0 && !smota_verify_hash_equal(digest, image->hash)) {
+        ret = -5;
+    }
+
+    memset(buffer, 0, SMOTA_WORK_BUF_SIZE);
+    return ret;
+}
+#endif
+
 /**
  * @brief       固件拷贝（双槽位模式）
- * @param[in]   src_addr: 源地址（备份区）
+ * @param[in]   src_addr: 源地址（备份区，所在设备的地址）
  * @param[in]   dst_addr: 目标地址（应用区）
  * @param[in]   size: 拷贝大小
- * @return      0=成功, <0=失败
+ * @return      0=成功, <0=失败（-4=延迟解密记录无效或解密失败, -5=解密后的明文哈希不符）
+ * @note        源地址按下载分区所在设备解析，目标地址按 App 分区所在设备解析，
+ *              因此备份区可位于外部 NOR 上；目标按分区擦除单元逐块擦除。
+ *              开启 SMOTA_CTR_DEFERRED 时备份区为密文：先整包解密校验明文哈希与 SMOTA_META_TAG_IMAGE
+ *              记录的已签名哈希一致，通过后才擦除应用区；拷贝时再次解密并计入哈希，
+ *              拷贝完成后再比较一次，防止两次读取之间暂存区内容变化
  */
 int smota_flash_copy_firmware(uint32_t src_addr, uint32_t dst_addr, uint32_t size)
 {
-    const struct smota_hal *hal;
-    const struct smota_flash_driver *flash;
-    uint32_t page_size;
+    const struct smota_partition *src;
+    const struct smota_partition *dst;
+    uint32_t src_off;
+    uint32_t dst_off;
     uint32_t offset = 0;
-    int ret;
+    uint8_t buffer[SMOTA_WORK_BUF_SIZE];
+    int ret = 0;
+#if SMOTA_CTR_DEFERRED
+    struct smota_meta_image image;
+    struct smota_hash_ctx hash;
+    uint8_t digest[32];
+#endif
 
     /* 初始化 Flash */
     ret = flash_init();
@@ -249,58 +419,106 @@ int smota_flash_copy_firmware(uint32_t src_addr, uint32_t dst_addr, uint32_t siz
         return ret;
     }
 
-    hal = smota_hal_get();
-    if (hal == NULL || hal->flash == NULL) {
+    src = flash_download_part();
+    dst = smota_partition_find(SMOTA_PART_ID_APP);
+    if (src == NULL || dst == NULL) {
         return -2;
     }
 
-    flash = hal->flash;
-    page_size = SMOTA_FLASH_PAGE_SIZE;
+    src = smota_partition_find_by_addr(src->dev, src_addr);
+    dst = smota_partition_find_by_addr(dst->dev, dst_addr);
+    if (src == NULL || dst == NULL) {
+        return -2;
+    }
 
-    /* 分配缓冲区 */
-    uint8_t buffer[SMOTA_WORK_BUF_SIZE];
+    src_off = src_addr - src->addr;
+    dst_off = dst_addr - dst->addr;
+    if (size > src->size - src_off || size > dst->size - dst_off || (dst_off % dst->erase_size) != 0) {
+        return -3;
+    }
 
-    /* 解锁 Flash */
-    if (flash->flash_unlock != NULL) {
-        flash->flash_unlock();
+#if SMOTA_CTR_DEFERRED
+    /* 密钥流以已签名的明文哈希为前缀，明文哈希按接收时协商的算法计算 */
+    if (smota_meta_read(SMOTA_META_TAG_IMAGE, &image, sizeof(image)) != (int)sizeof(image) || image.size != size ||
+        smota_hash_select(image.hash_alg) < 0 || smota_ctr_begin(image.hash) < 0) {
+        return -4;
     }
+    ret = flash_deferred_verify(src, src_off, size, &image, buffer);
+    if (ret < 0) {
+        smota_ctr_end();
+        SMOTA_DEBUG_PRINTF("Staged image rejected before install: %d\r\n", ret);
+        return ret;
+    }
+    if (smota_hash_start(&hash) < 0) {
+        smota_ctr_end();
+        return -4;
+    }
+#endif
+
+    /* 解锁 Flash */
+    smota_partition_unlock(dst);
 
     while (offset < size) {
         uint32_t chunk = (size - offset < SMOTA_WORK_BUF_SIZE) ?
                          (size - offset) : SMOTA_WORK_BUF_SIZE;
 
-        /* 计算页对齐的 chunk */
-        uint32_t aligned_chunk = (chunk + page_size - 1) / page_size * page_size;
+        /* 进入新的擦除单元时先擦除目标 */
+        if (((dst_off + offset) % dst->erase_size) == 0) {
+            uint32_t erase_size = dst->erase_size;
+
+            if (erase_size > dst->size - dst_off - offset) {
+                erase_size = dst->size - dst_off - offset;
+            }
+            ret = smota_partition_erase(dst, dst_off + offset, erase_size);
+            if (ret < 0) {
+                goto cleanup;
+            }
+        }
+
+        /* 不跨越目标擦除单元 */
+        if (chunk > dst->erase_size - (dst_off + offset) % dst->erase_size) {
+            chunk = dst->erase_size - (dst_off + offset) % dst->erase_size;
+        }
 
         /* 读取源数据 */
-        ret = flash->read(src_addr + offset, buffer, aligned_chunk);
-        if (ret != (int)aligned_chunk) {
+        ret = smota_partition_read(src, src_off + offset, buffer, chunk);
+        if (ret != (int)chunk) {
             goto cleanup;
         }
 
-        /* 擦除目标页 */
-        ret = flash->erase(dst_addr + offset, aligned_chunk);
-        if (ret < 0) {
+#if SMOTA_CTR_DEFERRED
+        /* 就地解密：每个字节只在这里解密一次 */
+        if (smota_ctr_crypt(offset, buffer, buffer, chunk) < 0 || smota_hash_update(&hash, buffer, chunk) < 0) {
+            ret = -4;
             goto cleanup;
         }
+#endif
 
         /* 写入目标地址 */
-        ret = flash->write(dst_addr + offset, buffer, aligned_chunk);
-        if (ret != (int)aligned_chunk) {
+        ret = smota_partition_write(dst, dst_off + offset, buffer, chunk);
+        if (ret != (int)chunk) {
             goto cleanup;
         }
 
-        offset += aligned_chunk;
+        offset += chunk;
 
         /* 更新进度 */
-        g_flash_ctx.progress = (offset * 100) / size;
+        FLASH_CTX.progress = (offset * 100) / size;
     }
 
 cleanup:
     /* 上锁 Flash */
-    if (flash->flash_lock != NULL) {
-        flash->flash_lock();
+    smota_partition_lock(dst);
+
+#if SMOTA_CTR_DEFERRED
+    smota_ctr_end();
+    if (smota_hash_final(&hash, digest) < 0 && offset >= size) {
+        return -4;
     }
+    if (offset >= size && !smota_verify_hash_equal(digest, image.hash)) {
+        return -5;
+    }
+#endif
 
     return (offset >= size) ? 0 : ret;
 }
@@ -309,105 +527,63 @@ cleanup:
  * @brief       读取固件版本
  * @param[out]  version: 版本号输出 [major, minor, patch]
  * @return      0=成功, <0=失败
+ * @note        版本号保存在元数据区，由 RAM 索引直接定位
  */
 int smota_flash_read_version(uint8_t version[3])
 {
-    const struct smota_hal *hal;
-    const struct smota_flash_driver *flash;
-    uint32_t addr;
     int ret;
 
     if (version == NULL) {
         return -1;
     }
 
-    hal = smota_hal_get();
-    if (hal == NULL || hal->flash == NULL) {
-        return -2;
+    ret = smota_meta_read(SMOTA_META_TAG_VERSION, version, 3);
+    if (ret != 3) {
+        return (ret < 0) ? ret : -2;
     }
 
-    flash = hal->flash;
-
-    /* 版本存储在应用区末尾 */
-    addr = calc_app_addr() + SMOTA_APP_SIZE - 16;
-
-    ret = flash->read(addr, version, 3);
-
-    return ret;
+    return 0;
 }
 
 /**
  * @brief       写入固件版本
  * @param[in]   version: 版本号 [major, minor, patch]
  * @return      0=成功, <0=失败
+ * @note        追加一条元数据记录，无需擦除应用区
  */
 int smota_flash_write_version(const uint8_t version[3])
 {
-    const struct smota_hal *hal;
-    const struct smota_flash_driver *flash;
-    uint32_t addr;
-    int ret;
-
     if (version == NULL) {
         return -1;
     }
 
-    hal = smota_hal_get();
-    if (hal == NULL || hal->flash == NULL) {
-        return -2;
-    }
-
-    flash = hal->flash;
-
-    /* 解锁 Flash */
-    if (flash->flash_unlock != NULL) {
-        flash->flash_unlock();
-    }
-
-    /* 版本存储在应用区末尾 */
-    addr = calc_app_addr() + SMOTA_APP_SIZE - 16;
-
-    /* 擦除并写入 */
-    ret = flash->erase(addr, SMOTA_FLASH_PAGE_SIZE);
-    if (ret < 0) {
-        goto cleanup;
-    }
-
-    ret = flash->write(addr, version, 3);
-
-cleanup:
-    /* 上锁 Flash */
-    if (flash->flash_lock != NULL) {
-        flash->flash_lock();
-    }
-
-    return ret;
+    return smota_meta_write(SMOTA_META_TAG_VERSION, version, 3);
 }
 
 /**
  * @brief       检查 Flash 是否为空（全部为 0xFF）
- * @param[in]   addr: 起始地址
+ * @param[in]   addr: 起始地址（片内 Flash）
  * @param[in]   size: 检查大小
  * @return      true=空, false=非空
  */
 bool smota_flash_is_erased(uint32_t addr, uint32_t size)
 {
-    const struct smota_hal *hal;
-    const struct smota_flash_driver *flash;
+    const struct smota_partition *part;
     uint8_t buffer[256];
+    uint32_t base;
     uint32_t offset = 0;
 
-    hal = smota_hal_get();
-    if (hal == NULL || hal->flash == NULL) {
+    part = smota_partition_find_by_addr(0, addr);
+    if (part == NULL) {
         return false;
     }
 
-    flash = hal->flash;
+    base = addr - part->addr;
 
     while (offset < size) {
         uint32_t chunk = (size - offset < 256) ? (size - offset) : 256;
 
-        if (flash->read(addr + offset, buffer, chunk) != (int)chunk) {
+        if (smota_partition_read(part, base + offset, buffer, chunk) != (int)chunk) {
             return false;
         }
 
@@ -425,35 +601,48 @@ bool smota_flash_is_erased(uint32_t addr, uint32_t size)
 
 /**
  * @brief       获取备份区起始地址
- * @return      备份区起始地址
+ * @return      备份区起始地址，0=分区表未加载
+ * @note        单分区模式没有备份区，返回 App 区地址（直接下载到 App 区）；
+ *              开启暂存位置轮换时返回本次固件的暂存地址
  */
 uint32_t smota_flash_backup_addr(void)
 {
-    return calc_backup_addr();
+    const struct smota_partition *part = flash_download_part();
+
+    return (part != NULL) ? part->addr + smota_wear_stage_offset() : 0;
 }
 
 /**
  * @brief       获取应用区起始地址
- * @return      应用区起始地址
+ * @return      应用区起始地址，0=分区表未加载
  */
 uint32_t smota_flash_app_addr(void)
 {
-    return calc_app_addr();
+    const struct smota_partition *part = smota_partition_find(SMOTA_PART_ID_APP);
+
+    return (part != NULL) ? part->addr : 0;
 }
 
 /**
  * @brief       获取备份区大小
- * @return      备份区大小
+ * @return      备份区大小，即可接收的最大固件大小
  */
 uint32_t smota_flash_backup_size(void)
 {
-#if SMOTA_MODE == 0  /* 双 Bank 模式 */
-    return SMOTA_APP_SIZE;
-#elif SMOTA_MODE == 1  /* 双槽位模式 */
-    return SMOTA_APP_SIZE;
-#else  /* 单分区模式 */
-    return SMOTA_FLASH_SIZE - SMOTA_BOOTLOADER_SIZE - SMOTA_APP_SIZE;
-#endif
+    const struct smota_partition *part = flash_download_part();
+
+    return (part != NULL) ? part->size : 0;
+}
+
+/**
+ * @brief       获取备份区擦除单元大小
+ * @return      擦除单元大小，0=分区表未加载
+ */
+uint32_t smota_flash_backup_erase_size(void)
+{
+    const struct smota_partition *part = flash_download_part();
+
+    return (part != NULL) ? part->erase_size : 0;
 }
 
 /**
@@ -462,7 +651,9 @@ uint32_t smota_flash_backup_size(void)
  */
 uint32_t smota_flash_app_size(void)
 {
-    return SMOTA_APP_SIZE;
+    const struct smota_partition *part = smota_partition_find(SMOTA_PART_ID_APP);
+
+    return (part != NULL) ? part->size : 0;
 }
 
 /*---------- end of file ----------*/
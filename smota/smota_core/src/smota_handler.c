@@ -9,14 +9,22 @@
  */
 
 /*---------- includes ----------*/
+#include <stddef.h>
 #include <string.h>
 #include "../../smota.h"
 #include "smota_packet.h"
 #include "smota_state.h"
+#include "smota_instance.h"
 #include "smota_config.h"
 
 /*---------- macro ----------*/
 
+/* 当前实例的整包流式哈希 */
+#define IMAGE_SHA (g_image_sha[SMOTA_INSTANCE_SLOT()])
+
+/* 当前实例的流式哈希进行标志 */
+#define IMAGE_SHA_ACTIVE (g_image_sha_active[SMOTA_INSTANCE_SLOT()])
+
 /*---------- type define ----------*/
 
 /*---------- variable prototype ----------*/
@@ -29,8 +37,62 @@
  */
 static uint8_t g_resp_buffer[256];
 
+#if !SMOTA_CHUNK_MANIFEST
+/**
+ * @brief  整包流式哈希（HEADER_INFO 时开始，数据块写入后更新，传输完成时比较；每个实例一份）
+ */
+static struct smota_hash_ctx g_image_sha[SMOTA_INSTANCE_MAX];
+
+/**
+ * @brief  流式哈希是否进行中
+ */
+static bool g_image_sha_active[SMOTA_INSTANCE_MAX];
+#endif
+
+#if SMOTA_CHACHA20_POLY1305 || (SMOTA_RELIABILITY_TRANSMISSION && !SMOTA_CTR_DEFERRED)
+/**
+ * @brief  数据块明文缓冲区（解密后写入 Flash）
+ */
+static uint8_t g_plain_buf[SMOTA_DECRYPT_BUF_SIZE];
+#endif
+
 /*---------- function ----------*/
 
+#if !SMOTA_CHUNK_MANIFEST
+/**
+ * @brief       结束进行中的流式哈希
+ * @param[out]  hash: 输出哈希（32字节）
+ * @return      0=成功, <0=未开始或计算失败
+ */
+static int image_sha_end(uint8_t hash[32])
+{
+    if (!IMAGE_SHA_ACTIVE) {
+        return -1;
+    }
+
+    IMAGE_SHA_ACTIVE = false;
+    return smota_hash_final(&IMAGE_SHA, hash);
+}
+
+/**
+ * @brief       开始新的流式哈希（放弃上一次会话未结束的计算）
+ * @return      0=成功, <0=失败
+ */
+static int image_sha_begin(void)
+{
+    uint8_t discard[32];
+
+    (void)image_sha_end(discard);
+
+    if (smota_hash_start(&IMAGE_SHA) < 0) {
+        return -1;
+    }
+
+    IMAGE_SHA_ACTIVE = true;
+    return 0;
+}
+#endif
+
 /**
  * @brief       处理握手请求 (0x01)
  * @param[in]   req: 握手请求结构体
@@ -71,8 +133,8 @@ smota_err_t smota_handle_handshake_req(const struct smota_handshake_req *req,
     /* TODO: 从设备信息获取当前版本进行比较 */
 
     /* 检查 Flash 空间是否足够 */
-    /* 计算可用空间（简化处理，实际应从 HAL 获取） */
-    free_size = 64 * 1024;  /* 假设可用 64KB */
+    /* 可用空间即下载分区容量（由分区表决定） */
+    free_size = smota_flash_backup_size();
     resp->flash_free_size = free_size;
 
     if (req->firmware_size > free_size) {
@@ -80,12 +142,16 @@ smota_err_t smota_handle_handshake_req(const struct smota_handshake_req *req,
         return SMOTA_ERR_SPACE;
     }
 
+    /* 新的升级会话，Flash 操作统计从此开始 */
+    smota_stats_begin(req->firmware_size);
+
     /* 更新上下文 */
     ctx->firmware_size = req->firmware_size;
     ctx->firmware_version[0] = req->fw_version_major;
     ctx->firmware_version[1] = req->fw_version_minor;
     ctx->firmware_version[2] = req->fw_version_patch;
     ctx->timeout_ms = req->block_timeout;
+    ctx->total_timeout_ms = req->total_timeout;
 
     /* 填充响应 */
     resp->error_code = 0;
@@ -95,6 +161,32 @@ smota_err_t smota_handle_handshake_req(const struct smota_handshake_req *req,
     resp->block_timeout = req->block_timeout;  /* 确认超时 */
     resp->install_timeout = req->install_timeout;
     resp->capabilities = SMOTA_CAP_ANTI_ROLLBACK;  /* 设备能力 */
+#if SMOTA_BLOCK_AUTH
+    resp->capabilities |= SMOTA_CAP_BLOCK_AUTH;
+#endif
+#if SMOTA_CHUNK_MANIFEST
+    resp->capabilities |= SMOTA_CAP_CHUNK_MANIFEST;
+#endif
+#if SMOTA_RELIABILITY_SOURCE
+    resp->capabilities |= SMOTA_CAP_SIGNATURE;
+#endif
+#if SMOTA_CHACHA20_POLY1305
+    resp->capabilities |= SMOTA_CAP_CHACHA20_POLY1305;
+#endif
+#if SMOTA_RELIABILITY_TRANSMISSION
+    resp->capabilities |= SMOTA_CAP_ENCRYPT;
+#endif
+#if SMOTA_CTR_DEFERRED
+    resp->capabilities |= SMOTA_CAP_DEFERRED_DECRYPT;
+#endif
+#if SMOTA_HASH_BLAKE2S
+    if (smota_hash_supported(SMOTA_HASH_ALG_BLAKE2S)) {
+        resp->capabilities |= SMOTA_CAP_HASH_BLAKE2S;
+    }
+#endif
+
+    /* 新会话默认 SHA-256，HEADER_INFO 时按上位机的选择切换 */
+    (void)smota_hash_select(SMOTA_HASH_ALG_SHA256);
 
     /* 切换到握手状态 */
     smota_state_set(SMOTA_STATE_HANDSHAKE);
@@ -113,6 +205,11 @@ smota_err_t smota_handle_header_info_req(const struct smota_header_info_req *req
 {
     struct smota_ctx *ctx;
     const struct smota_hal *hal;
+    const uint8_t *trailer;
+    const struct smota_header_chunk_info *chunk = NULL;
+#if SMOTA_HASH_BLAKE2S
+    const struct smota_header_hash_info *hash_info;
+#endif
     int ret;
 
     /* 参数检查 */
@@ -134,18 +231,64 @@ smota_err_t smota_handle_header_info_req(const struct smota_header_info_req *req
         return SMOTA_ERR_INVALID_STATE;
     }
 
-    /* 保存 SHA-256 哈希值 */
-    memcpy(ctx->recv_buffer, req->sha256_hash, 32);
+    /* 附加信息紧跟在请求之后：分片信息（分片哈希清单随后由 0x08 下发）、哈希算法 */
+    trailer = (const uint8_t *)(req + 1);
+#if SMOTA_CHUNK_MANIFEST
+    chunk = (const struct smota_header_chunk_info *)trailer;
+#endif
+
+#if SMOTA_HASH_BLAKE2S
+    /* 先切换算法：签名摘要、整包哈希和分片哈希都按所选算法计算 */
+    hash_info = (const struct smota_header_hash_info *)(trailer + SMOTA_HEADER_CHUNK_INFO_LEN);
+    if (smota_hash_select(hash_info->hash_alg) < 0) {
+        resp->error_code = SMOTA_ERR_PROTOCOL_MISMATCH;
+        return SMOTA_ERR_NOT_SUPPORTED;
+    }
+#endif
+
+#if SMOTA_RELIABILITY_SOURCE
+    /* 擦除之前校验签名：未签名或非本项目签发的固件在一个往返内被拒绝 */
+    if (smota_crypto_verify_header(req, ctx->firmware_size, ctx->firmware_version, SMOTA_HEADER_TRAILER_LEN) < 0) {
+        resp->error_code = SMOTA_ERR_VERIFY_SIGN_FAILED;
+        return SMOTA_ERR_SIGNATURE;
+    }
+#endif
+
+    /* 保存整包哈希值（签名已覆盖，传输完成时与流式哈希比较） */
+    memcpy(ctx->image_hash, req->sha256_hash, sizeof(ctx->image_hash));
+
+#if SMOTA_RELIABILITY_TRANSMISSION && !SMOTA_CTR_DEFERRED
+    /* 密钥流计数块以整包哈希为前缀，空闲时即可开始预取 */
+    if (smota_ctr_begin(ctx->image_hash) < 0) {
+        resp->error_code = SMOTA_ERR_DATA_AES;
+        return SMOTA_ERR_INVALID_STATE;
+    }
+#endif
+
+#if SMOTA_CHUNK_MANIFEST
+    if (smota_chunk_begin(ctx->firmware_size, chunk->chunk_size, chunk->chunk_root) < 0) {
+        resp->error_code = SMOTA_ERR_CHUNK_MANIFEST;
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+#else
+    (void)chunk;
+    (void)trailer;
+#endif
 
     /* 擦除 Flash 目标区域 */
-    ret = hal->flash->erase(0, ctx->firmware_size);
+    ret = smota_flash_erase_backup(ctx->firmware_size);
     if (ret < 0) {
         resp->error_code = SMOTA_ERR_FLASH_WRITE;
         return SMOTA_ERR_FLASH;
     }
 
-    /* 初始化 SHA-256 上下文 */
-    ctx->recv_len = 0;
+#if !SMOTA_CHUNK_MANIFEST
+    /* 按协商的算法开始整包流式哈希 */
+    if (image_sha_begin() < 0) {
+        resp->error_code = SMOTA_ERR_VERIFY_SHA256_FAILED;
+        return SMOTA_ERR_INVALID_STATE;
+    }
+#endif
 
     /* 填充响应 */
     resp->error_code = 0;
@@ -161,7 +304,11 @@ smota_err_t smota_handle_header_info_req(const struct smota_header_info_req *req
  * @param[in]   req: 数据块请求结构体
  * @param[in]   data: 数据指针（指向 req 后的数据区）
  * @param[out]  resp: 数据块响应结构体
- * @return      smota_err_t 错误码
+ * @return      smota_err_t 错误码，SMOTA_ERR_CRC=认证标签不符（应答 NACK，不写入）
+ * @note        开启 SMOTA_BLOCK_AUTH 或 SMOTA_CHACHA20_POLY1305 时 data 后紧跟认证标签，
+ *              由调用者保证负载长度足够；后者 data 为密文，认证解密后再写入。
+ *              开启 SMOTA_RELIABILITY_TRANSMISSION 时 data 为 AES-128-CTR 密文（标签覆盖密文），
+ *              用空闲时预取的密钥流解密后写入；同时开启 SMOTA_CTR_DEFERRED 时密文直接写入暂存区
  */
 smota_err_t smota_handle_data_block_req(const struct smota_data_block_req *req,
                                          const uint8_t *data,
@@ -200,17 +347,82 @@ smota_err_t smota_handle_data_block_req(const struct smota_data_block_req *req,
         return SMOTA_ERR_INVALID_PARAM;
     }
 
+#if SMOTA_CHACHA20_POLY1305
+    /* 一次遍历完成认证和解密：标签不符的数据块不写入，上位机按 received_offset 重发；
+     * Poly1305 标签已覆盖 offset 和 length，不再计算 block_mac */
+    if (req->length > sizeof(g_plain_buf) ||
+        smota_aead_decrypt_block(ctx->image_hash, req->offset, data, g_plain_buf, req->length,
+                                 data + req->length) < 0) {
+        resp->error_code = SMOTA_ERR_DATA_BLOCK;
+        resp->received_offset = ctx->received_size;
+        return SMOTA_ERR_CRC;
+    }
+    data = g_plain_buf;
+#else
+#if SMOTA_BLOCK_AUTH
+    /* 写入前校验认证标签：损坏或伪造的数据块不写入，上位机按 received_offset 重发 */
+    if (smota_verify_block_tag(req->offset, data, req->length, data + req->length) < 0) {
+        resp->error_code = SMOTA_ERR_DATA_BLOCK;
+        resp->received_offset = ctx->received_size;
+        return SMOTA_ERR_CRC;
+    }
+#endif
+#if SMOTA_RELIABILITY_TRANSMISSION && !SMOTA_CTR_DEFERRED
+    /* 密钥流通常已在等待本帧时预取，这里只剩异或（延迟解密时密文原样写入，安装拷贝时再解密） */
+    if (req->length > sizeof(g_plain_buf) ||
+        smota_ctr_crypt(req->offset, data, g_plain_buf, req->length) < 0) {
+        resp->error_code = SMOTA_ERR_DATA_AES;
+        resp->received_offset = ctx->received_size;
+        return SMOTA_ERR_CRC;
+    }
+    data = g_plain_buf;
+#endif
+#endif
+
+#if SMOTA_CHUNK_MANIFEST
+    /* 清单收齐前不接收数据 */
+    if (!smota_chunk_manifest_ready()) {
+        resp->error_code = SMOTA_ERR_CHUNK_MANIFEST;
+        resp->received_offset = ctx->received_size;
+        return SMOTA_ERR_INVALID_STATE;
+    }
+
+    /* 写入前流式校验分片：不符时丢弃该分片已写入的部分，上位机从分片起始重发 */
+    if (smota_chunk_update(req->offset, data, req->length) < 0) {
+        ctx->received_size = smota_chunk_committed();
+        (void)smota_flash_rewind_backup(ctx->received_size);
+        resp->error_code = SMOTA_ERR_CHUNK_HASH;
+        resp->received_offset = ctx->received_size;
+        return SMOTA_ERR_CRC;
+    }
+#endif
+
     /* 写入 Flash */
-    ret = hal->flash->write(req->offset, data, req->length);
+    ret = smota_flash_write_backup(data, req->length);
     if (ret != req->length) {
         resp->error_code = SMOTA_ERR_FLASH_WRITE;
         resp->received_offset = ctx->received_size;
         return SMOTA_ERR_FLASH;
     }
 
+#if !SMOTA_CHUNK_MANIFEST
+    /* 已写入的数据计入整包哈希；计算失败时传输完成报告哈希不符 */
+    if (IMAGE_SHA_ACTIVE && smota_hash_update(&IMAGE_SHA, data, req->length) < 0) {
+        uint8_t discard[32];
+
+        (void)image_sha_end(discard);
+    }
+#endif
+
     /* 更新接收进度 */
     ctx->received_size += req->length;
-    ctx->recv_len = 0;
+
+    /* 最后一个数据块：写入合并缓冲区中的剩余数据 */
+    if (ctx->received_size >= ctx->firmware_size && smota_flash_flush_backup() < 0) {
+        resp->error_code = SMOTA_ERR_FLASH_WRITE;
+        resp->received_offset = ctx->received_size;
+        return SMOTA_ERR_FLASH;
+    }
 
     /* 填充响应 */
     resp->error_code = 0;
@@ -229,15 +441,17 @@ smota_err_t smota_handle_data_block_req(const struct smota_data_block_req *req,
  * @param[in]   req: 传输完成请求结构体
  * @param[out]  resp: 传输完成响应结构体
  * @return      smota_err_t 错误码
+ * @note        开启 SMOTA_CTR_DEFERRED 时 req 后紧跟 SMOTA_COMPLETE_TRAILER_LEN 字节密文哈希，
+ *              由调用者保证负载长度足够
  */
 smota_err_t smota_handle_transfer_complete_req(const struct smota_transfer_complete_req *req,
                                                 struct smota_transfer_complete_resp *resp)
 {
     struct smota_ctx *ctx;
     const struct smota_hal *hal;
-    void *sha256_ctx;
+#if !SMOTA_CHUNK_MANIFEST
     uint8_t hash[32];
-    int ret;
+#endif
 
     /* 参数检查 */
     if (req == NULL || resp == NULL) {
@@ -264,27 +478,50 @@ smota_err_t smota_handle_transfer_complete_req(const struct smota_transfer_compl
         return SMOTA_ERR_INVALID_STATE;
     }
 
-    /* 重新计算 SHA-256 验证 */
-    sha256_ctx = hal->crypto->sha256_init();
-    if (sha256_ctx == NULL) {
+#if SMOTA_RELIABILITY_TRANSMISSION
+    /* 数据已收齐，清零密钥流并归还 AES 上下文 */
+    smota_ctr_end();
+#endif
+
+#if SMOTA_CHUNK_MANIFEST
+    /* 所有分片都须已通过校验（分片哈希由已签名的 Merkle 根约束） */
+    if (smota_chunk_committed() != ctx->firmware_size) {
+        resp->error_code = SMOTA_ERR_VERIFY_SHA256_FAILED;
+        return SMOTA_ERR_VERSION;
+    }
+#else
+    /* 结束流式哈希，与 HEADER_INFO 声明的哈希比较，无需回读 Flash */
+    if (image_sha_end(hash) < 0) {
         resp->error_code = SMOTA_ERR_VERIFY_SHA256_FAILED;
         return SMOTA_ERR_FLASH;
     }
 
-    /* 读取并计算整个固件的 SHA-256 */
-    /* TODO: 分块读取大文件进行哈希计算 */
-
-    ret = hal->crypto->sha256_final(sha256_ctx, hash);
-    if (ret < 0) {
+#if SMOTA_CTR_DEFERRED
+    /* 暂存区为密文：与上位机给出的密文哈希比较；明文哈希随记录保存，安装拷贝解密时校验 */
+    if (!smota_verify_hash_equal(hash, ((const struct smota_complete_cipher_info *)(req + 1))->cipher_hash)) {
         resp->error_code = SMOTA_ERR_VERIFY_SHA256_FAILED;
-        return SMOTA_ERR_FLASH;
+        return SMOTA_ERR_VERSION;
     }
 
-    /* 比较哈希值 */
-    if (memcmp(hash, ctx->recv_buffer, 32) != 0) {
+    {
+        struct smota_meta_image image;
+
+        memset(&image, 0, sizeof(image));
+        memcpy(image.hash, ctx->image_hash, sizeof(image.hash));
+        image.hash_alg = smota_hash_current();
+        image.size = ctx->firmware_size;
+        if (smota_meta_write(SMOTA_META_TAG_IMAGE, &image, sizeof(image)) < 0) {
+            resp->error_code = SMOTA_ERR_FLASH_WRITE;
+            return SMOTA_ERR_FLASH;
+        }
+    }
+#else
+    if (!smota_verify_hash_equal(hash, ctx->image_hash)) {
         resp->error_code = SMOTA_ERR_VERIFY_SHA256_FAILED;
         return SMOTA_ERR_VERSION;
     }
+#endif
+#endif
 
     /* 填充响应 */
     resp->error_code = 0;
@@ -330,8 +567,11 @@ smota_err_t smota_handle_install_req(const struct smota_install_req *req,
     /* 检查业务状态（可选） */
     /* TODO: 实现业务状态检查 */
 
-    /* 设置安装标志位 */
-    /* TODO: 根据 SMOTA_MODE 设置相应的标志 */
+    /* 设置安装标志位（追加写元数据记录，供 Bootloader 读取） */
+    if (smota_meta_boot_flags_update(SMOTA_BOOT_FLAG_INSTALL_PENDING, 0) < 0) {
+        resp->error_code = SMOTA_ERR_FLASH_WRITE;
+        return SMOTA_ERR_FLASH;
+    }
 
     /* 填充响应 */
     resp->error_code = 0;
@@ -356,16 +596,23 @@ smota_err_t smota_handle_install_req(const struct smota_install_req *req,
 smota_err_t smota_handle_activate_check_req(const struct smota_activate_check_req *req,
                                              struct smota_activate_check_resp *resp)
 {
+    uint8_t version[3];
+
     /* 参数检查 */
     if (resp == NULL) {
         return SMOTA_ERR_INVALID_PARAM;
     }
 
-    /* 填充响应（实际版本号应从设备读取） */
+    /* 从元数据区读取当前运行版本 */
+    if (smota_flash_read_version(version) < 0) {
+        memset(version, 0, sizeof(version));
+    }
+
+    /* 填充响应 */
     resp->error_code = 0;
-    resp->fw_version_major = 1;  /* TODO: 从实际固件读取 */
-    resp->fw_version_minor = 0;
-    resp->fw_version_patch = 0;
+    resp->fw_version_major = version[0];
+    resp->fw_version_minor = version[1];
+    resp->fw_version_patch = version[2];
 
     /* 切换到激活状态 */
     smota_state_set(SMOTA_STATE_ACTIVATE);
@@ -373,4 +620,123 @@ smota_err_t smota_handle_activate_check_req(const struct smota_activate_check_re
     return SMOTA_ERR_OK;
 }
 
+/**
+ * @brief       填充下载区擦除计数诊断数据
+ * @param[in]   index: 起始计数器编号
+ * @param[out]  resp: 诊断查询响应结构体
+ * @return      0=成功, <0=失败
+ */
+static int diag_fill_wear(uint16_t index, struct smota_diag_resp *resp)
+{
+    struct smota_wear_info info;
+    struct smota_diag_wear wear;
+    uint16_t counts[SMOTA_DIAG_WEAR_COUNTS];
+    int num;
+
+    if (smota_wear_info_get(&info) < 0) {
+        return -1;
+    }
+
+    num = smota_wear_counts_get(index, counts, SMOTA_DIAG_WEAR_COUNTS);
+    if (num < 0) {
+        return -2;
+    }
+
+    memset(&wear, 0, sizeof(wear));
+    wear.erase_size = info.erase_size;
+    wear.unit_num = info.unit_num;
+    wear.unit_per_counter = info.unit_per_counter;
+    wear.counter_num = info.counter_num;
+    wear.min_count = info.min_count;
+    wear.max_count = info.max_count;
+    wear.count = (uint16_t)num;
+    wear.stage_offset = info.stage_offset;
+    wear.stage_size = info.stage_size;
+    memcpy(wear.counts, counts, (size_t)num * sizeof(uint16_t));
+
+    resp->length = (uint16_t)(offsetof(struct smota_diag_wear, counts) + (size_t)num * sizeof(uint16_t));
+    memcpy(resp->data, &wear, resp->length);
+
+    return 0;
+}
+
+/**
+ * @brief       处理诊断查询请求 (0x07)
+ * @param[in]   req: 诊断查询请求结构体
+ * @param[out]  resp: 诊断查询响应结构体
+ * @return      smota_err_t 错误码
+ */
+smota_err_t smota_handle_diag_query_req(const struct smota_diag_req *req,
+                                         struct smota_diag_resp *resp)
+{
+    int ret = -1;
+
+    /* 参数检查 */
+    if (req == NULL || resp == NULL) {
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+
+    resp->error_code = 0;
+    resp->item = req->item;
+    resp->index = req->index;
+    resp->length = 0;
+
+    switch (req->item) {
+    case SMOTA_DIAG_WEAR:
+        ret = diag_fill_wear(req->index, resp);
+        break;
+
+    default:
+        break;
+    }
+
+    /* 查询本身已处理，诊断项不可用时通过错误码告知上位机 */
+    if (ret < 0) {
+        resp->error_code = SMOTA_ERR_DIAG_UNSUPPORTED;
+        resp->length = 0;
+    }
+
+    return SMOTA_ERR_OK;
+}
+
+/**
+ * @brief       处理分片哈希清单请求 (0x08)
+ * @param[in]   req: 清单请求结构体
+ * @param[out]  resp: 清单响应结构体
+ * @return      smota_err_t 错误码，SMOTA_ERR_CRC=编号不连续或清单与 Merkle 根不符（应答 NACK）
+ * @note        只在 HEADER_INFO 之后、第一个数据块之前接收；未开启 SMOTA_CHUNK_MANIFEST 时分片总数为 0
+ */
+smota_err_t smota_handle_chunk_manifest_req(const struct smota_chunk_manifest_req *req,
+                                             struct smota_chunk_manifest_resp *resp)
+{
+    int ret;
+
+    /* 参数检查 */
+    if (req == NULL || resp == NULL) {
+        return SMOTA_ERR_INVALID_PARAM;
+    }
+
+    resp->total = smota_chunk_total();
+    resp->received = smota_chunk_manifest_received();
+
+    /* 检查状态 */
+    if (smota_state_get() != SMOTA_STATE_HEADER_INFO || resp->total == 0) {
+        resp->error_code = SMOTA_ERR_INVALID_STATE;
+        return SMOTA_ERR_INVALID_STATE;
+    }
+
+    ret = smota_chunk_manifest_put(req->index, req->hash, req->count);
+    if (ret < 0) {
+        /* 编号不连续时按 received 续发；与根不符时清单已清空，从 0 重发 */
+        resp->error_code = SMOTA_ERR_CHUNK_MANIFEST;
+        resp->received = smota_chunk_manifest_received();
+        return SMOTA_ERR_CRC;
+    }
+
+    resp->error_code = 0;
+    resp->received = (uint16_t)ret;
+
+    return SMOTA_ERR_OK;
+}
+
 /*---------- end of file ----------*/
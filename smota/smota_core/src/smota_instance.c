@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_instance.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 23:30:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 23:30:00
+ * @Brief        : smOTA 多实例实现
+ */
+
+/*---------- includes ----------*/
+#include <stddef.h>
+#include "smota_instance.h"
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* 当前实例的存储说明符：按线程保存时每个线程各有一份 */
+#if SMOTA_INSTANCE_THREAD_LOCAL
+#if defined(_MSC_VER)
+#define INSTANCE_TLS __declspec(thread)
+#else
+#define INSTANCE_TLS _Thread_local
+#endif
+#else
+#define INSTANCE_TLS
+#endif
+
+/*---------- type define ----------*/
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+/**
+ * @brief  默认实例（原有单实例接口使用，槽位 0）
+ */
+static struct smota_instance g_default_instance;
+
+/**
+ * @brief  当前实例（SMOTA_INSTANCE_THREAD_LOCAL=1 时每个线程一份）
+ */
+static INSTANCE_TLS struct smota_instance *g_current_instance = &g_default_instance;
+
+/**
+ * @brief  槽位登记表
+ */
+static struct smota_instance *g_instance_slots[SMOTA_INSTANCE_MAX] = { &g_default_instance };
+
+/*---------- function ----------*/
+
+/**
+ * @brief       获取默认实例
+ * @return      默认实例
+ */
+struct smota_instance *smota_instance_default(void)
+{
+    return &g_default_instance;
+}
+
+/**
+ * @brief       获取当前实例
+ * @return      当前实例
+ */
+struct smota_instance *smota_instance_current(void)
+{
+    return g_current_instance;
+}
+
+/**
+ * @brief       为实例分配模块状态槽位
+ * @param[in]   inst: 实例
+ * @return      槽位号, <0=失败
+ */
+int smota_instance_attach(struct smota_instance *inst)
+{
+    int free_slot = -1;
+
+    if (inst == NULL) {
+        return -1;
+    }
+
+    for (int i = 0; i < SMOTA_INSTANCE_MAX; i++) {
+        if (g_instance_slots[i] == inst) {
+            return i;
+        }
+        if (g_instance_slots[i] == NULL && free_slot < 0) {
+            free_slot = i;
+        }
+    }
+
+    if (free_slot < 0) {
+        return -2;
+    }
+
+    g_instance_slots[free_slot] = inst;
+    inst->slot = (uint8_t)free_slot;
+    return free_slot;
+}
+
+/**
+ * @brief       释放实例的模块状态槽位
+ * @param[in]   inst: 实例
+ */
+void smota_instance_detach(struct smota_instance *inst)
+{
+    if (inst == NULL || inst == &g_default_instance) {
+        return;
+    }
+
+    for (int i = 1; i < SMOTA_INSTANCE_MAX; i++) {
+        if (g_instance_slots[i] == inst) {
+            g_instance_slots[i] = NULL;
+        }
+    }
+}
+
+/**
+ * @brief       进入实例
+ * @param[in]   inst: 实例
+ * @return      进入前的当前实例
+ */
+struct smota_instance *smota_instance_enter(struct smota_instance *inst)
+{
+    struct smota_instance *prev = g_current_instance;
+
+    g_current_instance = inst;
+    return prev;
+}
+
+/**
+ * @brief       离开实例
+ * @param[in]   prev: 进入前的当前实例
+ */
+void smota_instance_leave(struct smota_instance *prev)
+{
+    g_current_instance = (prev != NULL) ? prev : &g_default_instance;
+}
+
+/*---------- end of file ----------*/
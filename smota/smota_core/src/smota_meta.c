@@ -0,0 +1,625 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_meta.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 09:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 09:00:00
+ * @Brief        : smOTA 元数据存储实现（追加写日志结构）
+ */
+
+/*---------- includes ----------*/
+#include <stddef.h>
+#include <string.h>
+#include "smota_meta.h"
+#include "smota_packet.h"
+#include "smota_partition.h"
+#include "smota_instance.h"
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* 当前实例的元数据存储上下文 */
+#define META_CTX (g_meta_ctx[SMOTA_INSTANCE_SLOT()])
+
+/* 扇区头占用大小（struct meta_sector_hdr 8 字节，对齐到编程单元） */
+#define META_SECTOR_HDR_SIZE SMOTA_ALIGN_UP(8, SMOTA_META_ALIGN)
+
+/* 记录头大小（struct meta_record_hdr，写成常量供下面的编译时检查使用） */
+#define META_RECORD_HDR_SIZE 8
+
+/* 单条记录最大占用大小 */
+#define META_RECORD_MAX_SIZE SMOTA_ALIGN_UP(META_RECORD_HDR_SIZE + SMOTA_META_VALUE_MAX, SMOTA_META_ALIGN)
+
+/* 整理先擦除下一扇区再搬移，每个标签各一条最长记录必须放得下，不能搬到一半才发现扇区不够 */
+#if SMOTA_META_TAG_MAX * META_RECORD_MAX_SIZE + META_SECTOR_HDR_SIZE > SMOTA_META_SECTOR_SIZE
+#error "Error: SMOTA_META_SECTOR_SIZE cannot hold one record per tag, reduce SMOTA_META_TAG_MAX or SMOTA_META_VALUE_MAX!"
+#endif
+
+/* 未写入（已擦除）的标签值 */
+#define META_TAG_ERASED      0xFF
+
+/*---------- type define ----------*/
+
+/**
+ * @brief  扇区头
+ */
+struct meta_sector_hdr {
+    uint32_t magic;      /* 固定为 SMOTA_META_MAGIC */
+    uint32_t generation; /* 扇区代数，整理一次加一，最大者为当前扇区 */
+};
+
+/**
+ * @brief  记录头（后跟 len 字节内容，整体对齐到 SMOTA_META_ALIGN）
+ */
+struct meta_record_hdr {
+    uint8_t tag;  /* 标签 */
+    uint8_t len;  /* 内容长度 */
+    uint16_t crc; /* CRC16（计算时该字段视为 0） */
+    uint32_t seq; /* 全局递增序号 */
+};
+
+/**
+ * @brief  RAM 索引项
+ */
+struct meta_index {
+    uint32_t offset; /* 最新记录在扇区内的偏移，0=无记录 */
+    uint8_t len;     /* 内容长度 */
+};
+
+/**
+ * @brief  元数据存储上下文
+ */
+struct meta_ctx {
+    bool ready;                                  /* 是否已初始化 */
+    const struct smota_partition *part;          /* 元数据分区 */
+    uint8_t sector_num;                          /* 分区内扇区数量 */
+    uint8_t sector;                              /* 当前扇区编号 */
+    uint32_t generation;                         /* 当前扇区代数 */
+    uint32_t write_off;                          /* 下一条记录的写入偏移 */
+    uint32_t seq;                                /* 下一条记录的序号 */
+    struct meta_index index[SMOTA_META_TAG_MAX]; /* 标签 -> 最新记录 */
+};
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+/**
+ * @brief  元数据存储上下文（每个实例一份）
+ */
+static struct meta_ctx g_meta_ctx[SMOTA_INSTANCE_MAX];
+
+/*---------- function ----------*/
+
+/**
+ * @brief       获取元数据扇区在分区内的偏移
+ * @param[in]   sector: 扇区编号
+ * @return      扇区起始偏移
+ */
+static uint32_t meta_sector_addr(uint8_t sector)
+{
+    return (uint32_t)sector * SMOTA_META_SECTOR_SIZE;
+}
+
+/**
+ * @brief       解析元数据分区
+ * @return      0=成功, <0=失败
+ */
+static int meta_partition_open(void)
+{
+    const struct smota_partition *part = smota_partition_find(SMOTA_PART_ID_META);
+
+    if (part == NULL) {
+        return -1;
+    }
+
+    /* 扇区必须可独立擦除，记录对齐必须满足编程单元 */
+    if ((SMOTA_META_SECTOR_SIZE % part->erase_size) != 0 || (SMOTA_META_ALIGN % part->write_size) != 0 ||
+        part->size / SMOTA_META_SECTOR_SIZE < 2 || part->size / SMOTA_META_SECTOR_SIZE > 255) {
+        SMOTA_DEBUG_PRINTF("Meta: partition geometry not supported\r\n");
+        return -1;
+    }
+
+    META_CTX.part = part;
+    META_CTX.sector_num = (uint8_t)(part->size / SMOTA_META_SECTOR_SIZE);
+    return 0;
+}
+
+/**
+ * @brief       读取元数据分区
+ * @return      0=成功, <0=失败
+ */
+static int meta_read(uint32_t offset, uint8_t *data, uint32_t size)
+{
+    return (smota_partition_read(META_CTX.part, offset, data, size) == (int)size) ? 0 : -1;
+}
+
+/**
+ * @brief       编程一段 Flash（带解锁/上锁）
+ * @return      0=成功, <0=失败
+ */
+static int meta_program(uint32_t offset, const uint8_t *data, uint32_t size)
+{
+    int ret;
+
+    smota_partition_unlock(META_CTX.part);
+    ret = smota_partition_write(META_CTX.part, offset, data, size);
+    smota_partition_lock(META_CTX.part);
+
+    return (ret == (int)size) ? 0 : -2;
+}
+
+/**
+ * @brief       擦除一个元数据扇区（带解锁/上锁）
+ * @return      0=成功, <0=失败
+ */
+static int meta_erase_sector(uint8_t sector)
+{
+    int ret;
+
+    smota_partition_unlock(META_CTX.part);
+    ret = smota_partition_erase(META_CTX.part, meta_sector_addr(sector), SMOTA_META_SECTOR_SIZE);
+    smota_partition_lock(META_CTX.part);
+
+    return (ret < 0) ? -2 : 0;
+}
+
+/**
+ * @brief       计算记录 CRC16
+ * @param[in]   record: 完整记录（记录头 + 内容）
+ * @return      CRC16 值
+ */
+static uint16_t meta_record_crc(const uint8_t *record)
+{
+    uint8_t tmp[META_RECORD_HDR_SIZE + SMOTA_META_VALUE_MAX];
+    uint16_t size = (uint16_t)(META_RECORD_HDR_SIZE + record[offsetof(struct meta_record_hdr, len)]);
+
+    /* 记录缓冲区按字节对齐，CRC 字段按偏移清零，不经结构体指针访问 */
+    memcpy(tmp, record, size);
+    memset(tmp + offsetof(struct meta_record_hdr, crc), 0, sizeof(uint16_t));
+
+    return smota_crc16_compute(tmp, size);
+}
+
+/**
+ * @brief       组装一条记录到缓冲区
+ * @param[out]  record: 输出缓冲区（至少 META_RECORD_MAX_SIZE 字节）
+ * @return      记录占用大小（已对齐）
+ */
+static uint32_t meta_record_build(uint8_t *record, uint8_t tag, const void *value, uint8_t len, uint32_t seq)
+{
+    struct meta_record_hdr hdr;
+    uint32_t size = SMOTA_ALIGN_UP(META_RECORD_HDR_SIZE + len, SMOTA_META_ALIGN);
+
+    /* 填充部分保持擦除态，便于后续识别；记录头经局部结构体复制，缓冲区不要求对齐 */
+    memset(record, 0xFF, size);
+    hdr.tag = tag;
+    hdr.len = len;
+    hdr.crc = 0;
+    hdr.seq = seq;
+    memcpy(record, &hdr, META_RECORD_HDR_SIZE);
+    if (len > 0) {
+        memcpy(record + META_RECORD_HDR_SIZE, value, len);
+    }
+    hdr.crc = meta_record_crc(record);
+    memcpy(record, &hdr, META_RECORD_HDR_SIZE);
+
+    return size;
+}
+
+/**
+ * @brief       读取扇区头并判断是否有效
+ * @param[in]   sector: 扇区编号
+ * @param[out]  generation: 扇区代数
+ * @return      true=有效, false=无效
+ */
+static bool meta_sector_valid(uint8_t sector, uint32_t *generation)
+{
+    struct meta_sector_hdr hdr;
+
+    if (meta_read(meta_sector_addr(sector), (uint8_t *)&hdr, sizeof(hdr)) < 0) {
+        return false;
+    }
+
+    if (hdr.magic != SMOTA_META_MAGIC) {
+        return false;
+    }
+
+    *generation = hdr.generation;
+    return true;
+}
+
+/**
+ * @brief       扫描当前扇区，建立 RAM 索引
+ * @return      0=成功, <0=失败
+ * @note        遇到损坏记录（掉电写入中断）时停止扫描，并标记扇区已满，
+ *              下次写入将触发整理，跳过损坏区域
+ */
+static int meta_build_index(void)
+{
+    uint8_t record[META_RECORD_MAX_SIZE];
+    struct meta_record_hdr hdr;
+    uint32_t base = meta_sector_addr(META_CTX.sector);
+    uint32_t off = META_SECTOR_HDR_SIZE;
+    uint32_t size;
+
+    memset(META_CTX.index, 0, sizeof(META_CTX.index));
+    META_CTX.seq = 0;
+
+    while (off + META_RECORD_HDR_SIZE <= SMOTA_META_SECTOR_SIZE) {
+        if (meta_read(base + off, record, META_RECORD_HDR_SIZE) < 0) {
+            return -1;
+        }
+        memcpy(&hdr, record, META_RECORD_HDR_SIZE);
+
+        /* 已到达未写入区域 */
+        if (hdr.tag == META_TAG_ERASED && hdr.len == 0xFF && hdr.seq == 0xFFFFFFFFU) {
+            break;
+        }
+
+        size = SMOTA_ALIGN_UP(META_RECORD_HDR_SIZE + hdr.len, SMOTA_META_ALIGN);
+        if (hdr.tag == 0 || hdr.tag >= SMOTA_META_TAG_MAX || hdr.len > SMOTA_META_VALUE_MAX ||
+            off + size > SMOTA_META_SECTOR_SIZE) {
+            SMOTA_DEBUG_PRINTF("Meta: corrupted record at 0x%08X\r\n", (unsigned int)(base + off));
+            off = SMOTA_META_SECTOR_SIZE;
+            break;
+        }
+
+        if (hdr.len > 0 && meta_read(base + off + META_RECORD_HDR_SIZE, record + META_RECORD_HDR_SIZE, hdr.len) < 0) {
+            return -1;
+        }
+
+        if (meta_record_crc(record) != hdr.crc) {
+            SMOTA_DEBUG_PRINTF("Meta: CRC error at 0x%08X\r\n", (unsigned int)(base + off));
+            off = SMOTA_META_SECTOR_SIZE;
+            break;
+        }
+
+        /* 后写入的记录覆盖先写入的记录 */
+        META_CTX.index[hdr.tag].offset = off;
+        META_CTX.index[hdr.tag].len = hdr.len;
+        if (hdr.seq >= META_CTX.seq) {
+            META_CTX.seq = hdr.seq + 1;
+        }
+
+        off += size;
+    }
+
+    META_CTX.write_off = off;
+    return 0;
+}
+
+/**
+ * @brief       整理：将所有最新记录搬移到下一个扇区，并追加新记录
+ * @param[in]   tag: 新记录标签
+ * @param[in]   value: 新记录内容
+ * @param[in]   len: 新记录长度
+ * @return      0=成功, <0=失败
+ * @note        新扇区头最后写入，整理过程中掉电时旧扇区仍然有效；
+ *              每个标签最多一条记录，扇区容量由编译时检查保证，搬移不会越界
+ */
+static int meta_compact(uint8_t tag, const void *value, uint8_t len)
+{
+    struct meta_index index[SMOTA_META_TAG_MAX];
+    struct meta_sector_hdr sector_hdr;
+    uint8_t record[META_RECORD_MAX_SIZE];
+    uint8_t next = (uint8_t)((META_CTX.sector + 1) % META_CTX.sector_num);
+    uint32_t old_base = meta_sector_addr(META_CTX.sector);
+    uint32_t new_base = meta_sector_addr(next);
+    uint32_t off = META_SECTOR_HDR_SIZE;
+    uint32_t seq = META_CTX.seq;
+    uint32_t size;
+    uint8_t t;
+    int ret;
+
+    ret = meta_erase_sector(next);
+    if (ret < 0) {
+        return ret;
+    }
+
+    memset(index, 0, sizeof(index));
+
+    for (t = 1; t < SMOTA_META_TAG_MAX; t++) {
+        const struct meta_index *item = &META_CTX.index[t];
+        uint8_t buf[SMOTA_META_VALUE_MAX];
+
+        if (item->offset == 0 || t == tag) {
+            continue;
+        }
+
+        if (item->len > 0 && meta_read(old_base + item->offset + META_RECORD_HDR_SIZE, buf, item->len) < 0) {
+            return -3;
+        }
+
+        size = meta_record_build(record, t, buf, item->len, seq);
+        ret = meta_program(new_base + off, record, size);
+        if (ret < 0) {
+            return ret;
+        }
+
+        index[t].offset = off;
+        index[t].len = item->len;
+        off += size;
+        seq++;
+    }
+
+    /* 追加新记录 */
+    size = meta_record_build(record, tag, value, len, seq);
+    ret = meta_program(new_base + off, record, size);
+    if (ret < 0) {
+        return ret;
+    }
+
+    index[tag].offset = off;
+    index[tag].len = len;
+    off += size;
+    seq++;
+
+    /* 最后写入扇区头，新扇区生效 */
+    sector_hdr.magic = SMOTA_META_MAGIC;
+    sector_hdr.generation = META_CTX.generation + 1;
+    ret = meta_program(new_base, (const uint8_t *)&sector_hdr, sizeof(sector_hdr));
+    if (ret < 0) {
+        return ret;
+    }
+
+    SMOTA_DEBUG_PRINTF("Meta: compacted sector %u -> %u (generation %u)\r\n",
+                       (unsigned int)META_CTX.sector, (unsigned int)next,
+                       (unsigned int)sector_hdr.generation);
+
+    META_CTX.sector = next;
+    META_CTX.generation = sector_hdr.generation;
+    META_CTX.write_off = off;
+    META_CTX.seq = seq;
+    memcpy(META_CTX.index, index, sizeof(index));
+
+    return 0;
+}
+
+/**
+ * @brief       格式化元数据存储
+ * @return      0=成功, <0=失败
+ */
+int smota_meta_format(void)
+{
+    struct meta_sector_hdr sector_hdr;
+    uint8_t sector;
+    int ret;
+
+    if (meta_partition_open() < 0) {
+        return -1;
+    }
+
+    for (sector = 0; sector < META_CTX.sector_num; sector++) {
+        ret = meta_erase_sector(sector);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    sector_hdr.magic = SMOTA_META_MAGIC;
+    sector_hdr.generation = 1;
+    ret = meta_program(meta_sector_addr(0), (const uint8_t *)&sector_hdr, sizeof(sector_hdr));
+    if (ret < 0) {
+        return ret;
+    }
+
+    memset(META_CTX.index, 0, sizeof(META_CTX.index));
+    META_CTX.seq = 0;
+    META_CTX.sector = 0;
+    META_CTX.generation = 1;
+    META_CTX.write_off = META_SECTOR_HDR_SIZE;
+    META_CTX.ready = true;
+
+    SMOTA_DEBUG_PRINTF("Meta: formatted at 0x%08X\r\n", (unsigned int)META_CTX.part->addr);
+    return 0;
+}
+
+/**
+ * @brief       初始化元数据存储
+ * @return      0=成功, <0=失败
+ */
+int smota_meta_init(void)
+{
+    uint32_t generation;
+    bool found = false;
+    uint8_t sector;
+    int ret;
+
+    META_CTX.ready = false;
+
+    if (meta_partition_open() < 0) {
+        return -1;
+    }
+
+    /* 选择代数最大的有效扇区 */
+    for (sector = 0; sector < META_CTX.sector_num; sector++) {
+        if (!meta_sector_valid(sector, &generation)) {
+            continue;
+        }
+        if (!found || (int32_t)(generation - META_CTX.generation) > 0) {
+            META_CTX.sector = sector;
+            META_CTX.generation = generation;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return smota_meta_format();
+    }
+
+    ret = meta_build_index();
+    if (ret < 0) {
+        return ret;
+    }
+
+    META_CTX.ready = true;
+
+    SMOTA_DEBUG_PRINTF("Meta: sector %u, generation %u, used %u bytes\r\n",
+                       (unsigned int)META_CTX.sector, (unsigned int)META_CTX.generation,
+                       (unsigned int)META_CTX.write_off);
+    return 0;
+}
+
+/**
+ * @brief       读取标签对应的最新记录
+ * @param[in]   tag: 记录标签
+ * @param[out]  buf: 输出缓冲区
+ * @param[in]   size: 缓冲区大小
+ * @return      实际记录长度, <0=失败（-3 表示记录不存在）
+ */
+int smota_meta_read(uint8_t tag, void *buf, uint8_t size)
+{
+    const struct meta_index *item;
+    uint8_t read_size;
+
+    if (!META_CTX.ready) {
+        return -1;
+    }
+
+    if (tag == 0 || tag >= SMOTA_META_TAG_MAX || buf == NULL) {
+        return -2;
+    }
+
+    item = &META_CTX.index[tag];
+    if (item->offset == 0) {
+        return -3;
+    }
+
+    read_size = (item->len < size) ? item->len : size;
+    if (read_size > 0 &&
+        meta_read(meta_sector_addr(META_CTX.sector) + item->offset + META_RECORD_HDR_SIZE,
+                  (uint8_t *)buf, read_size) < 0) {
+        return -4;
+    }
+
+    return item->len;
+}
+
+/**
+ * @brief       追加写入标签记录
+ * @param[in]   tag: 记录标签
+ * @param[in]   value: 记录内容
+ * @param[in]   len: 记录长度
+ * @return      0=成功, <0=失败
+ */
+int smota_meta_write(uint8_t tag, const void *value, uint8_t len)
+{
+    uint8_t record[META_RECORD_MAX_SIZE];
+    uint8_t old[SMOTA_META_VALUE_MAX];
+    uint32_t size;
+    int ret;
+
+    if (!META_CTX.ready) {
+        return -1;
+    }
+
+    if (tag == 0 || tag >= SMOTA_META_TAG_MAX || len > SMOTA_META_VALUE_MAX ||
+        (value == NULL && len > 0)) {
+        return -2;
+    }
+
+    /* 内容未变化时不写入，减少 Flash 磨损 */
+    if (smota_meta_read(tag, old, sizeof(old)) == len && memcmp(old, value, len) == 0) {
+        return 0;
+    }
+
+    size = SMOTA_ALIGN_UP(META_RECORD_HDR_SIZE + len, SMOTA_META_ALIGN);
+    if (META_CTX.write_off + size > SMOTA_META_SECTOR_SIZE) {
+        return meta_compact(tag, value, len);
+    }
+
+    size = meta_record_build(record, tag, value, len, META_CTX.seq);
+    ret = meta_program(meta_sector_addr(META_CTX.sector) + META_CTX.write_off, record, size);
+    if (ret < 0) {
+        /* 写入位置状态未知，下次写入时整理 */
+        META_CTX.write_off = SMOTA_META_SECTOR_SIZE;
+        return ret;
+    }
+
+    META_CTX.index[tag].offset = META_CTX.write_off;
+    META_CTX.index[tag].len = len;
+    META_CTX.write_off += size;
+    META_CTX.seq++;
+
+    return 0;
+}
+
+/**
+ * @brief       检查标签是否存在有效记录
+ * @param[in]   tag: 记录标签
+ * @return      true=存在, false=不存在
+ */
+bool smota_meta_exists(uint8_t tag)
+{
+    if (!META_CTX.ready || tag == 0 || tag >= SMOTA_META_TAG_MAX) {
+        return false;
+    }
+    return META_CTX.index[tag].offset != 0;
+}
+
+/**
+ * @brief       计数器加一
+ * @param[in]   tag: 计数器标签
+ * @param[out]  value: 输出加一后的值，可为 NULL
+ * @return      0=成功, <0=失败
+ */
+int smota_meta_counter_inc(uint8_t tag, uint32_t *value)
+{
+    uint32_t counter = 0;
+    int ret;
+
+    ret = smota_meta_read(tag, &counter, sizeof(counter));
+    if (ret == -3) {
+        counter = 0;
+    } else if (ret != (int)sizeof(counter)) {
+        return (ret < 0) ? ret : -5;
+    }
+
+    counter++;
+
+    ret = smota_meta_write(tag, &counter, sizeof(counter));
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (value != NULL) {
+        *value = counter;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       设置启动标志位
+ * @param[in]   set_mask: 需要置位的标志
+ * @param[in]   clear_mask: 需要清除的标志
+ * @return      0=成功, <0=失败
+ */
+int smota_meta_boot_flags_update(uint32_t set_mask, uint32_t clear_mask)
+{
+    uint32_t flags = smota_meta_boot_flags_get();
+
+    flags = (flags & ~clear_mask) | set_mask;
+
+    return smota_meta_write(SMOTA_META_TAG_BOOT_FLAGS, &flags, sizeof(flags));
+}
+
+/**
+ * @brief       获取启动标志
+ * @return      启动标志，无记录时返回 0
+ */
+uint32_t smota_meta_boot_flags_get(void)
+{
+    uint32_t flags = 0;
+
+    if (smota_meta_read(SMOTA_META_TAG_BOOT_FLAGS, &flags, sizeof(flags)) != (int)sizeof(flags)) {
+        return 0;
+    }
+
+    return flags;
+}
+
+/*---------- end of file ----------*/
@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_partition.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 10:30:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 10:30:00
+ * @Brief        : smOTA 运行时分区表实现
+ */
+
+/*---------- includes ----------*/
+#include <string.h>
+#include "smota_partition.h"
+#include "smota_packet.h"
+#include "smota_stats.h"
+#include "smota_instance.h"
+#include "smota_config.h"
+#include "../smota_hal/smota_hal.h"
+
+/*---------- macro ----------*/
+
+/* 当前实例的分区表 */
+#define PART_TABLE (g_part_table[SMOTA_INSTANCE_SLOT()])
+
+/* 当前实例的分区表加载标志 */
+#define PART_READY (g_part_ready[SMOTA_INSTANCE_SLOT()])
+
+/*---------- type define ----------*/
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+/**
+ * @brief  当前生效的分区表（RAM 副本，每个实例一份）
+ */
+static struct smota_partition_table g_part_table[SMOTA_INSTANCE_MAX];
+
+/**
+ * @brief  分区表是否已加载
+ */
+static bool g_part_ready[SMOTA_INSTANCE_MAX];
+
+/*---------- function ----------*/
+
+/**
+ * @brief       获取存储设备驱动
+ * @param[in]   dev: 设备编号，0=片内 Flash，1~n=外部存储设备
+ * @return      Flash 驱动指针，NULL=设备不存在
+ */
+const struct smota_flash_driver *smota_partition_device(uint8_t dev)
+{
+    const struct smota_hal *hal = smota_hal_get();
+
+    if (hal == NULL) {
+        return NULL;
+    }
+
+    if (dev == 0) {
+        return hal->flash;
+    }
+
+    if (hal->ext_flash == NULL || dev > hal->ext_flash_num) {
+        return NULL;
+    }
+
+    return hal->ext_flash[dev - 1];
+}
+
+/**
+ * @brief       获取分区所在设备的驱动
+ * @param[in]   part: 分区
+ * @return      Flash 驱动指针，NULL=设备不存在
+ */
+static const struct smota_flash_driver *partition_device(const struct smota_partition *part)
+{
+    if (part == NULL) {
+        return NULL;
+    }
+
+    return smota_partition_device(part->dev);
+}
+
+/**
+ * @brief       检查分区内访问范围
+ * @return      true=合法, false=越界
+ */
+static bool partition_range_valid(const struct smota_partition *part, uint32_t offset, uint32_t size)
+{
+    return (offset <= part->size) && (size <= part->size - offset);
+}
+
+/**
+ * @brief       填充一个分区项
+ */
+static void partition_entry_set(struct smota_partition *entry, const char *name, uint8_t id, uint16_t flags,
+                                uint32_t addr, uint32_t size)
+{
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, SMOTA_PART_NAME_MAX - 1);
+    entry->id = id;
+    entry->dev = 0;
+    entry->flags = flags;
+    entry->addr = addr;
+    entry->size = size;
+    entry->erase_size = SMOTA_FLASH_PAGE_SIZE;
+    entry->write_size = SMOTA_FLASH_WRITE_SIZE;
+}
+
+/**
+ * @brief       计算分区表 CRC16
+ */
+static uint16_t partition_table_crc(const struct smota_partition_table *table)
+{
+    return smota_crc16_compute((const uint8_t *)table->entries,
+                               (uint16_t)(table->count * sizeof(struct smota_partition)));
+}
+
+/**
+ * @brief       校验分区表
+ * @return      0=有效, <0=无效
+ */
+static int partition_table_check(const struct smota_partition_table *table)
+{
+    uint8_t i;
+    uint8_t j;
+
+    if (table->magic != SMOTA_PART_TABLE_MAGIC || table->version != SMOTA_PART_TABLE_VER) {
+        return -1;
+    }
+
+    if (table->count == 0 || table->count > SMOTA_PART_MAX) {
+        return -2;
+    }
+
+    if (partition_table_crc(table) != table->crc) {
+        return -3;
+    }
+
+    for (i = 0; i < table->count; i++) {
+        const struct smota_partition *a = &table->entries[i];
+
+        /* 大小和擦写粒度检查 */
+        if (a->size == 0 || a->erase_size == 0 || a->write_size == 0 ||
+            (a->addr % a->erase_size) != 0 || (a->size % a->erase_size) != 0 ||
+            a->addr + a->size < a->addr) {
+            SMOTA_DEBUG_PRINTF("Partition '%.8s': bad geometry\r\n", a->name);
+            return -4;
+        }
+
+        /* 所在设备必须已在 HAL 中注册 */
+        if (smota_partition_device(a->dev) == NULL) {
+            SMOTA_DEBUG_PRINTF("Partition '%.8s': device %u not registered\r\n", a->name, (unsigned int)a->dev);
+            return -8;
+        }
+
+        for (j = (uint8_t)(i + 1); j < table->count; j++) {
+            const struct smota_partition *b = &table->entries[j];
+
+            /* ID 唯一 */
+            if (a->id == b->id) {
+                SMOTA_DEBUG_PRINTF("Partition '%.8s': duplicated id %u\r\n", b->name, (unsigned int)b->id);
+                return -5;
+            }
+
+            /* 同一设备上的分区不能重叠 */
+            if (a->dev == b->dev && a->addr < b->addr + b->size && b->addr < a->addr + a->size) {
+                SMOTA_DEBUG_PRINTF("Partition '%.8s' overlaps '%.8s'\r\n", a->name, b->name);
+                return -6;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       填充分区表魔数、版本和 CRC
+ * @param[in,out] table: 分区表
+ */
+void smota_partition_table_seal(struct smota_partition_table *table)
+{
+    if (table == NULL || table->count > SMOTA_PART_MAX) {
+        return;
+    }
+
+    table->magic = SMOTA_PART_TABLE_MAGIC;
+    table->version = SMOTA_PART_TABLE_VER;
+    table->crc = partition_table_crc(table);
+}
+
+/**
+ * @brief       获取默认分区表（由 smota_config.h 布局宏生成）
+ * @param[out]  table: 输出分区表
+ */
+void smota_partition_table_default(struct smota_partition_table *table)
+{
+    uint8_t n = 0;
+
+    if (table == NULL) {
+        return;
+    }
+
+    memset(table, 0, sizeof(*table));
+
+    partition_entry_set(&table->entries[n++], "boot", SMOTA_PART_ID_BOOTLOADER, SMOTA_PART_FLAG_READONLY,
+                        SMOTA_FLASH_BASE_ADDR, SMOTA_BOOTLOADER_SIZE);
+    partition_entry_set(&table->entries[n++], "app", SMOTA_PART_ID_APP, 0,
+                        SMOTA_APP_ADDR, SMOTA_APP_SIZE);
+#if SMOTA_MODE != 2
+    partition_entry_set(&table->entries[n++], "backup", SMOTA_PART_ID_BACKUP, 0,
+                        SMOTA_BACKUP_ADDR, SMOTA_APP_SIZE);
+#endif
+    partition_entry_set(&table->entries[n++], "meta", SMOTA_PART_ID_META, 0,
+                        SMOTA_META_ADDR, SMOTA_META_SECTOR_SIZE * SMOTA_META_SECTOR_NUM);
+
+    table->count = n;
+    smota_partition_table_seal(table);
+}
+
+/**
+ * @brief       读取并校验分区表
+ * @param[in]   table: 分区表，NULL=使用默认分区表
+ * @return      0=成功, <0=失败
+ */
+int smota_partition_init(const struct smota_partition_table *table)
+{
+    struct smota_partition_table tmp;
+    int ret;
+
+    PART_READY = false;
+
+    if (table == NULL) {
+        smota_partition_table_default(&tmp);
+    } else {
+        memcpy(&tmp, table, sizeof(tmp));
+    }
+
+    ret = partition_table_check(&tmp);
+    if (ret < 0) {
+        SMOTA_DEBUG_PRINTF("Error: invalid partition table (%d)\r\n", ret);
+        return ret;
+    }
+
+    memcpy(&PART_TABLE, &tmp, sizeof(PART_TABLE));
+    PART_READY = true;
+
+    /* App 区和元数据区为必需分区 */
+    if (smota_partition_find(SMOTA_PART_ID_APP) == NULL || smota_partition_find(SMOTA_PART_ID_META) == NULL) {
+        SMOTA_DEBUG_PRINTF("Error: partition table lacks app/meta partition\r\n");
+        PART_READY = false;
+        return -7;
+    }
+
+    SMOTA_DEBUG_PRINTF("Partition table loaded: %u partitions\r\n", (unsigned int)PART_TABLE.count);
+    return 0;
+}
+
+/**
+ * @brief       获取分区数量
+ * @return      分区数量
+ */
+uint8_t smota_partition_count(void)
+{
+    return PART_READY ? PART_TABLE.count : 0;
+}
+
+/**
+ * @brief       按索引获取分区
+ * @param[in]   index: 分区索引
+ * @return      分区指针，NULL=越界
+ */
+const struct smota_partition *smota_partition_get(uint8_t index)
+{
+    if (!PART_READY || index >= PART_TABLE.count) {
+        return NULL;
+    }
+    return &PART_TABLE.entries[index];
+}
+
+/**
+ * @brief       获取分区在分区表中的索引
+ * @param[in]   part: 分区
+ * @return      分区索引, <0=不在当前分区表中
+ */
+int smota_partition_index(const struct smota_partition *part)
+{
+    if (!PART_READY || part < &PART_TABLE.entries[0] || part >= &PART_TABLE.entries[PART_TABLE.count]) {
+        return -1;
+    }
+    return (int)(part - PART_TABLE.entries);
+}
+
+/**
+ * @brief       按 ID 查找分区
+ * @param[in]   id: 分区 ID
+ * @return      分区指针，NULL=不存在
+ */
+const struct smota_partition *smota_partition_find(uint8_t id)
+{
+    uint8_t i;
+
+    for (i = 0; i < smota_partition_count(); i++) {
+        if (PART_TABLE.entries[i].id == id) {
+            return &PART_TABLE.entries[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief       按名称查找分区
+ * @param[in]   name: 分区名
+ * @return      分区指针，NULL=不存在
+ */
+const struct smota_partition *smota_partition_find_by_name(const char *name)
+{
+    uint8_t i;
+
+    if (name == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < smota_partition_count(); i++) {
+        if (strncmp(PART_TABLE.entries[i].name, name, SMOTA_PART_NAME_MAX) == 0) {
+            return &PART_TABLE.entries[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief       按设备地址查找分区
+ * @param[in]   dev: 存储设备编号
+ * @param[in]   addr: 设备地址
+ * @return      分区指针，NULL=不存在
+ */
+const struct smota_partition *smota_partition_find_by_addr(uint8_t dev, uint32_t addr)
+{
+    uint8_t i;
+
+    for (i = 0; i < smota_partition_count(); i++) {
+        const struct smota_partition *part = &PART_TABLE.entries[i];
+
+        if (part->dev == dev && addr >= part->addr && addr - part->addr < part->size) {
+            return part;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief       读取分区数据
+ * @return      实际读取字节数, <0=失败
+ */
+int smota_partition_read(const struct smota_partition *part, uint32_t offset, uint8_t *data, uint32_t size)
+{
+    const struct smota_flash_driver *flash = partition_device(part);
+    uint64_t start;
+    int ret;
+
+    if (flash == NULL || flash->read == NULL) {
+        return -1;
+    }
+
+    if (data == NULL || !partition_range_valid(part, offset, size)) {
+        return -2;
+    }
+
+    SMOTA_STATS_START(start);
+    ret = flash->read(part->addr + offset, data, size);
+    SMOTA_STATS_STOP(part, SMOTA_FLASH_OP_READ, size, start, ret);
+
+    return ret;
+}
+
+/**
+ * @brief       写入分区数据
+ * @return      实际写入字节数, <0=失败
+ */
+int smota_partition_write(const struct smota_partition *part, uint32_t offset, const uint8_t *data, uint32_t size)
+{
+    const struct smota_flash_driver *flash = partition_device(part);
+    uint64_t start;
+    int ret;
+
+    if (flash == NULL || flash->write == NULL) {
+        return -1;
+    }
+
+    if (data == NULL || !partition_range_valid(part, offset, size)) {
+        return -2;
+    }
+
+    if (part->flags & SMOTA_PART_FLAG_READONLY) {
+        return -3;
+    }
+
+    SMOTA_STATS_START(start);
+    ret = flash->write(part->addr + offset, data, size);
+    SMOTA_STATS_STOP(part, SMOTA_FLASH_OP_WRITE, size, start, ret);
+
+    return ret;
+}
+
+/**
+ * @brief       擦除分区区域
+ * @return      0=成功, <0=失败
+ */
+int smota_partition_erase(const struct smota_partition *part, uint32_t offset, uint32_t size)
+{
+    const struct smota_flash_driver *flash = partition_device(part);
+    uint64_t start;
+    int ret;
+
+    if (flash == NULL || flash->erase == NULL) {
+        return -1;
+    }
+
+    if (!partition_range_valid(part, offset, size) ||
+        (offset % part->erase_size) != 0 || (size % part->erase_size) != 0) {
+        return -2;
+    }
+
+    if (part->flags & SMOTA_PART_FLAG_READONLY) {
+        return -3;
+    }
+
+    SMOTA_STATS_START(start);
+    ret = flash->erase(part->addr + offset, size);
+    SMOTA_STATS_STOP(part, SMOTA_FLASH_OP_ERASE, size, start, ret);
+
+    return ret;
+}
+
+/**
+ * @brief       解锁分区所在设备的写保护
+ * @return      0=成功, <0=失败
+ */
+int smota_partition_unlock(const struct smota_partition *part)
+{
+    const struct smota_flash_driver *flash = partition_device(part);
+    uint64_t start;
+    int ret;
+
+    if (flash == NULL) {
+        return -1;
+    }
+
+    if (flash->flash_unlock == NULL) {
+        return 0;
+    }
+
+    SMOTA_STATS_START(start);
+    ret = flash->flash_unlock();
+    SMOTA_STATS_STOP(part, SMOTA_FLASH_OP_UNLOCK, 0, start, ret);
+
+    return ret;
+}
+
+/**
+ * @brief       上锁分区所在设备的写保护
+ * @return      0=成功, <0=失败
+ */
+int smota_partition_lock(const struct smota_partition *part)
+{
+    const struct smota_flash_driver *flash = partition_device(part);
+    uint64_t start;
+    int ret;
+
+    if (flash == NULL) {
+        return -1;
+    }
+
+    if (flash->flash_lock == NULL) {
+        return 0;
+    }
+
+    SMOTA_STATS_START(start);
+    ret = flash->flash_lock();
+    SMOTA_STATS_STOP(part, SMOTA_FLASH_OP_LOCK, 0, start, ret);
+
+    return ret;
+}
+
+/*---------- end of file ----------*/
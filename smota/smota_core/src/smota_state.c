@@ -14,9 +14,13 @@
 #include <stddef.h>
 #include "../inc/smota_types.h"
 #include "../inc/smota_state.h"
+#include "../inc/smota_instance.h"
 
 /*---------- macro ----------*/
 
+/* 当前实例的 OTA 上下文 */
+#define SMOTA_CTX (smota_instance_current()->ctx)
+
 /*---------- type define ----------*/
 
 /*---------- variable prototype ----------*/
@@ -24,23 +28,6 @@
 /*---------- function prototype ----------*/
 
 /*---------- variable ----------*/
-/**
- * @brief  OTA 上下文实例
- * @note   全局唯一实例，由 smota_init 初始化
- */
-static struct smota_ctx g_smota_ctx = {
-    .state = SMOTA_STATE_IDLE,
-    .firmware_size = 0,
-    .received_size = 0,
-    .firmware_version = {0},
-    .flash_addr = 0,
-    .timeout_ms = 0,
-    .recv_buffer = NULL,
-    .recv_len = 0,
-    .last_packet_time = 0,
-    .retry_count = 0,
-};
-
 /**
  * @brief  状态字符串映射表
  */
@@ -79,7 +66,7 @@ static const bool g_state_transition[SMOTA_STATE_MAX][SMOTA_STATE_MAX] = {
  */
 smota_state_t smota_state_get(void)
 {
-    return g_smota_ctx.state;
+    return SMOTA_CTX.state;
 }
 
 /**
@@ -89,7 +76,7 @@ smota_state_t smota_state_get(void)
  */
 smota_err_t smota_state_set(smota_state_t state)
 {
-    smota_state_t from = g_smota_ctx.state;
+    smota_state_t from = SMOTA_CTX.state;
 
     /* 参数检查 */
     if (state >= SMOTA_STATE_MAX) {
@@ -98,12 +85,12 @@ smota_err_t smota_state_set(smota_state_t state)
 
     /* 检查状态转换是否有效 */
     if (!g_state_transition[from][state]) {
-        g_smota_ctx.state = SMOTA_STATE_ERROR;
+        SMOTA_CTX.state = SMOTA_STATE_ERROR;
         return SMOTA_ERR_INVALID_STATE;
     }
 
     /* 设置新状态 */
-    g_smota_ctx.state = state;
+    SMOTA_CTX.state = state;
 
     return SMOTA_ERR_OK;
 }
@@ -140,20 +127,20 @@ bool smota_state_transition_is_valid(smota_state_t from, smota_state_t to)
  */
 void smota_state_reset(void)
 {
-    g_smota_ctx.state = SMOTA_STATE_IDLE;
-    g_smota_ctx.firmware_size = 0;
-    g_smota_ctx.received_size = 0;
-    g_smota_ctx.recv_len = 0;
-    g_smota_ctx.retry_count = 0;
+    SMOTA_CTX.state = SMOTA_STATE_IDLE;
+    SMOTA_CTX.firmware_size = 0;
+    SMOTA_CTX.received_size = 0;
+    SMOTA_CTX.recv_len = 0;
+    SMOTA_CTX.retry_count = 0;
 }
 
 /**
  * @brief       获取 OTA 上下文指针
- * @return      struct smota_ctx* 上下文指针
+ * @return      struct smota_ctx* 当前实例的上下文指针
  */
 struct smota_ctx *smota_ctx_get(void)
 {
-    return &g_smota_ctx;
+    return &SMOTA_CTX;
 }
 
 /*---------- end of file ----------*/
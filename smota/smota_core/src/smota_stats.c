@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_stats.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 18:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 18:00:00
+ * @Brief        : smOTA Flash 操作统计实现
+ */
+
+/*---------- includes ----------*/
+#include <stddef.h>
+#include <string.h>
+#include "smota_stats.h"
+#include "smota_partition.h"
+#include "smota_instance.h"
+#include "smota_config.h"
+#include "../smota_hal/smota_hal.h"
+
+/*---------- macro ----------*/
+
+/* 当前实例的统计上下文 */
+#define STATS_CTX (g_stats_ctx[SMOTA_INSTANCE_SLOT()])
+
+/*---------- type define ----------*/
+
+#if SMOTA_FLASH_STATS
+/**
+ * @brief  统计上下文
+ */
+struct stats_ctx {
+    uint32_t image_size;                                   /* 固件大小 */
+    uint64_t begin_us;                                     /* 会话开始时间 */
+    struct smota_flash_region_stats region[SMOTA_PART_MAX]; /* 按分区索引 */
+};
+#endif
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+#if SMOTA_FLASH_STATS
+/**
+ * @brief  统计上下文（每个实例一份）
+ */
+static struct stats_ctx g_stats_ctx[SMOTA_INSTANCE_MAX];
+#endif
+
+/**
+ * @brief  操作类型名称
+ */
+static const char *const g_op_names[SMOTA_FLASH_OP_NUM] = {
+    "read", "write", "erase", "unlock", "lock",
+};
+
+/*---------- function ----------*/
+
+/**
+ * @brief       获取微秒时间戳
+ * @return      微秒时间戳
+ */
+uint64_t smota_stats_now_us(void)
+{
+    const struct smota_hal *hal = smota_hal_get();
+
+    if (hal == NULL || hal->system == NULL) {
+        return 0;
+    }
+
+    if (hal->system->get_tick_us != NULL) {
+        return hal->system->get_tick_us();
+    }
+
+    return (hal->system->get_tick_ms != NULL) ? hal->system->get_tick_ms() * 1000U : 0;
+}
+
+/**
+ * @brief       开始新的统计会话
+ * @param[in]   image_size: 本次升级的固件大小
+ */
+void smota_stats_begin(uint32_t image_size)
+{
+#if SMOTA_FLASH_STATS
+    memset(&STATS_CTX, 0, sizeof(STATS_CTX));
+    STATS_CTX.image_size = image_size;
+    STATS_CTX.begin_us = smota_stats_now_us();
+#else
+    (void)image_size;
+#endif
+}
+
+/**
+ * @brief       记录一次 Flash 操作
+ * @param[in]   part: 分区
+ * @param[in]   op: 操作类型
+ * @param[in]   size: 请求的字节数
+ * @param[in]   start_us: 操作开始时间
+ * @param[in]   ret: 驱动返回值
+ */
+void smota_stats_record(const struct smota_partition *part, uint8_t op, uint32_t size, uint64_t start_us, int ret)
+{
+#if SMOTA_FLASH_STATS
+    struct smota_flash_op_stats *item;
+    int index = smota_partition_index(part);
+
+    /* 不在分区表中的分区（调用者自建的描述）不统计 */
+    if (index < 0 || op >= SMOTA_FLASH_OP_NUM) {
+        return;
+    }
+
+    item = &STATS_CTX.region[index].op[op];
+    item->count++;
+    item->time_us += (uint32_t)(smota_stats_now_us() - start_us);
+
+    if (ret < 0) {
+        item->errors++;
+    } else {
+        item->bytes += size;
+    }
+#else
+    (void)part;
+    (void)op;
+    (void)size;
+    (void)start_us;
+    (void)ret;
+#endif
+}
+
+/**
+ * @brief       获取分区统计
+ * @param[in]   index: 分区索引
+ * @param[out]  stats: 输出
+ * @return      0=成功, <0=失败
+ */
+int smota_stats_region_get(uint8_t index, struct smota_flash_region_stats *stats)
+{
+#if SMOTA_FLASH_STATS
+    if (stats == NULL || index >= smota_partition_count()) {
+        return -2;
+    }
+
+    *stats = STATS_CTX.region[index];
+    return 0;
+#else
+    (void)index;
+    (void)stats;
+    return -1;
+#endif
+}
+
+/**
+ * @brief       获取会话摘要
+ * @param[out]  summary: 输出
+ * @return      0=成功, <0=失败
+ */
+int smota_stats_summary_get(struct smota_flash_summary *summary)
+{
+#if SMOTA_FLASH_STATS
+    const struct smota_partition *stage;
+    int stage_index;
+    uint8_t i;
+    uint8_t op;
+
+    if (summary == NULL) {
+        return -2;
+    }
+
+    memset(summary, 0, sizeof(*summary));
+    summary->image_size = STATS_CTX.image_size;
+    summary->elapsed_ms = (uint32_t)((smota_stats_now_us() - STATS_CTX.begin_us) / 1000U);
+
+    for (i = 0; i < smota_partition_count(); i++) {
+        for (op = 0; op < SMOTA_FLASH_OP_NUM; op++) {
+            const struct smota_flash_op_stats *item = &STATS_CTX.region[i].op[op];
+
+            summary->total[op].count += item->count;
+            summary->total[op].errors += item->errors;
+            summary->total[op].bytes += item->bytes;
+            summary->total[op].time_us += item->time_us;
+        }
+    }
+
+    /* 下载分区：有备份区时为备份区，否则为 App 区 */
+    stage = smota_partition_find(SMOTA_PART_ID_BACKUP);
+    if (stage == NULL) {
+        stage = smota_partition_find(SMOTA_PART_ID_APP);
+    }
+
+    stage_index = smota_partition_index(stage);
+    if (stage_index >= 0) {
+        const struct smota_flash_region_stats *region = &STATS_CTX.region[stage_index];
+
+        summary->stage_erase_count = region->op[SMOTA_FLASH_OP_ERASE].count;
+        summary->stage_erase_bytes = region->op[SMOTA_FLASH_OP_ERASE].bytes;
+        summary->stage_write_count = region->op[SMOTA_FLASH_OP_WRITE].count;
+        summary->stage_write_bytes = region->op[SMOTA_FLASH_OP_WRITE].bytes;
+    }
+
+    if (summary->image_size > 0) {
+        uint64_t erase_amp = (uint64_t)summary->stage_erase_bytes * 100U / summary->image_size;
+        uint64_t write_amp = (uint64_t)summary->stage_write_bytes * 100U / summary->image_size;
+
+        summary->erase_amp_x100 = (uint16_t)((erase_amp > 0xFFFFU) ? 0xFFFFU : erase_amp);
+        summary->write_amp_x100 = (uint16_t)((write_amp > 0xFFFFU) ? 0xFFFFU : write_amp);
+    }
+
+    return 0;
+#else
+    (void)summary;
+    return -1;
+#endif
+}
+
+/**
+ * @brief       获取操作类型名称
+ * @param[in]   op: 操作类型
+ * @return      名称字符串
+ */
+const char *smota_stats_op_name(uint8_t op)
+{
+    return (op < SMOTA_FLASH_OP_NUM) ? g_op_names[op] : "unknown";
+}
+
+/*---------- end of file ----------*/
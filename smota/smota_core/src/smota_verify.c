@@ -14,10 +14,35 @@
 #include <stddef.h>
 #include <string.h>
 #include "smota_verify.h"
+#include "smota_instance.h"
+#include "smota_config.h"
 #include "../smota_hal/smota_hal.h"
 
 /*---------- macro ----------*/
 
+/* 当前实例的内容哈希算法 */
+#define HASH_ALG (g_hash_alg[SMOTA_INSTANCE_SLOT()])
+
+/* 上下文池按 8 字节对齐，槽位数量受占用位图（uint32_t）限制 */
+#define CTX_POOL_WORDS(size) (((size) + 7U) / 8U)
+
+#if SMOTA_SHA256_CTX_NUM > 32 || SMOTA_AES_CTX_NUM > 32
+#error "SMOTA_SHA256_CTX_NUM / SMOTA_AES_CTX_NUM must not exceed 32"
+#endif
+
+/* 各实例在不同线程中运行时上下文池按实例平分，每段有自己的占用位图，取还不需要加锁 */
+#if SMOTA_INSTANCE_THREAD_LOCAL
+#define CTX_POOL_PARTS SMOTA_INSTANCE_MAX
+#define CTX_POOL_PART() SMOTA_INSTANCE_SLOT()
+#else
+#define CTX_POOL_PARTS 1
+#define CTX_POOL_PART() 0
+#endif
+
+/* 每段的槽位数 */
+#define SHA256_POOL_SHARE (SMOTA_SHA256_CTX_NUM / CTX_POOL_PARTS)
+#define AES_POOL_SHARE (SMOTA_AES_CTX_NUM / CTX_POOL_PARTS)
+
 /*---------- type define ----------*/
 
 /*---------- variable prototype ----------*/
@@ -25,9 +50,59 @@
 /*---------- function prototype ----------*/
 
 /*---------- variable ----------*/
+/**
+ * @brief  SHA-256 上下文池（HAL 提供 sha256_init_at 时使用）
+ */
+static uint64_t g_sha256_pool[SMOTA_SHA256_CTX_NUM][CTX_POOL_WORDS(SMOTA_SHA256_CTX_SIZE)];
+static uint32_t g_sha256_pool_used[CTX_POOL_PARTS];
+
+/**
+ * @brief  AES-128-CTR 上下文池（HAL 提供 aes_init_at 时使用）
+ */
+static uint64_t g_aes_pool[SMOTA_AES_CTX_NUM][CTX_POOL_WORDS(SMOTA_AES_CTX_SIZE)];
+static uint32_t g_aes_pool_used[CTX_POOL_PARTS];
+
+/**
+ * @brief  本次会话的内容哈希算法（每个实例一份）
+ */
+static uint8_t g_hash_alg[SMOTA_INSTANCE_MAX]; /* 0 即 SMOTA_HASH_ALG_SHA256 */
 
 /*---------- function ----------*/
 
+/**
+ * @brief       从当前实例的上下文池分段取一个空闲槽位
+ * @param[in]   used: 各分段的占用位图
+ * @param[in]   num: 每段槽位数量
+ * @return      槽位编号（整个池中的下标）, <0=已用完
+ */
+static int8_t ctx_pool_take(uint32_t *used, uint8_t num)
+{
+    uint8_t part = (uint8_t)CTX_POOL_PART();
+    uint8_t i;
+
+    for (i = 0; i < num; i++) {
+        if ((used[part] & (1UL << i)) == 0) {
+            used[part] |= (1UL << i);
+            return (int8_t)(part * num + i);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief       归还上下文池槽位
+ * @param[in]   used: 各分段的占用位图
+ * @param[in]   num: 每段槽位数量
+ * @param[in]   slot: 槽位编号，<0 时忽略
+ */
+static void ctx_pool_give(uint32_t *used, uint8_t num, int8_t slot)
+{
+    if (slot >= 0) {
+        used[slot / num] &= ~(1UL << (slot % num));
+    }
+}
+
 /**
  * @brief       开始 SHA-256 计算
  * @param[out]  ctx: SHA-256 上下文指针
@@ -49,11 +124,38 @@ int smota_sha256_start(struct smota_sha256_ctx *ctx)
     }
 
     crypto = hal->crypto;
+    ctx->hal_ctx = NULL;
+    ctx->slot = -1;
+
+    /* 优先在静态上下文池中初始化，不动态分配 */
+    if (crypto->sha256_init_at != NULL) {
+        ctx->slot = ctx_pool_take(g_sha256_pool_used, SHA256_POOL_SHARE);
+#if !SMOTA_CRYPTO_HEAP_FALLBACK
+        if (ctx->slot < 0) {
+            SMOTA_DEBUG_PRINTF("SHA-256 context pool exhausted\r\n");
+            return -4;
+        }
+#endif
+        if (ctx->slot >= 0) {
+            ctx->hal_ctx = g_sha256_pool[ctx->slot];
+            if (crypto->sha256_init_at(ctx->hal_ctx) < 0) {
+                ctx_pool_give(g_sha256_pool_used, SHA256_POOL_SHARE, ctx->slot);
+                ctx->slot = -1;
+                ctx->hal_ctx = NULL;
+                return -3;
+            }
+        }
+    }
 
-    /* 初始化 HAL 上下文 */
-    ctx->hal_ctx = crypto->sha256_init();
+    /* 未提供 sha256_init_at（或开启 SMOTA_CRYPTO_HEAP_FALLBACK 且池已用完）时由驱动分配 */
     if (ctx->hal_ctx == NULL) {
-        return -3;
+        if (crypto->sha256_init == NULL) {
+            return -3;
+        }
+        ctx->hal_ctx = crypto->sha256_init();
+        if (ctx->hal_ctx == NULL) {
+            return -3;
+        }
     }
 
     ctx->total_size = 0;
@@ -125,8 +227,11 @@ int smota_sha256_final(struct smota_sha256_ctx *ctx, uint8_t hash[32])
 
     crypto = hal->crypto;
 
-    /* 调用 HAL 完成 */
+    /* 调用 HAL 完成，无论成败都归还上下文 */
     ret = crypto->sha256_final(ctx->hal_ctx, hash);
+    ctx_pool_give(g_sha256_pool_used, SHA256_POOL_SHARE, ctx->slot);
+    ctx->slot = -1;
+    ctx->hal_ctx = NULL;
     if (ret < 0) {
         return -3;
     }
@@ -134,6 +239,313 @@ int smota_sha256_final(struct smota_sha256_ctx *ctx, uint8_t hash[32])
     return 0;
 }
 
+/**
+ * @brief       HAL 是否支持指定的内容哈希算法
+ * @param[in]   alg: 算法
+ * @return      true=支持
+ */
+bool smota_hash_supported(uint8_t alg)
+{
+    const struct smota_hal *hal = smota_hal_get();
+
+    if (hal == NULL || hal->crypto == NULL) {
+        return false;
+    }
+
+    switch (alg) {
+        case SMOTA_HASH_ALG_SHA256:
+            return true;
+
+        case SMOTA_HASH_ALG_BLAKE2S:
+            return hal->crypto->blake2s_init_at != NULL && hal->crypto->blake2s_update != NULL &&
+                   hal->crypto->blake2s_final != NULL;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief       选择本次会话的内容哈希算法
+ * @param[in]   alg: 算法
+ * @return      0=成功, <0=失败
+ */
+int smota_hash_select(uint8_t alg)
+{
+    if (!smota_hash_supported(alg)) {
+        return -1;
+    }
+
+    HASH_ALG = alg;
+    return 0;
+}
+
+/**
+ * @brief       获取本次会话的内容哈希算法
+ * @return      算法
+ */
+uint8_t smota_hash_current(void)
+{
+    return HASH_ALG;
+}
+
+/**
+ * @brief       开始内容哈希计算
+ * @param[out]  ctx: 上下文
+ * @return      0=成功, <0=失败
+ */
+int smota_hash_start(struct smota_hash_ctx *ctx)
+{
+    const struct smota_hal *hal;
+
+    if (ctx == NULL) {
+        return -1;
+    }
+
+    ctx->alg = HASH_ALG;
+    if (ctx->alg == SMOTA_HASH_ALG_SHA256) {
+        return smota_sha256_start(&ctx->base);
+    }
+
+    hal = smota_hal_get();
+    if (hal == NULL || hal->crypto == NULL || !smota_hash_supported(ctx->alg)) {
+        return -2;
+    }
+
+    /* BLAKE2s 只提供调用者存储接口，与 SHA-256 共用上下文池 */
+    ctx->base.total_size = 0;
+    ctx->base.slot = ctx_pool_take(g_sha256_pool_used, SHA256_POOL_SHARE);
+    if (ctx->base.slot < 0) {
+        ctx->base.hal_ctx = NULL;
+        return -3;
+    }
+
+    ctx->base.hal_ctx = g_sha256_pool[ctx->base.slot];
+    if (hal->crypto->blake2s_init_at(ctx->base.hal_ctx) < 0) {
+        ctx_pool_give(g_sha256_pool_used, SHA256_POOL_SHARE, ctx->base.slot);
+        ctx->base.slot = -1;
+        ctx->base.hal_ctx = NULL;
+        return -3;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       更新内容哈希计算
+ * @param[in]   ctx: 上下文
+ * @param[in]   data: 待计算数据
+ * @param[in]   size: 数据长度
+ * @return      0=成功, <0=失败
+ */
+int smota_hash_update(struct smota_hash_ctx *ctx, const uint8_t *data, uint32_t size)
+{
+    const struct smota_hal *hal;
+
+    if (ctx == NULL || ctx->base.hal_ctx == NULL) {
+        return -1;
+    }
+
+    if (ctx->alg == SMOTA_HASH_ALG_SHA256) {
+        return smota_sha256_update(&ctx->base, data, size);
+    }
+
+    if (data == NULL || size == 0) {
+        return 0;
+    }
+
+    hal = smota_hal_get();
+    if (hal == NULL || hal->crypto == NULL || hal->crypto->blake2s_update == NULL) {
+        return -2;
+    }
+
+    if (hal->crypto->blake2s_update(ctx->base.hal_ctx, data, size) < 0) {
+        return -3;
+    }
+
+    ctx->base.total_size += size;
+    return 0;
+}
+
+/**
+ * @brief       完成内容哈希计算
+ * @param[in]   ctx: 上下文
+ * @param[out]  hash: 输出摘要（32字节）
+ * @return      0=成功, <0=失败
+ */
+int smota_hash_final(struct smota_hash_ctx *ctx, uint8_t hash[32])
+{
+    const struct smota_hal *hal;
+    int ret;
+
+    if (ctx == NULL || ctx->base.hal_ctx == NULL || hash == NULL) {
+        return -1;
+    }
+
+    if (ctx->alg == SMOTA_HASH_ALG_SHA256) {
+        return smota_sha256_final(&ctx->base, hash);
+    }
+
+    hal = smota_hal_get();
+    ret = (hal != NULL && hal->crypto != NULL && hal->crypto->blake2s_final != NULL)
+              ? hal->crypto->blake2s_final(ctx->base.hal_ctx, hash)
+              : -2;
+
+    /* 无论成败都归还上下文 */
+    ctx_pool_give(g_sha256_pool_used, SHA256_POOL_SHARE, ctx->base.slot);
+    ctx->base.slot = -1;
+    ctx->base.hal_ctx = NULL;
+
+    return (ret < 0) ? -3 : 0;
+}
+
+/**
+ * @brief       开始 AES-128-CTR 加解密
+ * @param[out]  ctx: AES 上下文指针
+ * @param[in]   key: 密钥（16字节）
+ * @param[in]   iv: 初始计数器（16字节）
+ * @return      0=成功, <0=失败
+ */
+int smota_aes_start(struct smota_aes_ctx *ctx, const uint8_t key[16], const uint8_t iv[16])
+{
+    const struct smota_hal *hal;
+    const struct smota_crypto_driver *crypto;
+
+    if (ctx == NULL || key == NULL || iv == NULL) {
+        return -1;
+    }
+
+    hal = smota_hal_get();
+    if (hal == NULL || hal->crypto == NULL) {
+        return -2;
+    }
+
+    crypto = hal->crypto;
+    ctx->hal_ctx = NULL;
+    ctx->slot = -1;
+
+    /* 优先在静态上下文池中初始化，不动态分配 */
+    if (crypto->aes_init_at != NULL) {
+        ctx->slot = ctx_pool_take(g_aes_pool_used, AES_POOL_SHARE);
+#if !SMOTA_CRYPTO_HEAP_FALLBACK
+        if (ctx->slot < 0) {
+            SMOTA_DEBUG_PRINTF("AES context pool exhausted\r\n");
+            return -4;
+        }
+#endif
+        if (ctx->slot >= 0) {
+            ctx->hal_ctx = g_aes_pool[ctx->slot];
+            if (crypto->aes_init_at(ctx->hal_ctx, key, iv) < 0) {
+                ctx_pool_give(g_aes_pool_used, AES_POOL_SHARE, ctx->slot);
+                ctx->slot = -1;
+                ctx->hal_ctx = NULL;
+                return -3;
+            }
+        }
+    }
+
+    if (ctx->hal_ctx == NULL) {
+        if (crypto->aes_init == NULL) {
+            return -3;
+        }
+        ctx->hal_ctx = crypto->aes_init(key, iv);
+        if (ctx->hal_ctx == NULL) {
+            return -3;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       重新设置 AES-128-CTR 的密钥和计数器
+ * @param[in]   ctx: AES 上下文指针
+ * @param[in]   key: 密钥（16字节）
+ * @param[in]   iv: 初始计数器（16字节）
+ * @return      0=成功, <0=失败
+ */
+int smota_aes_rekey(struct smota_aes_ctx *ctx, const uint8_t key[16], const uint8_t iv[16])
+{
+    const struct smota_hal *hal;
+
+    if (ctx == NULL || key == NULL || iv == NULL) {
+        return -1;
+    }
+
+    if (ctx->hal_ctx == NULL) {
+        return smota_aes_start(ctx, key, iv);
+    }
+
+    /* 池中的存储原地重新初始化，密钥调度直接覆盖 */
+    hal = smota_hal_get();
+    if (ctx->slot >= 0 && hal != NULL && hal->crypto != NULL && hal->crypto->aes_init_at != NULL) {
+        if (hal->crypto->aes_init_at(ctx->hal_ctx, key, iv) < 0) {
+            smota_aes_end(ctx);
+            return -3;
+        }
+        return 0;
+    }
+
+    /* 驱动分配的上下文先清零释放再重新申请 */
+    smota_aes_end(ctx);
+    return smota_aes_start(ctx, key, iv);
+}
+
+/**
+ * @brief       AES-128-CTR 加解密
+ * @param[in]   ctx: AES 上下文指针
+ * @param[in]   input: 输入数据
+ * @param[out]  output: 输出数据（可与 input 相同）
+ * @param[in]   size: 数据长度
+ * @return      0=成功, <0=失败
+ */
+int smota_aes_crypt(struct smota_aes_ctx *ctx, const uint8_t *input, uint8_t *output, uint32_t size)
+{
+    const struct smota_hal *hal;
+
+    if (ctx == NULL || ctx->hal_ctx == NULL) {
+        return -1;
+    }
+
+    if (size == 0) {
+        return 0;
+    }
+
+    hal = smota_hal_get();
+    if (hal == NULL || hal->crypto == NULL || hal->crypto->aes_crypt == NULL) {
+        return -2;
+    }
+
+    return (hal->crypto->aes_crypt(ctx->hal_ctx, input, output, size) < 0) ? -3 : 0;
+}
+
+/**
+ * @brief       结束 AES-128-CTR 加解密，归还上下文
+ * @param[in]   ctx: AES 上下文指针
+ * @note        上下文池中的存储先清零（含密钥调度）再归还；驱动分配的上下文交给 aes_deinit 清零释放
+ */
+void smota_aes_end(struct smota_aes_ctx *ctx)
+{
+    const struct smota_hal *hal;
+
+    if (ctx == NULL || ctx->hal_ctx == NULL) {
+        return;
+    }
+
+    if (ctx->slot >= 0) {
+        memset(ctx->hal_ctx, 0, sizeof(g_aes_pool[0]));
+        ctx_pool_give(g_aes_pool_used, AES_POOL_SHARE, ctx->slot);
+    } else {
+        hal = smota_hal_get();
+        if (hal != NULL && hal->crypto != NULL && hal->crypto->aes_deinit != NULL) {
+            hal->crypto->aes_deinit(ctx->hal_ctx);
+        }
+    }
+
+    ctx->slot = -1;
+    ctx->hal_ctx = NULL;
+}
+
 /**
  * @brief       验证版本号（防回滚）
  * @param[in]   current_version: 当前版本号[major, minor, patch]
@@ -181,6 +593,80 @@ bool smota_verify_hash_equal(const uint8_t hash1[32], const uint8_t hash2[32])
     return (memcmp(hash1, hash2, 32) == 0);
 }
 
+/**
+ * @brief       校验数据块认证标签
+ * @param[in]   offset: 数据块在固件中的偏移
+ * @param[in]   data: 数据块
+ * @param[in]   size: 数据长度
+ * @param[in]   tag: 收到的标签（16字节）
+ * @return      0=校验通过, -1=HAL 未提供 block_mac, -2=计算失败, -3=标签不符
+ */
+int smota_verify_block_tag(uint32_t offset, const uint8_t *data, uint16_t size, const uint8_t tag[16])
+{
+    const struct smota_hal *hal = smota_hal_get();
+    uint8_t expected[16];
+    uint8_t diff = 0;
+    uint8_t i;
+
+    if (hal == NULL || hal->crypto == NULL || hal->crypto->block_mac == NULL) {
+        return -1;
+    }
+
+    if (data == NULL || tag == NULL || hal->crypto->block_mac(offset, data, size, expected) < 0) {
+        return -2;
+    }
+
+    /* 逐字节累积差异，耗时与不匹配的位置无关 */
+    for (i = 0; i < sizeof(expected); i++) {
+        diff |= (uint8_t)(expected[i] ^ tag[i]);
+    }
+
+    return (diff == 0) ? 0 : -3;
+}
+
+/**
+ * @brief       认证并解密数据块（ChaCha20-Poly1305）
+ * @param[in]   nonce_prefix: 随机数前缀（整包哈希前 8 字节）
+ * @param[in]   offset: 数据块在固件中的偏移
+ * @param[in]   input: 密文
+ * @param[out]  output: 明文
+ * @param[in]   size: 数据长度
+ * @param[in]   tag: 收到的标签（16字节）
+ * @return      0=标签正确并已解密, <0=失败
+ */
+int smota_aead_decrypt_block(const uint8_t nonce_prefix[8], uint32_t offset, const uint8_t *input,
+                             uint8_t *output, uint16_t size, const uint8_t tag[16])
+{
+    const struct smota_hal *hal = smota_hal_get();
+    uint8_t nonce[12];
+    uint8_t aad[6];
+
+    if (hal == NULL || hal->crypto == NULL || hal->crypto->aead_decrypt == NULL) {
+        return -1;
+    }
+
+    if (nonce_prefix == NULL || input == NULL || output == NULL || tag == NULL) {
+        return -2;
+    }
+
+    /* AAD 与 block_mac 的头部相同：offset(LE32) || length(LE16) */
+    aad[0] = (uint8_t)(offset);
+    aad[1] = (uint8_t)(offset >> 8);
+    aad[2] = (uint8_t)(offset >> 16);
+    aad[3] = (uint8_t)(offset >> 24);
+    aad[4] = (uint8_t)(size);
+    aad[5] = (uint8_t)(size >> 8);
+
+    memcpy(nonce, nonce_prefix, 8);
+    memcpy(&nonce[8], aad, 4);
+
+    if (hal->crypto->aead_decrypt(nonce, aad, sizeof(aad), input, output, size, tag) < 0) {
+        return -3;
+    }
+
+    return 0;
+}
+
 /**
  * @brief       快速计算数据的 SHA-256 哈希
  * @param[in]   data: 待计算数据
@@ -200,6 +686,7 @@ int smota_sha256_compute(const uint8_t *data, uint32_t size, uint8_t hash[32])
 
     ret = smota_sha256_update(&ctx, data, size);
     if (ret < 0) {
+        (void)smota_sha256_final(&ctx, hash);  /* 归还上下文 */
         return ret;
     }
 
@@ -208,4 +695,46 @@ int smota_sha256_compute(const uint8_t *data, uint32_t size, uint8_t hash[32])
     return ret;
 }
 
+/**
+ * @brief       批量计算多段独立数据的 SHA-256 哈希
+ * @param[in]   data: 数据指针数组
+ * @param[in]   size: 数据长度数组
+ * @param[out]  hash: 输出哈希值数组（count 个 32 字节）
+ * @param[in]   count: 数据段数量
+ * @return      0=成功, <0=失败
+ */
+int smota_sha256_compute_batch(const uint8_t *const *data, const uint32_t *size, uint8_t (*hash)[32], uint32_t count)
+{
+    const struct smota_hal *hal;
+    uint32_t i;
+    int ret;
+
+    if (count == 0) {
+        return 0;
+    }
+
+    if (data == NULL || size == NULL || hash == NULL) {
+        return -1;
+    }
+
+    hal = smota_hal_get();
+    if (hal == NULL || hal->crypto == NULL) {
+        return -2;
+    }
+
+    if (hal->crypto->sha256_batch != NULL) {
+        ret = hal->crypto->sha256_batch(data, size, hash, count);
+        return (ret < 0) ? -3 : 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        ret = smota_sha256_compute(data[i], size[i], hash[i]);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
 /*---------- end of file ----------*/
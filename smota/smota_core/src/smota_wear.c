@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_wear.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 16:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 16:00:00
+ * @Brief        : smOTA 下载区擦除计数与暂存位置轮换实现
+ */
+
+/*---------- includes ----------*/
+#include <stdbool.h>
+#include <string.h>
+#include "smota_wear.h"
+#include "smota_meta.h"
+#include "smota_partition.h"
+#include "smota_instance.h"
+#include "smota_config.h"
+
+/*---------- macro ----------*/
+
+/* 当前实例的擦除计数上下文 */
+#define WEAR_CTX (g_wear_ctx[SMOTA_INSTANCE_SLOT()])
+
+/* 每条元数据记录保存的计数器数量 */
+#define WEAR_PER_RECORD    (SMOTA_META_VALUE_MAX / sizeof(uint16_t))
+
+/* 计数器数组大小（关闭擦除计数时保留一个占位） */
+#define WEAR_COUNTER_SLOTS ((SMOTA_WEAR_COUNTER_NUM > 0) ? SMOTA_WEAR_COUNTER_NUM : 1)
+
+/*---------- type define ----------*/
+
+/**
+ * @brief  擦除计数上下文
+ */
+struct wear_ctx {
+    bool ready;                                     /* 是否已初始化 */
+    const struct smota_partition *part;             /* 下载分区 */
+    uint16_t unit_num;                              /* 擦除单元数量 */
+    uint16_t group;                                 /* 每个计数器覆盖的擦除单元数 */
+    uint16_t counter_num;                           /* 计数器数量，0=关闭擦除计数 */
+    struct smota_meta_stage stage;                  /* 当前暂存位置 */
+    uint16_t count[WEAR_COUNTER_SLOTS];             /* 擦除计数 */
+    uint8_t dirty[(WEAR_COUNTER_SLOTS + 7) / 8];    /* 本次升级中已擦除、尚未提交的计数器 */
+};
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+/**
+ * @brief  擦除计数上下文（每个实例一份）
+ */
+static struct wear_ctx g_wear_ctx[SMOTA_INSTANCE_MAX];
+
+/*---------- function ----------*/
+
+/**
+ * @brief       获取下载分区
+ * @return      分区指针，NULL=分区表中不存在
+ * @note        与 smota_flash 一致：有备份区时为备份区，否则为 App 区
+ */
+static const struct smota_partition *wear_partition(void)
+{
+    const struct smota_partition *part = smota_partition_find(SMOTA_PART_ID_BACKUP);
+
+    return (part != NULL) ? part : smota_partition_find(SMOTA_PART_ID_APP);
+}
+
+/**
+ * @brief       加载擦除计数器
+ * @note        记录长度与当前计数器数量不符（分区布局变化）时该组计数从 0 开始
+ */
+static void wear_load_counts(void)
+{
+    uint16_t base;
+
+    for (base = 0; base < WEAR_CTX.counter_num; base += WEAR_PER_RECORD) {
+        uint16_t n = WEAR_CTX.counter_num - base;
+        uint8_t tag = (uint8_t)(SMOTA_META_TAG_WEAR + base / WEAR_PER_RECORD);
+
+        if (n > WEAR_PER_RECORD) {
+            n = WEAR_PER_RECORD;
+        }
+
+        if (smota_meta_read(tag, &WEAR_CTX.count[base], (uint8_t)(n * sizeof(uint16_t))) !=
+            (int)(n * sizeof(uint16_t))) {
+            memset(&WEAR_CTX.count[base], 0, n * sizeof(uint16_t));
+        }
+    }
+}
+
+/**
+ * @brief       加载暂存位置
+ * @note        记录超出当前分区范围时视为无效
+ */
+static void wear_load_stage(void)
+{
+    const struct smota_partition *part = WEAR_CTX.part;
+    struct smota_meta_stage stage;
+
+    memset(&WEAR_CTX.stage, 0, sizeof(WEAR_CTX.stage));
+
+    if (smota_meta_read(SMOTA_META_TAG_STAGE, &stage, sizeof(stage)) != (int)sizeof(stage)) {
+        return;
+    }
+
+    if ((stage.offset % part->erase_size) != 0 || stage.size > part->size ||
+        stage.offset > part->size - stage.size) {
+        return;
+    }
+
+    WEAR_CTX.stage = stage;
+}
+
+#if SMOTA_WEAR_ROTATE
+/**
+ * @brief       计算暂存窗口覆盖的擦除计数之和
+ * @param[in]   offset: 窗口起始偏移
+ * @param[in]   size: 窗口大小
+ * @return      擦除计数之和
+ */
+static uint32_t wear_window_sum(uint32_t offset, uint32_t size)
+{
+    uint32_t step = (uint32_t)WEAR_CTX.group * WEAR_CTX.part->erase_size;
+    uint32_t sum = 0;
+    uint32_t i;
+
+    if (WEAR_CTX.counter_num == 0) {
+        return 0;
+    }
+
+    for (i = offset / step; i <= (offset + size - 1) / step && i < WEAR_CTX.counter_num; i++) {
+        sum += WEAR_CTX.count[i];
+    }
+
+    return sum;
+}
+
+/**
+ * @brief       选择擦除计数最少的暂存窗口
+ * @param[in]   size: 暂存大小（已对齐到擦除单元）
+ * @return      暂存起始偏移
+ * @note        候选位置按计数器粒度对齐；从上次暂存区域之后开始比较，
+ *              计数相同时取先遇到的位置，因此计数未拉开差距时依次轮换
+ */
+static uint32_t wear_pick(uint32_t size)
+{
+    uint32_t step = (uint32_t)WEAR_CTX.group * WEAR_CTX.part->erase_size;
+    uint32_t pos_num = (WEAR_CTX.part->size - size) / step + 1;
+    uint32_t start = (WEAR_CTX.stage.offset + WEAR_CTX.stage.size + step - 1) / step;
+    uint32_t best = 0;
+    uint32_t best_sum = UINT32_MAX;
+    uint32_t i;
+
+    if (start >= pos_num) {
+        start = 0;
+    }
+
+    for (i = 0; i < pos_num; i++) {
+        uint32_t k = (start + i) % pos_num;
+        uint32_t sum = wear_window_sum(k * step, size);
+
+        if (sum < best_sum) {
+            best_sum = sum;
+            best = k;
+        }
+    }
+
+    return best * step;
+}
+#endif
+
+/**
+ * @brief       初始化擦除计数
+ * @return      0=成功, <0=失败
+ */
+int smota_wear_init(void)
+{
+    const struct smota_partition *part = wear_partition();
+    uint32_t unit_num;
+
+    memset(&WEAR_CTX, 0, sizeof(WEAR_CTX));
+
+    if (part == NULL) {
+        return -1;
+    }
+
+    unit_num = part->size / part->erase_size;
+    if (unit_num == 0 || unit_num > 0xFFFF) {
+        return -2;
+    }
+
+    WEAR_CTX.part = part;
+    WEAR_CTX.unit_num = (uint16_t)unit_num;
+    WEAR_CTX.group = 1;
+
+    if (SMOTA_WEAR_COUNTER_NUM > 0) {
+        WEAR_CTX.group = (uint16_t)((unit_num + SMOTA_WEAR_COUNTER_NUM - 1) / SMOTA_WEAR_COUNTER_NUM);
+        WEAR_CTX.counter_num = (uint16_t)((unit_num + WEAR_CTX.group - 1) / WEAR_CTX.group);
+        wear_load_counts();
+    }
+
+    wear_load_stage();
+    WEAR_CTX.ready = true;
+
+    SMOTA_DEBUG_PRINTF("Wear: %u units x %u bytes, %u counters, stage at 0x%08X\r\n",
+                       (unsigned int)WEAR_CTX.unit_num, (unsigned int)part->erase_size,
+                       (unsigned int)WEAR_CTX.counter_num, (unsigned int)WEAR_CTX.stage.offset);
+    return 0;
+}
+
+/**
+ * @brief       标记下载分区中被擦除的范围
+ * @param[in]   offset: 分区内偏移
+ * @param[in]   size: 擦除大小
+ */
+void smota_wear_mark(uint32_t offset, uint32_t size)
+{
+    uint32_t unit;
+    uint32_t end;
+
+    if (!WEAR_CTX.ready || WEAR_CTX.counter_num == 0 || size == 0) {
+        return;
+    }
+
+    end = (offset + size - 1) / WEAR_CTX.part->erase_size;
+    for (unit = offset / WEAR_CTX.part->erase_size; unit <= end && unit < WEAR_CTX.unit_num; unit++) {
+        uint32_t i = unit / WEAR_CTX.group;
+        WEAR_CTX.dirty[i / 8] |= (uint8_t)(1U << (i % 8));
+    }
+}
+
+/**
+ * @brief       提交本次升级中标记的擦除
+ * @return      0=成功, <0=失败
+ */
+int smota_wear_commit(void)
+{
+    uint16_t base;
+    int ret = 0;
+
+    if (!WEAR_CTX.ready) {
+        return -1;
+    }
+
+    for (base = 0; base < WEAR_CTX.counter_num; base += WEAR_PER_RECORD) {
+        uint16_t n = WEAR_CTX.counter_num - base;
+        bool changed = false;
+        uint16_t i;
+
+        if (n > WEAR_PER_RECORD) {
+            n = WEAR_PER_RECORD;
+        }
+
+        for (i = base; i < base + n; i++) {
+            if ((WEAR_CTX.dirty[i / 8] & (1U << (i % 8))) == 0) {
+                continue;
+            }
+            if (WEAR_CTX.count[i] < SMOTA_WEAR_COUNT_MAX) {
+                WEAR_CTX.count[i]++;
+            }
+            changed = true;
+        }
+
+        if (changed && smota_meta_write((uint8_t)(SMOTA_META_TAG_WEAR + base / WEAR_PER_RECORD),
+                                        &WEAR_CTX.count[base], (uint8_t)(n * sizeof(uint16_t))) < 0) {
+            ret = -2;
+        }
+    }
+
+    memset(WEAR_CTX.dirty, 0, sizeof(WEAR_CTX.dirty));
+    return ret;
+}
+
+/**
+ * @brief       开始新一次升级，选择暂存起始位置
+ * @param[in]   size: 固件大小
+ * @return      暂存起始偏移, <0=失败
+ * @note        未初始化时固定返回 0
+ */
+int32_t smota_wear_stage_select(uint32_t size)
+{
+    const struct smota_partition *part = WEAR_CTX.part;
+    struct smota_meta_stage stage;
+
+    /* 未初始化时不轮换，也不记录暂存位置 */
+    if (!WEAR_CTX.ready) {
+        return 0;
+    }
+
+    if (size > part->size) {
+        return -2;
+    }
+
+    stage.offset = 0;
+    stage.size = (size + part->erase_size - 1) / part->erase_size * part->erase_size;
+
+#if SMOTA_WEAR_ROTATE
+    /* 单分区模式固件必须从 App 区起始位置开始 */
+    if (part->id != SMOTA_PART_ID_APP && stage.size > 0 && stage.size < part->size) {
+        stage.offset = wear_pick(stage.size);
+    }
+#endif
+
+    if (smota_meta_write(SMOTA_META_TAG_STAGE, &stage, sizeof(stage)) < 0) {
+        return -3;
+    }
+
+    WEAR_CTX.stage = stage;
+    memset(WEAR_CTX.dirty, 0, sizeof(WEAR_CTX.dirty));
+
+    return (int32_t)stage.offset;
+}
+
+/**
+ * @brief       获取当前暂存起始偏移
+ * @return      暂存起始偏移（相对下载分区）
+ */
+uint32_t smota_wear_stage_offset(void)
+{
+    return (WEAR_CTX.ready && SMOTA_WEAR_ROTATE) ? WEAR_CTX.stage.offset : 0;
+}
+
+/**
+ * @brief       获取磨损概况
+ * @param[out]  info: 输出
+ * @return      0=成功, <0=失败
+ */
+int smota_wear_info_get(struct smota_wear_info *info)
+{
+    uint16_t i;
+
+    if (info == NULL) {
+        return -1;
+    }
+
+    if (!WEAR_CTX.ready) {
+        return -2;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->erase_size = WEAR_CTX.part->erase_size;
+    info->unit_num = WEAR_CTX.unit_num;
+    info->unit_per_counter = WEAR_CTX.group;
+    info->counter_num = WEAR_CTX.counter_num;
+    info->stage_offset = smota_wear_stage_offset();
+    info->stage_size = WEAR_CTX.stage.size;
+
+    for (i = 0; i < WEAR_CTX.counter_num; i++) {
+        if (i == 0 || WEAR_CTX.count[i] < info->min_count) {
+            info->min_count = WEAR_CTX.count[i];
+        }
+        if (WEAR_CTX.count[i] > info->max_count) {
+            info->max_count = WEAR_CTX.count[i];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       读取擦除计数器
+ * @param[in]   first: 起始计数器编号
+ * @param[out]  counts: 输出缓冲区
+ * @param[in]   num: 最多读取的数量
+ * @return      实际读取的数量, <0=失败
+ */
+int smota_wear_counts_get(uint16_t first, uint16_t *counts, uint16_t num)
+{
+    if (counts == NULL) {
+        return -1;
+    }
+
+    if (!WEAR_CTX.ready) {
+        return -2;
+    }
+
+    if (first >= WEAR_CTX.counter_num) {
+        return 0;
+    }
+
+    if (num > WEAR_CTX.counter_num - first) {
+        num = WEAR_CTX.counter_num - first;
+    }
+
+    memcpy(counts, &WEAR_CTX.count[first], num * sizeof(uint16_t));
+    return num;
+}
+
+/*---------- end of file ----------*/
@@ -11,6 +11,7 @@
 
 /*---------- includes ----------*/
 #include "smota_hal.h"
+#include "../smota_core/inc/smota_instance.h"
 #include "../smota_core/inc/smota_config.h"
 
 /*---------- macro ----------*/
@@ -19,11 +20,7 @@
 
 /*---------- variable prototype ----------*/
 
-/**
- * @brief  全局 HAL 接口指针
- * @note   静态变量，仅在本文件可见
- */
-static const struct smota_hal *g_smota_hal = NULL;
+/* HAL 接口指针保存在当前实例中（smota_instance.h） */
 
 /*---------- function prototype ----------*/
 
@@ -57,6 +54,20 @@ int smota_hal_register(const struct smota_hal *hal)
         return -4;
     }
 
+    /* 外部存储设备可选，注册时必须完整 */
+    if (hal->ext_flash_num > 0) {
+        if (hal->ext_flash == NULL) {
+            SMOTA_DEBUG_PRINTF("Error: External flash list is NULL\r\n");
+            return -6;
+        }
+        for (uint8_t i = 0; i < hal->ext_flash_num; i++) {
+            if (hal->ext_flash[i] == NULL) {
+                SMOTA_DEBUG_PRINTF("Error: External flash %u is NULL\r\n", (unsigned int)i);
+                return -6;
+            }
+        }
+    }
+
     /* 加密驱动可选（根据配置） */
 #if SMOTA_RELIABILITY_SOURCE || SMOTA_RELIABILITY_TRANSMISSION
     if (hal->crypto == NULL) {
@@ -64,9 +75,42 @@ int smota_hal_register(const struct smota_hal *hal)
         return -5;
     }
 #endif
+    /* 调用者提供存储时，上下文须放得进核心的静态上下文池 */
+    if (hal->crypto != NULL && hal->crypto->sha256_init_at != NULL &&
+        (hal->crypto->sha256_ctx_size == NULL || hal->crypto->sha256_ctx_size() > SMOTA_SHA256_CTX_SIZE)) {
+        SMOTA_DEBUG_PRINTF("Error: SHA-256 context exceeds SMOTA_SHA256_CTX_SIZE\r\n");
+        return -5;
+    }
+    if (hal->crypto != NULL && hal->crypto->aes_init_at != NULL &&
+        (hal->crypto->aes_ctx_size == NULL || hal->crypto->aes_ctx_size() > SMOTA_AES_CTX_SIZE)) {
+        SMOTA_DEBUG_PRINTF("Error: AES context exceeds SMOTA_AES_CTX_SIZE\r\n");
+        return -5;
+    }
+    /* 驱动分配的 AES 上下文含密钥调度，须能清零释放 */
+    if (hal->crypto != NULL && hal->crypto->aes_init != NULL && hal->crypto->aes_deinit == NULL) {
+        SMOTA_DEBUG_PRINTF("Error: aes_init requires aes_deinit\r\n");
+        return -5;
+    }
+    if (hal->crypto != NULL && hal->crypto->blake2s_init_at != NULL &&
+        (hal->crypto->blake2s_ctx_size == NULL || hal->crypto->blake2s_ctx_size() > SMOTA_SHA256_CTX_SIZE)) {
+        SMOTA_DEBUG_PRINTF("Error: BLAKE2s context exceeds SMOTA_SHA256_CTX_SIZE\r\n");
+        return -5;
+    }
+#if SMOTA_BLOCK_AUTH
+    if (hal->crypto == NULL || hal->crypto->block_mac == NULL) {
+        SMOTA_DEBUG_PRINTF("Error: Block MAC is NULL (required by SMOTA_BLOCK_AUTH)\r\n");
+        return -5;
+    }
+#endif
+#if SMOTA_CHACHA20_POLY1305
+    if (hal->crypto == NULL || hal->crypto->aead_decrypt == NULL) {
+        SMOTA_DEBUG_PRINTF("Error: AEAD decrypt is NULL (required by SMOTA_CHACHA20_POLY1305)\r\n");
+        return -5;
+    }
+#endif
 
-    /* 保存 HAL 指针 */
-    g_smota_hal = hal;
+    /* 保存 HAL 指针（绑定到当前实例） */
+    smota_instance_current()->hal = hal;
 
     SMOTA_DEBUG_PRINTF("HAL registered successfully\r\n");
     return 0;
@@ -78,7 +122,7 @@ int smota_hal_register(const struct smota_hal *hal)
  */
 const struct smota_hal *smota_hal_get(void)
 {
-    return g_smota_hal;
+    return smota_instance_current()->hal;
 }
 
 /**
@@ -87,12 +131,12 @@ const struct smota_hal *smota_hal_get(void)
  */
 int smota_hal_unregister(void)
 {
-    if (g_smota_hal == NULL) {
+    if (smota_instance_current()->hal == NULL) {
         SMOTA_DEBUG_PRINTF("Warning: HAL not registered\r\n");
         return -1;
     }
 
-    g_smota_hal = NULL;
+    smota_instance_current()->hal = NULL;
     SMOTA_DEBUG_PRINTF("HAL unregistered\r\n");
     return 0;
 }
@@ -103,7 +147,7 @@ int smota_hal_unregister(void)
  */
 int smota_hal_is_initialized(void)
 {
-    return (g_smota_hal != NULL) ? 1 : 0;
+    return (smota_instance_current()->hal != NULL) ? 1 : 0;
 }
 
 /*---------- end of file ----------*/
@@ -27,7 +27,7 @@ extern "C" {
  * @brief  HAL 版本号
  */
 #define SMOTA_HAL_VERSION_MAJOR  1
-#define SMOTA_HAL_VERSION_MINOR  0
+#define SMOTA_HAL_VERSION_MINOR  1
 #define SMOTA_HAL_VERSION_PATCH  0
 
 /*---------- type define ----------*/
@@ -121,6 +121,7 @@ struct smota_comm_driver {
      * @param  size: 期望接收字节数
      * @param  timeout: 超时时间（毫秒）
      * @return 实际接收字节数，<0=失败/超时
+     * @note   开启 SMOTA_FEED_BUF_SIZE 时数据由中断调用 smota_feed() 推送，不再调用此函数，可为 NULL
      */
     int (*receive)(uint8_t *data, uint32_t size, uint32_t timeout);
 };
@@ -135,6 +136,7 @@ struct smota_crypto_driver {
     /**
      * @brief  初始化 SHA-256 上下文
      * @return 上下文指针，NULL=失败
+     * @note   由驱动分配存储，sha256_final 时释放；提供 sha256_init_at 时可为 NULL
      */
     void *(*sha256_init)(void);
 
@@ -162,9 +164,17 @@ struct smota_crypto_driver {
      * @param  key: 密钥（16字节）
      * @param  iv: 初始化向量（16字节）
      * @return 上下文指针，NULL=失败
+     * @note   由驱动分配存储，aes_deinit 时释放；提供 aes_init_at 时可为 NULL
      */
     void *(*aes_init)(const uint8_t *key, const uint8_t *iv);
 
+    /**
+     * @brief  释放 aes_init 分配的上下文
+     * @param  ctx: 上下文指针
+     * @note   须先清零（含密钥调度）再释放；提供 aes_init 时必须提供，否则 smota_hal_register() 失败
+     */
+    void (*aes_deinit)(void *ctx);
+
     /**
      * @brief  AES 加密/解密（CTR模式）
      * @param  ctx: 上下文指针
@@ -172,7 +182,8 @@ struct smota_crypto_driver {
      * @param  output: 输出数据
      * @param  size: 数据长度
      * @return 0=成功, <0=失败
-     * @note   CTR模式下加密和解密使用同一函数
+     * @note   CTR模式下加密和解密使用同一函数；计数器为 iv 末 4 字节，按 16 字节分组大端递增，
+     *         input 与 output 可以相同（传输解密对全零缓冲区原地加密以生成密钥流）
      */
     int (*aes_crypt)(void *ctx, const uint8_t *input, uint8_t *output, uint32_t size);
 
@@ -190,6 +201,133 @@ struct smota_crypto_driver {
                         const uint8_t *sig_r,
                         const uint8_t *sig_s,
                         const uint8_t *pub_key);
+
+    /**
+     * @brief  用编译时固化的公钥验证 ECDSA-P256 签名
+     * @param  hash: 消息哈希（32字节）
+     * @param  sig_r: 签名 r 分量（32字节）
+     * @param  sig_s: 签名 s 分量（32字节）
+     * @return 0=验证成功, <0=验证失败
+     * @note   可选，NULL=由 smota_get_key(SMOTA_KEY_ECDSA_PUB) 取公钥调用 ecdsa_verify；
+     *         提供时 HEADER_INFO 验签优先使用，驱动可直接使用 keygen.py 生成的验签预计算表
+     *         （uECC_verify_with_table），省去每次验签的公钥转换和倍点计算
+     */
+    int (*ecdsa_verify_fixed)(const uint8_t *hash, const uint8_t *sig_r, const uint8_t *sig_s);
+
+    /* ========== SHA-256 批量（可选） ========== */
+
+    /**
+     * @brief  批量计算多段独立数据的 SHA-256
+     * @param  data: 数据指针数组
+     * @param  size: 数据长度数组
+     * @param  hash: 输出哈希值数组（count 个 32 字节）
+     * @param  count: 数据段数量
+     * @return 0=成功, <0=失败
+     * @note   可选，NULL=逐段使用 sha256_init/update/final；
+     *         主机端可用多缓冲 SIMD 实现（如 tc_sha256_mb）
+     */
+    int (*sha256_batch)(const uint8_t *const *data, const uint32_t *size,
+                        uint8_t (*hash)[32], uint32_t count);
+
+    /* ========== 数据块认证（SMOTA_BLOCK_AUTH） ========== */
+
+    /**
+     * @brief  计算数据块认证标签
+     * @param  offset: 数据块在固件中的偏移
+     * @param  data: 数据块（传输的原始字节）
+     * @param  size: 数据长度
+     * @param  tag: 输出标签（16字节）
+     * @return 0=成功, <0=失败
+     * @note   开启 SMOTA_BLOCK_AUTH 时必须提供；计算 MAC(offset || length || data)，
+     *         offset 为 4 字节小端、length 为 2 字节小端，密钥由移植层管理，
+     *         与上位机一致（如 AES-128-CMAC 取截断前的 16 字节）
+     */
+    int (*block_mac)(uint32_t offset, const uint8_t *data, uint16_t size, uint8_t tag[16]);
+
+    /* ========== 数据块 AEAD 加密（SMOTA_CHACHA20_POLY1305） ========== */
+
+    /**
+     * @brief  认证并解密数据块（ChaCha20-Poly1305）
+     * @param  nonce: 随机数（12字节）
+     * @param  aad: 附加认证数据
+     * @param  aad_len: 附加认证数据长度
+     * @param  input: 密文
+     * @param  output: 明文输出（可与 input 相同）
+     * @param  size: 数据长度
+     * @param  tag: 收到的标签（16字节）
+     * @return 0=标签正确并已解密, <0=失败或标签不符（output 内容无效）
+     * @note   开启 SMOTA_CHACHA20_POLY1305 时必须提供；密钥由移植层管理，
+     *         按一机一密用 KDF 派生（上下文 SMOTA_KDF_CONTEXT），与上位机一致
+     */
+    int (*aead_decrypt)(const uint8_t nonce[12], const uint8_t *aad, uint32_t aad_len, const uint8_t *input,
+                        uint8_t *output, uint32_t size, const uint8_t tag[16]);
+
+    /* ========== 调用者提供上下文存储（可选） ========== */
+
+    /**
+     * @brief  获取 SHA-256 上下文大小
+     * @return 字节数，不超过 SMOTA_SHA256_CTX_SIZE
+     */
+    uint32_t (*sha256_ctx_size)(void);
+
+    /**
+     * @brief  在调用者提供的存储中初始化 SHA-256 上下文
+     * @param  ctx: 存储（sha256_ctx_size() 字节，按 8 字节对齐）
+     * @return 0=成功, <0=失败
+     * @note   可选，NULL=使用 sha256_init；提供时核心从静态上下文池取存储，
+     *         sha256_update/final 使用同一指针，sha256_final 不得释放它
+     */
+    int (*sha256_init_at)(void *ctx);
+
+    /**
+     * @brief  获取 AES-128-CTR 上下文大小
+     * @return 字节数，不超过 SMOTA_AES_CTX_SIZE
+     */
+    uint32_t (*aes_ctx_size)(void);
+
+    /**
+     * @brief  在调用者提供的存储中初始化 AES-128-CTR 上下文
+     * @param  ctx: 存储（aes_ctx_size() 字节，按 8 字节对齐）
+     * @param  key: 密钥（16字节）
+     * @param  iv: 初始化向量（16字节）
+     * @return 0=成功, <0=失败
+     * @note   可选，NULL=使用 aes_init；存储由核心的静态上下文池管理
+     */
+    int (*aes_init_at)(void *ctx, const uint8_t *key, const uint8_t *iv);
+
+    /* ========== BLAKE2s-256 内容哈希（可选，SMOTA_HASH_BLAKE2S） ========== */
+
+    /**
+     * @brief  获取 BLAKE2s 上下文大小
+     * @return 字节数，不超过 SMOTA_SHA256_CTX_SIZE（与 SHA-256 共用上下文池）
+     */
+    uint32_t (*blake2s_ctx_size)(void);
+
+    /**
+     * @brief  在调用者提供的存储中初始化 BLAKE2s-256 上下文（无密钥，32 字节摘要）
+     * @param  ctx: 存储（blake2s_ctx_size() 字节，按 8 字节对齐）
+     * @return 0=成功, <0=失败
+     * @note   可选，四个 blake2s_* 全部提供时握手声明 SMOTA_CAP_HASH_BLAKE2S，
+     *         上位机可选用 BLAKE2s 作为整包哈希、分片哈希和签名摘要的算法
+     */
+    int (*blake2s_init_at)(void *ctx);
+
+    /**
+     * @brief  更新 BLAKE2s 计算
+     * @param  ctx: 上下文
+     * @param  data: 待计算数据
+     * @param  size: 数据长度
+     * @return 0=成功, <0=失败
+     */
+    int (*blake2s_update)(void *ctx, const uint8_t *data, uint32_t size);
+
+    /**
+     * @brief  完成 BLAKE2s 计算
+     * @param  ctx: 上下文（不得释放）
+     * @param  hash: 输出摘要（32字节）
+     * @return 0=成功, <0=失败
+     */
+    int (*blake2s_final)(void *ctx, uint8_t hash[32]);
 };
 
 /**
@@ -208,17 +346,33 @@ struct smota_system_driver {
      * @note   此函数不会返回
      */
     void (*system_reset)(void);
+
+    /**
+     * @brief  获取微秒时间戳（可选）
+     * @return 系统运行时间（微秒）
+     * @note   用于 Flash 操作耗时统计（SMOTA_FLASH_STATS），NULL=使用 get_tick_ms 换算
+     */
+    uint64_t (*get_tick_us)(void);
 };
 
+struct smota_partition_table;
+
 /**
  * @brief  smOTA HAL 综合接口
- * @details 包含所有驱动接口，通过此结构体注册平台实现
+ * @details 包含所有驱动接口，通过此结构体注册平台实现；
+ *          flash 为片内 Flash（设备 0），外部 SPI/QSPI NOR 等设备通过 ext_flash 注册，
+ *          由分区表中的 dev 字段绑定到具体分区
  */
 struct smota_hal {
     struct smota_flash_driver   *flash;
     struct smota_comm_driver    *comm;
     struct smota_crypto_driver  *crypto;
     struct smota_system_driver  *system;
+    /* 分区表（可选），NULL=使用 smota_config.h 布局宏生成的默认分区表 */
+    const struct smota_partition_table *partitions;
+    /* 外部存储设备（可选），分区 dev=1..ext_flash_num 对应 ext_flash[0..ext_flash_num-1] */
+    struct smota_flash_driver  *const *ext_flash;
+    uint8_t                     ext_flash_num;
 };
 
 /*---------- variable prototype ----------*/
@@ -229,13 +383,13 @@ struct smota_hal {
  * @brief  注册并初始化 HAL 接口
  * @param  hal: HAL 结构体指针
  * @return 0=成功, <0=失败
- * @note   必须在使用任何 HAL 功能前调用
+ * @note   必须在使用任何 HAL 功能前调用；HAL 绑定到当前实例（未进入实例时为默认实例）
  */
 int smota_hal_register(const struct smota_hal *hal);
 
 /**
  * @brief  获取已注册的 HAL 接口
- * @return HAL 结构体指针，NULL=未初始化
+ * @return 当前实例的 HAL 结构体指针，NULL=未初始化
  */
 const struct smota_hal *smota_hal_get(void);
 
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_nor_flash.c
+ * @Author       : lxf
+ * @Date         : 2026-10-18 14:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 14:00:00
+ * @Brief        : smOTA 外部 SPI/QSPI NOR Flash 参考驱动实现
+ */
+
+/*---------- includes ----------*/
+#include <stddef.h>
+#include "smota_nor_flash.h"
+#include "../smota_core/inc/smota_config.h"
+
+/*---------- macro ----------*/
+
+/* JEDEC 通用命令 */
+#define NOR_CMD_WRITE_ENABLE    0x06
+#define NOR_CMD_WRITE_DISABLE   0x04
+#define NOR_CMD_READ_STATUS     0x05
+#define NOR_CMD_READ_ID         0x9F
+#define NOR_CMD_RELEASE_PD      0xAB
+#define NOR_CMD_FAST_READ       0x0B
+#define NOR_CMD_PAGE_PROGRAM    0x02
+#define NOR_CMD_SECTOR_ERASE    0x20
+#define NOR_CMD_BLOCK_ERASE     0xD8
+
+/* 4 字节地址命令 */
+#define NOR_CMD_FAST_READ_4B    0x0C
+#define NOR_CMD_PAGE_PROGRAM_4B 0x12
+#define NOR_CMD_SECTOR_ERASE_4B 0x21
+#define NOR_CMD_BLOCK_ERASE_4B  0xDC
+
+/* 状态寄存器：写入/擦除进行中 */
+#define NOR_STATUS_WIP          0x01
+
+/*---------- type define ----------*/
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+/**
+ * @brief  默认设备（smota_nor_attach()/smota_nor_*() 使用）
+ */
+static struct smota_nor_dev g_nor_dev;
+
+/*---------- function ----------*/
+
+/**
+ * @brief  组装命令 + 地址
+ * @param  dev: 设备
+ * @param  cmd: 输出缓冲区（至少 6 字节）
+ * @param  op: 3 字节地址命令
+ * @param  op_4b: 4 字节地址命令
+ * @param  addr: 设备地址
+ * @param  dummy: dummy 字节数
+ * @return 命令阶段长度
+ */
+static uint32_t nor_build_cmd(const struct smota_nor_dev *dev, uint8_t *cmd, uint8_t op, uint8_t op_4b, uint32_t addr, uint8_t dummy)
+{
+    uint32_t n = 0;
+
+    if (dev->addr_len == 4) {
+        cmd[n++] = op_4b;
+        cmd[n++] = (uint8_t)(addr >> 24);
+    } else {
+        cmd[n++] = op;
+    }
+    cmd[n++] = (uint8_t)(addr >> 16);
+    cmd[n++] = (uint8_t)(addr >> 8);
+    cmd[n++] = (uint8_t)addr;
+
+    while (dummy-- > 0) {
+        cmd[n++] = 0xFF;
+    }
+
+    return n;
+}
+
+/**
+ * @brief  发送单字节命令
+ * @param  dev: 设备
+ * @param  op: 命令
+ * @return 0=成功, <0=失败
+ */
+static int nor_command(const struct smota_nor_dev *dev, uint8_t op)
+{
+    return dev->bus->transfer(&op, 1, NULL, NULL, 0);
+}
+
+/**
+ * @brief  等待写入/擦除完成
+ * @param  dev: 设备
+ * @param  timeout_ms: 超时时间
+ * @return 0=成功, <0=超时或总线错误
+ * @note   HAL 没有 get_tick_ms 时按 SMOTA_NOR_POLL_MAX 限制读状态次数，芯片卡死时不会永久阻塞
+ */
+static int nor_wait_ready(const struct smota_nor_dev *dev, uint32_t timeout_ms)
+{
+    const struct smota_hal *hal = smota_hal_get();
+    uint8_t op = NOR_CMD_READ_STATUS;
+    uint8_t status;
+    uint64_t start = 0;
+    uint32_t polls = 0;
+    int has_tick = 0;
+
+    if (hal != NULL && hal->system != NULL && hal->system->get_tick_ms != NULL) {
+        start = hal->system->get_tick_ms();
+        has_tick = 1;
+    }
+
+    while (1) {
+        if (dev->bus->transfer(&op, 1, NULL, &status, 1) < 0) {
+            return -1;
+        }
+
+        if ((status & NOR_STATUS_WIP) == 0) {
+            return 0;
+        }
+
+        if (has_tick ? (hal->system->get_tick_ms() - start > timeout_ms) : (++polls >= SMOTA_NOR_POLL_MAX)) {
+            SMOTA_DEBUG_PRINTF("NOR: busy timeout\r\n");
+            return -2;
+        }
+    }
+}
+
+/**
+ * @brief  绑定 SPI 总线和芯片容量
+ * @param  dev: 设备
+ * @param  bus: 总线接口
+ * @param  capacity: 芯片容量（字节）
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_dev_attach(struct smota_nor_dev *dev, const struct smota_nor_bus *bus, uint32_t capacity)
+{
+    if (dev == NULL || bus == NULL || bus->transfer == NULL || capacity == 0 ||
+        (capacity % SMOTA_NOR_BLOCK_SIZE) != 0) {
+        return -1;
+    }
+
+    dev->bus = bus;
+    dev->capacity = capacity;
+    dev->addr_len = (capacity > SMOTA_NOR_3B_ADDR_MAX) ? 4 : 3;
+    dev->is_init = 0;
+
+    return 0;
+}
+
+/**
+ * @brief  初始化 NOR Flash（唤醒并读取 JEDEC ID）
+ * @param  dev: 设备
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_dev_init(struct smota_nor_dev *dev)
+{
+    uint8_t op = NOR_CMD_READ_ID;
+
+    if (dev == NULL || dev->bus == NULL || dev->bus->transfer == NULL || dev->capacity == 0 ||
+        (dev->capacity % SMOTA_NOR_BLOCK_SIZE) != 0) {
+        return -1;
+    }
+
+    if (dev->is_init) {
+        return 0;
+    }
+
+    /* SMOTA_NOR_DEVICE_DEFINE() 静态定义的设备不经过 attach，在此补算地址长度 */
+    dev->addr_len = (dev->capacity > SMOTA_NOR_3B_ADDR_MAX) ? 4 : 3;
+
+    /* 从深度掉电模式唤醒（已唤醒时无副作用） */
+    if (nor_command(dev, NOR_CMD_RELEASE_PD) < 0) {
+        return -2;
+    }
+
+    if (dev->bus->transfer(&op, 1, NULL, dev->jedec_id, sizeof(dev->jedec_id)) < 0) {
+        return -2;
+    }
+
+    /* 总线悬空或芯片未焊接 */
+    if (dev->jedec_id[0] == 0x00 || dev->jedec_id[0] == 0xFF) {
+        SMOTA_DEBUG_PRINTF("NOR: no device (ID %02X)\r\n", (unsigned int)dev->jedec_id[0]);
+        return -3;
+    }
+
+    dev->is_init = 1;
+
+    SMOTA_DEBUG_PRINTF("NOR: JEDEC ID %02X %02X %02X, %u KB\r\n",
+                       (unsigned int)dev->jedec_id[0], (unsigned int)dev->jedec_id[1],
+                       (unsigned int)dev->jedec_id[2], (unsigned int)(dev->capacity / 1024));
+    return 0;
+}
+
+/**
+ * @brief  去初始化 NOR Flash
+ * @param  dev: 设备
+ * @return 0=成功, <0=参数无效
+ */
+int smota_nor_dev_deinit(struct smota_nor_dev *dev)
+{
+    if (dev == NULL) {
+        return -1;
+    }
+
+    dev->is_init = 0;
+    return 0;
+}
+
+/**
+ * @brief  读取数据
+ * @param  dev: 设备
+ * @param  addr: 设备地址
+ * @param  data: 数据缓冲区
+ * @param  size: 读取字节数
+ * @return 实际读取字节数，<0=失败
+ */
+int smota_nor_dev_read(struct smota_nor_dev *dev, uint32_t addr, uint8_t *data, uint32_t size)
+{
+    uint8_t cmd[6];
+    uint32_t cmd_len;
+
+    if (dev == NULL || !dev->is_init) {
+        return -1;
+    }
+
+    if (data == NULL || addr >= dev->capacity || size > dev->capacity - addr) {
+        return -2;
+    }
+
+    /* 连续读取无页边界限制，一次事务完成 */
+    cmd_len = nor_build_cmd(dev, cmd, NOR_CMD_FAST_READ, NOR_CMD_FAST_READ_4B, addr, 1);
+    if (dev->bus->transfer(cmd, cmd_len, NULL, data, size) < 0) {
+        return -3;
+    }
+
+    return (int)size;
+}
+
+/**
+ * @brief  写入数据（按页编程）
+ * @param  dev: 设备
+ * @param  addr: 设备地址
+ * @param  data: 数据缓冲区
+ * @param  size: 写入字节数
+ * @return 实际写入字节数，<0=失败
+ */
+int smota_nor_dev_write(struct smota_nor_dev *dev, uint32_t addr, const uint8_t *data, uint32_t size)
+{
+    uint8_t cmd[6];
+    uint32_t cmd_len;
+    uint32_t written = 0;
+
+    if (dev == NULL || !dev->is_init) {
+        return -1;
+    }
+
+    if (data == NULL || addr >= dev->capacity || size > dev->capacity - addr) {
+        return -2;
+    }
+
+    while (written < size) {
+        /* 页编程不能跨页，否则地址回卷到页首 */
+        uint32_t page_remain = SMOTA_NOR_PAGE_SIZE - (addr % SMOTA_NOR_PAGE_SIZE);
+        uint32_t chunk = (size - written < page_remain) ? (size - written) : page_remain;
+
+        if (nor_command(dev, NOR_CMD_WRITE_ENABLE) < 0) {
+            break;
+        }
+
+        cmd_len = nor_build_cmd(dev, cmd, NOR_CMD_PAGE_PROGRAM, NOR_CMD_PAGE_PROGRAM_4B, addr, 0);
+        if (dev->bus->transfer(cmd, cmd_len, data + written, NULL, chunk) < 0) {
+            break;
+        }
+
+        if (nor_wait_ready(dev, SMOTA_NOR_TIMEOUT_MS) < 0) {
+            break;
+        }
+
+        addr += chunk;
+        written += chunk;
+    }
+
+    return (written > 0) ? (int)written : -3;
+}
+
+/**
+ * @brief  擦除区域
+ * @param  dev: 设备
+ * @param  addr: 设备地址（需对齐到 SMOTA_NOR_SECTOR_SIZE）
+ * @param  size: 擦除字节数（需对齐到 SMOTA_NOR_SECTOR_SIZE）
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_dev_erase(struct smota_nor_dev *dev, uint32_t addr, uint32_t size)
+{
+    uint8_t cmd[6];
+    uint32_t cmd_len;
+    uint32_t end;
+
+    if (dev == NULL || !dev->is_init) {
+        return -1;
+    }
+
+    if ((addr % SMOTA_NOR_SECTOR_SIZE) != 0 || (size % SMOTA_NOR_SECTOR_SIZE) != 0 ||
+        addr >= dev->capacity || size > dev->capacity - addr) {
+        return -2;
+    }
+
+    end = addr + size;
+
+    while (addr < end) {
+        uint32_t step;
+
+        if (nor_command(dev, NOR_CMD_WRITE_ENABLE) < 0) {
+            return -3;
+        }
+
+        /* 块对齐且剩余足够时使用块擦除 */
+        if ((addr % SMOTA_NOR_BLOCK_SIZE) == 0 && end - addr >= SMOTA_NOR_BLOCK_SIZE) {
+            cmd_len = nor_build_cmd(dev, cmd, NOR_CMD_BLOCK_ERASE, NOR_CMD_BLOCK_ERASE_4B, addr, 0);
+            step = SMOTA_NOR_BLOCK_SIZE;
+        } else {
+            cmd_len = nor_build_cmd(dev, cmd, NOR_CMD_SECTOR_ERASE, NOR_CMD_SECTOR_ERASE_4B, addr, 0);
+            step = SMOTA_NOR_SECTOR_SIZE;
+        }
+
+        if (dev->bus->transfer(cmd, cmd_len, NULL, NULL, 0) < 0) {
+            return -3;
+        }
+
+        if (nor_wait_ready(dev, SMOTA_NOR_TIMEOUT_MS) < 0) {
+            return -4;
+        }
+
+        addr += step;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  上锁（发送写禁止命令）
+ * @param  dev: 设备
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_dev_lock(struct smota_nor_dev *dev)
+{
+    if (dev == NULL || !dev->is_init) {
+        return -1;
+    }
+
+    return nor_command(dev, NOR_CMD_WRITE_DISABLE);
+}
+
+/**
+ * @brief  解锁（每次编程/擦除前会自动发送写使能）
+ * @param  dev: 设备
+ * @return 0=成功
+ */
+int smota_nor_dev_unlock(struct smota_nor_dev *dev)
+{
+    (void)dev;
+    return 0;
+}
+
+
+/*---------- 默认设备 ----------*/
+
+/**
+ * @brief  默认设备的 smota_nor_dev_attach()
+ */
+int smota_nor_attach(const struct smota_nor_bus *bus, uint32_t capacity)
+{
+    return smota_nor_dev_attach(&g_nor_dev, bus, capacity);
+}
+
+/**
+ * @brief  默认设备的 smota_nor_dev_init()
+ */
+int smota_nor_init(void)
+{
+    return smota_nor_dev_init(&g_nor_dev);
+}
+
+/**
+ * @brief  默认设备的 smota_nor_dev_deinit()
+ */
+int smota_nor_deinit(void)
+{
+    return smota_nor_dev_deinit(&g_nor_dev);
+}
+
+/**
+ * @brief  默认设备的 smota_nor_dev_read()
+ */
+int smota_nor_read(uint32_t addr, uint8_t *data, uint32_t size)
+{
+    return smota_nor_dev_read(&g_nor_dev, addr, data, size);
+}
+
+/**
+ * @brief  默认设备的 smota_nor_dev_write()
+ */
+int smota_nor_write(uint32_t addr, const uint8_t *data, uint32_t size)
+{
+    return smota_nor_dev_write(&g_nor_dev, addr, data, size);
+}
+
+/**
+ * @brief  默认设备的 smota_nor_dev_erase()
+ */
+int smota_nor_erase(uint32_t addr, uint32_t size)
+{
+    return smota_nor_dev_erase(&g_nor_dev, addr, size);
+}
+
+/**
+ * @brief  默认设备的 smota_nor_dev_lock()
+ */
+int smota_nor_lock(void)
+{
+    return smota_nor_dev_lock(&g_nor_dev);
+}
+
+/**
+ * @brief  默认设备的 smota_nor_dev_unlock()
+ */
+int smota_nor_unlock(void)
+{
+    return smota_nor_dev_unlock(&g_nor_dev);
+}
+
+/*---------- end of file ----------*/
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_nor_flash.h
+ * @Author       : lxf
+ * @Date         : 2026-10-18 14:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-18 14:00:00
+ * @Brief        : smOTA 外部 SPI/QSPI NOR Flash 参考驱动
+ * @details      基于 JEDEC 通用命令集（0x03/0x0B 读、0x02 页编程、0x20 扇区擦除、
+ *              0xD8 块擦除、0x05 读状态），适用于 W25Q/GD25Q/MX25L 等常见型号。
+ *              - 擦除时地址和剩余长度满足 SMOTA_NOR_BLOCK_SIZE 对齐则使用块擦除，
+ *                否则按 SMOTA_NOR_SECTOR_SIZE 扇区擦除
+ *              - 写入按 SMOTA_NOR_PAGE_SIZE 页边界拆分，页对齐的数据块全部以整页编程
+ *              - 容量超过 16MB 时自动使用 4 字节地址命令
+ *              - 每颗芯片一个 struct smota_nor_dev（总线、容量、JEDEC ID），可同时驱动多颗芯片
+ *              - 芯片忙等待按 SMOTA_NOR_TIMEOUT_MS 超时；HAL 没有 get_tick_ms 时按 SMOTA_NOR_POLL_MAX 限制轮询次数
+ *              移植层只需为每颗芯片实现 struct smota_nor_bus 的 SPI 事务接口（各自的片选），
+ *              然后用 SMOTA_NOR_DEVICE_DEFINE() 生成 struct smota_flash_driver 并注册到 hal->ext_flash。
+ *
+ *              使用示例：
+ *              SMOTA_NOR_DEVICE_DEFINE(g_nor0, &g_qspi_bus_cs0, 8 * 1024 * 1024);
+ *              SMOTA_NOR_DEVICE_DEFINE(g_nor1, &g_qspi_bus_cs1, 32 * 1024 * 1024);
+ *              static struct smota_flash_driver *const g_ext_flash[] = { &g_nor0, &g_nor1 };
+ *
+ *              只有一颗芯片时也可以用默认设备：smota_nor_attach() 绑定总线后，
+ *              把 smota_nor_init/read/write/... 直接填入 struct smota_flash_driver。
+ */
+
+#ifndef SMOTA_NOR_FLASH_H
+#define SMOTA_NOR_FLASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include "smota_hal.h"
+
+/*---------- macro ----------*/
+
+/* 3 字节地址可寻址的最大容量 */
+#define SMOTA_NOR_3B_ADDR_MAX 0x1000000U // 16MB
+
+/*---------- type define ----------*/
+
+/**
+ * @brief  SPI/QSPI 总线接口
+ * @details 一次调用对应一次完整的片选周期
+ */
+struct smota_nor_bus {
+    /**
+     * @brief  执行一次 SPI 事务
+     * @param  cmd: 命令阶段（命令字节 + 地址 + dummy）
+     * @param  cmd_len: 命令阶段长度
+     * @param  tx: 数据阶段发送缓冲区，NULL=不发送
+     * @param  rx: 数据阶段接收缓冲区，NULL=不接收
+     * @param  len: 数据阶段长度
+     * @return 0=成功, <0=失败
+     * @note   片选在命令阶段开始前拉低、数据阶段结束后拉高；
+     *         QSPI 控制器可根据命令字节自行选择单线/四线传输
+     */
+    int (*transfer)(const uint8_t *cmd, uint32_t cmd_len, const uint8_t *tx, uint8_t *rx, uint32_t len);
+};
+
+/**
+ * @brief  NOR Flash 设备
+ * @note   由调用者分配，bus/capacity 由 smota_nor_dev_attach() 或 SMOTA_NOR_DEVICE_DEFINE() 设置，
+ *         其余字段由驱动维护
+ */
+struct smota_nor_dev {
+    const struct smota_nor_bus *bus; /* 总线接口 */
+    uint32_t capacity;               /* 芯片容量 */
+    uint8_t addr_len;                /* 地址字节数（3 或 4） */
+    uint8_t jedec_id[3];             /* 厂商 ID + 器件 ID（初始化后有效） */
+    int is_init;                     /* 是否已初始化 */
+};
+
+/**
+ * @brief  定义一颗 NOR Flash 设备及其 struct smota_flash_driver
+ * @param  name: 生成的 struct smota_flash_driver 变量名（设备为 name##_dev）
+ * @param  bus_ptr: 总线接口（const struct smota_nor_bus *）
+ * @param  cap: 芯片容量（字节，需对齐到 SMOTA_NOR_BLOCK_SIZE）
+ * @note   struct smota_flash_driver 的接口不带上下文，宏为每颗芯片生成一组绑定到该设备的包装函数
+ */
+#define SMOTA_NOR_DEVICE_DEFINE(name, bus_ptr, cap)                                                        \
+    static struct smota_nor_dev name##_dev = { .bus = (bus_ptr), .capacity = (cap) };                      \
+    static int name##_init(void) { return smota_nor_dev_init(&name##_dev); }                               \
+    static int name##_deinit(void) { return smota_nor_dev_deinit(&name##_dev); }                           \
+    static int name##_read(uint32_t addr, uint8_t *data, uint32_t size)                                    \
+    {                                                                                                      \
+        return smota_nor_dev_read(&name##_dev, addr, data, size);                                          \
+    }                                                                                                      \
+    static int name##_write(uint32_t addr, const uint8_t *data, uint32_t size)                             \
+    {                                                                                                      \
+        return smota_nor_dev_write(&name##_dev, addr, data, size);                                         \
+    }                                                                                                      \
+    static int name##_erase(uint32_t addr, uint32_t size)                                                  \
+    {                                                                                                      \
+        return smota_nor_dev_erase(&name##_dev, addr, size);                                               \
+    }                                                                                                      \
+    static int name##_lock(void) { return smota_nor_dev_lock(&name##_dev); }                               \
+    static int name##_unlock(void) { return smota_nor_dev_unlock(&name##_dev); }                           \
+    static struct smota_flash_driver name = {                                                              \
+        .init = name##_init,                                                                               \
+        .deinit = name##_deinit,                                                                           \
+        .read = name##_read,                                                                               \
+        .write = name##_write,                                                                             \
+        .erase = name##_erase,                                                                             \
+        .flash_lock = name##_lock,                                                                         \
+        .flash_unlock = name##_unlock,                                                                     \
+    }
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief  绑定 SPI 总线和芯片容量
+ * @param  dev: 设备
+ * @param  bus: 总线接口
+ * @param  capacity: 芯片容量（字节）
+ * @return 0=成功, <0=失败
+ * @note   须在 smota_init() 之前调用；SMOTA_NOR_DEVICE_DEFINE() 定义的设备无需调用
+ */
+int smota_nor_dev_attach(struct smota_nor_dev *dev, const struct smota_nor_bus *bus, uint32_t capacity);
+
+/**
+ * @brief  初始化 NOR Flash（唤醒并读取 JEDEC ID）
+ * @param  dev: 设备
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_dev_init(struct smota_nor_dev *dev);
+
+/**
+ * @brief  去初始化 NOR Flash
+ * @param  dev: 设备
+ * @return 0=成功, <0=参数无效
+ */
+int smota_nor_dev_deinit(struct smota_nor_dev *dev);
+
+/**
+ * @brief  读取数据
+ * @param  dev: 设备
+ * @param  addr: 设备地址（从 0 开始）
+ * @param  data: 数据缓冲区
+ * @param  size: 读取字节数
+ * @return 实际读取字节数，<0=失败
+ */
+int smota_nor_dev_read(struct smota_nor_dev *dev, uint32_t addr, uint8_t *data, uint32_t size);
+
+/**
+ * @brief  写入数据（按页编程）
+ * @param  dev: 设备
+ * @param  addr: 设备地址
+ * @param  data: 数据缓冲区
+ * @param  size: 写入字节数
+ * @return 实际写入字节数，<0=失败
+ * @note   写入前需确保目标区域已擦除
+ */
+int smota_nor_dev_write(struct smota_nor_dev *dev, uint32_t addr, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief  擦除区域
+ * @param  dev: 设备
+ * @param  addr: 设备地址（需对齐到 SMOTA_NOR_SECTOR_SIZE）
+ * @param  size: 擦除字节数（需对齐到 SMOTA_NOR_SECTOR_SIZE）
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_dev_erase(struct smota_nor_dev *dev, uint32_t addr, uint32_t size);
+
+/**
+ * @brief  上锁（发送写禁止命令）
+ * @param  dev: 设备
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_dev_lock(struct smota_nor_dev *dev);
+
+/**
+ * @brief  解锁（每次编程/擦除前会自动发送写使能，此处无需操作）
+ * @param  dev: 设备
+ * @return 0=成功
+ */
+int smota_nor_dev_unlock(struct smota_nor_dev *dev);
+
+/*
+ * 默认设备（只有一颗芯片时使用），接口与 struct smota_flash_driver 一致
+ */
+
+/**
+ * @brief  绑定 SPI 总线和芯片容量
+ * @param  bus: 总线接口
+ * @param  capacity: 芯片容量（字节）
+ * @return 0=成功, <0=失败
+ * @note   须在 smota_init() 之前调用
+ */
+int smota_nor_attach(const struct smota_nor_bus *bus, uint32_t capacity);
+
+/**
+ * @brief  初始化 NOR Flash（唤醒并读取 JEDEC ID）
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_init(void);
+
+/**
+ * @brief  去初始化 NOR Flash
+ * @return 0=成功
+ */
+int smota_nor_deinit(void);
+
+/**
+ * @brief  读取数据
+ * @param  addr: 设备地址（从 0 开始）
+ * @param  data: 数据缓冲区
+ * @param  size: 读取字节数
+ * @return 实际读取字节数，<0=失败
+ */
+int smota_nor_read(uint32_t addr, uint8_t *data, uint32_t size);
+
+/**
+ * @brief  写入数据（按页编程）
+ * @param  addr: 设备地址
+ * @param  data: 数据缓冲区
+ * @param  size: 写入字节数
+ * @return 实际写入字节数，<0=失败
+ * @note   写入前需确保目标区域已擦除
+ */
+int smota_nor_write(uint32_t addr, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief  擦除区域
+ * @param  addr: 设备地址（需对齐到 SMOTA_NOR_SECTOR_SIZE）
+ * @param  size: 擦除字节数（需对齐到 SMOTA_NOR_SECTOR_SIZE）
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_erase(uint32_t addr, uint32_t size);
+
+/**
+ * @brief  上锁（发送写禁止命令）
+ * @return 0=成功, <0=失败
+ */
+int smota_nor_lock(void);
+
+/**
+ * @brief  解锁（每次编程/擦除前会自动发送写使能，此处无需操作）
+ * @return 0=成功
+ */
+int smota_nor_unlock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_NOR_FLASH_H
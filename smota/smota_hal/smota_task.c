@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_task.c
+ * @Author       : lxf
+ * @Date         : 2026-10-19 09:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-19 09:00:00
+ * @Brief        : smOTA RTOS 专用 OTA 任务参考集成实现
+ */
+
+/*---------- includes ----------*/
+#include <stddef.h>
+#include "smota_task.h"
+#include "../smota.h"
+
+/*---------- macro ----------*/
+
+/*---------- type define ----------*/
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/*---------- variable ----------*/
+
+/*---------- function ----------*/
+
+#if SMOTA_FEED_BUF_SIZE > 0
+/**
+ * @brief  OTA 任务函数
+ * @param  arg: struct smota_task
+ */
+static void task_entry(void *arg)
+{
+    struct smota_task *task = (struct smota_task *)arg;
+    uint32_t wait_ms = 0;
+
+    while (task->running) {
+        /* 等待中断推送数据，或到核心给出的期限（数据包超时、会话总超时） */
+#if SMOTA_TASK_IDLE_MS > 0
+        if (wait_ms > SMOTA_TASK_IDLE_MS) {
+            wait_ms = SMOTA_TASK_IDLE_MS;
+        }
+#endif
+        (void)task->os->sem_wait(task->sem, wait_ms);
+        task->wakeups++;
+
+        /* 信号量只记一次，一次唤醒把已到达的帧全部处理完 */
+        do {
+            (void)smota_instance_poll_deadline(task->inst, &wait_ms);
+            task->polls++;
+        } while (task->running && wait_ms == 0);
+    }
+}
+#endif
+
+/**
+ * @brief  启动 OTA 任务
+ * @param  task: 任务
+ * @param  inst: 已初始化的实例
+ * @param  os: RTOS 接口
+ * @return 0=成功, <0=失败
+ */
+int smota_task_start(struct smota_task *task, struct smota_instance *inst, const struct smota_os_driver *os)
+{
+#if SMOTA_FEED_BUF_SIZE > 0
+    if (task == NULL || inst == NULL || os == NULL || os->sem_create == NULL || os->sem_delete == NULL ||
+        os->sem_wait == NULL || os->sem_post == NULL || os->task_create == NULL || os->task_join == NULL) {
+        return -1;
+    }
+
+#if SMOTA_INSTANCE_MAX > 1 && !SMOTA_INSTANCE_THREAD_LOCAL
+    /* 当前实例为全局指针，任务与其他线程的调用会互相切换对方的实例 */
+    return -5;
+#endif
+
+    task->inst = inst;
+    task->os = os;
+    task->wakeups = 0;
+    task->polls = 0;
+
+    task->sem = os->sem_create();
+    if (task->sem == NULL) {
+        return -2;
+    }
+
+    task->running = true;
+    task->handle = os->task_create(task_entry, task, "smota", SMOTA_TASK_STACK_SIZE, SMOTA_TASK_PRIORITY);
+    if (task->handle == NULL) {
+        task->running = false;
+        os->sem_delete(task->sem);
+        task->sem = NULL;
+        return -3;
+    }
+
+    return 0;
+#else
+    (void)task;
+    (void)inst;
+    (void)os;
+    return -4;
+#endif
+}
+
+/**
+ * @brief  停止 OTA 任务
+ * @param  task: 任务
+ * @return 0=成功, <0=失败
+ */
+int smota_task_stop(struct smota_task *task)
+{
+#if SMOTA_FEED_BUF_SIZE > 0
+    if (task == NULL || task->handle == NULL) {
+        return -1;
+    }
+
+    task->running = false;
+    task->os->sem_post(task->sem);
+    task->os->task_join(task->handle);
+    task->handle = NULL;
+
+    task->os->sem_delete(task->sem);
+    task->sem = NULL;
+
+    return 0;
+#else
+    (void)task;
+    return -1;
+#endif
+}
+
+/**
+ * @brief  推送收到的数据并唤醒任务（可在中断中调用）
+ * @param  task: 任务
+ * @param  data: 数据
+ * @param  len: 长度
+ * @return 写入接收队列的字节数
+ */
+size_t smota_task_feed(struct smota_task *task, const uint8_t *data, size_t len)
+{
+#if SMOTA_FEED_BUF_SIZE > 0
+    size_t n;
+
+    if (task == NULL || task->sem == NULL) {
+        return 0;
+    }
+
+    n = smota_instance_feed(task->inst, data, len);
+    if (n > 0) {
+        task->os->sem_post(task->sem);
+    }
+
+    return n;
+#else
+    (void)task;
+    (void)data;
+    (void)len;
+    return 0;
+#endif
+}
+
+/*---------- end of file ----------*/
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 by Lu Xianfan.
+ * @FilePath     : smota_task.h
+ * @Author       : lxf
+ * @Date         : 2026-10-19 09:00:00
+ * @LastEditors  : lxf_zjnb@qq.com
+ * @LastEditTime : 2026-10-19 09:00:00
+ * @Brief        : smOTA RTOS 专用 OTA 任务参考集成
+ * @details      在 RTOS 上把 OTA 从应用主循环移到一个独立任务中，Flash 擦写和加解密
+ *              只占用 OTA 任务的时间片，不再挤占控制任务：
+ *              - 任务独占一个 struct smota_instance，启动后只有该任务调用它的 smota_instance_*() 接口
+ *              - 核心的当前实例默认是全局指针，其他线程调用任何 smota 接口都会打乱任务的槽位查找：
+ *                实例数大于 1 时须开启 SMOTA_INSTANCE_THREAD_LOCAL（当前实例按线程保存），
+ *                否则 smota_task_start() 返回 -5；只有一个实例时其他线程同样不得调用 smota 接口
+ *                （smota_task_feed() 除外）
+ *              - 串口/DMA 中断调用 smota_task_feed()：数据写入实例的推送队列（SMOTA_FEED_BUF_SIZE），
+ *                再释放信号量唤醒任务
+ *              - 任务阻塞在信号量上，醒来后轮询到没有待处理的帧为止；没有数据时按
+ *                smota_instance_poll_deadline() 给出的期限等待（可用 SMOTA_TASK_IDLE_MS 限制上限），
+ *                空闲期间不再周期性唤醒
+ *              - 任务优先级和栈大小取 SMOTA_TASK_PRIORITY / SMOTA_TASK_STACK_SIZE
+ *              移植层只需实现 struct smota_os_driver 的信号量和任务接口。
+ *              需开启 SMOTA_FEED_BUF_SIZE，否则 smota_task_start() 返回失败。
+ *
+ *              FreeRTOS 移植示例：
+ *              static void *os_sem_create(void) { return xSemaphoreCreateBinary(); }
+ *              static int os_sem_wait(void *sem, uint32_t ms)
+ *              {
+ *                  TickType_t ticks = (ms == SMOTA_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(ms);
+ *                  return xSemaphoreTake(sem, ticks) == pdTRUE ? 0 : -1;
+ *              }
+ *              static void os_sem_post(void *sem)
+ *              {
+ *                  BaseType_t woken = pdFALSE;
+ *                  if (xPortIsInsideInterrupt()) {
+ *                      xSemaphoreGiveFromISR(sem, &woken);
+ *                      portYIELD_FROM_ISR(woken);
+ *                  } else {
+ *                      xSemaphoreGive(sem);
+ *                  }
+ *              }
+ *              task_create 用 xTaskCreate()，task_join 等待任务通知后 vTaskDelete()。
+ *
+ *              Zephyr 移植示例：信号量用 k_sem_init(sem, 0, 1)/k_sem_take()/k_sem_give()
+ *              （SMOTA_WAIT_FOREVER 对应 K_FOREVER，k_sem_give 可在中断中调用），
+ *              任务用 k_thread_create()/k_thread_join()。
+ */
+
+#ifndef SMOTA_TASK_H
+#define SMOTA_TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------- includes ----------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*---------- macro ----------*/
+
+/*---------- type define ----------*/
+
+struct smota_instance;
+
+/**
+ * @brief  RTOS 接口
+ */
+struct smota_os_driver {
+    /**
+     * @brief  创建二值信号量（初始为空）
+     * @return 信号量句柄，NULL=失败
+     */
+    void *(*sem_create)(void);
+
+    /**
+     * @brief  删除信号量
+     * @param  sem: 信号量句柄
+     */
+    void (*sem_delete)(void *sem);
+
+    /**
+     * @brief  等待信号量
+     * @param  sem: 信号量句柄
+     * @param  timeout_ms: 最长等待时间（毫秒），SMOTA_WAIT_FOREVER=一直等待，0=不等待
+     * @return 0=已获取, <0=超时
+     */
+    int (*sem_wait)(void *sem, uint32_t timeout_ms);
+
+    /**
+     * @brief  释放信号量
+     * @param  sem: 信号量句柄
+     * @note   须可在中断中调用
+     */
+    void (*sem_post)(void *sem);
+
+    /**
+     * @brief  创建并启动任务
+     * @param  entry: 任务函数
+     * @param  arg: 任务参数
+     * @param  name: 任务名
+     * @param  stack_size: 栈大小（SMOTA_TASK_STACK_SIZE）
+     * @param  priority: 优先级（SMOTA_TASK_PRIORITY）
+     * @return 任务句柄，NULL=失败
+     */
+    void *(*task_create)(void (*entry)(void *arg), void *arg, const char *name, uint32_t stack_size, uint32_t priority);
+
+    /**
+     * @brief  等待任务函数返回并回收任务
+     * @param  task: 任务句柄
+     */
+    void (*task_join)(void *task);
+};
+
+/**
+ * @brief  OTA 任务
+ * @note   由调用者分配；字段由本模块维护，wakeups/polls 可只读访问用于统计
+ */
+struct smota_task {
+    struct smota_instance *inst;       /* 任务独占的实例 */
+    const struct smota_os_driver *os;  /* RTOS 接口 */
+    void *sem;                         /* 数据到达信号量 */
+    void *handle;                      /* 任务句柄 */
+    volatile bool running;             /* 运行标志 */
+    volatile uint32_t wakeups;         /* 任务唤醒次数（含等待超时） */
+    volatile uint32_t polls;           /* smota_instance_poll_deadline() 调用次数 */
+};
+
+/*---------- variable prototype ----------*/
+
+/*---------- function prototype ----------*/
+
+/**
+ * @brief  启动 OTA 任务
+ * @param  task: 任务
+ * @param  inst: 已初始化的实例，启动后由任务独占
+ * @param  os: RTOS 接口
+ * @return 0=成功, -1=参数无效, -2=信号量创建失败, -3=任务创建失败, -4=未开启 SMOTA_FEED_BUF_SIZE,
+ *         -5=实例数大于 1 但未开启 SMOTA_INSTANCE_THREAD_LOCAL
+ */
+int smota_task_start(struct smota_task *task, struct smota_instance *inst, const struct smota_os_driver *os);
+
+/**
+ * @brief  停止 OTA 任务
+ * @param  task: 任务
+ * @return 0=成功, <0=任务未运行
+ * @note   等待任务退出后返回，之后实例重新归调用者所有
+ */
+int smota_task_stop(struct smota_task *task);
+
+/**
+ * @brief  推送收到的数据并唤醒任务（可在中断中调用）
+ * @param  task: 任务
+ * @param  data: 数据
+ * @param  len: 长度
+ * @return 写入接收队列的字节数，队列满时小于 len
+ */
+size_t smota_task_feed(struct smota_task *task, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SMOTA_TASK_H
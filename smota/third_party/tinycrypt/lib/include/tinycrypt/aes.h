@@ -44,6 +44,17 @@
  *  Usage:      1) call tc_aes128_set_encrypt/decrypt_key to set the key.
  *
  *              2) call tc_aes_encrypt/decrypt to process the data.
+ *
+ *  Backends:   encryption is dispatched at run time. The byte-oriented
+ *              version is always available; a 32-bit T-table version
+ *              (1KB table) is used when TC_AES_SMALL is not defined, and on
+ *              x86 hosts with AES-NI the hardware instructions are used
+ *              instead. Detection runs on the first encryption (or an
+ *              explicit tc_aes_backend_detect at startup). The T-table
+ *              lookups depend on the key and data, so on devices where
+ *              cache timing is observable by an attacker define
+ *              TC_AES_SMALL. Define TC_AES_PORTABLE_ONLY to compile AES-NI
+ *              out. Decryption always uses the byte-oriented version.
  */
 
 #ifndef __TC_AES_H__
@@ -61,6 +72,12 @@ extern "C" {
 #define TC_AES_BLOCK_SIZE (Nb*Nk)
 #define TC_AES_KEY_SIZE (Nb*Nk)
 
+/* encryption backends */
+#define TC_AES_BACKEND_BYTE (0)   /* byte-oriented portable C */
+#define TC_AES_BACKEND_TTABLE (1) /* 32-bit T-table */
+#define TC_AES_BACKEND_AESNI (2)  /* x86 AES-NI */
+#define TC_AES_BACKEND_NUM (3)
+
 typedef struct tc_aes_key_sched_struct {
 	unsigned int words[Nb*(Nr+1)];
 } *TCAesKeySched_t;
@@ -93,6 +110,44 @@ int tc_aes128_set_encrypt_key(TCAesKeySched_t s, const uint8_t *k);
 int tc_aes_encrypt(uint8_t *out, const uint8_t *in, 
 		   const TCAesKeySched_t s);
 
+/**
+ *  @brief Select the fastest encryption backend supported by the running CPU
+ *  @return returns the id of the backend now in use
+ *  @note Runs once automatically from the first tc_aes_encrypt or
+ *        tc_ctr_mode; call it at startup to keep CPU feature detection off
+ *        the data path. The selection is process wide and must not change
+ *        while another thread is encrypting.
+ */
+unsigned int tc_aes_backend_detect(void);
+
+/**
+ *  @brief Check whether a backend is compiled in and supported by this CPU
+ *  @return returns 1 if supported, 0 otherwise
+ *  @param backend TC_AES_BACKEND_* id
+ */
+int tc_aes_backend_supported(unsigned int backend);
+
+/**
+ *  @brief Force a backend, e.g. to test or benchmark each one
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if the backend is not supported
+ *  @param backend TC_AES_BACKEND_* id
+ */
+int tc_aes_backend_select(unsigned int backend);
+
+/**
+ *  @brief Get the backend currently in use
+ *  @return returns a TC_AES_BACKEND_* id
+ */
+unsigned int tc_aes_backend_current(void);
+
+/**
+ *  @brief Get a printable backend name
+ *  @return returns the name, or "unknown" for an invalid id
+ *  @param backend TC_AES_BACKEND_* id
+ */
+const char *tc_aes_backend_name(unsigned int backend);
+
 /**
  *  @brief Set the AES-128 decryption key
  *  Uses key k to initialize s
@@ -0,0 +1,98 @@
+/* blake2s.h - TinyCrypt interface to a BLAKE2s-256 implementation */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/**
+ * @file
+ * @brief Interface to a BLAKE2s-256 implementation.
+ *
+ *  Overview:   BLAKE2s is the 32-bit variant of BLAKE2 specified in RFC 7693.
+ *              It works on 32-bit words with 10 rounds of ARX operations and
+ *              needs no message schedule, so on 32-bit cores without a hash
+ *              accelerator it is markedly faster than SHA-256 in software.
+ *              This implementation produces unkeyed 32-byte digests.
+ *
+ *  Security:   BLAKE2s-256 provides 128 bits of security against collision
+ *              attacks and 256 bits against pre-image attacks, the same as
+ *              SHA-256.
+ *
+ *  Usage:      1) call tc_blake2s_init to initialize a struct
+ *              tc_blake2s_state_struct before hashing a new string.
+ *
+ *              2) call tc_blake2s_update to hash the next string segment, as
+ *              many times as needed; the order is important.
+ *
+ *              3) call tc_blake2s_final to output the digest; the state is
+ *              wiped afterwards.
+ */
+
+#ifndef __TC_BLAKE2S_H__
+#define __TC_BLAKE2S_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TC_BLAKE2S_BLOCK_SIZE (64)
+#define TC_BLAKE2S_DIGEST_SIZE (32)
+
+struct tc_blake2s_state_struct {
+	uint32_t h[8];
+	uint32_t t[2];
+	uint8_t buf[TC_BLAKE2S_BLOCK_SIZE];
+	size_t buflen;
+};
+
+typedef struct tc_blake2s_state_struct *TCBlake2sState_t;
+
+/**
+ *  @brief BLAKE2s initialization procedure
+ *  Initializes s for an unkeyed 32-byte digest
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if s == NULL
+ *  @param s BLAKE2s state struct
+ */
+int tc_blake2s_init(TCBlake2sState_t s);
+
+/**
+ *  @brief BLAKE2s update procedure
+ *  Hashes data_length bytes addressed by data into state s
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if:
+ *                s == NULL,
+ *                data == NULL while datalen > 0
+ *  @note Assumes s has been initialized by tc_blake2s_init. The last block
+ *        is kept in s->buf until tc_blake2s_final, because BLAKE2s flags the
+ *        final block when compressing it.
+ *  @param s BLAKE2s state struct
+ *  @param data message to hash
+ *  @param datalen length of message to hash
+ */
+int tc_blake2s_update(TCBlake2sState_t s, const uint8_t *data, size_t datalen);
+
+/**
+ *  @brief BLAKE2s final procedure
+ *  Inserts the completed hash computation into digest and wipes s
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if:
+ *                s == NULL,
+ *                digest == NULL
+ *  @note Assumes: s has been initialized by tc_blake2s_init
+ *        digest points to at least TC_BLAKE2S_DIGEST_SIZE bytes
+ *  @param digest unsigned eight bit integer
+ *  @param s BLAKE2s state struct
+ */
+int tc_blake2s_final(uint8_t *digest, TCBlake2sState_t s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TC_BLAKE2S_H__ */
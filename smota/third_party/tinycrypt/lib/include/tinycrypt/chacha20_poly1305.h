@@ -0,0 +1,162 @@
+/* chacha20_poly1305.h - TinyCrypt interface to ChaCha20-Poly1305 (RFC 8439) */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/**
+ * @file
+ * @brief Interface to the ChaCha20 stream cipher, the Poly1305 one-time
+ *        authenticator and the ChaCha20-Poly1305 AEAD construction.
+ *
+ *  Overview:   ChaCha20-Poly1305 is the AEAD specified in RFC 8439. ChaCha20
+ *              only needs 32-bit additions, rotations and XORs and has no
+ *              tables, so on cores without an AES accelerator (Cortex-M0/M3)
+ *              it is several times faster than table-less AES and runs in
+ *              constant time. Poly1305 uses 26-bit limbs and 32x32->64
+ *              multiplications.
+ *
+ *  Security:   A (key, nonce) pair must never be used to encrypt two
+ *              different messages. The 96-bit nonce is usually built from a
+ *              message counter or a unique message identifier.
+ *
+ *              tc_chacha20_poly1305_decrypt checks the tag in constant time
+ *              and wipes the output when it does not match, so unauthenticated
+ *              plaintext never leaves the function.
+ *
+ *  Usage:      1) call tc_chacha20_poly1305_encrypt to encrypt and tag a
+ *              message, tc_chacha20_poly1305_decrypt to authenticate and
+ *              decrypt it in a single pass.
+ *
+ *              2) tc_chacha20_xor and tc_poly1305_* expose the primitives.
+ */
+
+#ifndef __TC_CHACHA20_POLY1305_H__
+#define __TC_CHACHA20_POLY1305_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TC_CHACHA20_KEY_SIZE (32)
+#define TC_CHACHA20_NONCE_SIZE (12)
+#define TC_CHACHA20_BLOCK_SIZE (64)
+#define TC_POLY1305_KEY_SIZE (32)
+#define TC_POLY1305_TAG_SIZE (16)
+
+struct tc_poly1305_state_struct {
+	uint32_t r[5];
+	uint32_t h[5];
+	uint32_t pad[4];
+	uint8_t buf[16];
+	size_t buflen;
+};
+
+typedef struct tc_poly1305_state_struct *TCPoly1305State_t;
+
+/**
+ *  @brief ChaCha20 encryption/decryption procedure
+ *  XORs len bytes of in with the ChaCha20 key stream starting at block
+ *  counter and writes the result to out
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if:
+ *                out, key or nonce == NULL,
+ *                in == NULL while len > 0
+ *  @note in and out may be the same buffer
+ *  @param out output buffer
+ *  @param in input buffer
+ *  @param len number of bytes
+ *  @param key 32-byte key
+ *  @param nonce 12-byte nonce
+ *  @param counter initial block counter
+ */
+int tc_chacha20_xor(uint8_t *out, const uint8_t *in, size_t len,
+		    const uint8_t *key, const uint8_t *nonce, uint32_t counter);
+
+/**
+ *  @brief Poly1305 initialization procedure
+ *  Initializes s with the 32-byte one-time key r || s
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if s == NULL or key == NULL
+ *  @param s Poly1305 state struct
+ *  @param key one-time key, never reused across messages
+ */
+int tc_poly1305_init(TCPoly1305State_t s, const uint8_t *key);
+
+/**
+ *  @brief Poly1305 update procedure
+ *  Authenticates datalen bytes addressed by data into state s
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if:
+ *                s == NULL,
+ *                data == NULL while datalen > 0
+ *  @param s Poly1305 state struct
+ *  @param data message
+ *  @param datalen length of message
+ */
+int tc_poly1305_update(TCPoly1305State_t s, const uint8_t *data, size_t datalen);
+
+/**
+ *  @brief Poly1305 final procedure
+ *  Writes the 16-byte tag and wipes s
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if tag == NULL or s == NULL
+ *  @param tag output tag
+ *  @param s Poly1305 state struct
+ */
+int tc_poly1305_final(uint8_t *tag, TCPoly1305State_t s);
+
+/**
+ *  @brief ChaCha20-Poly1305 AEAD encryption procedure
+ *  Encrypts len bytes of in into out and computes the tag over aad and the
+ *  ciphertext
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) on NULL arguments
+ *  @note in and out may be the same buffer
+ *  @param out ciphertext (len bytes)
+ *  @param tag output tag (16 bytes)
+ *  @param in plaintext
+ *  @param len plaintext length
+ *  @param aad additional authenticated data (may be NULL if aad_len == 0)
+ *  @param aad_len aad length
+ *  @param nonce 12-byte nonce
+ *  @param key 32-byte key
+ */
+int tc_chacha20_poly1305_encrypt(uint8_t *out, uint8_t *tag,
+				 const uint8_t *in, size_t len,
+				 const uint8_t *aad, size_t aad_len,
+				 const uint8_t *nonce, const uint8_t *key);
+
+/**
+ *  @brief ChaCha20-Poly1305 AEAD decryption procedure
+ *  Authenticates aad and len bytes of ciphertext and decrypts them into out,
+ *  reading the ciphertext once
+ *  @return returns TC_CRYPTO_SUCCESS (1) if the tag matches
+ *          returns TC_CRYPTO_FAIL (0) on NULL arguments or tag mismatch;
+ *          out is zeroed on mismatch
+ *  @note in and out may be the same buffer
+ *  @param out plaintext (len bytes)
+ *  @param in ciphertext
+ *  @param len ciphertext length
+ *  @param aad additional authenticated data (may be NULL if aad_len == 0)
+ *  @param aad_len aad length
+ *  @param tag received tag (16 bytes)
+ *  @param nonce 12-byte nonce
+ *  @param key 32-byte key
+ */
+int tc_chacha20_poly1305_decrypt(uint8_t *out,
+				 const uint8_t *in, size_t len,
+				 const uint8_t *aad, size_t aad_len,
+				 const uint8_t *tag,
+				 const uint8_t *nonce, const uint8_t *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TC_CHACHA20_POLY1305_H__ */
@@ -73,6 +73,9 @@
  *          - To verify a signature: Compute the hash of the signed data using
  *          the same hash as the signer and pass it to this function along with
  *          the signer's public key and the signature values (r and s).
+ *          - To verify with a key fixed at build time: store the table from
+ *          uECC_verify_table_compute (or scripts/keygen.py) in flash and
+ *          call uECC_verify_with_table; the per-call key setup is skipped.
  */
 
 #ifndef __TC_ECC_DSA_H__
@@ -132,6 +135,78 @@ int uECC_sign_with_k(const uint8_t *private_key, const uint8_t *message_hash,
 int uECC_verify(const uint8_t *p_public_key, const uint8_t *p_message_hash,
 		unsigned int p_hash_size, const uint8_t *p_signature, uECC_Curve curve);
 
+/* precomputed public key table: odd multiples Q, 3Q, ..., 31Q */
+#define uECC_VERIFY_TABLE_WIDTH 6
+#define uECC_VERIFY_TABLE_POINTS (1 << (uECC_VERIFY_TABLE_WIDTH - 2))
+#define uECC_VERIFY_TABLE_WORDS (uECC_VERIFY_TABLE_POINTS * NUM_ECC_WORDS * 2)
+
+/**
+ * @brief Precompute the verification table of a public key.
+ * @return returns TC_CRYPTO_SUCCESS (1) if the table was computed
+ *         returns TC_CRYPTO_FAIL (0) if table or p_public_key is NULL.
+ *
+ * @param table OUT -- uECC_VERIFY_TABLE_WORDS words: the affine points
+ * (2i+1)Q for i = 0 .. uECC_VERIFY_TABLE_POINTS-1, each as x then y in
+ * native word order (least significant word first).
+ * @param p_public_key IN -- The signer's public key.
+ *
+ * @note scripts/keygen.py emits the same table as a const array, so a key
+ * fixed at build time costs no setup on the device.
+ */
+int uECC_verify_table_compute(uECC_word_t *table, const uint8_t *p_public_key,
+			      uECC_Curve curve);
+
+/**
+ * @brief Verify an ECDSA signature with a precomputed public key table.
+ * @return returns TC_SUCCESS (1) if the signature is valid
+ * 	   returns TC_FAIL (0) if the signature is invalid.
+ *
+ * @param table IN -- Table from uECC_verify_table_compute or keygen.py.
+ * @param p_message_hash IN -- The hash of the signed data.
+ * @param p_hash_size IN -- The size of p_message_hash in bytes.
+ * @param p_signature IN -- The signature values.
+ *
+ * @note The table is trusted: it must come from the signer's genuine public
+ * key, e.g. a const array in flash. Compared with uECC_verify, the public key
+ * conversion, the Q multiples and their inversion are skipped, and the wider
+ * window needs fewer point additions.
+ */
+int uECC_verify_with_table(const uECC_word_t *table,
+			   const uint8_t *p_message_hash, unsigned int p_hash_size,
+			   const uint8_t *p_signature, uECC_Curve curve);
+
+/**
+ * @brief Verify many ECDSA signatures in one call (host tooling).
+ * @return returns the number of valid signatures (0 .. count)
+ *         returns -1 if results or an array is NULL, or the curve is not
+ *         secp256r1 on the accelerated path.
+ *
+ * @param public_keys IN -- count pointers to 64-byte public keys; the same
+ * key may appear several times.
+ * @param message_hashes IN -- count pointers to message hashes.
+ * @param hash_size IN -- The size of each message hash in bytes.
+ * @param signatures IN -- count pointers to 64-byte signatures (r, s).
+ * @param results OUT -- count bytes: 1 if signature i is valid, else 0.
+ * @param count IN -- Number of signatures.
+ *
+ * @note With unsigned __int128 (64-bit GCC/Clang hosts) the signatures are
+ * checked with 64-bit limb arithmetic and the s and table inversions are
+ * shared across groups of signatures (Montgomery's trick); elsewhere, or
+ * with uECC_NO_INT128 defined, each item goes through uECC_verify. The
+ * function keeps no state, so several threads may verify disjoint batches.
+ * Not constant time: use it for public data only.
+ */
+int uECC_verify_batch(const uint8_t *const *public_keys,
+		      const uint8_t *const *message_hashes, unsigned hash_size,
+		      const uint8_t *const *signatures, uint8_t *results,
+		      unsigned count, uECC_Curve curve);
+
+/**
+ * @brief Report whether uECC_verify_batch uses the 64-bit path.
+ * @return returns 1 if the 64-bit path is built in, 0 for the fallback.
+ */
+int uECC_verify_batch_accelerated(void);
+
 #ifdef __cplusplus
 }
 #endif
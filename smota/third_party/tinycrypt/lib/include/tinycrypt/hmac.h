@@ -77,6 +77,20 @@ struct tc_hmac_state_struct {
 };
 typedef struct tc_hmac_state_struct *TCHmacState_t;
 
+/*
+ * Keyed HMAC object: the SHA-256 states after absorbing key^ipad and
+ * key^opad. Setting it up costs two compressions (plus the key hash for
+ * keys longer than a block); every MAC computed from it afterwards skips
+ * them, which matters when many short messages share one key.
+ */
+struct tc_hmac_key_struct {
+	/* state after hashing key ^ ipad */
+	struct tc_sha256_state_struct inner;
+	/* state after hashing key ^ opad */
+	struct tc_sha256_state_struct outer;
+};
+typedef struct tc_hmac_key_struct *TCHmacKey_t;
+
 /**
  *  @brief HMAC set key procedure
  *  Configures ctx to use key
@@ -132,6 +146,67 @@ int tc_hmac_update(TCHmacState_t ctx, const void *data,
  */
 int tc_hmac_final(uint8_t *tag, unsigned int taglen, TCHmacState_t ctx);
 
+/**
+ *  @brief HMAC keyed object setup
+ *  Hashes key^ipad and key^opad once and keeps both midstates
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if:
+ *                hkey == NULL or
+ *                key == NULL or
+ *                key_size == 0
+ *  @note hkey holds key-equivalent material: erase it with _set() when done
+ *  @param hkey OUT -- keyed object, may be reused for any number of MACs
+ *  @param key IN -- the HMAC key
+ *  @param key_size IN -- the HMAC key size
+ */
+int tc_hmac_key_setup(TCHmacKey_t hkey, const uint8_t *key,
+		      unsigned int key_size);
+
+/**
+ *  @brief Start an HMAC computation from a keyed object
+ *  Copies the inner midstate into state; feed the message with
+ *  tc_sha256_update and finish with tc_hmac_key_finish
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if: state == NULL or hkey == NULL
+ *  @param state OUT -- SHA-256 state of this computation
+ *  @param hkey IN -- keyed object from tc_hmac_key_setup
+ */
+int tc_hmac_key_start(TCSha256State_t state, const struct tc_hmac_key_struct *hkey);
+
+/**
+ *  @brief Finish an HMAC computation from a keyed object
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if:
+ *                tag == NULL or
+ *                taglen != TC_SHA256_DIGEST_SIZE or
+ *                state == NULL or
+ *                hkey == NULL
+ *  @note state is erased before exiting; hkey is left unchanged
+ *  @param tag OUT -- buffer to receive the HMAC tag
+ *  @param taglen IN -- size of tag in bytes
+ *  @param state IN/OUT -- state from tc_hmac_key_start and tc_sha256_update
+ *  @param hkey IN -- the keyed object passed to tc_hmac_key_start
+ */
+int tc_hmac_key_finish(uint8_t *tag, unsigned int taglen,
+		       TCSha256State_t state,
+		       const struct tc_hmac_key_struct *hkey);
+
+/**
+ *  @brief One-shot HMAC of a buffer with a keyed object
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) on the conditions of
+ *          tc_hmac_key_start and tc_hmac_key_finish, or if data == NULL
+ *          while data_length != 0
+ *  @param tag OUT -- buffer to receive the HMAC tag
+ *  @param taglen IN -- size of tag in bytes (TC_SHA256_DIGEST_SIZE)
+ *  @param hkey IN -- keyed object from tc_hmac_key_setup
+ *  @param data IN -- message
+ *  @param data_length IN -- size of the message in bytes
+ */
+int tc_hmac_key_compute(uint8_t *tag, unsigned int taglen,
+			const struct tc_hmac_key_struct *hkey,
+			const void *data, unsigned int data_length);
+
 #ifdef __cplusplus
 }
 #endif
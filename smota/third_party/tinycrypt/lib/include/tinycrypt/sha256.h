@@ -52,6 +52,14 @@
  *
  *              3) call tc_sha256_final to out put the digest from a hashing
  *              operation.
+ *
+ *  Backends:   the block compression function is dispatched at run time.
+ *              The portable C version is always available; on x86 hosts with
+ *              the SHA extensions and on ARMv8 cores with the crypto
+ *              extension a hardware version is used instead. Detection runs
+ *              on the first tc_sha256_init (or an explicit
+ *              tc_sha256_backend_detect at startup). Define
+ *              TC_SHA256_PORTABLE_ONLY to compile the hardware versions out.
  */
 
 #ifndef __TC_SHA256_H__
@@ -68,6 +76,12 @@ extern "C" {
 #define TC_SHA256_DIGEST_SIZE (32)
 #define TC_SHA256_STATE_BLOCKS (TC_SHA256_DIGEST_SIZE/4)
 
+/* block compression backends */
+#define TC_SHA256_BACKEND_PORTABLE (0) /* unrolled portable C */
+#define TC_SHA256_BACKEND_SHANI (1)    /* x86 SHA extensions */
+#define TC_SHA256_BACKEND_ARMV8 (2)    /* ARMv8 crypto extension */
+#define TC_SHA256_BACKEND_NUM (3)
+
 struct tc_sha256_state_struct {
 	unsigned int iv[TC_SHA256_STATE_BLOCKS];
 	uint64_t bits_hashed;
@@ -122,6 +136,44 @@ int tc_sha256_update (TCSha256State_t s, const uint8_t *data, size_t datalen);
  */
 int tc_sha256_final(uint8_t *digest, TCSha256State_t s);
 
+/**
+ *  @brief Select the fastest backend supported by the running CPU
+ *  @return returns the id of the backend now in use
+ *  @note Runs once automatically from the first tc_sha256_init; call it at
+ *        startup to keep CPU feature detection off the hashing path. The
+ *        selection is process wide and must not change while another thread
+ *        is hashing.
+ */
+unsigned int tc_sha256_backend_detect(void);
+
+/**
+ *  @brief Check whether a backend is compiled in and supported by this CPU
+ *  @return returns 1 if supported, 0 otherwise
+ *  @param backend TC_SHA256_BACKEND_* id
+ */
+int tc_sha256_backend_supported(unsigned int backend);
+
+/**
+ *  @brief Force a backend, e.g. to test or benchmark each one
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if the backend is not supported
+ *  @param backend TC_SHA256_BACKEND_* id
+ */
+int tc_sha256_backend_select(unsigned int backend);
+
+/**
+ *  @brief Get the backend currently in use
+ *  @return returns a TC_SHA256_BACKEND_* id
+ */
+unsigned int tc_sha256_backend_current(void);
+
+/**
+ *  @brief Get a printable backend name
+ *  @return returns the name, or "unknown" for an invalid id
+ *  @param backend TC_SHA256_BACKEND_* id
+ */
+const char *tc_sha256_backend_name(unsigned int backend);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,88 @@
+/* sha256_mb.h - TinyCrypt interface to multi-buffer SHA-256 */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/**
+ * @file
+ * @brief Interface to multi-buffer SHA-256.
+ *
+ *  Overview:   Hashes many independent messages at once. Each SIMD lane
+ *              carries one message; a lane that finishes is refilled with the
+ *              next message, so messages of different lengths keep every
+ *              lane busy. The digests are identical to tc_sha256_*.
+ *
+ *  Lanes:      8 with AVX2, 4 with SSE2, 1 (a loop over tc_sha256_*, which
+ *              uses the fastest single-buffer backend) otherwise. On CPUs
+ *              with the SHA extensions one SHA-NI stream is at least as fast
+ *              as eight AVX2 lanes (AVX2 has no vector rotate), so detection
+ *              picks one lane there.
+ *
+ *  Usage:      call tc_sha256_mb with arrays of message pointers and lengths;
+ *              it is reentrant and keeps all state on the stack (about 1.5KB
+ *              with 8 lanes).
+ */
+
+#ifndef __TC_SHA256_MB_H__
+#define __TC_SHA256_MB_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TC_SHA256_MB_LANES_MAX (8)
+
+/**
+ *  @brief Hash count independent messages
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if:
+ *                digests == NULL,
+ *                data == NULL or datalen == NULL while count > 0,
+ *                data[i] == NULL while datalen[i] > 0
+ *  @param digests OUT -- count * TC_SHA256_DIGEST_SIZE bytes, digest i at
+ *                 digests + i * TC_SHA256_DIGEST_SIZE
+ *  @param data IN -- message pointers
+ *  @param datalen IN -- message lengths
+ *  @param count IN -- number of messages
+ */
+int tc_sha256_mb(uint8_t *digests, const uint8_t *const *data,
+		 const size_t *datalen, size_t count);
+
+/**
+ *  @brief Choose the lane count supported by the running CPU
+ *  @return returns the lane count now in use (1, 4 or 8)
+ *  @note Runs once automatically from the first tc_sha256_mb
+ */
+unsigned int tc_sha256_mb_detect(void);
+
+/**
+ *  @brief Force a lane count, e.g. to test or benchmark each one
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if the CPU cannot run that many lanes
+ *  @param lanes 1, 4 or 8
+ */
+int tc_sha256_mb_select(unsigned int lanes);
+
+/**
+ *  @brief Check whether a lane count is supported by the running CPU
+ *  @return returns 1 if supported, 0 otherwise
+ *  @param lanes 1, 4 or 8
+ */
+int tc_sha256_mb_supported(unsigned int lanes);
+
+/**
+ *  @brief Get the lane count currently in use
+ */
+unsigned int tc_sha256_mb_lanes(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TC_SHA256_MB_H__ */
@@ -0,0 +1,84 @@
+/* aes_backend.h - TinyCrypt AES-128 encryption backends */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/*
+ * Internal interface between aes_encrypt.c, ctr_mode.c and the faster AES
+ * cores. 'rk' is the expanded key of struct tc_aes_key_sched_struct
+ * (44 big-endian words). A counter-mode backend writes 'blocks' keystream
+ * blocks for the counters nonce, nonce + 1, ... where the last four bytes of
+ * the nonce are a big-endian 32-bit counter that wraps.
+ */
+
+#ifndef __TC_AES_BACKEND_H__
+#define __TC_AES_BACKEND_H__
+
+#include <stdint.h>
+#include <tinycrypt/aes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* keystream blocks produced per backend call in tc_ctr_mode */
+#define TC_AES_CTR_BATCH (8)
+
+#if !defined(TC_AES_SMALL)
+#define TC_AES_HAVE_TTABLE 1
+#endif
+
+#if !defined(TC_AES_PORTABLE_ONLY) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define TC_AES_HAVE_AESNI 1
+#endif
+
+typedef void (*tc_aes_block_t)(uint8_t *out, const uint8_t *in, const unsigned int *rk);
+typedef void (*tc_aes_ctr_t)(uint8_t *keystream, const uint8_t *nonce,
+			     unsigned int blocks, const unsigned int *rk);
+
+/* write counter block 'nonce + index' to 'out' */
+static inline void _aes_ctr_block(uint8_t *out, const uint8_t *nonce, unsigned int index)
+{
+	unsigned int ctr = ((unsigned int)nonce[12] << 24) | ((unsigned int)nonce[13] << 16) |
+			   ((unsigned int)nonce[14] << 8) | ((unsigned int)nonce[15]);
+	unsigned int i;
+
+	for (i = 0; i < 12; ++i) {
+		out[i] = nonce[i];
+	}
+	ctr += index;
+	out[12] = (uint8_t)(ctr >> 24);
+	out[13] = (uint8_t)(ctr >> 16);
+	out[14] = (uint8_t)(ctr >> 8);
+	out[15] = (uint8_t)(ctr);
+}
+
+/*
+ * Keystream for 'blocks' counters starting at 'nonce' with the selected
+ * backend; 'nonce' is advanced past them. Defined in aes_encrypt.c.
+ */
+void _aes_ctr_keystream(uint8_t *keystream, uint8_t *nonce, unsigned int blocks,
+			const TCAesKeySched_t s);
+
+#if defined(TC_AES_HAVE_TTABLE)
+void _aes_encrypt_ttable(uint8_t *out, const uint8_t *in, const unsigned int *rk);
+void _aes_ctr_ttable(uint8_t *keystream, const uint8_t *nonce,
+		     unsigned int blocks, const unsigned int *rk);
+#endif
+
+#if defined(TC_AES_HAVE_AESNI)
+int _aes_ni_supported(void);
+void _aes_encrypt_ni(uint8_t *out, const uint8_t *in, const unsigned int *rk);
+void _aes_ctr_ni(uint8_t *keystream, const uint8_t *nonce,
+		 unsigned int blocks, const unsigned int *rk);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TC_AES_BACKEND_H__ */
@@ -33,6 +33,7 @@
 #include <tinycrypt/aes.h>
 #include <tinycrypt/utils.h>
 #include <tinycrypt/constants.h>
+#include "aes_backend.h"
 
 static const uint8_t sbox[256] = {
 	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
@@ -155,37 +156,157 @@ static inline void shift_rows(uint8_t *s)
 	(void) _copy(s, sizeof(t), t, sizeof(t));
 }
 
-int tc_aes_encrypt(uint8_t *out, const uint8_t *in, const TCAesKeySched_t s)
+static void encrypt_byte(uint8_t *out, const uint8_t *in, const unsigned int *rk)
 {
 	uint8_t state[Nk*Nb];
 	unsigned int i;
 
-	if (out == (uint8_t *) 0) {
-		return TC_CRYPTO_FAIL;
-	} else if (in == (const uint8_t *) 0) {
-		return TC_CRYPTO_FAIL;
-	} else if (s == (TCAesKeySched_t) 0) {
-		return TC_CRYPTO_FAIL;
-	}
-
 	(void)_copy(state, sizeof(state), in, sizeof(state));
-	add_round_key(state, s->words);
+	add_round_key(state, rk);
 
 	for (i = 0; i < (Nr - 1); ++i) {
 		sub_bytes(state);
 		shift_rows(state);
 		mix_columns(state);
-		add_round_key(state, s->words + Nb*(i+1));
+		add_round_key(state, rk + Nb*(i+1));
 	}
 
 	sub_bytes(state);
 	shift_rows(state);
-	add_round_key(state, s->words + Nb*(i+1));
+	add_round_key(state, rk + Nb*(i+1));
 
 	(void)_copy(out, sizeof(state), state, sizeof(state));
 
 	/* zeroing out the state buffer */
 	_set(state, TC_ZERO_BYTE, sizeof(state));
+}
+
+static void ctr_byte(uint8_t *keystream, const uint8_t *nonce,
+		     unsigned int blocks, const unsigned int *rk)
+{
+	uint8_t block[TC_AES_BLOCK_SIZE];
+	unsigned int i;
+
+	for (i = 0; i < blocks; ++i) {
+		_aes_ctr_block(block, nonce, i);
+		encrypt_byte(keystream + i * TC_AES_BLOCK_SIZE, block, rk);
+	}
+}
+
+struct aes_backend {
+	const char *name;
+	tc_aes_block_t encrypt;
+	tc_aes_ctr_t ctr;
+};
+
+static const struct aes_backend backends[TC_AES_BACKEND_NUM] = {
+	{ "byte", encrypt_byte, ctr_byte },
+#if defined(TC_AES_HAVE_TTABLE)
+	{ "t-table", _aes_encrypt_ttable, _aes_ctr_ttable },
+#else
+	{ "t-table", (tc_aes_block_t) 0, (tc_aes_ctr_t) 0 },
+#endif
+#if defined(TC_AES_HAVE_AESNI)
+	{ "aes-ni", _aes_encrypt_ni, _aes_ctr_ni },
+#else
+	{ "aes-ni", (tc_aes_block_t) 0, (tc_aes_ctr_t) 0 },
+#endif
+};
+
+static const struct aes_backend *backend = &backends[TC_AES_BACKEND_BYTE];
+static unsigned int current_backend = TC_AES_BACKEND_BYTE;
+static int backend_detected;
+
+int tc_aes_backend_supported(unsigned int id)
+{
+	switch (id) {
+	case TC_AES_BACKEND_BYTE:
+		return 1;
+#if defined(TC_AES_HAVE_TTABLE)
+	case TC_AES_BACKEND_TTABLE:
+		return 1;
+#endif
+#if defined(TC_AES_HAVE_AESNI)
+	case TC_AES_BACKEND_AESNI:
+		return _aes_ni_supported();
+#endif
+	default:
+		return 0;
+	}
+}
+
+int tc_aes_backend_select(unsigned int id)
+{
+	if (!tc_aes_backend_supported(id)) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	backend = &backends[id];
+	current_backend = id;
+	backend_detected = 1;
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+unsigned int tc_aes_backend_detect(void)
+{
+	unsigned int id = TC_AES_BACKEND_NUM;
+
+	/* faster backends are listed after the slower ones */
+	while (--id > TC_AES_BACKEND_BYTE) {
+		if (tc_aes_backend_supported(id)) {
+			break;
+		}
+	}
+	(void)tc_aes_backend_select(id);
+
+	return current_backend;
+}
+
+unsigned int tc_aes_backend_current(void)
+{
+	return current_backend;
+}
+
+const char *tc_aes_backend_name(unsigned int id)
+{
+	return (id < TC_AES_BACKEND_NUM) ? backends[id].name : "unknown";
+}
+
+void _aes_ctr_keystream(uint8_t *keystream, uint8_t *nonce, unsigned int blocks,
+			const TCAesKeySched_t s)
+{
+	unsigned int ctr;
+
+	if (!backend_detected) {
+		(void)tc_aes_backend_detect();
+	}
+
+	backend->ctr(keystream, nonce, blocks, s->words);
+
+	ctr = (nonce[12] << 24) | (nonce[13] << 16) | (nonce[14] << 8) | (nonce[15]);
+	ctr += blocks;
+	nonce[12] = (uint8_t)(ctr >> 24);
+	nonce[13] = (uint8_t)(ctr >> 16);
+	nonce[14] = (uint8_t)(ctr >> 8);
+	nonce[15] = (uint8_t)(ctr);
+}
+
+int tc_aes_encrypt(uint8_t *out, const uint8_t *in, const TCAesKeySched_t s)
+{
+	if (out == (uint8_t *) 0) {
+		return TC_CRYPTO_FAIL;
+	} else if (in == (const uint8_t *) 0) {
+		return TC_CRYPTO_FAIL;
+	} else if (s == (TCAesKeySched_t) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	if (!backend_detected) {
+		(void)tc_aes_backend_detect();
+	}
+
+	backend->encrypt(out, in, s->words);
 
 	return TC_CRYPTO_SUCCESS;
 }
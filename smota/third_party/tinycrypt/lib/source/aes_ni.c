@@ -0,0 +1,113 @@
+/* aes_ni.c - TinyCrypt AES-128 encryption with the x86 AES-NI instructions */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+#include "aes_backend.h"
+
+#if defined(TC_AES_HAVE_AESNI)
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AESNI_TARGET
+#else
+#include <cpuid.h>
+#define AESNI_TARGET __attribute__((target("aes,ssse3")))
+#endif
+
+int _aes_ni_supported(void)
+{
+	unsigned int ecx;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+	int regs[4];
+
+	__cpuid(regs, 1);
+	ecx = (unsigned int)regs[2];
+#else
+	unsigned int eax, ebx, edx;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		return 0;
+	}
+#endif
+
+	/* SSSE3 (ECX bit 9), AES (ECX bit 25) */
+	return ((ecx >> 9) & 1) && ((ecx >> 25) & 1);
+}
+
+/* the schedule holds big-endian words; the instructions want key bytes */
+AESNI_TARGET
+static inline void load_round_keys(__m128i *k, const unsigned int *rk)
+{
+	const __m128i bswap32 = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
+					     4, 5, 6, 7, 0, 1, 2, 3);
+	unsigned int i;
+
+	for (i = 0; i <= Nr; ++i) {
+		k[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(rk + Nb * i)), bswap32);
+	}
+}
+
+AESNI_TARGET
+void _aes_encrypt_ni(uint8_t *out, const uint8_t *in, const unsigned int *rk)
+{
+	__m128i k[Nr + 1];
+	__m128i b;
+	unsigned int i;
+
+	load_round_keys(k, rk);
+
+	b = _mm_xor_si128(_mm_loadu_si128((const __m128i *)in), k[0]);
+	for (i = 1; i < Nr; ++i) {
+		b = _mm_aesenc_si128(b, k[i]);
+	}
+	b = _mm_aesenclast_si128(b, k[Nr]);
+	_mm_storeu_si128((__m128i *)out, b);
+}
+
+AESNI_TARGET
+void _aes_ctr_ni(uint8_t *keystream, const uint8_t *nonce,
+		 unsigned int blocks, const unsigned int *rk)
+{
+	uint8_t ctr[TC_AES_CTR_BATCH][TC_AES_BLOCK_SIZE];
+	__m128i k[Nr + 1];
+	__m128i b[TC_AES_CTR_BATCH];
+	unsigned int done = 0;
+	unsigned int n;
+	unsigned int i;
+	unsigned int j;
+
+	load_round_keys(k, rk);
+
+	/* up to eight independent blocks keep the AES unit's pipeline full */
+	while (done < blocks) {
+		n = blocks - done;
+		if (n > TC_AES_CTR_BATCH) {
+			n = TC_AES_CTR_BATCH;
+		}
+
+		for (j = 0; j < n; ++j) {
+			_aes_ctr_block(ctr[j], nonce, done + j);
+			b[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)ctr[j]), k[0]);
+		}
+		for (i = 1; i < Nr; ++i) {
+			for (j = 0; j < n; ++j) {
+				b[j] = _mm_aesenc_si128(b[j], k[i]);
+			}
+		}
+		for (j = 0; j < n; ++j) {
+			b[j] = _mm_aesenclast_si128(b[j], k[Nr]);
+			_mm_storeu_si128((__m128i *)(keystream + (done + j) * TC_AES_BLOCK_SIZE), b[j]);
+		}
+
+		done += n;
+	}
+}
+
+#endif /* TC_AES_HAVE_AESNI */
@@ -0,0 +1,184 @@
+/* blake2s.c - TinyCrypt BLAKE2s-256 implementation (RFC 7693) */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+#include <tinycrypt/blake2s.h>
+#include <tinycrypt/constants.h>
+#include <tinycrypt/utils.h>
+
+/* same initial values as SHA-256 */
+static const uint32_t blake2s_iv[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint8_t blake2s_sigma[10][16] = {
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+	{ 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+	{ 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+	{ 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+	{ 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+	{ 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+	{ 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+	{ 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+	{ 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 }
+};
+
+static inline uint32_t rotr32(uint32_t x, unsigned int n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t load32_le(const uint8_t *p)
+{
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+	       ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+#define G(a, b, c, d, x, y) \
+	do { \
+		v[a] = v[a] + v[b] + (x); \
+		v[d] = rotr32(v[d] ^ v[a], 16); \
+		v[c] = v[c] + v[d]; \
+		v[b] = rotr32(v[b] ^ v[c], 12); \
+		v[a] = v[a] + v[b] + (y); \
+		v[d] = rotr32(v[d] ^ v[a], 8); \
+		v[c] = v[c] + v[d]; \
+		v[b] = rotr32(v[b] ^ v[c], 7); \
+	} while (0)
+
+static void compress(TCBlake2sState_t s, const uint8_t *block, int last)
+{
+	uint32_t m[16];
+	uint32_t v[16];
+	unsigned int i;
+
+	for (i = 0; i < 16; ++i) {
+		m[i] = load32_le(block + 4 * i);
+	}
+	for (i = 0; i < 8; ++i) {
+		v[i] = s->h[i];
+		v[i + 8] = blake2s_iv[i];
+	}
+	v[12] ^= s->t[0];
+	v[13] ^= s->t[1];
+	if (last) {
+		v[14] = ~v[14];
+	}
+
+	for (i = 0; i < 10; ++i) {
+		const uint8_t *sg = blake2s_sigma[i];
+
+		G(0, 4, 8, 12, m[sg[0]], m[sg[1]]);
+		G(1, 5, 9, 13, m[sg[2]], m[sg[3]]);
+		G(2, 6, 10, 14, m[sg[4]], m[sg[5]]);
+		G(3, 7, 11, 15, m[sg[6]], m[sg[7]]);
+		G(0, 5, 10, 15, m[sg[8]], m[sg[9]]);
+		G(1, 6, 11, 12, m[sg[10]], m[sg[11]]);
+		G(2, 7, 8, 13, m[sg[12]], m[sg[13]]);
+		G(3, 4, 9, 14, m[sg[14]], m[sg[15]]);
+	}
+
+	for (i = 0; i < 8; ++i) {
+		s->h[i] ^= v[i] ^ v[i + 8];
+	}
+}
+
+static void increment_counter(TCBlake2sState_t s, uint32_t inc)
+{
+	s->t[0] += inc;
+	if (s->t[0] < inc) {
+		s->t[1]++;
+	}
+}
+
+int tc_blake2s_init(TCBlake2sState_t s)
+{
+	unsigned int i;
+
+	/* input sanity check: */
+	if (s == (TCBlake2sState_t) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	_set((uint8_t *) s, 0x00, sizeof(*s));
+	for (i = 0; i < 8; ++i) {
+		s->h[i] = blake2s_iv[i];
+	}
+	/* parameter block: digest length 32, no key, fanout 1, depth 1 */
+	s->h[0] ^= 0x01010000 | TC_BLAKE2S_DIGEST_SIZE;
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int tc_blake2s_update(TCBlake2sState_t s, const uint8_t *data, size_t datalen)
+{
+	size_t fill;
+
+	/* input sanity check: */
+	if (s == (TCBlake2sState_t) 0 ||
+	    (data == (const uint8_t *) 0 && datalen > 0)) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	if (datalen == 0) {
+		return TC_CRYPTO_SUCCESS;
+	}
+
+	/* the buffered block is compressed only once more data follows */
+	fill = TC_BLAKE2S_BLOCK_SIZE - s->buflen;
+	if (datalen > fill) {
+		_copy(s->buf + s->buflen, fill, data, fill);
+		increment_counter(s, TC_BLAKE2S_BLOCK_SIZE);
+		compress(s, s->buf, 0);
+		s->buflen = 0;
+		data += fill;
+		datalen -= fill;
+
+		/* whole blocks straight from the input, keeping the last one */
+		while (datalen > TC_BLAKE2S_BLOCK_SIZE) {
+			increment_counter(s, TC_BLAKE2S_BLOCK_SIZE);
+			compress(s, data, 0);
+			data += TC_BLAKE2S_BLOCK_SIZE;
+			datalen -= TC_BLAKE2S_BLOCK_SIZE;
+		}
+	}
+
+	_copy(s->buf + s->buflen, (unsigned int) (TC_BLAKE2S_BLOCK_SIZE - s->buflen),
+	      data, (unsigned int) datalen);
+	s->buflen += datalen;
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int tc_blake2s_final(uint8_t *digest, TCBlake2sState_t s)
+{
+	unsigned int i;
+
+	/* input sanity check: */
+	if (digest == (uint8_t *) 0 ||
+	    s == (TCBlake2sState_t) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	increment_counter(s, (uint32_t) s->buflen);
+	_set(s->buf + s->buflen, 0x00, TC_BLAKE2S_BLOCK_SIZE - s->buflen);
+	compress(s, s->buf, 1);
+
+	for (i = 0; i < 8; ++i) {
+		digest[4 * i] = (uint8_t) (s->h[i]);
+		digest[4 * i + 1] = (uint8_t) (s->h[i] >> 8);
+		digest[4 * i + 2] = (uint8_t) (s->h[i] >> 16);
+		digest[4 * i + 3] = (uint8_t) (s->h[i] >> 24);
+	}
+
+	/* destroy the current state */
+	_set(s, 0, sizeof(*s));
+
+	return TC_CRYPTO_SUCCESS;
+}
@@ -0,0 +1,405 @@
+/* chacha20_poly1305.c - TinyCrypt ChaCha20-Poly1305 implementation (RFC 8439) */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+#include <tinycrypt/chacha20_poly1305.h>
+#include <tinycrypt/constants.h>
+#include <tinycrypt/utils.h>
+
+#define POLY1305_MASK26 0x3ffffff
+
+static inline uint32_t rotl32(uint32_t x, unsigned int n)
+{
+	return (x << n) | (x >> (32 - n));
+}
+
+static inline uint32_t load32_le(const uint8_t *p)
+{
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+	       ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline void store32_le(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t) (v);
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+#define QR(a, b, c, d) \
+	do { \
+		x[a] += x[b]; x[d] = rotl32(x[d] ^ x[a], 16); \
+		x[c] += x[d]; x[b] = rotl32(x[b] ^ x[c], 12); \
+		x[a] += x[b]; x[d] = rotl32(x[d] ^ x[a], 8); \
+		x[c] += x[d]; x[b] = rotl32(x[b] ^ x[c], 7); \
+	} while (0)
+
+/* one 64-byte block of key stream */
+static void chacha20_block(uint8_t out[TC_CHACHA20_BLOCK_SIZE],
+			   const uint8_t *key, const uint8_t *nonce,
+			   uint32_t counter)
+{
+	uint32_t in[16];
+	uint32_t x[16];
+	unsigned int i;
+
+	in[0] = 0x61707865;
+	in[1] = 0x3320646e;
+	in[2] = 0x79622d32;
+	in[3] = 0x6b206574;
+	for (i = 0; i < 8; ++i) {
+		in[4 + i] = load32_le(key + 4 * i);
+	}
+	in[12] = counter;
+	in[13] = load32_le(nonce);
+	in[14] = load32_le(nonce + 4);
+	in[15] = load32_le(nonce + 8);
+
+	for (i = 0; i < 16; ++i) {
+		x[i] = in[i];
+	}
+	for (i = 0; i < 10; ++i) {
+		QR(0, 4, 8, 12);
+		QR(1, 5, 9, 13);
+		QR(2, 6, 10, 14);
+		QR(3, 7, 11, 15);
+		QR(0, 5, 10, 15);
+		QR(1, 6, 11, 12);
+		QR(2, 7, 8, 13);
+		QR(3, 4, 9, 14);
+	}
+	for (i = 0; i < 16; ++i) {
+		store32_le(out + 4 * i, x[i] + in[i]);
+	}
+
+	_set(x, 0, sizeof(x));
+	_set(in, 0, sizeof(in));
+}
+
+int tc_chacha20_xor(uint8_t *out, const uint8_t *in, size_t len,
+		    const uint8_t *key, const uint8_t *nonce, uint32_t counter)
+{
+	uint8_t ks[TC_CHACHA20_BLOCK_SIZE];
+	size_t n;
+	size_t i;
+
+	/* input sanity check: */
+	if (out == (uint8_t *) 0 ||
+	    (in == (const uint8_t *) 0 && len > 0) ||
+	    key == (const uint8_t *) 0 ||
+	    nonce == (const uint8_t *) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	while (len > 0) {
+		chacha20_block(ks, key, nonce, counter++);
+		n = (len < TC_CHACHA20_BLOCK_SIZE) ? len : TC_CHACHA20_BLOCK_SIZE;
+		for (i = 0; i < n; ++i) {
+			out[i] = in[i] ^ ks[i];
+		}
+		in += n;
+		out += n;
+		len -= n;
+	}
+
+	_set(ks, 0, sizeof(ks));
+	return TC_CRYPTO_SUCCESS;
+}
+
+/* absorb whole 16-byte blocks; hibit is 1 << 24 except for a padded final block */
+static void poly1305_blocks(TCPoly1305State_t s, const uint8_t *m, size_t len,
+			    uint32_t hibit)
+{
+	const uint32_t r0 = s->r[0], r1 = s->r[1], r2 = s->r[2];
+	const uint32_t r3 = s->r[3], r4 = s->r[4];
+	const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+	uint32_t h0 = s->h[0], h1 = s->h[1], h2 = s->h[2];
+	uint32_t h3 = s->h[3], h4 = s->h[4];
+	uint64_t d0, d1, d2, d3, d4;
+	uint32_t c;
+
+	while (len >= 16) {
+		h0 += load32_le(m) & POLY1305_MASK26;
+		h1 += (load32_le(m + 3) >> 2) & POLY1305_MASK26;
+		h2 += (load32_le(m + 6) >> 4) & POLY1305_MASK26;
+		h3 += (load32_le(m + 9) >> 6) & POLY1305_MASK26;
+		h4 += (load32_le(m + 12) >> 8) | hibit;
+
+		d0 = (uint64_t) h0 * r0 + (uint64_t) h1 * s4 + (uint64_t) h2 * s3 +
+		     (uint64_t) h3 * s2 + (uint64_t) h4 * s1;
+		d1 = (uint64_t) h0 * r1 + (uint64_t) h1 * r0 + (uint64_t) h2 * s4 +
+		     (uint64_t) h3 * s3 + (uint64_t) h4 * s2;
+		d2 = (uint64_t) h0 * r2 + (uint64_t) h1 * r1 + (uint64_t) h2 * r0 +
+		     (uint64_t) h3 * s4 + (uint64_t) h4 * s3;
+		d3 = (uint64_t) h0 * r3 + (uint64_t) h1 * r2 + (uint64_t) h2 * r1 +
+		     (uint64_t) h3 * r0 + (uint64_t) h4 * s4;
+		d4 = (uint64_t) h0 * r4 + (uint64_t) h1 * r3 + (uint64_t) h2 * r2 +
+		     (uint64_t) h3 * r1 + (uint64_t) h4 * r0;
+
+		c = (uint32_t) (d0 >> 26); h0 = (uint32_t) d0 & POLY1305_MASK26;
+		d1 += c; c = (uint32_t) (d1 >> 26); h1 = (uint32_t) d1 & POLY1305_MASK26;
+		d2 += c; c = (uint32_t) (d2 >> 26); h2 = (uint32_t) d2 & POLY1305_MASK26;
+		d3 += c; c = (uint32_t) (d3 >> 26); h3 = (uint32_t) d3 & POLY1305_MASK26;
+		d4 += c; c = (uint32_t) (d4 >> 26); h4 = (uint32_t) d4 & POLY1305_MASK26;
+		h0 += c * 5; c = h0 >> 26; h0 &= POLY1305_MASK26;
+		h1 += c;
+
+		m += 16;
+		len -= 16;
+	}
+
+	s->h[0] = h0;
+	s->h[1] = h1;
+	s->h[2] = h2;
+	s->h[3] = h3;
+	s->h[4] = h4;
+}
+
+int tc_poly1305_init(TCPoly1305State_t s, const uint8_t *key)
+{
+	/* input sanity check: */
+	if (s == (TCPoly1305State_t) 0 || key == (const uint8_t *) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	_set(s, 0, sizeof(*s));
+
+	/* r &= 0xffffffc0ffffffc0ffffffc0fffffff */
+	s->r[0] = load32_le(key) & 0x3ffffff;
+	s->r[1] = (load32_le(key + 3) >> 2) & 0x3ffff03;
+	s->r[2] = (load32_le(key + 6) >> 4) & 0x3ffc0ff;
+	s->r[3] = (load32_le(key + 9) >> 6) & 0x3f03fff;
+	s->r[4] = (load32_le(key + 12) >> 8) & 0x00fffff;
+
+	s->pad[0] = load32_le(key + 16);
+	s->pad[1] = load32_le(key + 20);
+	s->pad[2] = load32_le(key + 24);
+	s->pad[3] = load32_le(key + 28);
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int tc_poly1305_update(TCPoly1305State_t s, const uint8_t *data, size_t datalen)
+{
+	size_t fill;
+	size_t whole;
+
+	/* input sanity check: */
+	if (s == (TCPoly1305State_t) 0 ||
+	    (data == (const uint8_t *) 0 && datalen > 0)) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	if (s->buflen > 0) {
+		fill = 16 - s->buflen;
+		if (fill > datalen) {
+			fill = datalen;
+		}
+		_copy(s->buf + s->buflen, (unsigned int) (16 - s->buflen),
+		      data, (unsigned int) fill);
+		s->buflen += fill;
+		data += fill;
+		datalen -= fill;
+		if (s->buflen < 16) {
+			return TC_CRYPTO_SUCCESS;
+		}
+		poly1305_blocks(s, s->buf, 16, 1UL << 24);
+		s->buflen = 0;
+	}
+
+	whole = datalen & ~(size_t) 15;
+	if (whole > 0) {
+		poly1305_blocks(s, data, whole, 1UL << 24);
+		data += whole;
+		datalen -= whole;
+	}
+
+	if (datalen > 0) {
+		_copy(s->buf, sizeof(s->buf), data, (unsigned int) datalen);
+		s->buflen = datalen;
+	}
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int tc_poly1305_final(uint8_t *tag, TCPoly1305State_t s)
+{
+	uint32_t h0, h1, h2, h3, h4, c;
+	uint32_t g0, g1, g2, g3, g4;
+	uint32_t mask;
+	uint64_t f;
+
+	/* input sanity check: */
+	if (tag == (uint8_t *) 0 || s == (TCPoly1305State_t) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	/* the final partial block carries its 0x01 terminator inside the block */
+	if (s->buflen > 0) {
+		s->buf[s->buflen] = 1;
+		_set(s->buf + s->buflen + 1, 0, (unsigned int) (15 - s->buflen));
+		poly1305_blocks(s, s->buf, 16, 0);
+	}
+
+	h0 = s->h[0]; h1 = s->h[1]; h2 = s->h[2]; h3 = s->h[3]; h4 = s->h[4];
+
+	/* fully carry h */
+	c = h1 >> 26; h1 &= POLY1305_MASK26;
+	h2 += c; c = h2 >> 26; h2 &= POLY1305_MASK26;
+	h3 += c; c = h3 >> 26; h3 &= POLY1305_MASK26;
+	h4 += c; c = h4 >> 26; h4 &= POLY1305_MASK26;
+	h0 += c * 5; c = h0 >> 26; h0 &= POLY1305_MASK26;
+	h1 += c;
+
+	/* g = h + 5 - 2^130; select h if g is negative, in constant time */
+	g0 = h0 + 5; c = g0 >> 26; g0 &= POLY1305_MASK26;
+	g1 = h1 + c; c = g1 >> 26; g1 &= POLY1305_MASK26;
+	g2 = h2 + c; c = g2 >> 26; g2 &= POLY1305_MASK26;
+	g3 = h3 + c; c = g3 >> 26; g3 &= POLY1305_MASK26;
+	g4 = h4 + c - (1UL << 26);
+
+	mask = (g4 >> 31) - 1;
+	g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+	mask = ~mask;
+	h0 = (h0 & mask) | g0;
+	h1 = (h1 & mask) | g1;
+	h2 = (h2 & mask) | g2;
+	h3 = (h3 & mask) | g3;
+	h4 = (h4 & mask) | g4;
+
+	/* h = h % 2^128, then tag = h + pad */
+	h0 = h0 | (h1 << 26);
+	h1 = (h1 >> 6) | (h2 << 20);
+	h2 = (h2 >> 12) | (h3 << 14);
+	h3 = (h3 >> 18) | (h4 << 8);
+
+	f = (uint64_t) h0 + s->pad[0]; h0 = (uint32_t) f;
+	f = (uint64_t) h1 + s->pad[1] + (f >> 32); h1 = (uint32_t) f;
+	f = (uint64_t) h2 + s->pad[2] + (f >> 32); h2 = (uint32_t) f;
+	f = (uint64_t) h3 + s->pad[3] + (f >> 32); h3 = (uint32_t) f;
+
+	store32_le(tag, h0);
+	store32_le(tag + 4, h1);
+	store32_le(tag + 8, h2);
+	store32_le(tag + 12, h3);
+
+	/* destroy the current state */
+	_set(s, 0, sizeof(*s));
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+/* pad16(x) after aad or ciphertext of length len */
+static void poly1305_pad16(TCPoly1305State_t s, size_t len)
+{
+	static const uint8_t zeros[16] = { 0 };
+
+	if ((len & 15) != 0) {
+		(void) tc_poly1305_update(s, zeros, 16 - (len & 15));
+	}
+}
+
+/* one-time Poly1305 key from block 0, aad absorbed */
+static void aead_start(TCPoly1305State_t s, const uint8_t *aad, size_t aad_len,
+		       const uint8_t *nonce, const uint8_t *key)
+{
+	uint8_t block0[TC_CHACHA20_BLOCK_SIZE];
+
+	chacha20_block(block0, key, nonce, 0);
+	(void) tc_poly1305_init(s, block0);
+	_set(block0, 0, sizeof(block0));
+
+	(void) tc_poly1305_update(s, aad, aad_len);
+	poly1305_pad16(s, aad_len);
+}
+
+/* lengths block, then the tag */
+static void aead_finish(uint8_t *tag, TCPoly1305State_t s, size_t aad_len,
+			size_t len)
+{
+	uint8_t lens[16];
+
+	poly1305_pad16(s, len);
+	store32_le(lens, (uint32_t) aad_len);
+	store32_le(lens + 4, (uint32_t) ((uint64_t) aad_len >> 32));
+	store32_le(lens + 8, (uint32_t) len);
+	store32_le(lens + 12, (uint32_t) ((uint64_t) len >> 32));
+	(void) tc_poly1305_update(s, lens, sizeof(lens));
+	(void) tc_poly1305_final(tag, s);
+}
+
+int tc_chacha20_poly1305_encrypt(uint8_t *out, uint8_t *tag,
+				 const uint8_t *in, size_t len,
+				 const uint8_t *aad, size_t aad_len,
+				 const uint8_t *nonce, const uint8_t *key)
+{
+	struct tc_poly1305_state_struct s;
+
+	/* input sanity check: */
+	if (out == (uint8_t *) 0 || tag == (uint8_t *) 0 ||
+	    (in == (const uint8_t *) 0 && len > 0) ||
+	    (aad == (const uint8_t *) 0 && aad_len > 0) ||
+	    nonce == (const uint8_t *) 0 || key == (const uint8_t *) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	aead_start(&s, aad, aad_len, nonce, key);
+	(void) tc_chacha20_xor(out, in, len, key, nonce, 1);
+	(void) tc_poly1305_update(&s, out, len);
+	aead_finish(tag, &s, aad_len, len);
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int tc_chacha20_poly1305_decrypt(uint8_t *out,
+				 const uint8_t *in, size_t len,
+				 const uint8_t *aad, size_t aad_len,
+				 const uint8_t *tag,
+				 const uint8_t *nonce, const uint8_t *key)
+{
+	struct tc_poly1305_state_struct s;
+	uint8_t ks[TC_CHACHA20_BLOCK_SIZE];
+	uint8_t computed[TC_POLY1305_TAG_SIZE];
+	uint32_t counter = 1;
+	size_t total = len;
+	size_t n;
+	size_t i;
+
+	/* input sanity check: */
+	if (out == (uint8_t *) 0 || tag == (const uint8_t *) 0 ||
+	    (in == (const uint8_t *) 0 && len > 0) ||
+	    (aad == (const uint8_t *) 0 && aad_len > 0) ||
+	    nonce == (const uint8_t *) 0 || key == (const uint8_t *) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	aead_start(&s, aad, aad_len, nonce, key);
+
+	/* one pass: authenticate each ciphertext block, then decrypt it */
+	while (len > 0) {
+		n = (len < TC_CHACHA20_BLOCK_SIZE) ? len : TC_CHACHA20_BLOCK_SIZE;
+		(void) tc_poly1305_update(&s, in, n);
+		chacha20_block(ks, key, nonce, counter++);
+		for (i = 0; i < n; ++i) {
+			out[i] = in[i] ^ ks[i];
+		}
+		in += n;
+		out += n;
+		len -= n;
+	}
+	_set(ks, 0, sizeof(ks));
+
+	aead_finish(computed, &s, aad_len, total);
+
+	if (_compare(computed, tag, sizeof(computed)) != 0) {
+		_set(out - total, 0, (unsigned int) total);
+		return TC_CRYPTO_FAIL;
+	}
+
+	return TC_CRYPTO_SUCCESS;
+}
@@ -33,15 +33,21 @@
 #include <tinycrypt/constants.h>
 #include <tinycrypt/ctr_mode.h>
 #include <tinycrypt/utils.h>
+#include "aes_backend.h"
+
+#include <string.h>
 
 int tc_ctr_mode(uint8_t *out, unsigned int outlen, const uint8_t *in,
 		unsigned int inlen, uint8_t *ctr, const TCAesKeySched_t sched)
 {
 
-	uint8_t buffer[TC_AES_BLOCK_SIZE];
+	uint8_t buffer[TC_AES_CTR_BATCH * TC_AES_BLOCK_SIZE];
 	uint8_t nonce[TC_AES_BLOCK_SIZE];
-	unsigned int block_num;
+	unsigned int blocks;
+	unsigned int len;
 	unsigned int i;
+	uint32_t a;
+	uint32_t b;
 
 	/* input sanity check: */
 	if (out == (uint8_t *) 0 ||
@@ -57,26 +63,34 @@ int tc_ctr_mode(uint8_t *out, unsigned int outlen, const uint8_t *in,
 	/* copy the ctr to the nonce */
 	(void)_copy(nonce, sizeof(nonce), ctr, sizeof(nonce));
 
-	/* select the last 4 bytes of the nonce to be incremented */
-	block_num = (nonce[12] << 24) | (nonce[13] << 16) |
-		    (nonce[14] << 8) | (nonce[15]);
-	for (i = 0; i < inlen; ++i) {
-		if ((i % (TC_AES_BLOCK_SIZE)) == 0) {
-			/* encrypt data using the current nonce */
-			if (tc_aes_encrypt(buffer, nonce, sched)) {
-				block_num++;
-				nonce[12] = (uint8_t)(block_num >> 24);
-				nonce[13] = (uint8_t)(block_num >> 16);
-				nonce[14] = (uint8_t)(block_num >> 8);
-				nonce[15] = (uint8_t)(block_num);
-			} else {
-				return TC_CRYPTO_FAIL;
-			}
+	/*
+	 * Generate the keystream for several counters per call, then XOR it a
+	 * word at a time. The counter advances by one per started block, so
+	 * the keystream left over in a partial last block is discarded.
+	 */
+	while (inlen > 0) {
+		len = (inlen < sizeof(buffer)) ? inlen : sizeof(buffer);
+		blocks = (len + TC_AES_BLOCK_SIZE - 1) / TC_AES_BLOCK_SIZE;
+		_aes_ctr_keystream(buffer, nonce, blocks, sched);
+
+		for (i = 0; i + sizeof(a) <= len; i += sizeof(a)) {
+			memcpy(&a, in + i, sizeof(a));
+			memcpy(&b, buffer + i, sizeof(b));
+			a ^= b;
+			memcpy(out + i, &a, sizeof(a));
+		}
+		for (; i < len; ++i) {
+			out[i] = in[i] ^ buffer[i];
 		}
-		/* update the output */
-		*out++ = buffer[i%(TC_AES_BLOCK_SIZE)] ^ *in++;
+
+		in += len;
+		out += len;
+		inlen -= len;
 	}
 
+	/* zeroing out the keystream buffer */
+	_set(buffer, TC_ZERO_BYTE, sizeof(buffer));
+
 	/* update the counter */
 	ctr[12] = nonce[12]; ctr[13] = nonce[13];
 	ctr[14] = nonce[14]; ctr[15] = nonce[15];
@@ -179,30 +179,372 @@ int uECC_sign(const uint8_t *private_key, const uint8_t *message_hash,
 	return 0;
 }
 
+/*
+ * Verification computes u1*G + u2*Q with Shamir's trick: one shared chain of
+ * doublings, adding multiples of G and Q as the scalar bits ask for them.
+ * Both scalars are recoded in width-w NAF, whose non-zero digits are odd and
+ * at least w positions apart, so each scalar needs about 256/(w+1) additions
+ * instead of one per set bit. Additions use the affine odd multiples
+ * +-P, +-3P, ..., +-(2^(w-1)-1)P: for G they come from a const table, for Q
+ * they are computed once per verification.
+ */
+#if !defined(uECC_VERIFY_SMALL)
+#define uECC_VERIFY_G_WIDTH 6 /* 16 G multiples in a 1KB const table */
+#endif
+#define uECC_VERIFY_Q_WIDTH 4 /* 4 Q multiples on the stack */
+
+#define WNAF_POINTS(w) (1 << ((w) - 2))
+#define WNAF_MAX_DIGITS (NUM_ECC_WORDS * uECC_WORD_BITS + 1)
+
+#if defined(uECC_VERIFY_G_WIDTH)
+/* odd multiples 1G, 3G, ..., 31G of the secp256r1 generator, affine */
+static const uECC_word_t verify_g_table[WNAF_POINTS(uECC_VERIFY_G_WIDTH)][NUM_ECC_WORDS * 2] = {
+	{ /* 1G */
+		BYTES_TO_WORDS_8(96, C2, 98, D8, 45, 39, A1, F4),
+		BYTES_TO_WORDS_8(A0, 33, EB, 2D, 81, 7D, 03, 77),
+		BYTES_TO_WORDS_8(F2, 40, A4, 63, E5, E6, BC, F8),
+		BYTES_TO_WORDS_8(47, 42, 2C, E1, F2, D1, 17, 6B),
+
+		BYTES_TO_WORDS_8(F5, 51, BF, 37, 68, 40, B6, CB),
+		BYTES_TO_WORDS_8(CE, 5E, 31, 6B, 57, 33, CE, 2B),
+		BYTES_TO_WORDS_8(16, 9E, 0F, 7C, 4A, EB, E7, 8E),
+		BYTES_TO_WORDS_8(9B, 7F, 1A, FE, E2, 42, E3, 4F)
+	},
+	{ /* 3G */
+		BYTES_TO_WORDS_8(6C, FD, E7, C6, 1B, 66, 41, FB),
+		BYTES_TO_WORDS_8(85, A9, AD, EF, 21, B7, C6, E6),
+		BYTES_TO_WORDS_8(65, F1, 4B, 1D, 95, EF, F7, C8),
+		BYTES_TO_WORDS_8(44, 0A, 33, A6, D1, E4, CB, 5E),
+
+		BYTES_TO_WORDS_8(32, 50, 7D, A2, 27, B1, 79, 9A),
+		BYTES_TO_WORDS_8(3D, B8, 4F, 38, 36, B0, 2A, D8),
+		BYTES_TO_WORDS_8(EC, A2, 64, 1A, CE, 06, 4B, 37),
+		BYTES_TO_WORDS_8(7E, FF, 98, 49, 0C, 64, 34, 87)
+	},
+	{ /* 5G */
+		BYTES_TO_WORDS_8(ED, 33, D0, C3, 0D, 4A, 55, 21),
+		BYTES_TO_WORDS_8(24, E5, 5B, 1F, FD, 82, 8C, EF),
+		BYTES_TO_WORDS_8(DF, 8F, 66, 08, 56, C8, 84, D7),
+		BYTES_TO_WORDS_8(D2, 40, 51, 51, 7A, 0B, 59, 51),
+
+		BYTES_TO_WORDS_8(A4, 6D, A1, FD, 44, BB, D0, D1),
+		BYTES_TO_WORDS_8(88, 08, D8, D4, 00, 2F, 01, 0D),
+		BYTES_TO_WORDS_8(26, 79, 8A, BF, 36, BF, E1, 8A),
+		BYTES_TO_WORDS_8(7D, 72, 4A, 90, A8, 7D, C1, E0)
+	},
+	{ /* 7G */
+		BYTES_TO_WORDS_8(A3, B2, 87, 31, 70, 28, 06, 30),
+		BYTES_TO_WORDS_8(5B, EF, 0F, A8, B8, F8, F9, 7E),
+		BYTES_TO_WORDS_8(60, FB, 01, 7C, 66, 30, BB, 25),
+		BYTES_TO_WORDS_8(46, 7B, BF, A0, 6F, 3B, 53, 8E),
+
+		BYTES_TO_WORDS_8(B4, 00, F4, C1, 86, 1A, 5E, C5),
+		BYTES_TO_WORDS_8(21, 1B, 04, CB, 33, 36, C7, 53),
+		BYTES_TO_WORDS_8(00, 90, F5, A6, 83, 9F, 06, 6D),
+		BYTES_TO_WORDS_8(36, 18, 33, E0, BD, 1D, EB, 73)
+	},
+	{ /* 9G */
+		BYTES_TO_WORDS_8(E0, 9E, 94, 90, 4B, 8A, 9E, D7),
+		BYTES_TO_WORDS_8(B3, F8, 6D, 2C, 8C, CB, 0A, 9E),
+		BYTES_TO_WORDS_8(72, F8, 71, 1D, D5, 38, 89, 87),
+		BYTES_TO_WORDS_8(71, 0B, DF, FE, B6, D7, 68, EA),
+
+		BYTES_TO_WORDS_8(FA, 48, D0, 4D, 4A, 22, 5A, E8),
+		BYTES_TO_WORDS_8(3F, 82, DE, A4, EA, 4F, 71, 4D),
+		BYTES_TO_WORDS_8(C8, A0, 8E, 4A, 96, 4A, 01, 87),
+		BYTES_TO_WORDS_8(E7, FC, C9, 72, C9, 44, 27, 2A)
+	},
+	{ /* 11G */
+		BYTES_TO_WORDS_8(D1, 21, BC, 74, D3, 91, 33, 43),
+		BYTES_TO_WORDS_8(BF, 48, 50, 25, D0, 2E, 74, 16),
+		BYTES_TO_WORDS_8(DA, 1C, C2, B0, 9D, 37, 38, 06),
+		BYTES_TO_WORDS_8(59, 4C, 3B, 88, B7, 13, D1, 3E),
+
+		BYTES_TO_WORDS_8(40, 37, 2A, E8, FC, EE, F8, E2),
+		BYTES_TO_WORDS_8(DA, 89, 98, 5E, DA, 04, 0D, 09),
+		BYTES_TO_WORDS_8(8A, C6, F4, A4, AF, 43, C8, 24),
+		BYTES_TO_WORDS_8(A2, C8, C4, CC, 9A, 20, 99, 90)
+	},
+	{ /* 13G */
+		BYTES_TO_WORDS_8(01, 2C, 07, 46, 9D, 5D, E1, 98),
+		BYTES_TO_WORDS_8(8A, D5, EA, 65, 4B, 28, 2E, 79),
+		BYTES_TO_WORDS_8(FC, E2, 5E, D8, F2, 5D, 80, 61),
+		BYTES_TO_WORDS_8(5A, 49, AC, E0, 7A, 83, 7C, 17),
+
+		BYTES_TO_WORDS_8(D8, BF, C7, EF, E2, BB, 43, 9C),
+		BYTES_TO_WORDS_8(F3, 4D, FB, A1, C3, 14, EE, 26),
+		BYTES_TO_WORDS_8(72, 4E, 0F, B4, AD, 91, 40, A2),
+		BYTES_TO_WORDS_8(58, A5, BE, 4E, CD, 58, BB, 63)
+	},
+	{ /* 15G */
+		BYTES_TO_WORDS_8(5F, 9D, 9B, E5, 63, 8C, 66, 63),
+		BYTES_TO_WORDS_8(F1, 0E, 3A, DE, 92, AF, 03, AE),
+		BYTES_TO_WORDS_8(65, 82, 88, 99, 89, 37, FB, AD),
+		BYTES_TO_WORDS_8(E7, BA, 1A, 97, C6, 4D, 45, F0),
+
+		BYTES_TO_WORDS_8(36, 4F, 03, 0D, DE, 9C, E5, 47),
+		BYTES_TO_WORDS_8(3F, FA, B5, 75, CE, 21, 3B, 2A),
+		BYTES_TO_WORDS_8(E6, 43, 96, 1F, E5, 94, 65, 4E),
+		BYTES_TO_WORDS_8(1F, 2D, 2E, 59, E3, 3E, B9, B5)
+	},
+	{ /* 17G */
+		BYTES_TO_WORDS_8(3E, A7, 38, 47, E3, BC, 1A, BA),
+		BYTES_TO_WORDS_8(F8, 4A, D6, F0, 78, 86, A6, 5F),
+		BYTES_TO_WORDS_8(1A, 30, 75, 6F, B6, 84, 09, 9C),
+		BYTES_TO_WORDS_8(3A, CC, F1, C0, 04, 69, 77, 47),
+
+		BYTES_TO_WORDS_8(DC, FC, F1, 71, FF, 87, F7, 32),
+		BYTES_TO_WORDS_8(3F, 73, D5, 28, 44, 80, B2, 81),
+		BYTES_TO_WORDS_8(83, 8E, 64, 77, 65, 85, 31, 62),
+		BYTES_TO_WORDS_8(28, 57, B9, B5, E6, 5E, 00, AA)
+	},
+	{ /* 19G */
+		BYTES_TO_WORDS_8(83, ED, 03, AB, 74, 7B, FC, C1),
+		BYTES_TO_WORDS_8(95, 48, 88, 57, 22, 45, 2C, 78),
+		BYTES_TO_WORDS_8(07, C5, 08, 71, C1, B7, 39, CE),
+		BYTES_TO_WORDS_8(25, 0C, 2C, 10, 61, 28, 6D, CB),
+
+		BYTES_TO_WORDS_8(AA, CD, CE, 2B, 75, 50, 91, E3),
+		BYTES_TO_WORDS_8(03, 3E, FA, 30, 6E, 71, 96, A4),
+		BYTES_TO_WORDS_8(E4, 6C, 6D, 0D, 10, E7, 35, 5C),
+		BYTES_TO_WORDS_8(51, EF, D9, 24, 4B, 61, D7, 58)
+	},
+	{ /* 21G */
+		BYTES_TO_WORDS_8(83, 9E, 39, 67, 4E, 36, 76, FD),
+		BYTES_TO_WORDS_8(23, 15, 2B, F4, 39, 21, 58, 3A),
+		BYTES_TO_WORDS_8(A5, BC, 73, B4, 6E, C8, 4A, 2E),
+		BYTES_TO_WORDS_8(7B, 7C, 63, 86, F6, FC, 50, 32),
+
+		BYTES_TO_WORDS_8(09, 8C, D4, 71, A0, 24, DE, 15),
+		BYTES_TO_WORDS_8(82, 6A, 56, 3B, C3, D3, 7C, 89),
+		BYTES_TO_WORDS_8(8C, B8, 7E, 1D, 0D, 09, B3, 97),
+		BYTES_TO_WORDS_8(93, 35, 7D, 66, 42, C3, E7, 42)
+	},
+	{ /* 23G */
+		BYTES_TO_WORDS_8(96, 78, CA, 45, 30, 57, 2E, 67),
+		BYTES_TO_WORDS_8(FE, A4, 64, DF, A5, C0, 0B, 3C),
+		BYTES_TO_WORDS_8(A6, 3F, 58, D4, 39, 3E, 8A, D2),
+		BYTES_TO_WORDS_8(D7, 40, 26, 9C, 23, C7, 91, 0E),
+
+		BYTES_TO_WORDS_8(55, AD, 40, 31, 54, 46, 80, 13),
+		BYTES_TO_WORDS_8(AE, A5, E7, 75, 35, 83, 68, 7E),
+		BYTES_TO_WORDS_8(6D, BD, E0, B8, 3B, 73, 22, 1A),
+		BYTES_TO_WORDS_8(22, BA, 0D, 55, 3B, 5C, F6, 5D)
+	},
+	{ /* 25G */
+		BYTES_TO_WORDS_8(87, D6, 00, F2, 45, DC, A4, 84),
+		BYTES_TO_WORDS_8(24, 1B, 6F, B7, C5, 2F, 65, 41),
+		BYTES_TO_WORDS_8(84, FA, 07, 8C, 2D, F5, F4, 85),
+		BYTES_TO_WORDS_8(B6, 0B, 0C, 4B, 55, E2, 67, 3A),
+
+		BYTES_TO_WORDS_8(24, 93, F7, 02, B3, 16, ED, A9),
+		BYTES_TO_WORDS_8(8A, 61, A7, 35, F7, 8A, 18, 8C),
+		BYTES_TO_WORDS_8(0D, FB, 3A, 16, 67, F2, DA, 26),
+		BYTES_TO_WORDS_8(43, CF, 1F, 2F, 87, F1, D0, 27)
+	},
+	{ /* 27G */
+		BYTES_TO_WORDS_8(D1, 83, 08, 3B, 17, 01, E2, F2),
+		BYTES_TO_WORDS_8(AB, 54, 3E, 68, BD, 55, 63, 57),
+		BYTES_TO_WORDS_8(78, F3, 11, 46, AC, 2F, BA, DE),
+		BYTES_TO_WORDS_8(51, 0D, D8, 19, 58, FA, 4F, 18),
+
+		BYTES_TO_WORDS_8(6F, 6E, 90, 60, C2, 42, D2, 20),
+		BYTES_TO_WORDS_8(16, 49, F0, 63, CC, EC, BD, 45),
+		BYTES_TO_WORDS_8(95, 99, CB, 26, 08, D9, C6, A4),
+		BYTES_TO_WORDS_8(59, F3, 88, 66, 27, 6E, A6, C0)
+	},
+	{ /* 29G */
+		BYTES_TO_WORDS_8(EF, 4D, 78, 1C, 3D, 69, DD, DE),
+		BYTES_TO_WORDS_8(41, 8A, B5, 88, C6, D1, 8C, FD),
+		BYTES_TO_WORDS_8(8C, 3B, 85, 90, A0, 6D, C3, A7),
+		BYTES_TO_WORDS_8(07, 5B, 19, FA, DE, 3A, D3, D6),
+
+		BYTES_TO_WORDS_8(A6, BC, D1, 93, 45, 12, 0C, 55),
+		BYTES_TO_WORDS_8(ED, ED, 95, 4B, AB, 66, A1, 09),
+		BYTES_TO_WORDS_8(CB, 5D, 8A, 55, 5F, 24, 78, 3F),
+		BYTES_TO_WORDS_8(7E, 5D, 19, EE, 16, BA, AA, 84)
+	},
+	{ /* 31G */
+		BYTES_TO_WORDS_8(8B, 5B, B4, A1, A0, 9A, 3F, 3E),
+		BYTES_TO_WORDS_8(3E, 5B, A9, 52, 7D, DB, C9, FA),
+		BYTES_TO_WORDS_8(A0, 9A, AE, A7, 26, A0, 5D, A8),
+		BYTES_TO_WORDS_8(5D, E0, C7, 2D, 50, 9E, 1D, 30),
+
+		BYTES_TO_WORDS_8(67, E2, 7E, A1, AE, B6, 8D, D5),
+		BYTES_TO_WORDS_8(61, CA, 87, 68, E4, 9A, 8D, 29),
+		BYTES_TO_WORDS_8(72, 7D, 01, 6B, 02, 3C, D2, E0),
+		BYTES_TO_WORDS_8(23, 12, 06, B3, F6, B6, 51, 65)
+	}
+
+};
+#endif
+
 static bitcount_t smax(bitcount_t a, bitcount_t b)
 {
 	return (a > b ? a : b);
 }
 
-int uECC_verify(const uint8_t *public_key, const uint8_t *message_hash,
-		unsigned hash_size, const uint8_t *signature,
-	        uECC_Curve curve)
+/* Recode k into width-w NAF digits, least significant first. */
+static bitcount_t wnaf_recode(signed char *naf, const uECC_word_t *k,
+			      unsigned width, wordcount_t num_words)
 {
+	uECC_word_t t[NUM_ECC_WORDS + 1];
+	const uECC_word_t mask = ((uECC_word_t)1 << width) - 1;
+	const int half = 1 << (width - 1);
+	bitcount_t len = 0;
+	wordcount_t i;
+
+	uECC_vli_set(t, k, num_words);
+	t[num_words] = 0;
+
+	while (!uECC_vli_isZero(t, num_words + 1)) {
+		int digit = 0;
+
+		if (t[0] & 1) {
+			digit = (int)(t[0] & mask);
+			if (digit >= half) {
+				digit -= (1 << width);
+			}
+
+			if (digit > 0) {
+				/* the low bits are exactly digit: no borrow */
+				t[0] -= (uECC_word_t)digit;
+			} else {
+				uECC_word_t carry = (uECC_word_t)(-digit);
+
+				for (i = 0; i <= num_words && carry; ++i) {
+					t[i] += carry;
+					carry = (t[i] < carry);
+				}
+			}
+		}
+		naf[len++] = (signed char)digit;
 
-	uECC_word_t u1[NUM_ECC_WORDS], u2[NUM_ECC_WORDS];
+		for (i = 0; i < num_words; ++i) {
+			t[i] = (t[i] >> 1) | (t[i + 1] << (uECC_WORD_BITS - 1));
+		}
+		t[num_words] >>= 1;
+	}
+
+	return len;
+}
+
+/*
+ * Fill table with the affine odd multiples P, 3P, ..., (2*count-1)P of the
+ * affine point P. The multiples are built with co-Z additions of 2P and
+ * share a single inversion (Montgomery's trick); f holds count - 1 field
+ * elements of scratch space.
+ */
+static void build_odd_multiples(uECC_word_t *table, uECC_word_t (*f)[NUM_ECC_WORDS],
+				unsigned count, const uECC_word_t *point,
+				uECC_Curve curve)
+{
+	uECC_word_t dx[NUM_ECC_WORDS];
+	uECC_word_t dy[NUM_ECC_WORDS];
 	uECC_word_t z[NUM_ECC_WORDS];
-	uECC_word_t sum[NUM_ECC_WORDS * 2];
-	uECC_word_t rx[NUM_ECC_WORDS];
-	uECC_word_t ry[NUM_ECC_WORDS];
+	wordcount_t num_words = curve->num_words;
+	uECC_word_t *entry;
+	unsigned j;
+
+	uECC_vli_set(table, point, num_words * 2);
+	if (count < 2) {
+		return;
+	}
+
+	/* (dx, dy, z) = 2P, table[1] = P with the same Z */
+	uECC_vli_set(dx, point, num_words);
+	uECC_vli_set(dy, point + num_words, num_words);
+	uECC_vli_clear(z, num_words);
+	z[0] = 1;
+	curve->double_jacobian(dx, dy, z, curve);
+	entry = table + num_words * 2;
+	uECC_vli_set(entry, point, num_words * 2);
+	apply_z(entry, entry + num_words, z, curve);
+
+	for (j = 1; j < count; ++j) {
+		entry = table + j * num_words * 2;
+		if (j > 1) {
+			uECC_vli_set(entry, entry - num_words * 2, num_words * 2);
+		}
+		/* table[j] = table[j] + 2P, Z is multiplied by f[j - 1] */
+		uECC_vli_modSub(f[j - 1], entry, dx, curve->p, num_words);
+		XYcZ_add(dx, dy, entry, entry + num_words, curve);
+		uECC_vli_modMult_fast(z, z, f[j - 1], curve);
+	}
+
+	/* table[j] has Z = z / (f[j] * ... * f[count - 2]) */
+	uECC_vli_modInv(z, z, curve->p, num_words);
+	for (j = count - 1; j > 0; --j) {
+		entry = table + j * num_words * 2;
+		apply_z(entry, entry + num_words, z, curve);
+		uECC_vli_modMult_fast(z, z, f[j - 1], curve);
+	}
+}
+
+/* (rx, ry, z) += digit * P for an odd-multiples table entry P */
+static void add_multiple(uECC_word_t *rx, uECC_word_t *ry, uECC_word_t *z,
+			 int *started, const uECC_word_t *point, int digit,
+			 uECC_Curve curve)
+{
 	uECC_word_t tx[NUM_ECC_WORDS];
 	uECC_word_t ty[NUM_ECC_WORDS];
 	uECC_word_t tz[NUM_ECC_WORDS];
-	const uECC_word_t *points[4];
-	const uECC_word_t *point;
-	bitcount_t num_bits;
+	wordcount_t num_words = curve->num_words;
+
+	uECC_vli_set(tx, point, num_words);
+	if (digit < 0) {
+		uECC_vli_sub(ty, curve->p, point + num_words, num_words);
+	} else {
+		uECC_vli_set(ty, point + num_words, num_words);
+	}
+
+	if (!*started) {
+		uECC_vli_set(rx, tx, num_words);
+		uECC_vli_set(ry, ty, num_words);
+		uECC_vli_clear(z, num_words);
+		z[0] = 1;
+		*started = 1;
+		return;
+	}
+
+	apply_z(tx, ty, z, curve);
+	uECC_vli_modSub(tz, rx, tx, curve->p, num_words); /* Z = x2 - x1 */
+	XYcZ_add(tx, ty, rx, ry, curve);
+	uECC_vli_modMult_fast(z, z, tz, curve);
+}
+
+/* pointer to entry digit of an odd-multiples table */
+static const uECC_word_t *table_entry(const uECC_word_t *table, int digit,
+				      wordcount_t num_words)
+{
+	return table + ((digit < 0 ? -digit : digit) >> 1) * num_words * 2;
+}
+
+/*
+ * Verify a signature given the odd multiples of Q for a width-q_width NAF.
+ */
+static int verify_with_multiples(const uECC_word_t *q_points, unsigned q_width,
+				 const uint8_t *message_hash, unsigned hash_size,
+				 const uint8_t *signature, uECC_Curve curve)
+{
+	uECC_word_t u1[NUM_ECC_WORDS], u2[NUM_ECC_WORDS];
+	uECC_word_t z[NUM_ECC_WORDS];
+	uECC_word_t rx[NUM_ECC_WORDS];
+	uECC_word_t ry[NUM_ECC_WORDS];
+#if !defined(uECC_VERIFY_G_WIDTH)
+	uECC_word_t g_table[WNAF_POINTS(uECC_VERIFY_Q_WIDTH)][NUM_ECC_WORDS * 2];
+	uECC_word_t f[WNAF_POINTS(uECC_VERIFY_Q_WIDTH) - 1][NUM_ECC_WORDS];
+#endif
+	const uECC_word_t *g_points;
+	signed char naf1[WNAF_MAX_DIGITS];
+	signed char naf2[WNAF_MAX_DIGITS];
+	bitcount_t len1;
+	bitcount_t len2;
 	bitcount_t i;
+	unsigned g_width;
+	int started;
+	int digit;
 
-	uECC_word_t _public[NUM_ECC_WORDS * 2];
 	uECC_word_t r[NUM_ECC_WORDS], s[NUM_ECC_WORDS];
 	wordcount_t num_words = curve->num_words;
 	wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
@@ -211,9 +553,6 @@ int uECC_verify(const uint8_t *public_key, const uint8_t *message_hash,
 	r[num_n_words - 1] = 0;
 	s[num_n_words - 1] = 0;
 
-	uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
-	uECC_vli_bytesToNative(_public + num_words, public_key + curve->num_bytes,
-			       curve->num_bytes);
 	uECC_vli_bytesToNative(r, signature, curve->num_bytes);
 	uECC_vli_bytesToNative(s, signature + curve->num_bytes, curve->num_bytes);
 
@@ -235,46 +574,50 @@ int uECC_verify(const uint8_t *public_key, const uint8_t *message_hash,
 	uECC_vli_modMult(u1, u1, z, curve->n, num_n_words); /* u1 = e/s */
 	uECC_vli_modMult(u2, r, z, curve->n, num_n_words); /* u2 = r/s */
 
-	/* Calculate sum = G + Q. */
-	uECC_vli_set(sum, _public, num_words);
-	uECC_vli_set(sum + num_words, _public + num_words, num_words);
-	uECC_vli_set(tx, curve->G, num_words);
-	uECC_vli_set(ty, curve->G + num_words, num_words);
-	uECC_vli_modSub(z, sum, tx, curve->p, num_words); /* z = x2 - x1 */
-	XYcZ_add(tx, ty, sum, sum + num_words, curve);
-	uECC_vli_modInv(z, z, curve->p, num_words); /* z = 1/z */
-	apply_z(sum, sum + num_words, z, curve);
+	/* Odd multiples of G. */
+#if defined(uECC_VERIFY_G_WIDTH)
+	/* the table holds secp256r1 multiples, the only curve TinyCrypt has */
+	if (uECC_vli_equal(curve->G, verify_g_table[0], num_words * 2) != 0) {
+		return 0;
+	}
+	g_points = verify_g_table[0];
+	g_width = uECC_VERIFY_G_WIDTH;
+#else
+	build_odd_multiples(g_table[0], f, WNAF_POINTS(uECC_VERIFY_Q_WIDTH),
+			    curve->G, curve);
+	g_points = g_table[0];
+	g_width = uECC_VERIFY_Q_WIDTH;
+#endif
 
 	/* Use Shamir's trick to calculate u1*G + u2*Q */
-	points[0] = 0;
-	points[1] = curve->G;
-	points[2] = _public;
-	points[3] = sum;
-	num_bits = smax(uECC_vli_numBits(u1, num_n_words),
-	uECC_vli_numBits(u2, num_n_words));
-
-	point = points[(!!uECC_vli_testBit(u1, num_bits - 1)) |
-                       ((!!uECC_vli_testBit(u2, num_bits - 1)) << 1)];
-	uECC_vli_set(rx, point, num_words);
-	uECC_vli_set(ry, point + num_words, num_words);
-	uECC_vli_clear(z, num_words);
-	z[0] = 1;
+	len1 = wnaf_recode(naf1, u1, g_width, num_n_words);
+	len2 = wnaf_recode(naf2, u2, q_width, num_n_words);
 
-	for (i = num_bits - 2; i >= 0; --i) {
-		uECC_word_t index;
-		curve->double_jacobian(rx, ry, z, curve);
-
-		index = (!!uECC_vli_testBit(u1, i)) | ((!!uECC_vli_testBit(u2, i)) << 1);
-		point = points[index];
-		if (point) {
-			uECC_vli_set(tx, point, num_words);
-			uECC_vli_set(ty, point + num_words, num_words);
-			apply_z(tx, ty, z, curve);
-			uECC_vli_modSub(tz, rx, tx, curve->p, num_words); /* Z = x2 - x1 */
-			XYcZ_add(tx, ty, rx, ry, curve);
-			uECC_vli_modMult_fast(z, z, tz, curve);
+	started = 0;
+	for (i = smax(len1, len2) - 1; i >= 0; --i) {
+		if (started) {
+			curve->double_jacobian(rx, ry, z, curve);
 		}
-  	}
+
+		digit = (i < len1) ? naf1[i] : 0;
+		if (digit) {
+			add_multiple(rx, ry, z, &started,
+				     table_entry(g_points, digit, num_words),
+				     digit, curve);
+		}
+
+		digit = (i < len2) ? naf2[i] : 0;
+		if (digit) {
+			add_multiple(rx, ry, z, &started,
+				     table_entry(q_points, digit, num_words),
+				     digit, curve);
+		}
+	}
+
+	/* u1*G + u2*Q is the point at infinity */
+	if (!started || uECC_vli_isZero(z, num_words)) {
+		return 0;
+	}
 
 	uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
 	apply_z(rx, ry, z, curve);
@@ -288,3 +631,55 @@ int uECC_verify(const uint8_t *public_key, const uint8_t *message_hash,
 	return (int)(uECC_vli_equal(rx, r, num_words) == 0);
 }
 
+int uECC_verify(const uint8_t *public_key, const uint8_t *message_hash,
+		unsigned hash_size, const uint8_t *signature,
+	        uECC_Curve curve)
+{
+	uECC_word_t _public[NUM_ECC_WORDS * 2];
+	uECC_word_t q_table[WNAF_POINTS(uECC_VERIFY_Q_WIDTH)][NUM_ECC_WORDS * 2];
+	uECC_word_t f[WNAF_POINTS(uECC_VERIFY_Q_WIDTH) - 1][NUM_ECC_WORDS];
+	wordcount_t num_words = curve->num_words;
+
+	uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
+	uECC_vli_bytesToNative(_public + num_words, public_key + curve->num_bytes,
+			       curve->num_bytes);
+
+	/* Odd multiples of Q. */
+	build_odd_multiples(q_table[0], f, WNAF_POINTS(uECC_VERIFY_Q_WIDTH),
+			    _public, curve);
+
+	return verify_with_multiples(q_table[0], uECC_VERIFY_Q_WIDTH, message_hash,
+				     hash_size, signature, curve);
+}
+
+int uECC_verify_table_compute(uECC_word_t *table, const uint8_t *public_key,
+			      uECC_Curve curve)
+{
+	uECC_word_t _public[NUM_ECC_WORDS * 2];
+	uECC_word_t f[uECC_VERIFY_TABLE_POINTS - 1][NUM_ECC_WORDS];
+	wordcount_t num_words = curve->num_words;
+
+	if (table == (uECC_word_t *) 0 || public_key == (const uint8_t *) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
+	uECC_vli_bytesToNative(_public + num_words, public_key + curve->num_bytes,
+			       curve->num_bytes);
+
+	build_odd_multiples(table, f, uECC_VERIFY_TABLE_POINTS, _public, curve);
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int uECC_verify_with_table(const uECC_word_t *table,
+			   const uint8_t *message_hash, unsigned hash_size,
+			   const uint8_t *signature, uECC_Curve curve)
+{
+	if (table == (const uECC_word_t *) 0) {
+		return 0;
+	}
+
+	return verify_with_multiples(table, uECC_VERIFY_TABLE_WIDTH, message_hash,
+				     hash_size, signature, curve);
+}
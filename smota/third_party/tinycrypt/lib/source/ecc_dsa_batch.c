@@ -0,0 +1,964 @@
+/* ecc_dsa_batch.c - TinyCrypt batch EC-DSA verification for host tools */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/*
+ * uECC_verify works on 32-bit words with a generic multiply-accumulate and a
+ * binary extended GCD inversion, which suits MCUs but wastes a 64-bit host.
+ * When the compiler has unsigned __int128 this file verifies P-256
+ * signatures with its own arithmetic:
+ *
+ *  - field elements are four 64-bit limbs; products are reduced with the
+ *    NIST fast reduction for p = 2^256 - 2^224 + 2^192 + 2^96 - 1
+ *  - scalars mod n use Montgomery multiplication
+ *  - u1*G + u2*Q is a joint width-w NAF multiplication with Jacobian
+ *    doubling and mixed additions, using a 2KB const table of G multiples
+ *  - the inversions of s and of the Q-table Z coordinates are shared across
+ *    a chunk of signatures with Montgomery's trick, and the final check
+ *    compares X with r*Z^2 so no inversion is needed at the end
+ *
+ * Everything is on the stack, so separate threads can verify separate
+ * batches. Only public data is processed; the code is not constant time and
+ * must not be reused for signing. Without __int128 (or with
+ * uECC_NO_INT128) uECC_verify_batch falls back to uECC_verify per item.
+ */
+
+#include <tinycrypt/ecc.h>
+#include <tinycrypt/ecc_dsa.h>
+#include <tinycrypt/constants.h>
+
+#if defined(__SIZEOF_INT128__) && !defined(uECC_NO_INT128)
+
+#include <string.h>
+
+typedef uint64_t fe[4];
+typedef unsigned __int128 u128;
+
+/* signatures whose inversions share one exponentiation */
+#define BATCH_CHUNK 16
+
+#define G_WIDTH 7 /* 32 G multiples */
+#define Q_WIDTH 5 /* 8 Q multiples per signature */
+#define WNAF_POINTS(w) (1 << ((w) - 2))
+#define WNAF_MAX_DIGITS (257)
+
+struct affine {
+	fe x;
+	fe y;
+};
+
+/* Jacobian coordinates, infinity when z == 0 */
+struct jacobian {
+	fe x;
+	fe y;
+	fe z;
+};
+
+static const fe p256_p = {
+	0xffffffffffffffff, 0x00000000ffffffff, 0x0000000000000000, 0xffffffff00000001
+};
+static const fe p256_b = {
+	0x3bce3c3e27d2604b, 0x651d06b0cc53b0f6, 0xb3ebbd55769886bc, 0x5ac635d8aa3a93e7
+};
+static const fe p256_n = {
+	0xf3b9cac2fc632551, 0xbce6faada7179e84, 0xffffffffffffffff, 0xffffffff00000000
+};
+/* -n^-1 mod 2^64 and R^2 mod n for Montgomery multiplication */
+static const uint64_t p256_n0 = 0xccd1c8aaee00bc4f;
+static const fe p256_n_r2 = {
+	0x83244c95be79eea2, 0x4699799c49bd6fa6, 0x2845b2392b6bec59, 0x66e12d94f3d95620
+};
+
+/* odd multiples 1G, 3G, ..., 63G of the generator, affine */
+static const struct affine g_table[WNAF_POINTS(G_WIDTH)] = {
+	{ /* 1G */
+		{ 0xf4a13945d898c296, 0x77037d812deb33a0, 0xf8bce6e563a440f2, 0x6b17d1f2e12c4247 },
+		{ 0xcbb6406837bf51f5, 0x2bce33576b315ece, 0x8ee7eb4a7c0f9e16, 0x4fe342e2fe1a7f9b }
+	},
+	{ /* 3G */
+		{ 0xfb41661bc6e7fd6c, 0xe6c6b721efada985, 0xc8f7ef951d4bf165, 0x5ecbe4d1a6330a44 },
+		{ 0x9a79b127a27d5032, 0xd82ab036384fb83d, 0x374b06ce1a64a2ec, 0x8734640c4998ff7e }
+	},
+	{ /* 5G */
+		{ 0x21554a0dc3d033ed, 0xef8c82fd1f5be524, 0xd784c85608668fdf, 0x51590b7a515140d2 },
+		{ 0xd1d0bb44fda16da4, 0x0d012f00d4d80888, 0x8ae1bf36bf8a7926, 0xe0c17da8904a727d }
+	},
+	{ /* 7G */
+		{ 0x300628703187b2a3, 0x7ef9f8b8a80fef5b, 0x25bb30667c01fb60, 0x8e533b6fa0bf7b46 },
+		{ 0xc55e1a86c1f400b4, 0x53c73633cb041b21, 0x6d069f83a6f59000, 0x73eb1dbde0331836 }
+	},
+	{ /* 9G */
+		{ 0xd79e8a4b90949ee0, 0x9e0acb8c2c6df8b3, 0x878938d51d71f872, 0xea68d7b6fedf0b71 },
+		{ 0xe85a224a4dd048fa, 0x4d714feaa4de823f, 0x87014a964a8ea0c8, 0x2a2744c972c9fce7 }
+	},
+	{ /* 11G */
+		{ 0x433391d374bc21d1, 0x16742ed0255048bf, 0x0638379db0c21cda, 0x3ed113b7883b4c59 },
+		{ 0xe2f8eefce82a3740, 0x090d04da5e9889da, 0x24c843afa4f4c68a, 0x9099209accc4c8a2 }
+	},
+	{ /* 13G */
+		{ 0x98e15d9d46072c01, 0x792e284b65ead58a, 0x61805df2d85ee2fc, 0x177c837ae0ac495a },
+		{ 0x9c43bbe2efc7bfd8, 0x26ee14c3a1fb4df3, 0xa24091adb40f4e72, 0x63bb58cd4ebea558 }
+	},
+	{ /* 15G */
+		{ 0x63668c63e59b9d5f, 0xae03af92de3a0ef1, 0xadfb378999888265, 0xf0454dc6971abae7 },
+		{ 0x47e59cde0d034f36, 0x2a3b21ce75b5fa3f, 0x4e6594e51f9643e6, 0xb5b93ee3592e2d1f }
+	},
+	{ /* 17G */
+		{ 0xba1abce34738a73e, 0x5fa68678f0d64af8, 0x9c0984b66f75301a, 0x47776904c0f1cc3a },
+		{ 0x32f787ff71f1fcdc, 0x81b2804428d5733f, 0x6231856577648e83, 0xaa005ee6b5b95728 }
+	},
+	{ /* 19G */
+		{ 0xc1fc7b74ab03ed83, 0x782c452257884895, 0xce39b7c17108c507, 0xcb6d2861102c0c25 },
+		{ 0xe39150752bcecdaa, 0xa496716e30fa3e03, 0x5c35e7100d6d6ce4, 0x58d7614b24d9ef51 }
+	},
+	{ /* 21G */
+		{ 0xfd76364e67399e83, 0x3a582139f42b1523, 0x2e4ac86eb473bca5, 0x3250fcf686637c7b },
+		{ 0x15de24a071d48c09, 0x897cd3c33b566a82, 0x97b3090d1d7eb88c, 0x42e7c342667d3593 }
+	},
+	{ /* 23G */
+		{ 0x672e573045ca7896, 0x3c0bc0a5df64a4fe, 0xd28a3e39d4583fa6, 0x0e91c7239c2640d7 },
+		{ 0x138046543140ad55, 0x7e68833575e7a5ae, 0x1a22733bb8e0bd6d, 0x5df65c3b550dba22 }
+	},
+	{ /* 25G */
+		{ 0x84a4dc45f200d687, 0x41652fc5b76f1b24, 0x85f4f52d8c07fa84, 0x3a67e2554b0c0bb6 },
+		{ 0xa9ed16b302f79324, 0x8c188af735a7618a, 0x26daf267163afb0d, 0x27d0f1872f1fcf43 }
+	},
+	{ /* 27G */
+		{ 0xf2e201173b0883d1, 0x576355bd683e54ab, 0xdeba2fac4611f378, 0x184ffa5819d80d51 },
+		{ 0x20d242c260906e6f, 0x45bdeccc63f04916, 0xa4c6d90826cb9995, 0xc0a66e276688f359 }
+	},
+	{ /* 29G */
+		{ 0xdedd693d1c784def, 0xfd8cd1c688b58a41, 0xa7c36da090853b8c, 0xd6d33adefa195b07 },
+		{ 0x550c124593d1bca6, 0x09a166ab4b95eded, 0x3f78245f558a5dcb, 0x84aaba16ee195d7e }
+	},
+	{ /* 31G */
+		{ 0x3e3f9aa0a1b45b8b, 0xfac9db7d52a95b3e, 0xa85da026a7ae9aa0, 0x301d9e502dc7e05d },
+		{ 0xd58db6aea17ee267, 0x298d9ae46887ca61, 0xe0d23c026b017d72, 0x6551b6f6b3061223 }
+	},
+	{ /* 33G */
+		{ 0x65c100f3cb2cd793, 0xa03b0a533aa872fd, 0xfa9aa25b89d9d34e, 0x9807d699fcd81356 },
+		{ 0x2f6bf92479634af4, 0xffe630b96c587853, 0x86a01a4d1d091b2f, 0xc2a59cdccab11bf2 }
+	},
+	{ /* 35G */
+		{ 0xa12d389033bb291a, 0x94e8e1fe92af9700, 0x8ffa3ad7326c48ca, 0xd58d4a589ed27d16 },
+		{ 0xa5b0c9c6f586b9d5, 0x67271c163b034979, 0x76ea92632dc7fef6, 0xd45514d102726b85 }
+	},
+	{ /* 37G */
+		{ 0x73a92894502b3348, 0xe0d21379246bfd44, 0xd6b0978611a826aa, 0x419a6a646ddb817d },
+		{ 0xdb1d6c81b09214b2, 0x13c6d072f3dee1e2, 0x545c9fb1954c2fd5, 0x332544cf1102f584 }
+	},
+	{ /* 39G */
+		{ 0xa0c199ddfb2776c4, 0x547b942dd2d138d4, 0x42014976a179046e, 0x22a682f7c3996d4d },
+		{ 0x5347f649cbaa285d, 0x979dcc310265b068, 0xb918c9835a54356c, 0x4f4606b0102223ee }
+	},
+	{ /* 41G */
+		{ 0x3a7de694995d2fa2, 0x6067c5c3d4175a59, 0x1cf258d2e6cfe8aa, 0x67a6bec240dee065 },
+		{ 0x49c24ce1441feed5, 0x1542c7ee209aca6c, 0x6c249b49464d4499, 0xde692b7022d13158 }
+	},
+	{ /* 43G */
+		{ 0x7544dc129b82d28d, 0x8f4bc4c6d009b30f, 0xd04230861d8f4b49, 0x986ae2506f1ff104 },
+		{ 0x25110c441bb07e97, 0xd86fc6289c189f25, 0xe328a4d97d3c7b61, 0x003cccc0a6460e0a }
+	},
+	{ /* 45G */
+		{ 0x79c78080fae0ba03, 0x0f5f609edd29d6d9, 0x3ecd0f5ddff0672e, 0xa891d06670bde99b },
+		{ 0xefc3edc8166934ae, 0x1c6b38f0feb0f2cc, 0x419a88c4033c1ce7, 0xb596cd922cbfa1c1 }
+	},
+	{ /* 47G */
+		{ 0x51d689227b1c0d7c, 0xdd5b31583e19066d, 0x595361ea83071bbc, 0x42c315cc48958708 },
+		{ 0xd6c4a72bb2f9b1b9, 0x74f1a1e1eb87f164, 0x2914d1dfbb7a7990, 0x649a61ce571b9585 }
+	},
+	{ /* 49G */
+		{ 0x7d228ce6a5674455, 0x28fb7ea9758fd4fd, 0xbb22b146866e6c05, 0xf785b0e098068875 },
+		{ 0xe7bc490c10d62408, 0x4b04b6fd5f3aa60a, 0xe15c767f0d9f5b41, 0x73fdb0bf6080da6e }
+	},
+	{ /* 51G */
+		{ 0x044360f0018e22b1, 0x95f7eb56e81008ff, 0xaadee6863c1d68bc, 0x672c4a514d9de43e },
+		{ 0x9935399191f37104, 0x136246589704d941, 0x611de5a4ace203f7, 0x548c7e9196a25bfe }
+	},
+	{ /* 53G */
+		{ 0xf126ec9f7449d036, 0x982b1ca78de9b983, 0x5a47802254b88039, 0x6f01bd49c9d95245 },
+		{ 0x360233dd989e17db, 0xa78551bfc3749b08, 0x11a0f21a608776ce, 0x1562080ff1d5deab }
+	},
+	{ /* 55G */
+		{ 0xdec1dff7df6e60a0, 0xc2a595b762c1eada, 0x7571a109fe7fea2c, 0x079dba7ba068c926 },
+		{ 0xfb0da5aeb4824dea, 0x83eb2df35751a397, 0x1d223f9d2a9588ab, 0xdc1e19b743d4d181 }
+	},
+	{ /* 57G */
+		{ 0x8abd97b1d0f56077, 0x289d406e2d6c6bd8, 0x126d45a8ea907f86, 0xc116e30ebb4d2865 },
+		{ 0x313fd7fda410c206, 0x7d5bd5e89e59c8c5, 0xb8b16d9bb13b8765, 0xe9478823c35b30c2 }
+	},
+	{ /* 59G */
+		{ 0xa2b6ea0e0faa4b45, 0xe50941119e8dc8ec, 0x765b2784fca9bdf7, 0x665f1a6ffe0c6437 },
+		{ 0x6e25a6602b7f4ccf, 0x7dede5bf81e215bc, 0x6e8cca29f7eac37f, 0x490e2ca49ffd18c2 }
+	},
+	{ /* 61G */
+		{ 0x5939ac380d32af0e, 0x3e7910a08b724fd5, 0x2d3a6b3d8d990001, 0x059ccb19edd3da9a },
+		{ 0x928e1e3c97fe91d1, 0x1621f7a33956cecd, 0xda65281b9345638e, 0xbb6ad7eccad49159 }
+	},
+	{ /* 63G */
+		{ 0x32a290825d8bdac1, 0xdf53c8af01a7cd38, 0x2a1f28a08acc7d8f, 0x6a9501d85bf5dc80 },
+		{ 0x30aff53d5f1ef1a3, 0xf8461b5c697a6f35, 0x81c6c6e44a3c56a3, 0xca640ad193473743 }
+	}
+};
+
+static int fe_is_zero(const fe a)
+{
+	return (a[0] | a[1] | a[2] | a[3]) == 0;
+}
+
+static int fe_equal(const fe a, const fe b)
+{
+	return ((a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3])) == 0;
+}
+
+/* 1 if a >= b */
+static int fe_geq(const fe a, const fe b)
+{
+	int i;
+
+	for (i = 3; i >= 0; --i) {
+		if (a[i] != b[i]) {
+			return a[i] > b[i];
+		}
+	}
+	return 1;
+}
+
+/* r = a - b, returns the borrow */
+static uint64_t fe_sub_raw(fe r, const fe a, const fe b)
+{
+	uint64_t borrow = 0;
+	int i;
+
+	for (i = 0; i < 4; ++i) {
+		u128 t = (u128)a[i] - b[i] - borrow;
+		r[i] = (uint64_t)t;
+		borrow = (uint64_t)(t >> 64) & 1;
+	}
+	return borrow;
+}
+
+/* r = a + b, returns the carry */
+static uint64_t fe_add_raw(fe r, const fe a, const fe b)
+{
+	uint64_t carry = 0;
+	int i;
+
+	for (i = 0; i < 4; ++i) {
+		u128 t = (u128)a[i] + b[i] + carry;
+		r[i] = (uint64_t)t;
+		carry = (uint64_t)(t >> 64);
+	}
+	return carry;
+}
+
+static void fe_from_bytes(fe r, const uint8_t *bytes)
+{
+	int i;
+	int j;
+
+	for (i = 0; i < 4; ++i) {
+		uint64_t v = 0;
+
+		for (j = 0; j < 8; ++j) {
+			v = (v << 8) | bytes[(3 - i) * 8 + j];
+		}
+		r[i] = v;
+	}
+}
+
+/* field arithmetic mod p, inputs and outputs in [0, p) */
+
+static void fe_add(fe r, const fe a, const fe b)
+{
+	if (fe_add_raw(r, a, b) || fe_geq(r, p256_p)) {
+		(void)fe_sub_raw(r, r, p256_p);
+	}
+}
+
+static void fe_sub(fe r, const fe a, const fe b)
+{
+	if (fe_sub_raw(r, a, b)) {
+		(void)fe_add_raw(r, r, p256_p);
+	}
+}
+
+/*
+ * Reduce a 512-bit product with the NIST routine for p-256: the product's
+ * 32-bit words c0..c15 are recombined as T + 2S1 + 2S2 + S3 + S4 - D1 - D2 -
+ * D3 - D4 (FIPS 186-4 D.2.3), summed per word position in signed 64 bits.
+ */
+static void fe_reduce(fe r, const uint64_t t[8])
+{
+	/* 2^256 mod p = 2^224 - 2^192 - 2^96 + 1, per 32-bit word */
+	static const int fold[8] = { 1, 0, 0, -1, 0, 0, -1, 1 };
+	int64_t c[16];
+	int64_t acc[8];
+	uint32_t w[8];
+	int64_t carry;
+	int i;
+
+	for (i = 0; i < 8; ++i) {
+		c[2 * i] = (int64_t)(t[i] & 0xffffffff);
+		c[2 * i + 1] = (int64_t)(t[i] >> 32);
+	}
+
+	acc[0] = c[0] + c[8] + c[9] - c[11] - c[12] - c[13] - c[14];
+	acc[1] = c[1] + c[9] + c[10] - c[12] - c[13] - c[14] - c[15];
+	acc[2] = c[2] + c[10] + c[11] - c[13] - c[14] - c[15];
+	acc[3] = c[3] + 2 * c[11] + 2 * c[12] + c[13] - c[15] - c[8] - c[9];
+	acc[4] = c[4] + 2 * c[12] + 2 * c[13] + c[14] - c[9] - c[10];
+	acc[5] = c[5] + 2 * c[13] + 2 * c[14] + c[15] - c[10] - c[11];
+	acc[6] = c[6] + 3 * c[14] + 2 * c[15] + c[13] - c[8] - c[9];
+	acc[7] = c[7] + 3 * c[15] + c[8] - c[10] - c[11] - c[12] - c[13];
+
+	carry = 0;
+	for (i = 0; i < 8; ++i) {
+		carry += acc[i];
+		w[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+
+	/* fold the (small, signed) overflow back in until it is gone */
+	while (carry != 0) {
+		int64_t k = carry;
+
+		carry = 0;
+		for (i = 0; i < 8; ++i) {
+			carry += (int64_t)w[i] + k * fold[i];
+			w[i] = (uint32_t)carry;
+			carry >>= 32;
+		}
+	}
+
+	for (i = 0; i < 4; ++i) {
+		r[i] = ((uint64_t)w[2 * i + 1] << 32) | w[2 * i];
+	}
+	if (fe_geq(r, p256_p)) {
+		(void)fe_sub_raw(r, r, p256_p);
+	}
+}
+
+static void fe_mul(fe r, const fe a, const fe b)
+{
+	uint64_t t[8] = { 0 };
+	int i;
+	int j;
+
+	for (i = 0; i < 4; ++i) {
+		uint64_t carry = 0;
+
+		for (j = 0; j < 4; ++j) {
+			u128 uv = (u128)a[i] * b[j] + t[i + j] + carry;
+			t[i + j] = (uint64_t)uv;
+			carry = (uint64_t)(uv >> 64);
+		}
+		t[i + 4] = carry;
+	}
+	fe_reduce(r, t);
+}
+
+static void fe_sqr(fe r, const fe a)
+{
+	fe_mul(r, a, a);
+}
+
+/* r = a^e for a 256-bit exponent, with mul/one of the given arithmetic */
+static void fe_pow(fe r, const fe a, const fe e, const fe one,
+		   void (*mul)(fe, const fe, const fe))
+{
+	fe t;
+	int i;
+
+	memcpy(t, one, sizeof(fe));
+	for (i = 255; i >= 0; --i) {
+		mul(t, t, t);
+		if ((e[i / 64] >> (i % 64)) & 1) {
+			mul(t, t, a);
+		}
+	}
+	memcpy(r, t, sizeof(fe));
+}
+
+/* r = 1/a mod p (Fermat), a != 0 */
+static void fe_inv(fe r, const fe a)
+{
+	static const fe p_minus_2 = {
+		0xfffffffffffffffd, 0x00000000ffffffff, 0x0000000000000000, 0xffffffff00000001
+	};
+	static const fe one = { 1, 0, 0, 0 };
+
+	fe_pow(r, a, p_minus_2, one, fe_mul);
+}
+
+/* scalar arithmetic mod n in the Montgomery domain (a*R mod n, R = 2^256) */
+
+static void sc_mont_mul(fe r, const fe a, const fe b)
+{
+	uint64_t t[6] = { 0 };
+	uint64_t carry;
+	uint64_t m;
+	u128 uv;
+	int i;
+	int j;
+
+	for (i = 0; i < 4; ++i) {
+		carry = 0;
+		for (j = 0; j < 4; ++j) {
+			uv = (u128)a[j] * b[i] + t[j] + carry;
+			t[j] = (uint64_t)uv;
+			carry = (uint64_t)(uv >> 64);
+		}
+		uv = (u128)t[4] + carry;
+		t[4] = (uint64_t)uv;
+		t[5] = (uint64_t)(uv >> 64);
+
+		m = t[0] * p256_n0;
+		uv = (u128)m * p256_n[0] + t[0];
+		carry = (uint64_t)(uv >> 64);
+		for (j = 1; j < 4; ++j) {
+			uv = (u128)m * p256_n[j] + t[j] + carry;
+			t[j - 1] = (uint64_t)uv;
+			carry = (uint64_t)(uv >> 64);
+		}
+		uv = (u128)t[4] + carry;
+		t[3] = (uint64_t)uv;
+		t[4] = t[5] + (uint64_t)(uv >> 64);
+	}
+
+	memcpy(r, t, sizeof(fe));
+	if (t[4] || fe_geq(r, p256_n)) {
+		(void)fe_sub_raw(r, r, p256_n);
+	}
+}
+
+/* r = 1/a in the Montgomery domain (Fermat), a != 0 */
+static void sc_mont_inv(fe r, const fe a)
+{
+	static const fe n_minus_2 = {
+		0xf3b9cac2fc63254f, 0xbce6faada7179e84, 0xffffffffffffffff, 0xffffffff00000000
+	};
+	/* R mod n */
+	static const fe mont_one = {
+		0x0c46353d039cdaaf, 0x4319055258e8617b, 0x0000000000000000, 0x00000000ffffffff
+	};
+
+	fe_pow(r, a, n_minus_2, mont_one, sc_mont_mul);
+}
+
+/*
+ * Replace each a[i] by its inverse with one inversion (Montgomery's trick);
+ * every a[i] must be non-zero. scratch holds count elements.
+ */
+static void batch_invert(fe *a, fe *scratch, unsigned count,
+			 void (*mul)(fe, const fe, const fe),
+			 void (*inv)(fe, const fe))
+{
+	fe acc;
+	fe t;
+	unsigned i;
+
+	if (count == 0) {
+		return;
+	}
+
+	/* scratch[i] = a[0] * ... * a[i] */
+	memcpy(scratch[0], a[0], sizeof(fe));
+	for (i = 1; i < count; ++i) {
+		mul(scratch[i], scratch[i - 1], a[i]);
+	}
+
+	inv(acc, scratch[count - 1]);
+	for (i = count - 1; i > 0; --i) {
+		mul(t, acc, scratch[i - 1]); /* 1/a[i] */
+		mul(acc, acc, a[i]);         /* 1/(a[0] * ... * a[i-1]) */
+		memcpy(a[i], t, sizeof(fe));
+	}
+	memcpy(a[0], acc, sizeof(fe));
+}
+
+/* point arithmetic, a = -3 */
+
+static void point_double(struct jacobian *p)
+{
+	fe delta, gamma, beta, alpha, t1, t2;
+
+	if (fe_is_zero(p->z)) {
+		return;
+	}
+
+	fe_sqr(delta, p->z);
+	fe_sqr(gamma, p->y);
+	fe_mul(beta, p->x, gamma);
+
+	/* alpha = 3 * (x - delta) * (x + delta) */
+	fe_sub(t1, p->x, delta);
+	fe_add(t2, p->x, delta);
+	fe_mul(alpha, t1, t2);
+	fe_add(t1, alpha, alpha);
+	fe_add(alpha, t1, alpha);
+
+	/* z3 = (y + z)^2 - gamma - delta */
+	fe_add(t1, p->y, p->z);
+	fe_sqr(t1, t1);
+	fe_sub(t1, t1, gamma);
+	fe_sub(p->z, t1, delta);
+
+	/* x3 = alpha^2 - 8 * beta */
+	fe_add(beta, beta, beta);
+	fe_add(beta, beta, beta); /* 4 * beta */
+	fe_sqr(t1, alpha);
+	fe_add(t2, beta, beta);
+	fe_sub(p->x, t1, t2);
+
+	/* y3 = alpha * (4 * beta - x3) - 8 * gamma^2 */
+	fe_sub(t1, beta, p->x);
+	fe_mul(t1, alpha, t1);
+	fe_sqr(t2, gamma);
+	fe_add(t2, t2, t2);
+	fe_add(t2, t2, t2);
+	fe_add(t2, t2, t2);
+	fe_sub(p->y, t1, t2);
+}
+
+/* p += (x, y) */
+static void point_add_affine(struct jacobian *p, const fe x, const fe y)
+{
+	fe z1z1, u2, s2, h, r, hh, i, j, v, t;
+
+	if (fe_is_zero(p->z)) {
+		memcpy(p->x, x, sizeof(fe));
+		memcpy(p->y, y, sizeof(fe));
+		memset(p->z, 0, sizeof(fe));
+		p->z[0] = 1;
+		return;
+	}
+
+	fe_sqr(z1z1, p->z);
+	fe_mul(u2, x, z1z1);
+	fe_mul(s2, p->z, z1z1);
+	fe_mul(s2, y, s2);
+	fe_sub(h, u2, p->x);
+	fe_sub(r, s2, p->y);
+
+	if (fe_is_zero(h)) {
+		if (fe_is_zero(r)) {
+			point_double(p);
+		} else {
+			memset(p->z, 0, sizeof(fe));
+		}
+		return;
+	}
+
+	fe_add(r, r, r);
+	fe_sqr(hh, h);
+	fe_add(i, hh, hh);
+	fe_add(i, i, i);
+	fe_mul(j, h, i);
+	fe_mul(v, p->x, i);
+
+	/* z3 = (z1 + h)^2 - z1z1 - hh */
+	fe_add(t, p->z, h);
+	fe_sqr(t, t);
+	fe_sub(t, t, z1z1);
+	fe_sub(p->z, t, hh);
+
+	/* x3 = r^2 - j - 2 * v */
+	fe_sqr(t, r);
+	fe_sub(t, t, j);
+	fe_sub(t, t, v);
+	fe_sub(p->x, t, v);
+
+	/* y3 = r * (v - x3) - 2 * y1 * j */
+	fe_sub(t, v, p->x);
+	fe_mul(t, r, t);
+	fe_mul(j, p->y, j);
+	fe_add(j, j, j);
+	fe_sub(p->y, t, j);
+}
+
+/* p += q, both Jacobian */
+static void point_add(struct jacobian *p, const struct jacobian *q)
+{
+	fe z1z1, z2z2, u1, u2, s1, s2, h, i, j, r, v, t;
+
+	if (fe_is_zero(q->z)) {
+		return;
+	}
+	if (fe_is_zero(p->z)) {
+		*p = *q;
+		return;
+	}
+
+	fe_sqr(z1z1, p->z);
+	fe_sqr(z2z2, q->z);
+	fe_mul(u1, p->x, z2z2);
+	fe_mul(u2, q->x, z1z1);
+	fe_mul(s1, q->z, z2z2);
+	fe_mul(s1, p->y, s1);
+	fe_mul(s2, p->z, z1z1);
+	fe_mul(s2, q->y, s2);
+	fe_sub(h, u2, u1);
+	fe_sub(r, s2, s1);
+
+	if (fe_is_zero(h)) {
+		if (fe_is_zero(r)) {
+			point_double(p);
+		} else {
+			memset(p->z, 0, sizeof(fe));
+		}
+		return;
+	}
+
+	fe_add(r, r, r);
+	fe_add(i, h, h);
+	fe_sqr(i, i);
+	fe_mul(j, h, i);
+	fe_mul(v, u1, i);
+
+	/* z3 = ((z1 + z2)^2 - z1z1 - z2z2) * h */
+	fe_add(t, p->z, q->z);
+	fe_sqr(t, t);
+	fe_sub(t, t, z1z1);
+	fe_sub(t, t, z2z2);
+	fe_mul(p->z, t, h);
+
+	/* x3 = r^2 - j - 2 * v */
+	fe_sqr(t, r);
+	fe_sub(t, t, j);
+	fe_sub(t, t, v);
+	fe_sub(p->x, t, v);
+
+	/* y3 = r * (v - x3) - 2 * s1 * j */
+	fe_sub(t, v, p->x);
+	fe_mul(t, r, t);
+	fe_mul(s1, s1, j);
+	fe_add(s1, s1, s1);
+	fe_sub(p->y, t, s1);
+}
+
+/* p += digit * table entry, digit odd */
+static void point_add_digit(struct jacobian *p, const struct affine *table,
+			    int digit)
+{
+	const struct affine *e = &table[(digit < 0 ? -digit : digit) >> 1];
+	fe y;
+
+	if (digit < 0) {
+		fe_sub(y, p256_p, e->y);
+		point_add_affine(p, e->x, y);
+	} else {
+		point_add_affine(p, e->x, e->y);
+	}
+}
+
+/* Recode k < 2^256 into width-w NAF digits, least significant first. */
+static int wnaf_recode(signed char *naf, const fe k, unsigned width)
+{
+	uint64_t t[5];
+	const uint64_t mask = ((uint64_t)1 << width) - 1;
+	const int half = 1 << (width - 1);
+	int len = 0;
+	int i;
+
+	memcpy(t, k, sizeof(fe));
+	t[4] = 0;
+
+	while (t[0] | t[1] | t[2] | t[3] | t[4]) {
+		int digit = 0;
+
+		if (t[0] & 1) {
+			digit = (int)(t[0] & mask);
+			if (digit >= half) {
+				digit -= (1 << width);
+			}
+
+			if (digit > 0) {
+				t[0] -= (uint64_t)digit;
+			} else {
+				uint64_t carry = (uint64_t)(-digit);
+
+				for (i = 0; i < 5 && carry; ++i) {
+					t[i] += carry;
+					carry = (t[i] < carry);
+				}
+			}
+		}
+		naf[len++] = (signed char)digit;
+
+		for (i = 0; i < 4; ++i) {
+			t[i] = (t[i] >> 1) | (t[i + 1] << 63);
+		}
+		t[4] >>= 1;
+	}
+
+	return len;
+}
+
+/* per-signature state within a chunk */
+struct batch_item {
+	fe u1;
+	fe u2;
+	fe r;
+	struct affine q[WNAF_POINTS(Q_WIDTH)];
+	int ok;
+};
+
+/* 1 if (x, y) is on the curve: y^2 = x^3 - 3x + b */
+static int point_on_curve(const fe x, const fe y)
+{
+	fe l, r, t;
+
+	if (fe_geq(x, p256_p) || fe_geq(y, p256_p)) {
+		return 0;
+	}
+	fe_sqr(l, y);
+	fe_sqr(r, x);
+	fe_mul(r, r, x);
+	fe_add(t, x, x);
+	fe_add(t, t, x);
+	fe_sub(r, r, t);
+	fe_add(r, r, p256_b);
+	return fe_equal(l, r);
+}
+
+/* Decode key, signature and hash; leaves ok = 0 on any invalid input. */
+static void batch_item_load(struct batch_item *it, fe s,
+			    const uint8_t *public_key, const uint8_t *hash,
+			    unsigned hash_size, const uint8_t *signature)
+{
+	uint8_t e_bytes[NUM_ECC_BYTES];
+
+	it->ok = 0;
+	if (public_key == (const uint8_t *) 0 || hash == (const uint8_t *) 0 ||
+	    signature == (const uint8_t *) 0) {
+		return;
+	}
+
+	fe_from_bytes(it->q[0].x, public_key);
+	fe_from_bytes(it->q[0].y, public_key + NUM_ECC_BYTES);
+	fe_from_bytes(it->r, signature);
+	fe_from_bytes(s, signature + NUM_ECC_BYTES);
+
+	/* r, s must be in [1, n - 1], Q on the curve */
+	if (fe_is_zero(it->r) || fe_is_zero(s) || fe_geq(it->r, p256_n) ||
+	    fe_geq(s, p256_n) || !point_on_curve(it->q[0].x, it->q[0].y)) {
+		return;
+	}
+
+	/* e = leftmost 256 bits of the hash, reduced once mod n (bits2int) */
+	if (hash_size > NUM_ECC_BYTES) {
+		hash_size = NUM_ECC_BYTES;
+	}
+	memset(e_bytes, 0, sizeof(e_bytes));
+	memcpy(e_bytes + NUM_ECC_BYTES - hash_size, hash, hash_size);
+	fe_from_bytes(it->u1, e_bytes);
+	if (fe_geq(it->u1, p256_n)) {
+		(void)fe_sub_raw(it->u1, it->u1, p256_n);
+	}
+
+	it->ok = 1;
+}
+
+/* Verify one chunk of at most BATCH_CHUNK signatures. */
+static unsigned verify_chunk(const uint8_t *const *public_keys,
+			     const uint8_t *const *hashes, unsigned hash_size,
+			     const uint8_t *const *signatures, uint8_t *results,
+			     unsigned count)
+{
+	struct batch_item items[BATCH_CHUNK];
+	struct jacobian jq[WNAF_POINTS(Q_WIDTH)];
+	fe inv[BATCH_CHUNK * WNAF_POINTS(Q_WIDTH)];
+	fe scratch[BATCH_CHUNK * WNAF_POINTS(Q_WIDTH)];
+	signed char naf1[WNAF_MAX_DIGITS];
+	signed char naf2[WNAF_MAX_DIGITS];
+	unsigned valid = 0;
+	unsigned k;
+	unsigned i;
+	unsigned m;
+
+	/* s^-1 for every valid item (Montgomery domain mod n) */
+	for (i = 0, m = 0; i < count; ++i) {
+		batch_item_load(&items[i], inv[m], public_keys[i], hashes[i],
+				hash_size, signatures[i]);
+		if (items[i].ok) {
+			sc_mont_mul(inv[m], inv[m], p256_n_r2);
+			++m;
+		}
+	}
+	batch_invert(inv, scratch, m, sc_mont_mul, sc_mont_inv);
+
+	/* u1 = e / s, u2 = r / s (mont_mul by a Montgomery value leaves plain) */
+	for (i = 0, m = 0; i < count; ++i) {
+		if (items[i].ok) {
+			sc_mont_mul(items[i].u1, items[i].u1, inv[m]);
+			sc_mont_mul(items[i].u2, items[i].r, inv[m]);
+			++m;
+		}
+	}
+
+	/* odd multiples 3Q, 5Q, ... in Jacobian, Z collected for one inversion */
+	for (i = 0, m = 0; i < count; ++i) {
+		struct jacobian d;
+
+		if (!items[i].ok) {
+			continue;
+		}
+
+		memcpy(d.x, items[i].q[0].x, sizeof(fe));
+		memcpy(d.y, items[i].q[0].y, sizeof(fe));
+		memset(d.z, 0, sizeof(fe));
+		d.z[0] = 1;
+		jq[0] = d;
+		point_double(&d);
+
+		for (k = 1; k < WNAF_POINTS(Q_WIDTH); ++k) {
+			jq[k] = jq[k - 1];
+			point_add(&jq[k], &d);
+			if (fe_is_zero(jq[k].z)) {
+				items[i].ok = 0;
+				break;
+			}
+		}
+		if (!items[i].ok) {
+			continue;
+		}
+
+		for (k = 1; k < WNAF_POINTS(Q_WIDTH); ++k) {
+			/* keep Jacobian x, y in the table until Z^-1 is known */
+			memcpy(items[i].q[k].x, jq[k].x, sizeof(fe));
+			memcpy(items[i].q[k].y, jq[k].y, sizeof(fe));
+			memcpy(inv[m++], jq[k].z, sizeof(fe));
+		}
+	}
+	batch_invert(inv, scratch, m, fe_mul, fe_inv);
+
+	for (i = 0, m = 0; i < count; ++i) {
+		struct jacobian acc;
+		fe z2, t;
+		int len1, len2, j;
+
+		if (!items[i].ok) {
+			results[i] = 0;
+			continue;
+		}
+
+		/* affine (x, y) = (X / Z^2, Y / Z^3) */
+		for (k = 1; k < WNAF_POINTS(Q_WIDTH); ++k, ++m) {
+			fe_sqr(t, inv[m]);
+			fe_mul(items[i].q[k].x, items[i].q[k].x, t);
+			fe_mul(t, t, inv[m]);
+			fe_mul(items[i].q[k].y, items[i].q[k].y, t);
+		}
+
+		/* u1*G + u2*Q with shared doublings */
+		len1 = wnaf_recode(naf1, items[i].u1, G_WIDTH);
+		len2 = wnaf_recode(naf2, items[i].u2, Q_WIDTH);
+		memset(&acc, 0, sizeof(acc));
+		for (j = (len1 > len2 ? len1 : len2) - 1; j >= 0; --j) {
+			point_double(&acc);
+			if (j < len1 && naf1[j]) {
+				point_add_digit(&acc, g_table, naf1[j]);
+			}
+			if (j < len2 && naf2[j]) {
+				point_add_digit(&acc, items[i].q, naf2[j]);
+			}
+		}
+
+		/*
+		 * Accept if x(acc) mod n == r, i.e. X == r * Z^2 or, when
+		 * r + n < p, X == (r + n) * Z^2; no inversion needed.
+		 */
+		results[i] = 0;
+		if (!fe_is_zero(acc.z)) {
+			fe_sqr(z2, acc.z);
+			fe_mul(t, items[i].r, z2);
+			if (fe_equal(t, acc.x)) {
+				results[i] = 1;
+			} else if (!fe_add_raw(t, items[i].r, p256_n) &&
+				   !fe_geq(t, p256_p)) {
+				fe_mul(t, t, z2);
+				results[i] = (uint8_t)fe_equal(t, acc.x);
+			}
+		}
+		valid += results[i];
+	}
+
+	return valid;
+}
+
+int uECC_verify_batch(const uint8_t *const *public_keys,
+		      const uint8_t *const *message_hashes, unsigned hash_size,
+		      const uint8_t *const *signatures, uint8_t *results,
+		      unsigned count, uECC_Curve curve)
+{
+	unsigned valid = 0;
+	unsigned done;
+	unsigned n;
+
+	if (results == (uint8_t *) 0 ||
+	    (count > 0 && (public_keys == (const uint8_t *const *) 0 ||
+			   message_hashes == (const uint8_t *const *) 0 ||
+			   signatures == (const uint8_t *const *) 0))) {
+		return -1;
+	}
+
+	/* the arithmetic above is secp256r1 only */
+	if (curve != uECC_secp256r1()) {
+		memset(results, 0, count);
+		return -1;
+	}
+
+	for (done = 0; done < count; done += n) {
+		n = (count - done < BATCH_CHUNK) ? count - done : BATCH_CHUNK;
+		valid += verify_chunk(public_keys + done, message_hashes + done,
+				      hash_size, signatures + done, results + done,
+				      n);
+	}
+
+	return (int)valid;
+}
+
+int uECC_verify_batch_accelerated(void)
+{
+	return 1;
+}
+
+#else /* no unsigned __int128 */
+
+int uECC_verify_batch(const uint8_t *const *public_keys,
+		      const uint8_t *const *message_hashes, unsigned hash_size,
+		      const uint8_t *const *signatures, uint8_t *results,
+		      unsigned count, uECC_Curve curve)
+{
+	unsigned valid = 0;
+	unsigned i;
+
+	if (results == (uint8_t *) 0 ||
+	    (count > 0 && (public_keys == (const uint8_t *const *) 0 ||
+			   message_hashes == (const uint8_t *const *) 0 ||
+			   signatures == (const uint8_t *const *) 0))) {
+		return -1;
+	}
+
+	for (i = 0; i < count; ++i) {
+		results[i] = (uint8_t)(public_keys[i] && message_hashes[i] &&
+				       signatures[i] &&
+				       uECC_verify(public_keys[i], message_hashes[i],
+						   hash_size, signatures[i], curve));
+		valid += results[i];
+	}
+
+	return (int)valid;
+}
+
+int uECC_verify_batch_accelerated(void)
+{
+	return 0;
+}
+
+#endif
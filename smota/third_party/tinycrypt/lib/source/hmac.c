@@ -145,3 +145,80 @@ int tc_hmac_final(uint8_t *tag, unsigned int taglen, TCHmacState_t ctx)
 
 	return TC_CRYPTO_SUCCESS;
 }
+
+int tc_hmac_key_setup(TCHmacKey_t hkey, const uint8_t *key,
+		      unsigned int key_size)
+{
+	struct tc_hmac_state_struct pads;
+
+	/* the key hashing and its timing guard are those of tc_hmac_set_key */
+	if (hkey == (TCHmacKey_t) 0 ||
+	    tc_hmac_set_key(&pads, key, key_size) != TC_CRYPTO_SUCCESS) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	(void)tc_sha256_init(&hkey->inner);
+	(void)tc_sha256_update(&hkey->inner, pads.key, TC_SHA256_BLOCK_SIZE);
+	(void)tc_sha256_init(&hkey->outer);
+	(void)tc_sha256_update(&hkey->outer, &pads.key[TC_SHA256_BLOCK_SIZE],
+			       TC_SHA256_BLOCK_SIZE);
+
+	/* destroy the padded key */
+	_set(&pads, 0, sizeof(pads));
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int tc_hmac_key_start(TCSha256State_t state, const struct tc_hmac_key_struct *hkey)
+{
+	/* input sanity check: */
+	if (state == (TCSha256State_t) 0 ||
+	    hkey == (const struct tc_hmac_key_struct *) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	_copy((uint8_t *)state, sizeof(*state),
+	      (const uint8_t *)&hkey->inner, sizeof(hkey->inner));
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int tc_hmac_key_finish(uint8_t *tag, unsigned int taglen,
+		       TCSha256State_t state,
+		       const struct tc_hmac_key_struct *hkey)
+{
+	/* input sanity check: */
+	if (tag == (uint8_t *) 0 ||
+	    taglen != TC_SHA256_DIGEST_SIZE ||
+	    state == (TCSha256State_t) 0 ||
+	    hkey == (const struct tc_hmac_key_struct *) 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	(void)tc_sha256_final(tag, state);
+
+	_copy((uint8_t *)state, sizeof(*state),
+	      (const uint8_t *)&hkey->outer, sizeof(hkey->outer));
+	(void)tc_sha256_update(state, tag, TC_SHA256_DIGEST_SIZE);
+	(void)tc_sha256_final(tag, state);
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+int tc_hmac_key_compute(uint8_t *tag, unsigned int taglen,
+			const struct tc_hmac_key_struct *hkey,
+			const void *data, unsigned int data_length)
+{
+	struct tc_sha256_state_struct state;
+
+	if (data == (const void *) 0 && data_length != 0) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	if (tc_hmac_key_start(&state, hkey) != TC_CRYPTO_SUCCESS) {
+		return TC_CRYPTO_FAIL;
+	}
+	(void)tc_sha256_update(&state, data, data_length);
+
+	return tc_hmac_key_finish(tag, taglen, &state, hkey);
+}
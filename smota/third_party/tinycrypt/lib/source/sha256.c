@@ -33,8 +33,88 @@
 #include <tinycrypt/sha256.h>
 #include <tinycrypt/constants.h>
 #include <tinycrypt/utils.h>
+#include "sha256_backend.h"
 
-static void compress(unsigned int *iv, const uint8_t *data);
+static void compress_portable(unsigned int *iv, const uint8_t *data, size_t blocks);
+
+struct sha256_backend {
+	const char *name;
+	tc_sha256_compress_t compress;
+};
+
+static const struct sha256_backend backends[TC_SHA256_BACKEND_NUM] = {
+	{ "portable", compress_portable },
+#if defined(TC_SHA256_HAVE_SHANI)
+	{ "sha-ni", _sha256_compress_shani },
+#else
+	{ "sha-ni", (tc_sha256_compress_t) 0 },
+#endif
+#if defined(TC_SHA256_HAVE_ARMV8)
+	{ "armv8-ce", _sha256_compress_armv8 },
+#else
+	{ "armv8-ce", (tc_sha256_compress_t) 0 },
+#endif
+};
+
+static tc_sha256_compress_t compress = compress_portable;
+static unsigned int current_backend = TC_SHA256_BACKEND_PORTABLE;
+static int backend_detected;
+
+int tc_sha256_backend_supported(unsigned int backend)
+{
+	switch (backend) {
+	case TC_SHA256_BACKEND_PORTABLE:
+		return 1;
+#if defined(TC_SHA256_HAVE_SHANI)
+	case TC_SHA256_BACKEND_SHANI:
+		return _sha256_shani_supported();
+#endif
+#if defined(TC_SHA256_HAVE_ARMV8)
+	case TC_SHA256_BACKEND_ARMV8:
+		return _sha256_armv8_supported();
+#endif
+	default:
+		return 0;
+	}
+}
+
+int tc_sha256_backend_select(unsigned int backend)
+{
+	if (!tc_sha256_backend_supported(backend)) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	compress = backends[backend].compress;
+	current_backend = backend;
+	backend_detected = 1;
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+unsigned int tc_sha256_backend_detect(void)
+{
+	unsigned int backend = TC_SHA256_BACKEND_NUM;
+
+	/* hardware backends are listed after the portable one */
+	while (--backend > TC_SHA256_BACKEND_PORTABLE) {
+		if (tc_sha256_backend_supported(backend)) {
+			break;
+		}
+	}
+	(void)tc_sha256_backend_select(backend);
+
+	return current_backend;
+}
+
+unsigned int tc_sha256_backend_current(void)
+{
+	return current_backend;
+}
+
+const char *tc_sha256_backend_name(unsigned int backend)
+{
+	return (backend < TC_SHA256_BACKEND_NUM) ? backends[backend].name : "unknown";
+}
 
 int tc_sha256_init(TCSha256State_t s)
 {
@@ -43,6 +123,10 @@ int tc_sha256_init(TCSha256State_t s)
 		return TC_CRYPTO_FAIL;
 	}
 
+	if (!backend_detected) {
+		(void)tc_sha256_backend_detect();
+	}
+
 	/*
 	 * Setting the initial state values.
 	 * These values correspond to the first 32 bits of the fractional parts
@@ -72,13 +156,40 @@ int tc_sha256_update(TCSha256State_t s, const uint8_t *data, size_t datalen)
 		return TC_CRYPTO_SUCCESS;
 	}
 
-	while (datalen-- > 0) {
-		s->leftover[s->leftover_offset++] = *(data++);
-		if (s->leftover_offset >= TC_SHA256_BLOCK_SIZE) {
-			compress(s->iv, s->leftover);
-			s->leftover_offset = 0;
-			s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+	/* top up a partially filled block first */
+	if (s->leftover_offset > 0) {
+		size_t fill = TC_SHA256_BLOCK_SIZE - s->leftover_offset;
+
+		if (fill > datalen) {
+			fill = datalen;
+		}
+		(void)_copy(s->leftover + s->leftover_offset, fill, data, fill);
+		s->leftover_offset += fill;
+		data += fill;
+		datalen -= fill;
+
+		if (s->leftover_offset < TC_SHA256_BLOCK_SIZE) {
+			return TC_CRYPTO_SUCCESS;
 		}
+		compress(s->iv, s->leftover, 1);
+		s->leftover_offset = 0;
+		s->bits_hashed += (TC_SHA256_BLOCK_SIZE << 3);
+	}
+
+	/* compress whole blocks straight from the caller's buffer */
+	if (datalen >= TC_SHA256_BLOCK_SIZE) {
+		size_t blocks = datalen / TC_SHA256_BLOCK_SIZE;
+
+		compress(s->iv, data, blocks);
+		data += blocks * TC_SHA256_BLOCK_SIZE;
+		datalen -= blocks * TC_SHA256_BLOCK_SIZE;
+		s->bits_hashed += (uint64_t)blocks * (TC_SHA256_BLOCK_SIZE << 3);
+	}
+
+	/* keep the tail for the next call */
+	if (datalen > 0) {
+		(void)_copy(s->leftover, sizeof(s->leftover), data, datalen);
+		s->leftover_offset = datalen;
 	}
 
 	return TC_CRYPTO_SUCCESS;
@@ -101,7 +212,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 		/* there is not room for all the padding in this block */
 		_set(s->leftover + s->leftover_offset, 0x00,
 		     sizeof(s->leftover) - s->leftover_offset);
-		compress(s->iv, s->leftover);
+		compress(s->iv, s->leftover, 1);
 		s->leftover_offset = 0;
 	}
 
@@ -118,7 +229,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
 	s->leftover[sizeof(s->leftover) - 8] = (uint8_t)(s->bits_hashed >> 56);
 
 	/* hash the padding and length */
-	compress(s->iv, s->leftover);
+	compress(s->iv, s->leftover, 1);
 
 	/* copy the iv out to digest */
 	for (i = 0; i < TC_SHA256_STATE_BLOCKS; ++i) {
@@ -140,7 +251,7 @@ int tc_sha256_final(uint8_t *digest, TCSha256State_t s)
  * These values correspond to the first 32 bits of the fractional parts of the
  * cube roots of the first 64 primes between 2 and 311.
  */
-static const unsigned int k256[64] = {
+const unsigned int _sha256_k256[64] = {
 	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
 	0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
 	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
@@ -167,51 +278,64 @@ static inline unsigned int ROTR(unsigned int a, unsigned int n)
 #define Ch(a, b, c)(((a) & (b)) ^ ((~(a)) & (c)))
 #define Maj(a, b, c)(((a) & (b)) ^ ((a) & (c)) ^ ((b) & (c)))
 
-static inline unsigned int BigEndian(const uint8_t **c)
+/*
+ * Load the i-th big-endian word of a block. Indexing a fixed offset (rather
+ * than walking a pointer) lets the compiler emit a single load plus byte swap
+ * where the target allows unaligned access.
+ */
+static inline unsigned int BigEndian(const uint8_t *c, unsigned int i)
 {
-	unsigned int n = 0;
-
-	n = (((unsigned int)(*((*c)++))) << 24);
-	n |= ((unsigned int)(*((*c)++)) << 16);
-	n |= ((unsigned int)(*((*c)++)) << 8);
-	n |= ((unsigned int)(*((*c)++)));
-	return n;
+	c += i << 2;
+	return ((unsigned int)c[0] << 24) | ((unsigned int)c[1] << 16) |
+	       ((unsigned int)c[2] << 8) | ((unsigned int)c[3]);
 }
 
-static void compress(unsigned int *iv, const uint8_t *data)
+/* one round; the caller rotates the roles of a..h instead of moving values */
+#define ROUND(a, b, c, d, e, f, g, h, i, w) \
+	do { \
+		t1 = (h) + Sigma1(e) + Ch(e, f, g) + _sha256_k256[i] + (w); \
+		(d) += t1; \
+		(h) = t1 + Sigma0(a) + Maj(a, b, c); \
+	} while (0)
+
+#define LOAD(i) (work_space[i] = BigEndian(data, i))
+#define SCHEDULE(i) \
+	(work_space[(i) & 0x0f] += sigma1(work_space[((i) - 2) & 0x0f]) + \
+				   work_space[((i) - 7) & 0x0f] + \
+				   sigma0(work_space[((i) - 15) & 0x0f]))
+
+#define ROUNDS8(i, W) \
+	do { \
+		ROUND(a, b, c, d, e, f, g, h, (i) + 0, W((i) + 0)); \
+		ROUND(h, a, b, c, d, e, f, g, (i) + 1, W((i) + 1)); \
+		ROUND(g, h, a, b, c, d, e, f, (i) + 2, W((i) + 2)); \
+		ROUND(f, g, h, a, b, c, d, e, (i) + 3, W((i) + 3)); \
+		ROUND(e, f, g, h, a, b, c, d, (i) + 4, W((i) + 4)); \
+		ROUND(d, e, f, g, h, a, b, c, (i) + 5, W((i) + 5)); \
+		ROUND(c, d, e, f, g, h, a, b, (i) + 6, W((i) + 6)); \
+		ROUND(b, c, d, e, f, g, h, a, (i) + 7, W((i) + 7)); \
+	} while (0)
+
+static void compress_portable(unsigned int *iv, const uint8_t *data, size_t blocks)
 {
 	unsigned int a, b, c, d, e, f, g, h;
-	unsigned int s0, s1;
-	unsigned int t1, t2;
+	unsigned int t1;
 	unsigned int work_space[16];
-	unsigned int n;
 	unsigned int i;
 
-	a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
-	e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
+	while (blocks-- > 0) {
+		a = iv[0]; b = iv[1]; c = iv[2]; d = iv[3];
+		e = iv[4]; f = iv[5]; g = iv[6]; h = iv[7];
 
-	for (i = 0; i < 16; ++i) {
-		n = BigEndian(&data);
-		t1 = work_space[i] = n;
-		t1 += h + Sigma1(e) + Ch(e, f, g) + k256[i];
-		t2 = Sigma0(a) + Maj(a, b, c);
-		h = g; g = f; f = e; e = d + t1;
-		d = c; c = b; b = a; a = t1 + t2;
-	}
+		ROUNDS8(0, LOAD);
+		ROUNDS8(8, LOAD);
+		for (i = 16; i < 64; i += 16) {
+			ROUNDS8(i, SCHEDULE);
+			ROUNDS8(i + 8, SCHEDULE);
+		}
 
-	for ( ; i < 64; ++i) {
-		s0 = work_space[(i+1)&0x0f];
-		s0 = sigma0(s0);
-		s1 = work_space[(i+14)&0x0f];
-		s1 = sigma1(s1);
-
-		t1 = work_space[i&0xf] += s0 + s1 + work_space[(i+9)&0xf];
-		t1 += h + Sigma1(e) + Ch(e, f, g) + k256[i];
-		t2 = Sigma0(a) + Maj(a, b, c);
-		h = g; g = f; f = e; e = d + t1;
-		d = c; c = b; b = a; a = t1 + t2;
+		iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
+		iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
+		data += TC_SHA256_BLOCK_SIZE;
 	}
-
-	iv[0] += a; iv[1] += b; iv[2] += c; iv[3] += d;
-	iv[4] += e; iv[5] += f; iv[6] += g; iv[7] += h;
 }
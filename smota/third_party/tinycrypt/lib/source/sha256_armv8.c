@@ -0,0 +1,69 @@
+/* sha256_armv8.c - TinyCrypt SHA-256 compression using the ARMv8 crypto extension */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+#include "sha256_backend.h"
+
+#if defined(TC_SHA256_HAVE_ARMV8)
+
+#include <arm_neon.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+int _sha256_armv8_supported(void)
+{
+#if defined(_WIN32)
+	return IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE) ? 1 : 0;
+#elif defined(__linux__)
+	return (getauxval(AT_HWCAP) & HWCAP_SHA2) ? 1 : 0;
+#else
+	/* built with the crypto extension enabled, so the target must have it */
+	return 1;
+#endif
+}
+
+void _sha256_compress_armv8(unsigned int *iv, const uint8_t *data, size_t blocks)
+{
+	uint32x4_t state0 = vld1q_u32(&iv[0]);
+	uint32x4_t state1 = vld1q_u32(&iv[4]);
+	uint32x4_t abcd, efgh, msg, tmp;
+	uint32x4_t w[4];
+	unsigned int j;
+
+	while (blocks-- > 0) {
+		abcd = state0;
+		efgh = state1;
+
+		for (j = 0; j < 16; ++j) {
+			if (j < 4) {
+				w[j] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + (j << 4))));
+			} else {
+				w[j & 3] = vsha256su1q_u32(vsha256su0q_u32(w[j & 3], w[(j + 1) & 3]),
+							   w[(j + 2) & 3], w[(j + 3) & 3]);
+			}
+
+			msg = vaddq_u32(w[j & 3], vld1q_u32(&_sha256_k256[j << 2]));
+			tmp = state0;
+			state0 = vsha256hq_u32(state0, state1, msg);
+			state1 = vsha256h2q_u32(state1, tmp, msg);
+		}
+
+		state0 = vaddq_u32(state0, abcd);
+		state1 = vaddq_u32(state1, efgh);
+		data += 64;
+	}
+
+	vst1q_u32(&iv[0], state0);
+	vst1q_u32(&iv[4], state1);
+}
+
+#endif /* TC_SHA256_HAVE_ARMV8 */
@@ -0,0 +1,56 @@
+/* sha256_backend.h - TinyCrypt SHA-256 block compression backends */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/*
+ * Internal interface between sha256.c and the hardware compression
+ * functions. Every backend compresses 'blocks' consecutive 64-byte blocks
+ * from 'data' into the eight-word state 'iv'; 'data' needs no alignment.
+ */
+
+#ifndef __TC_SHA256_BACKEND_H__
+#define __TC_SHA256_BACKEND_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if !defined(TC_SHA256_PORTABLE_ONLY)
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TC_SHA256_HAVE_SHANI 1
+#endif
+/* the ARM intrinsics need the crypto extension enabled at build time
+ * (e.g. -march=armv8-a+crypto); MSVC always provides them */
+#if (defined(__aarch64__) && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))) || \
+    defined(_M_ARM64)
+#define TC_SHA256_HAVE_ARMV8 1
+#endif
+#endif
+
+typedef void (*tc_sha256_compress_t)(unsigned int *iv, const uint8_t *data, size_t blocks);
+
+/* round constants, shared by every backend */
+extern const unsigned int _sha256_k256[64];
+
+#if defined(TC_SHA256_HAVE_SHANI)
+int _sha256_shani_supported(void);
+void _sha256_compress_shani(unsigned int *iv, const uint8_t *data, size_t blocks);
+#endif
+
+#if defined(TC_SHA256_HAVE_ARMV8)
+int _sha256_armv8_supported(void);
+void _sha256_compress_armv8(unsigned int *iv, const uint8_t *data, size_t blocks);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TC_SHA256_BACKEND_H__ */
@@ -0,0 +1,408 @@
+/* sha256_mb.c - TinyCrypt multi-buffer SHA-256 implementation */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+#include <tinycrypt/sha256_mb.h>
+#include <tinycrypt/sha256.h>
+#include <tinycrypt/constants.h>
+#include <tinycrypt/utils.h>
+#include "sha256_backend.h"
+
+#if !defined(TC_SHA256_PORTABLE_ONLY) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define TC_SHA256_MB_HAVE_X86 1
+#endif
+
+#if defined(TC_SHA256_MB_HAVE_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MB_TARGET_SSE2
+#define MB_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define MB_TARGET_SSE2 __attribute__((target("sse2")))
+#define MB_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+typedef void (*mb_compress_t)(uint32_t state[8][TC_SHA256_MB_LANES_MAX],
+			      const uint8_t *const *blocks);
+
+/* one message in flight on a lane */
+struct mb_lane {
+	size_t msg;                      /* message index */
+	const uint8_t *data;             /* next whole block of the message */
+	size_t blocks;                   /* whole blocks left in data */
+	uint8_t tail[2 * TC_SHA256_BLOCK_SIZE]; /* last partial block + padding */
+	unsigned int tail_blocks;        /* padded blocks (1 or 2) */
+	unsigned int tail_next;          /* next padded block to hash */
+	int busy;
+};
+
+static const unsigned int sha256_iv[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/* hashed by idle lanes; their state is never read back */
+static const uint8_t idle_block[TC_SHA256_BLOCK_SIZE];
+
+static unsigned int mb_lanes = 1;
+static mb_compress_t mb_compress;
+static int mb_detected;
+
+static inline uint32_t mb_be32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+	       ((uint32_t)p[2] << 8) | ((uint32_t)p[3]);
+}
+
+#if defined(TC_SHA256_MB_HAVE_X86)
+
+/* 4 lanes, SSE2 */
+#define MB_FN mb_compress_sse2
+#define MB_TARGET MB_TARGET_SSE2
+#define MB_LANES 4
+#define MB_V __m128i
+#define MB_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define MB_STORE(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+#define MB_SET1(x) _mm_set1_epi32((int)(x))
+#define MB_ADD(x, y) _mm_add_epi32((x), (y))
+#define MB_XOR(x, y) _mm_xor_si128((x), (y))
+#define MB_AND(x, y) _mm_and_si128((x), (y))
+#define MB_OR(x, y) _mm_or_si128((x), (y))
+#define MB_ANDNOT(x, y) _mm_andnot_si128((x), (y))
+#define MB_SHR(x, n) _mm_srli_epi32((x), (n))
+#define MB_SHL(x, n) _mm_slli_epi32((x), (n))
+#define MB_GATHER(blk, t) \
+	_mm_set_epi32((int)mb_be32((blk)[3] + ((t) << 2)), (int)mb_be32((blk)[2] + ((t) << 2)), \
+		      (int)mb_be32((blk)[1] + ((t) << 2)), (int)mb_be32((blk)[0] + ((t) << 2)))
+#include "sha256_mb_simd.h"
+#undef MB_FN
+#undef MB_TARGET
+#undef MB_LANES
+#undef MB_V
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_AND
+#undef MB_OR
+#undef MB_ANDNOT
+#undef MB_SHR
+#undef MB_SHL
+#undef MB_GATHER
+
+/* 8 lanes, AVX2 */
+#define MB_FN mb_compress_avx2
+#define MB_TARGET MB_TARGET_AVX2
+#define MB_LANES 8
+#define MB_V __m256i
+#define MB_LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define MB_STORE(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+#define MB_SET1(x) _mm256_set1_epi32((int)(x))
+#define MB_ADD(x, y) _mm256_add_epi32((x), (y))
+#define MB_XOR(x, y) _mm256_xor_si256((x), (y))
+#define MB_AND(x, y) _mm256_and_si256((x), (y))
+#define MB_OR(x, y) _mm256_or_si256((x), (y))
+#define MB_ANDNOT(x, y) _mm256_andnot_si256((x), (y))
+#define MB_SHR(x, n) _mm256_srli_epi32((x), (n))
+#define MB_SHL(x, n) _mm256_slli_epi32((x), (n))
+#define MB_GATHER(blk, t) \
+	_mm256_set_epi32((int)mb_be32((blk)[7] + ((t) << 2)), (int)mb_be32((blk)[6] + ((t) << 2)), \
+			 (int)mb_be32((blk)[5] + ((t) << 2)), (int)mb_be32((blk)[4] + ((t) << 2)), \
+			 (int)mb_be32((blk)[3] + ((t) << 2)), (int)mb_be32((blk)[2] + ((t) << 2)), \
+			 (int)mb_be32((blk)[1] + ((t) << 2)), (int)mb_be32((blk)[0] + ((t) << 2)))
+#include "sha256_mb_simd.h"
+#undef MB_FN
+#undef MB_TARGET
+#undef MB_LANES
+#undef MB_V
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_AND
+#undef MB_OR
+#undef MB_ANDNOT
+#undef MB_SHR
+#undef MB_SHL
+#undef MB_GATHER
+
+static void mb_cpuid(unsigned int leaf, unsigned int *regs)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	__cpuidex((int *)regs, (int)leaf, 0);
+#else
+	if (__get_cpuid_max(0, (void *)0) < leaf) {
+		regs[0] = regs[1] = regs[2] = regs[3] = 0;
+		return;
+	}
+	__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static int mb_sse2_supported(void)
+{
+	unsigned int regs[4];
+
+	mb_cpuid(1, regs);
+	return (regs[3] >> 26) & 1;
+}
+
+static int mb_avx2_supported(void)
+{
+	unsigned int regs[4];
+	unsigned int xcr0;
+
+	/* OSXSAVE and AVX, then the OS must save YMM state */
+	mb_cpuid(1, regs);
+	if (!((regs[2] >> 27) & 1) || !((regs[2] >> 28) & 1)) {
+		return 0;
+	}
+#if defined(_MSC_VER) && !defined(__clang__)
+	xcr0 = (unsigned int)_xgetbv(0);
+#else
+	{
+		unsigned int edx;
+
+		__asm__ volatile("xgetbv" : "=a"(xcr0), "=d"(edx) : "c"(0));
+		(void)edx;
+	}
+#endif
+	if ((xcr0 & 6) != 6) {
+		return 0;
+	}
+
+	mb_cpuid(7, regs);
+	return (regs[1] >> 5) & 1;
+}
+
+#endif /* TC_SHA256_MB_HAVE_X86 */
+
+int tc_sha256_mb_supported(unsigned int lanes)
+{
+	switch (lanes) {
+	case 1:
+		return 1;
+#if defined(TC_SHA256_MB_HAVE_X86)
+	case 4:
+		return mb_sse2_supported();
+	case 8:
+		return mb_avx2_supported();
+#endif
+	default:
+		return 0;
+	}
+}
+
+int tc_sha256_mb_select(unsigned int lanes)
+{
+	if (!tc_sha256_mb_supported(lanes)) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	switch (lanes) {
+#if defined(TC_SHA256_MB_HAVE_X86)
+	case 4:
+		mb_compress = mb_compress_sse2;
+		break;
+	case 8:
+		mb_compress = mb_compress_avx2;
+		break;
+#endif
+	default:
+		mb_compress = (mb_compress_t) 0;
+		break;
+	}
+	mb_lanes = lanes;
+	mb_detected = 1;
+
+	return TC_CRYPTO_SUCCESS;
+}
+
+unsigned int tc_sha256_mb_detect(void)
+{
+	unsigned int lanes = 1;
+
+	/* SHA-NI hashes one message faster than AVX2 hashes eight */
+	if (!tc_sha256_backend_supported(TC_SHA256_BACKEND_SHANI)) {
+		if (tc_sha256_mb_supported(8)) {
+			lanes = 8;
+		} else if (tc_sha256_mb_supported(4)) {
+			lanes = 4;
+		}
+	}
+	(void)tc_sha256_mb_select(lanes);
+
+	return mb_lanes;
+}
+
+unsigned int tc_sha256_mb_lanes(void)
+{
+	return mb_lanes;
+}
+
+/* load message 'msg' onto a lane and reset that lane's state words */
+static void mb_lane_start(struct mb_lane *lane, unsigned int index,
+			  uint32_t state[8][TC_SHA256_MB_LANES_MAX],
+			  size_t msg, const uint8_t *data, size_t datalen)
+{
+	size_t rem = datalen % TC_SHA256_BLOCK_SIZE;
+	uint64_t bits = (uint64_t)datalen << 3;
+	uint8_t *end;
+	unsigned int i;
+
+	lane->msg = msg;
+	lane->data = data;
+	lane->blocks = datalen / TC_SHA256_BLOCK_SIZE;
+	lane->tail_blocks = (rem + 9 > TC_SHA256_BLOCK_SIZE) ? 2 : 1;
+	lane->tail_next = 0;
+	lane->busy = 1;
+
+	_set(lane->tail, 0x00, sizeof(lane->tail));
+	if (rem > 0) {
+		(void)_copy(lane->tail, sizeof(lane->tail),
+			    data + lane->blocks * TC_SHA256_BLOCK_SIZE, (unsigned int)rem);
+	}
+	lane->tail[rem] = 0x80;
+	end = lane->tail + lane->tail_blocks * TC_SHA256_BLOCK_SIZE;
+	for (i = 1; i <= 8; ++i) {
+		end[-(int)i] = (uint8_t)(bits >> ((i - 1) << 3));
+	}
+
+	for (i = 0; i < 8; ++i) {
+		state[i][index] = sha256_iv[i];
+	}
+}
+
+/* next block for a lane; returns 1 when it is the message's last block */
+static int mb_lane_next(struct mb_lane *lane, const uint8_t **block)
+{
+	if (lane->blocks > 0) {
+		*block = lane->data;
+		lane->data += TC_SHA256_BLOCK_SIZE;
+		lane->blocks--;
+		return 0;
+	}
+
+	*block = lane->tail + lane->tail_next * TC_SHA256_BLOCK_SIZE;
+	lane->tail_next++;
+	return lane->tail_next == lane->tail_blocks;
+}
+
+static void mb_digest_out(uint8_t *digest, uint32_t state[8][TC_SHA256_MB_LANES_MAX],
+			  unsigned int index)
+{
+	unsigned int i;
+
+	for (i = 0; i < 8; ++i) {
+		uint32_t t = state[i][index];
+		*digest++ = (uint8_t)(t >> 24);
+		*digest++ = (uint8_t)(t >> 16);
+		*digest++ = (uint8_t)(t >> 8);
+		*digest++ = (uint8_t)(t);
+	}
+}
+
+static int mb_hash_one(uint8_t *digest, const uint8_t *data, size_t datalen)
+{
+	struct tc_sha256_state_struct s;
+
+	if (tc_sha256_init(&s) != TC_CRYPTO_SUCCESS ||
+	    (datalen > 0 && tc_sha256_update(&s, data, datalen) != TC_CRYPTO_SUCCESS)) {
+		return TC_CRYPTO_FAIL;
+	}
+
+	return tc_sha256_final(digest, &s);
+}
+
+int tc_sha256_mb(uint8_t *digests, const uint8_t *const *data,
+		 const size_t *datalen, size_t count)
+{
+	struct mb_lane lanes[TC_SHA256_MB_LANES_MAX];
+	uint32_t state[8][TC_SHA256_MB_LANES_MAX];
+	const uint8_t *blocks[TC_SHA256_MB_LANES_MAX];
+	int done[TC_SHA256_MB_LANES_MAX];
+	unsigned int busy = 0;
+	unsigned int nlanes;
+	unsigned int i;
+	size_t next = 0;
+
+	/* input sanity check: */
+	if (digests == (uint8_t *) 0 ||
+	    (count > 0 && (data == (const uint8_t *const *) 0 || datalen == (const size_t *) 0))) {
+		return TC_CRYPTO_FAIL;
+	}
+	for (next = 0; next < count; ++next) {
+		if (data[next] == (const uint8_t *) 0 && datalen[next] > 0) {
+			return TC_CRYPTO_FAIL;
+		}
+	}
+
+	if (!mb_detected) {
+		(void)tc_sha256_mb_detect();
+	}
+	nlanes = mb_lanes;
+
+	/* one lane: the single-buffer backend is the fastest path */
+	if (nlanes == 1 || mb_compress == (mb_compress_t) 0) {
+		for (next = 0; next < count; ++next) {
+			if (mb_hash_one(digests + next * TC_SHA256_DIGEST_SIZE,
+					data[next], datalen[next]) != TC_CRYPTO_SUCCESS) {
+				return TC_CRYPTO_FAIL;
+			}
+		}
+		return TC_CRYPTO_SUCCESS;
+	}
+
+	next = 0;
+	for (i = 0; i < nlanes; ++i) {
+		lanes[i].busy = 0;
+		if (next < count) {
+			mb_lane_start(&lanes[i], i, state, next, data[next], datalen[next]);
+			next++;
+			busy++;
+		}
+	}
+
+	while (busy > 0) {
+		for (i = 0; i < nlanes; ++i) {
+			if (lanes[i].busy) {
+				done[i] = mb_lane_next(&lanes[i], &blocks[i]);
+			} else {
+				blocks[i] = idle_block;
+				done[i] = 0;
+			}
+		}
+
+		mb_compress(state, blocks);
+
+		/* refill finished lanes so they keep working */
+		for (i = 0; i < nlanes; ++i) {
+			if (!done[i]) {
+				continue;
+			}
+			mb_digest_out(digests + lanes[i].msg * TC_SHA256_DIGEST_SIZE, state, i);
+			if (next < count) {
+				mb_lane_start(&lanes[i], i, state, next, data[next], datalen[next]);
+				next++;
+			} else {
+				lanes[i].busy = 0;
+				busy--;
+			}
+		}
+	}
+
+	/* message tails were copied onto the stack */
+	_set(lanes, 0, sizeof(lanes));
+
+	return TC_CRYPTO_SUCCESS;
+}
@@ -0,0 +1,79 @@
+/* sha256_mb_simd.h - TinyCrypt multi-buffer SHA-256 compression template */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/*
+ * Included once per instruction set by sha256_mb.c (no include guard). One
+ * vector register holds the same state word of MB_LANES messages, so each
+ * operation below runs one SHA-256 step on all lanes at once.
+ *
+ * The includer defines:
+ *   MB_FN, MB_TARGET, MB_LANES, MB_V       function name, attributes, lane
+ *                                          count and vector type
+ *   MB_LOAD(p), MB_STORE(p, v), MB_SET1(x) MB_LANES x uint32_t load/store,
+ *                                          broadcast
+ *   MB_ADD, MB_XOR, MB_AND, MB_OR          lane-wise operations
+ *   MB_ANDNOT(a, b)                        (~a) & b
+ *   MB_SHR(x, n), MB_SHL(x, n)             lane-wise shifts
+ *   MB_GATHER(blocks, t)                   big-endian word t of each lane's
+ *                                          block
+ */
+
+#define MB_ROTR(x, n) MB_OR(MB_SHR((x), (n)), MB_SHL((x), 32 - (n)))
+#define MB_S0(x) MB_XOR(MB_XOR(MB_ROTR((x), 2), MB_ROTR((x), 13)), MB_ROTR((x), 22))
+#define MB_S1(x) MB_XOR(MB_XOR(MB_ROTR((x), 6), MB_ROTR((x), 11)), MB_ROTR((x), 25))
+#define MB_s0(x) MB_XOR(MB_XOR(MB_ROTR((x), 7), MB_ROTR((x), 18)), MB_SHR((x), 3))
+#define MB_s1(x) MB_XOR(MB_XOR(MB_ROTR((x), 17), MB_ROTR((x), 19)), MB_SHR((x), 10))
+#define MB_CH(x, y, z) MB_XOR(MB_AND((x), (y)), MB_ANDNOT((x), (z)))
+#define MB_MAJ(x, y, z) MB_XOR(MB_AND((x), (y)), MB_AND((z), MB_XOR((x), (y))))
+
+MB_TARGET
+static void MB_FN(uint32_t state[8][TC_SHA256_MB_LANES_MAX],
+		  const uint8_t *const *blocks)
+{
+	MB_V a, b, c, d, e, f, g, h;
+	MB_V t1, t2;
+	MB_V w[16];
+	unsigned int i;
+
+	a = MB_LOAD(state[0]); b = MB_LOAD(state[1]);
+	c = MB_LOAD(state[2]); d = MB_LOAD(state[3]);
+	e = MB_LOAD(state[4]); f = MB_LOAD(state[5]);
+	g = MB_LOAD(state[6]); h = MB_LOAD(state[7]);
+
+	for (i = 0; i < 64; ++i) {
+		if (i < 16) {
+			w[i] = MB_GATHER(blocks, i);
+		} else {
+			w[i & 15] = MB_ADD(MB_ADD(w[i & 15], MB_s0(w[(i + 1) & 15])),
+					   MB_ADD(w[(i + 9) & 15], MB_s1(w[(i + 14) & 15])));
+		}
+
+		t1 = MB_ADD(MB_ADD(h, MB_S1(e)), MB_ADD(MB_CH(e, f, g),
+			    MB_ADD(MB_SET1(_sha256_k256[i]), w[i & 15])));
+		t2 = MB_ADD(MB_S0(a), MB_MAJ(a, b, c));
+		h = g; g = f; f = e; e = MB_ADD(d, t1);
+		d = c; c = b; b = a; a = MB_ADD(t1, t2);
+	}
+
+	MB_STORE(state[0], MB_ADD(a, MB_LOAD(state[0])));
+	MB_STORE(state[1], MB_ADD(b, MB_LOAD(state[1])));
+	MB_STORE(state[2], MB_ADD(c, MB_LOAD(state[2])));
+	MB_STORE(state[3], MB_ADD(d, MB_LOAD(state[3])));
+	MB_STORE(state[4], MB_ADD(e, MB_LOAD(state[4])));
+	MB_STORE(state[5], MB_ADD(f, MB_LOAD(state[5])));
+	MB_STORE(state[6], MB_ADD(g, MB_LOAD(state[6])));
+	MB_STORE(state[7], MB_ADD(h, MB_LOAD(state[7])));
+}
+
+#undef MB_ROTR
+#undef MB_S0
+#undef MB_S1
+#undef MB_s0
+#undef MB_s1
+#undef MB_CH
+#undef MB_MAJ
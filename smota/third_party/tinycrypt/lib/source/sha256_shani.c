@@ -0,0 +1,108 @@
+/* sha256_shani.c - TinyCrypt SHA-256 compression using the x86 SHA extensions */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+#include "sha256_backend.h"
+
+#if defined(TC_SHA256_HAVE_SHANI)
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SHANI_TARGET
+#else
+#include <cpuid.h>
+#define SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+
+int _sha256_shani_supported(void)
+{
+	unsigned int ecx1;
+	unsigned int ebx7;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+	int regs[4];
+
+	__cpuid(regs, 0);
+	if (regs[0] < 7) {
+		return 0;
+	}
+	__cpuid(regs, 1);
+	ecx1 = (unsigned int)regs[2];
+	__cpuidex(regs, 7, 0);
+	ebx7 = (unsigned int)regs[1];
+#else
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid_max(0, (void *)0) < 7) {
+		return 0;
+	}
+	__cpuid(1, eax, ebx, ecx, edx);
+	ecx1 = ecx;
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	ebx7 = ebx;
+#endif
+
+	/* SSSE3 (ECX bit 9), SSE4.1 (ECX bit 19), SHA (leaf 7 EBX bit 29) */
+	return ((ecx1 >> 9) & 1) && ((ecx1 >> 19) & 1) && ((ebx7 >> 29) & 1);
+}
+
+SHANI_TARGET
+void _sha256_compress_shani(unsigned int *iv, const uint8_t *data, size_t blocks)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+					     0x0405060700010203ULL);
+	__m128i state0, state1, tmp, msg;
+	__m128i abef, cdgh;
+	__m128i w[4];
+	unsigned int j;
+
+	/* iv holds A..H; the instructions want ABEF and CDGH */
+	tmp = _mm_loadu_si128((const __m128i *)&iv[0]);
+	state1 = _mm_loadu_si128((const __m128i *)&iv[4]);
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);
+	state1 = _mm_shuffle_epi32(state1, 0x1B);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	while (blocks-- > 0) {
+		abef = state0;
+		cdgh = state1;
+
+		for (j = 0; j < 16; ++j) {
+			if (j < 4) {
+				w[j] = _mm_shuffle_epi8(
+					_mm_loadu_si128((const __m128i *)(data + (j << 4))), bswap);
+			} else {
+				tmp = _mm_sha256msg1_epu32(w[j & 3], w[(j + 1) & 3]);
+				tmp = _mm_add_epi32(tmp, _mm_alignr_epi8(w[(j + 3) & 3], w[(j + 2) & 3], 4));
+				w[j & 3] = _mm_sha256msg2_epu32(tmp, w[(j + 3) & 3]);
+			}
+
+			msg = _mm_add_epi32(w[j & 3],
+					    _mm_loadu_si128((const __m128i *)&_sha256_k256[j << 2]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg = _mm_shuffle_epi32(msg, 0x0E);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		}
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+		data += 64;
+	}
+
+	/* back to A..H */
+	tmp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+	_mm_storeu_si128((__m128i *)&iv[0], state0);
+	_mm_storeu_si128((__m128i *)&iv[4], state1);
+}
+
+#endif /* TC_SHA256_HAVE_SHANI */
@@ -2042,30 +2042,42 @@ int test_4(void)
 int main(void)
 {
 	int result = TC_PASS;
+	unsigned int backend;
 
 	TC_START("Performing AES128 tests:");
 
-	result = test_1();
-	if (result == TC_FAIL) { /* terminate test */
-		TC_ERROR("AES128 test #1 (NIST key schedule test) failed.\n");
-		goto exitTest;
-	}
-	result = test_2();
-	if (result == TC_FAIL) { /* terminate test */
-		TC_ERROR("AES128 test #2 (NIST encryption test) failed.\n");
-		goto exitTest;
-	}
-	result = test_3();
-	if (result == TC_FAIL) { /* terminate test */
-		TC_ERROR("AES128 test #3 (NIST fixed-key and variable-text) "
-			 "failed.\n");
-		goto exitTest;
-	}
-	result = test_4();
-	if (result == TC_FAIL) { /* terminate test */
-		TC_ERROR("AES128 test #4 (NIST variable-key and fixed-text) "
-			 "failed.\n");
-		goto exitTest;
+	/* run every vector through each encryption backend this CPU has */
+	for (backend = 0; backend < TC_AES_BACKEND_NUM; ++backend) {
+		if (!tc_aes_backend_supported(backend)) {
+			TC_PRINT("AES backend %s: not supported, skipped\n",
+				 tc_aes_backend_name(backend));
+			continue;
+		}
+		(void)tc_aes_backend_select(backend);
+		TC_PRINT("AES backend %s:\n", tc_aes_backend_name(backend));
+
+		result = test_1();
+		if (result == TC_FAIL) { /* terminate test */
+			TC_ERROR("AES128 test #1 (NIST key schedule test) failed.\n");
+			goto exitTest;
+		}
+		result = test_2();
+		if (result == TC_FAIL) { /* terminate test */
+			TC_ERROR("AES128 test #2 (NIST encryption test) failed.\n");
+			goto exitTest;
+		}
+		result = test_3();
+		if (result == TC_FAIL) { /* terminate test */
+			TC_ERROR("AES128 test #3 (NIST fixed-key and variable-text) "
+				 "failed.\n");
+			goto exitTest;
+		}
+		result = test_4();
+		if (result == TC_FAIL) { /* terminate test */
+			TC_ERROR("AES128 test #4 (NIST variable-key and fixed-text) "
+				 "failed.\n");
+			goto exitTest;
+		}
 	}
 
 	TC_PRINT("All AES128 tests succeeded!\n");
@@ -0,0 +1,153 @@
+/*  test_blake2s.c - TinyCrypt BLAKE2s-256 tests */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/*
+  DESCRIPTION
+  This module tests the following BLAKE2s routines:
+
+  Scenarios tested include:
+  - RFC 7693 Appendix B vector ("abc")
+  - the empty message
+  - a 1000-byte message hashed in one call and in every split point of
+    1..129 bytes (buffered last block, block boundaries, counter updates)
+*/
+
+#include <tinycrypt/blake2s.h>
+#include <tinycrypt/constants.h>
+#include <test_utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define LONG_MESSAGE_SIZE 1000
+
+static uint8_t message[LONG_MESSAGE_SIZE];
+
+/*
+ * RFC 7693 Appendix B: BLAKE2s-256("abc").
+ */
+unsigned int test_1(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("BLAKE2s test #1 (RFC 7693 \"abc\"):\n");
+        const uint8_t expected[32] = {
+		0x50, 0x8c, 0x5e, 0x8c, 0x32, 0x7c, 0x14, 0xe2, 0xe1, 0xa7, 0x2b, 0xa3,
+		0x4e, 0xeb, 0x45, 0x2f, 0x37, 0x45, 0x8b, 0x20, 0x9e, 0xd6, 0x3a, 0x29,
+		0x4d, 0x99, 0x9b, 0x4c, 0x86, 0x67, 0x59, 0x82
+        };
+        const char *m = "abc";
+        uint8_t digest[32];
+        struct tc_blake2s_state_struct s;
+
+        (void)tc_blake2s_init(&s);
+        tc_blake2s_update(&s, (const uint8_t *) m, strlen(m));
+        (void)tc_blake2s_final(digest, &s);
+        result = check_result(1, expected, sizeof(expected),
+			      digest, sizeof(digest));
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * The empty message.
+ */
+unsigned int test_2(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("BLAKE2s test #2 (empty message):\n");
+        const uint8_t expected[32] = {
+		0x69, 0x21, 0x7a, 0x30, 0x79, 0x90, 0x80, 0x94, 0xe1, 0x11, 0x21, 0xd0,
+		0x42, 0x35, 0x4a, 0x7c, 0x1f, 0x55, 0xb6, 0x48, 0x2c, 0xa1, 0xa5, 0x1e,
+		0x1b, 0x25, 0x0d, 0xfd, 0x1e, 0xd0, 0xee, 0xf9
+        };
+        uint8_t digest[32];
+        struct tc_blake2s_state_struct s;
+
+        (void)tc_blake2s_init(&s);
+        (void)tc_blake2s_final(digest, &s);
+        result = check_result(2, expected, sizeof(expected),
+			      digest, sizeof(digest));
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * 1000 bytes of (i * 7 + 1), in one call and split at every point 1..129.
+ */
+unsigned int test_3(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("BLAKE2s test #3 (1000 bytes, split updates):\n");
+        const uint8_t expected[32] = {
+		0x62, 0xb0, 0x88, 0x5e, 0xa8, 0xf0, 0x0f, 0x68, 0xfd, 0xe2, 0x39, 0x2b,
+		0xa5, 0xb0, 0xef, 0xdb, 0xcd, 0x38, 0xa5, 0x23, 0xb3, 0xb2, 0x31, 0x36,
+		0x23, 0x2b, 0x99, 0x5e, 0x0d, 0x1c, 0x46, 0xc3
+        };
+        uint8_t digest[32];
+        struct tc_blake2s_state_struct s;
+        unsigned int step;
+        unsigned int off;
+
+        (void)tc_blake2s_init(&s);
+        tc_blake2s_update(&s, message, sizeof(message));
+        (void)tc_blake2s_final(digest, &s);
+        result = check_result(3, expected, sizeof(expected),
+			      digest, sizeof(digest));
+
+        for (step = 1; step <= 129 && result == TC_PASS; ++step) {
+                (void)tc_blake2s_init(&s);
+                for (off = 0; off < sizeof(message); off += step) {
+                        size_t len = sizeof(message) - off;
+                        tc_blake2s_update(&s, message + off, len < step ? len : step);
+                }
+                (void)tc_blake2s_final(digest, &s);
+                result = check_result(3, expected, sizeof(expected),
+				      digest, sizeof(digest));
+        }
+
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * Main task to test BLAKE2s
+ */
+int main(void)
+{
+        unsigned int result = TC_PASS;
+        unsigned int i;
+        TC_START("Performing BLAKE2s tests:");
+
+        for (i = 0; i < sizeof(message); ++i) {
+                message[i] = (uint8_t)(i * 7 + 1);
+        }
+
+        result = test_1();
+        if (result == TC_FAIL) {
+                TC_ERROR("BLAKE2s test #1 failed.\n");
+                goto exitTest;
+        }
+        result = test_2();
+        if (result == TC_FAIL) {
+                TC_ERROR("BLAKE2s test #2 failed.\n");
+                goto exitTest;
+        }
+        result = test_3();
+        if (result == TC_FAIL) {
+                TC_ERROR("BLAKE2s test #3 failed.\n");
+                goto exitTest;
+        }
+
+        TC_PRINT("All BLAKE2s tests succeeded!\n");
+
+exitTest:
+        TC_END_RESULT(result);
+        TC_END_REPORT(result);
+}
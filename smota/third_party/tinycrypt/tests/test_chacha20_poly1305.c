@@ -0,0 +1,306 @@
+/*  test_chacha20_poly1305.c - TinyCrypt ChaCha20-Poly1305 tests */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/*
+  DESCRIPTION
+  This module tests the following ChaCha20-Poly1305 routines:
+
+  Scenarios tested include:
+  - RFC 8439 2.4.2 ChaCha20 encryption
+  - RFC 8439 2.5.2 Poly1305 tag, in one call and byte by byte
+  - RFC 8439 2.8.2 AEAD encryption, in-place decryption and tag rejection
+  - a 1000-byte message with a 6-byte AAD: decryption with every bit of the
+    tag flipped is rejected and leaves the output zeroed
+*/
+
+#include <tinycrypt/chacha20_poly1305.h>
+#include <tinycrypt/constants.h>
+#include <test_utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define LONG_MESSAGE_SIZE 1000
+
+static const char sunscreen[] =
+	"Ladies and Gentlemen of the class of '99: If I could offer you only "
+	"one tip for the future, sunscreen would be it.";
+
+static uint8_t message[LONG_MESSAGE_SIZE];
+static uint8_t buffer[LONG_MESSAGE_SIZE];
+
+/*
+ * RFC 8439 2.4.2: ChaCha20 with block counter 1.
+ */
+unsigned int test_1(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("ChaCha20-Poly1305 test #1 (RFC 8439 2.4.2 ChaCha20):\n");
+        const uint8_t nonce[12] = {
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00
+        };
+        const uint8_t expected[114] = {
+		0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28,
+		0xdd, 0x0d, 0x69, 0x81, 0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2,
+		0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b, 0xf9, 0x1b, 0x65, 0xc5,
+		0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+		0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35,
+		0x9f, 0x08, 0x61, 0xd8, 0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61,
+		0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e, 0x52, 0xbc, 0x51, 0x4d,
+		0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+		0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed,
+		0xf2, 0x78, 0x5e, 0x42, 0x87, 0x4d
+        };
+        uint8_t key[32];
+        unsigned int i;
+
+        for (i = 0; i < sizeof(key); ++i) {
+                key[i] = (uint8_t) i;
+        }
+
+        (void)tc_chacha20_xor(buffer, (const uint8_t *) sunscreen,
+			      sizeof(expected), key, nonce, 1);
+        result = check_result(1, expected, sizeof(expected),
+			      buffer, sizeof(expected));
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * RFC 8439 2.5.2: Poly1305 over "Cryptographic Forum Research Group".
+ */
+unsigned int test_2(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("ChaCha20-Poly1305 test #2 (RFC 8439 2.5.2 Poly1305):\n");
+        const uint8_t key[32] = {
+		0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33, 0x7f, 0x44, 0x52, 0xfe,
+		0x42, 0xd5, 0x06, 0xa8, 0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd,
+		0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b
+        };
+        const uint8_t expected[16] = {
+		0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6, 0xc2, 0x2b, 0x8b, 0xaf,
+		0x0c, 0x01, 0x27, 0xa9
+        };
+        const char *m = "Cryptographic Forum Research Group";
+        struct tc_poly1305_state_struct s;
+        uint8_t tag[16];
+        size_t i;
+
+        (void)tc_poly1305_init(&s, key);
+        (void)tc_poly1305_update(&s, (const uint8_t *) m, strlen(m));
+        (void)tc_poly1305_final(tag, &s);
+        result = check_result(2, expected, sizeof(expected),
+			      tag, sizeof(tag));
+
+        if (result == TC_PASS) {
+                (void)tc_poly1305_init(&s, key);
+                for (i = 0; i < strlen(m); ++i) {
+                        (void)tc_poly1305_update(&s, (const uint8_t *) m + i, 1);
+                }
+                (void)tc_poly1305_final(tag, &s);
+                result = check_result(2, expected, sizeof(expected),
+				      tag, sizeof(tag));
+        }
+
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * RFC 8439 2.8.2: AEAD encryption and decryption.
+ */
+unsigned int test_3(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("ChaCha20-Poly1305 test #3 (RFC 8439 2.8.2 AEAD):\n");
+        const uint8_t nonce[12] = {
+		0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47
+        };
+        const uint8_t aad[12] = {
+		0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7
+        };
+        const uint8_t expected_ct[114] = {
+		0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc,
+		0x53, 0xef, 0x7e, 0xc2, 0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe,
+		0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6, 0x3d, 0xbe, 0xa4, 0x5e,
+		0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+		0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6,
+		0x7e, 0xcd, 0x3b, 0x36, 0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c,
+		0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58, 0xfa, 0xb3, 0x24, 0xe4,
+		0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+		0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65,
+		0x86, 0xce, 0xc6, 0x4b, 0x61, 0x16
+        };
+        const uint8_t expected_tag[16] = {
+		0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb,
+		0xd0, 0x60, 0x06, 0x91
+        };
+        uint8_t key[32];
+        uint8_t tag[16];
+        unsigned int i;
+
+        for (i = 0; i < sizeof(key); ++i) {
+                key[i] = (uint8_t) (0x80 + i);
+        }
+
+        (void)tc_chacha20_poly1305_encrypt(buffer, tag,
+					   (const uint8_t *) sunscreen,
+					   sizeof(expected_ct), aad, sizeof(aad),
+					   nonce, key);
+        result = check_result(3, expected_ct, sizeof(expected_ct),
+			      buffer, sizeof(expected_ct));
+        if (result == TC_PASS) {
+                result = check_result(3, expected_tag, sizeof(expected_tag),
+				      tag, sizeof(tag));
+        }
+
+        /* in place */
+        if (result == TC_PASS &&
+            tc_chacha20_poly1305_decrypt(buffer, buffer, sizeof(expected_ct),
+					 aad, sizeof(aad), tag, nonce,
+					 key) != TC_CRYPTO_SUCCESS) {
+                TC_ERROR("AEAD decryption rejected a valid tag\n");
+                result = TC_FAIL;
+        }
+        if (result == TC_PASS) {
+                result = check_result(3, (const uint8_t *) sunscreen,
+				      sizeof(expected_ct), buffer,
+				      sizeof(expected_ct));
+        }
+
+        /* a modified AAD must be rejected */
+        if (result == TC_PASS) {
+                uint8_t bad_aad[12];
+
+                memcpy(bad_aad, aad, sizeof(bad_aad));
+                bad_aad[0] ^= 0x01;
+                if (tc_chacha20_poly1305_decrypt(buffer, expected_ct,
+						 sizeof(expected_ct), bad_aad,
+						 sizeof(bad_aad), tag, nonce,
+						 key) != TC_CRYPTO_FAIL) {
+                        TC_ERROR("AEAD decryption accepted a modified AAD\n");
+                        result = TC_FAIL;
+                }
+        }
+
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * 1000 bytes of (i * 7 + 1) under a 6-byte AAD; every tag bit flip is
+ * rejected and clears the output.
+ */
+unsigned int test_4(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("ChaCha20-Poly1305 test #4 (1000 bytes, tag bit flips):\n");
+        const uint8_t aad[6] = { 0x00, 0x10, 0x00, 0x00, 0xe8, 0x03 };
+        const uint8_t expected_tag[16] = {
+		0x14, 0xe8, 0x8c, 0x41, 0xdc, 0x45, 0x56, 0x85, 0xaa, 0x5d, 0x26, 0xaa,
+		0x2b, 0x5e, 0xb5, 0xd2
+        };
+        uint8_t key[32];
+        uint8_t nonce[12];
+        uint8_t tag[16];
+        unsigned int i;
+        unsigned int j;
+
+        for (i = 0; i < sizeof(key); ++i) {
+                key[i] = (uint8_t) (i * 3 + 5);
+        }
+        for (i = 0; i < sizeof(nonce); ++i) {
+                nonce[i] = (uint8_t) i;
+        }
+
+        (void)tc_chacha20_poly1305_encrypt(buffer, tag, message,
+					   sizeof(message), aad, sizeof(aad),
+					   nonce, key);
+        result = check_result(4, expected_tag, sizeof(expected_tag),
+			      tag, sizeof(tag));
+
+        for (i = 0; i < 8 * sizeof(tag) && result == TC_PASS; ++i) {
+                uint8_t bad_tag[16];
+                uint8_t plain[LONG_MESSAGE_SIZE];
+
+                memcpy(bad_tag, tag, sizeof(bad_tag));
+                bad_tag[i / 8] ^= (uint8_t) (1U << (i % 8));
+                memset(plain, 0xa5, sizeof(plain));
+                if (tc_chacha20_poly1305_decrypt(plain, buffer, sizeof(plain),
+						 aad, sizeof(aad), bad_tag,
+						 nonce, key) != TC_CRYPTO_FAIL) {
+                        TC_ERROR("AEAD decryption accepted a modified tag\n");
+                        result = TC_FAIL;
+                }
+                for (j = 0; j < sizeof(plain) && result == TC_PASS; ++j) {
+                        if (plain[j] != 0) {
+                                TC_ERROR("output not cleared on tag mismatch\n");
+                                result = TC_FAIL;
+                        }
+                }
+        }
+
+        if (result == TC_PASS &&
+            tc_chacha20_poly1305_decrypt(buffer, buffer, sizeof(message), aad,
+					 sizeof(aad), tag, nonce,
+					 key) != TC_CRYPTO_SUCCESS) {
+                TC_ERROR("AEAD decryption rejected a valid tag\n");
+                result = TC_FAIL;
+        }
+        if (result == TC_PASS) {
+                result = check_result(4, message, sizeof(message),
+				      buffer, sizeof(message));
+        }
+
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * Main task to test ChaCha20-Poly1305
+ */
+int main(void)
+{
+        unsigned int result = TC_PASS;
+        unsigned int i;
+        TC_START("Performing ChaCha20-Poly1305 tests:");
+
+        for (i = 0; i < sizeof(message); ++i) {
+                message[i] = (uint8_t)(i * 7 + 1);
+        }
+
+        result = test_1();
+        if (result == TC_FAIL) {
+                TC_ERROR("ChaCha20-Poly1305 test #1 failed.\n");
+                goto exitTest;
+        }
+        result = test_2();
+        if (result == TC_FAIL) {
+                TC_ERROR("ChaCha20-Poly1305 test #2 failed.\n");
+                goto exitTest;
+        }
+        result = test_3();
+        if (result == TC_FAIL) {
+                TC_ERROR("ChaCha20-Poly1305 test #3 failed.\n");
+                goto exitTest;
+        }
+        result = test_4();
+        if (result == TC_FAIL) {
+                TC_ERROR("ChaCha20-Poly1305 test #4 failed.\n");
+                goto exitTest;
+        }
+
+        TC_PRINT("All ChaCha20-Poly1305 tests succeeded!\n");
+
+exitTest:
+        TC_END_RESULT(result);
+        TC_END_REPORT(result);
+}
@@ -36,6 +36,9 @@
 
   Scenarios tested include:
   - AES128 CTR mode encryption SP 800-38a tests
+  - multi-block keystream against single-block encryption, including
+    lengths that are not a multiple of the block size and a counter that
+    wraps past 0xffffffff
 */
 
 #include <tinycrypt/ctr_mode.h>
@@ -113,6 +116,88 @@ unsigned int test_1_and_2(void)
         return result;
 }
 
+/*
+ * Reference CTR: one tc_aes_encrypt per block and a byte-wise XOR, as the
+ * original implementation did.
+ */
+static void ctr_reference(uint8_t *out, const uint8_t *in, unsigned int len,
+                          uint8_t *ctr, const TCAesKeySched_t sched)
+{
+        uint8_t buffer[TC_AES_BLOCK_SIZE];
+        unsigned int block_num;
+        unsigned int i;
+
+        block_num = (ctr[12] << 24) | (ctr[13] << 16) | (ctr[14] << 8) | ctr[15];
+        for (i = 0; i < len; ++i) {
+                if ((i % TC_AES_BLOCK_SIZE) == 0) {
+                        (void)tc_aes_encrypt(buffer, ctr, sched);
+                        block_num++;
+                        ctr[12] = (uint8_t)(block_num >> 24);
+                        ctr[13] = (uint8_t)(block_num >> 16);
+                        ctr[14] = (uint8_t)(block_num >> 8);
+                        ctr[15] = (uint8_t)(block_num);
+                }
+                out[i] = buffer[i % TC_AES_BLOCK_SIZE] ^ in[i];
+        }
+}
+
+/*
+ * Multi-block keystream test: every length from 1 to 300 bytes, starting
+ * three blocks before the 32-bit counter wraps.
+ */
+unsigned int test_3(unsigned int backend)
+{
+        const uint8_t key[16] = {
+		0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88,
+		0x09, 0xcf, 0x4f, 0x3c
+        };
+        const uint8_t start[16] = {
+		0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb,
+		0xff, 0xff, 0xff, 0xfd
+        };
+        struct tc_aes_key_sched_struct sched;
+        uint8_t in[300];
+        uint8_t expected[300];
+        uint8_t out[300];
+        uint8_t ctr_ref[16];
+        uint8_t ctr[16];
+        unsigned int result = TC_PASS;
+        unsigned int len;
+        unsigned int i;
+
+        TC_PRINT("CTR test #3 (multi-block keystream):\n");
+        (void)tc_aes128_set_encrypt_key(&sched, key);
+
+        for (i = 0; i < sizeof(in); ++i) {
+                in[i] = (uint8_t)(i * 7 + 1);
+        }
+
+        for (len = 1; len <= sizeof(in); ++len) {
+                /* the reference uses the byte-oriented core */
+                (void)tc_aes_backend_select(TC_AES_BACKEND_BYTE);
+                (void)memcpy(ctr_ref, start, sizeof(ctr_ref));
+                ctr_reference(expected, in, len, ctr_ref, &sched);
+
+                (void)tc_aes_backend_select(backend);
+                (void)memcpy(ctr, start, sizeof(ctr));
+                if (tc_ctr_mode(out, len, in, len, ctr, &sched) == 0) {
+                        TC_ERROR("CTR test #3 failed in %s.\n", __func__);
+                        result = TC_FAIL;
+                        break;
+                }
+
+                if (memcmp(out, expected, len) != 0 ||
+                    memcmp(ctr, ctr_ref, sizeof(ctr)) != 0) {
+                        TC_ERROR("CTR test #3 mismatch at length %u.\n", len);
+                        result = TC_FAIL;
+                        break;
+                }
+        }
+
+        TC_END_RESULT(result);
+        return result;
+}
+
 /*
  * Main task to test AES
  */
@@ -120,14 +205,32 @@ unsigned int test_1_and_2(void)
 int main(void)
 {
         unsigned int result = TC_PASS;
+        unsigned int backend;
 
         TC_START("Performing AES128-CTR mode tests:");
 
-        TC_PRINT("Performing CTR tests:\n");
-        result = test_1_and_2();
-        if (result == TC_FAIL) { /* terminate test */
-                TC_ERROR("CBC test #1 failed.\n");
-                goto exitTest;
+        /* run every test through each encryption backend this CPU has */
+        for (backend = 0; backend < TC_AES_BACKEND_NUM; ++backend) {
+                if (!tc_aes_backend_supported(backend)) {
+                        TC_PRINT("AES backend %s: not supported, skipped\n",
+                                 tc_aes_backend_name(backend));
+                        continue;
+                }
+                (void)tc_aes_backend_select(backend);
+                TC_PRINT("AES backend %s:\n", tc_aes_backend_name(backend));
+
+                TC_PRINT("Performing CTR tests:\n");
+                result = test_1_and_2();
+                if (result == TC_FAIL) { /* terminate test */
+                        TC_ERROR("CTR test #1 failed.\n");
+                        goto exitTest;
+                }
+
+                result = test_3(backend);
+                if (result == TC_FAIL) { /* terminate test */
+                        TC_ERROR("CTR test #3 failed.\n");
+                        goto exitTest;
+                }
         }
 
         TC_PRINT("All CTR tests succeeded!\n");
@@ -36,6 +36,7 @@
 
   Scenarios tested include:
   - HMAC tests (RFC 4231 test vectors)
+  - keyed HMAC object (cached midstates) against the streaming API
 */
 
 #include <tinycrypt/hmac.h>
@@ -302,6 +303,77 @@ unsigned int test_7(void)
         return result;
 }
 
+/*
+ * Keyed HMAC object (cached ipad/opad midstates): one setup, several
+ * messages of different lengths, fed whole and in pieces, must give the
+ * same tags as tc_hmac_set_key/init/update/final. Key sizes cover short,
+ * one-block and longer-than-block keys.
+ */
+unsigned int test_8(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("HMAC %s:\n", __func__);
+        static const unsigned int key_sizes[] = { 1, 20, 32, 64, 65, 131 };
+        static const unsigned int msg_sizes[] = { 0, 1, 31, 55, 56, 64, 200 };
+        uint8_t key[131];
+        uint8_t msg[200];
+        uint8_t expected[32];
+        uint8_t digest[32];
+        struct tc_hmac_state_struct h;
+        struct tc_hmac_key_struct hkey;
+        struct tc_sha256_state_struct s;
+        unsigned int i;
+        unsigned int j;
+
+        for (i = 0; i < sizeof(key); ++i) {
+                key[i] = (uint8_t)(i * 7 + 1);
+        }
+        for (i = 0; i < sizeof(msg); ++i) {
+                msg[i] = (uint8_t)(i * 13 + 5);
+        }
+
+        for (i = 0; i < sizeof(key_sizes) / sizeof(key_sizes[0]); ++i) {
+                (void)tc_hmac_key_setup(&hkey, key, key_sizes[i]);
+
+                for (j = 0; j < sizeof(msg_sizes) / sizeof(msg_sizes[0]); ++j) {
+                        unsigned int len = msg_sizes[j];
+
+                        (void)tc_hmac_set_key(&h, key, key_sizes[i]);
+                        (void)tc_hmac_init(&h);
+                        (void)tc_hmac_update(&h, msg, len);
+                        (void)tc_hmac_final(expected, sizeof(expected), &h);
+
+                        (void)tc_hmac_key_compute(digest, sizeof(digest),
+                                                  &hkey, msg, len);
+                        result = check_result(8, expected, sizeof(expected),
+                                              digest, sizeof(digest));
+                        if (result == TC_FAIL) {
+                                goto exitTest1;
+                        }
+
+                        (void)tc_hmac_key_start(&s, &hkey);
+                        (void)tc_sha256_update(&s, msg, len / 2);
+                        (void)tc_sha256_update(&s, msg + len / 2, len - len / 2);
+                        (void)tc_hmac_key_finish(digest, sizeof(digest), &s, &hkey);
+                        result = check_result(8, expected, sizeof(expected),
+                                              digest, sizeof(digest));
+                        if (result == TC_FAIL) {
+                                goto exitTest1;
+                        }
+                }
+        }
+
+        if (tc_hmac_key_compute(digest, 16, &hkey, msg, 1) != TC_CRYPTO_FAIL ||
+            tc_hmac_key_setup(&hkey, key, 0) != TC_CRYPTO_FAIL) {
+                TC_ERROR("HMAC keyed object accepted invalid arguments\n");
+                result = TC_FAIL;
+        }
+
+exitTest1:
+        TC_END_RESULT(result);
+        return result;
+}
+
 /*
  * Main task to test AES
  */
@@ -353,6 +425,12 @@ int main(void)
                 TC_ERROR("HMAC test #7 failed.\n");
                 goto exitTest;
         }
+        result = test_8();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("HMAC test #8 failed.\n");
+                goto exitTest;
+        }
 
         TC_PRINT("All HMAC tests succeeded!\n");
 
@@ -411,10 +411,48 @@ unsigned int test_14(void)
  * Main task to test AES
  */
 
-int main(void)
+/*
+ * Same 1000-byte message fed in every chunk size from 1 to 130 bytes, so the
+ * buffered head/tail and the direct whole-block path are mixed at every
+ * possible leftover offset.
+ */
+unsigned int test_15(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("SHA256 test #15 (split updates):\n");
+        const uint8_t expected[32] = {
+		0x09, 0x5e, 0xcb, 0x62, 0xe3, 0x07, 0x93, 0xab, 0x4b, 0x95, 0x4c, 0xd6,
+		0xa0, 0x58, 0x6d, 0x0c, 0xc9, 0x1f, 0x7e, 0xa5, 0xb1, 0x33, 0x26, 0x94,
+		0xd8, 0xda, 0x78, 0x0e, 0x98, 0x67, 0x6d, 0x78
+        };
+        uint8_t m[1000];
+        uint8_t digest[32];
+        struct tc_sha256_state_struct s;
+        unsigned int chunk;
+        unsigned int i;
+
+        for (i = 0; i < sizeof(m); ++i) {
+                m[i] = (uint8_t)(i * 7 + 1);
+        }
+
+        for (chunk = 1; chunk <= 130 && result == TC_PASS; ++chunk) {
+                (void)tc_sha256_init(&s);
+                for (i = 0; i < sizeof(m); i += chunk) {
+                        unsigned int len = (sizeof(m) - i < chunk) ?
+                                           (unsigned int)(sizeof(m) - i) : chunk;
+                        tc_sha256_update(&s, m + i, len);
+                }
+                (void)tc_sha256_final(digest, &s);
+                result = check_result(15, expected, sizeof(expected),
+				      digest, sizeof(digest));
+        }
+        TC_END_RESULT(result);
+        return result;
+}
+
+unsigned int test_all(void)
 {
         unsigned int result = TC_PASS;
-        TC_START("Performing SHA256 tests (NIST tests vectors):");
 
         result = test_1();
         if (result == TC_FAIL) {
@@ -501,6 +539,40 @@ int main(void)
                 TC_ERROR("SHA256 test #14 failed.\n");
                 goto exitTest;
         }
+        result = test_15();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA256 test #15 failed.\n");
+                goto exitTest;
+        }
+
+exitTest:
+        return result;
+}
+
+int main(void)
+{
+        unsigned int result = TC_PASS;
+        unsigned int backend;
+        TC_START("Performing SHA256 tests (NIST tests vectors):");
+
+        /* run every vector through each compression backend this CPU has */
+        for (backend = 0; backend < TC_SHA256_BACKEND_NUM; ++backend) {
+                if (!tc_sha256_backend_supported(backend)) {
+                        TC_PRINT("SHA256 backend %s: not supported, skipped\n",
+                                 tc_sha256_backend_name(backend));
+                        continue;
+                }
+                (void)tc_sha256_backend_select(backend);
+                TC_PRINT("SHA256 backend %s:\n", tc_sha256_backend_name(backend));
+
+                result = test_all();
+                if (result == TC_FAIL) {
+                        TC_ERROR("SHA256 backend %s failed.\n",
+                                 tc_sha256_backend_name(backend));
+                        goto exitTest;
+                }
+        }
 
         TC_PRINT("All SHA256 tests succeeded!\n");
 
@@ -0,0 +1,201 @@
+/*  test_sha256_mb.c - TinyCrypt multi-buffer SHA-256 tests */
+
+/*
+ *  Copyright (c) 2026 by Lu Xianfan.
+ *
+ *  Distributed under the same terms as the rest of TinyCrypt (see LICENSE).
+ */
+
+/*
+  DESCRIPTION
+  This module tests the following multi-buffer SHA256 routines:
+
+  Scenarios tested include:
+  - NIST SHA256 short vectors hashed together in one batch
+  - 300 messages of every length 0..299 (all padding cases, lanes refilled
+    at different times) against tc_sha256_*
+  - a batch with fewer messages than lanes
+  - each lane count supported by the CPU
+*/
+
+#include <tinycrypt/sha256_mb.h>
+#include <tinycrypt/sha256.h>
+#include <tinycrypt/constants.h>
+#include <test_utils.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define NUM_MESSAGES 300
+
+static uint8_t message[NUM_MESSAGES];
+static uint8_t expected[NUM_MESSAGES][TC_SHA256_DIGEST_SIZE];
+static uint8_t digests[NUM_MESSAGES][TC_SHA256_DIGEST_SIZE];
+
+/*
+ * NIST vectors "abc" and the 448-bit message, plus the empty message.
+ */
+unsigned int test_1(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("SHA256 multi-buffer test #1 (NIST vectors):\n");
+        const uint8_t nist[3][32] = {
+                {
+		0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde,
+		0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+		0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+                }, {
+		0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93,
+		0x0c, 0x3e, 0x60, 0x39, 0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+		0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+                }, {
+		0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8,
+		0x99, 0x6f, 0xb9, 0x24, 0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c,
+		0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55
+                }
+        };
+        const char *m1 = "abc";
+        const char *m2 = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+        const uint8_t *data[3] = {
+                (const uint8_t *) m1, (const uint8_t *) m2, (const uint8_t *) m1
+        };
+        const size_t datalen[3] = { strlen(m1), strlen(m2), 0 };
+        uint8_t out[3][TC_SHA256_DIGEST_SIZE];
+        unsigned int i;
+
+        if (tc_sha256_mb(&out[0][0], data, datalen, 3) != TC_CRYPTO_SUCCESS) {
+                result = TC_FAIL;
+        }
+        for (i = 0; i < 3 && result == TC_PASS; ++i) {
+                result = check_result(1, nist[i], sizeof(nist[i]),
+				      out[i], sizeof(out[i]));
+        }
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * Lengths 0..299 hashed in one batch must match the single-buffer API.
+ */
+unsigned int test_2(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("SHA256 multi-buffer test #2 (lengths 0..299):\n");
+        const uint8_t *data[NUM_MESSAGES];
+        size_t datalen[NUM_MESSAGES];
+        unsigned int i;
+
+        for (i = 0; i < NUM_MESSAGES; ++i) {
+                data[i] = message;
+                datalen[i] = i;
+        }
+
+        if (tc_sha256_mb(&digests[0][0], data, datalen, NUM_MESSAGES) != TC_CRYPTO_SUCCESS) {
+                result = TC_FAIL;
+        }
+        for (i = 0; i < NUM_MESSAGES && result == TC_PASS; ++i) {
+                result = check_result(2, expected[i], sizeof(expected[i]),
+				      digests[i], sizeof(digests[i]));
+        }
+        TC_END_RESULT(result);
+        return result;
+}
+
+/*
+ * Fewer messages than lanes leaves lanes idle from the start.
+ */
+unsigned int test_3(void)
+{
+        unsigned int result = TC_PASS;
+        TC_PRINT("SHA256 multi-buffer test #3 (partial batch):\n");
+        const uint8_t *data[2] = { message, message + 1 };
+        const size_t datalen[2] = { 200, 64 };
+
+        if (tc_sha256_mb(&digests[0][0], data, datalen, 2) != TC_CRYPTO_SUCCESS ||
+            tc_sha256_mb(&digests[0][0], data, datalen, 0) != TC_CRYPTO_SUCCESS) {
+                result = TC_FAIL;
+        }
+        if (result == TC_PASS) {
+                result = check_result(3, expected[200], sizeof(expected[200]),
+				      digests[0], sizeof(digests[0]));
+        }
+        if (result == TC_PASS) {
+                uint8_t single[TC_SHA256_DIGEST_SIZE];
+                struct tc_sha256_state_struct s;
+
+                (void)tc_sha256_init(&s);
+                (void)tc_sha256_update(&s, message + 1, 64);
+                (void)tc_sha256_final(single, &s);
+                result = check_result(3, single, sizeof(single),
+				      digests[1], sizeof(digests[1]));
+        }
+        TC_END_RESULT(result);
+        return result;
+}
+
+unsigned int test_all(void)
+{
+        unsigned int result = TC_PASS;
+
+        result = test_1();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA256 multi-buffer test #1 failed.\n");
+                goto exitTest;
+        }
+        result = test_2();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA256 multi-buffer test #2 failed.\n");
+                goto exitTest;
+        }
+        result = test_3();
+        if (result == TC_FAIL) {
+		/* terminate test */
+                TC_ERROR("SHA256 multi-buffer test #3 failed.\n");
+                goto exitTest;
+        }
+
+exitTest:
+        return result;
+}
+
+int main(void)
+{
+        unsigned int result = TC_PASS;
+        static const unsigned int lanes[] = { 1, 4, 8 };
+        struct tc_sha256_state_struct s;
+        unsigned int i;
+        TC_START("Performing multi-buffer SHA256 tests:");
+
+        for (i = 0; i < NUM_MESSAGES; ++i) {
+                message[i] = (uint8_t)(i * 7 + 1);
+        }
+        for (i = 0; i < NUM_MESSAGES; ++i) {
+                (void)tc_sha256_init(&s);
+                (void)tc_sha256_update(&s, message, i);
+                (void)tc_sha256_final(expected[i], &s);
+        }
+
+        for (i = 0; i < sizeof(lanes) / sizeof(lanes[0]); ++i) {
+                if (tc_sha256_mb_select(lanes[i]) != TC_CRYPTO_SUCCESS) {
+                        TC_PRINT("SHA256 %u lanes: not supported, skipped\n", lanes[i]);
+                        continue;
+                }
+                TC_PRINT("SHA256 %u lanes:\n", lanes[i]);
+
+                result = test_all();
+                if (result == TC_FAIL) {
+                        TC_ERROR("SHA256 %u lanes failed.\n", lanes[i]);
+                        goto exitTest;
+                }
+        }
+
+        TC_PRINT("All multi-buffer SHA256 tests succeeded!\n");
+
+exitTest:
+        TC_END_RESULT(result);
+        TC_END_REPORT(result);
+}